@@ -197,15 +197,17 @@ void createSphereInVolume(LargeVolume<MaterialDensityPair44>& volData, Vector3DF
 	}
 }
 
+//Shared by the threads which generate() runs load() on. Perlin sets up its tables (using rand()) the
+//first time it is used, so main() makes sure that has happened before any of the threads start.
+Perlin g_perlin(2,2,1,234);
+
 void load(const ConstVolumeProxy<MaterialDensityPair44>& volume, const PolyVox::Region& reg)
 {
-	Perlin perlin(2,2,1,234);
-
 	for(int x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
 	{
 		for(int y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
 		{
-			float perlinVal = perlin.Get(x / static_cast<float>(255-1), y / static_cast<float>(255-1));
+			float perlinVal = g_perlin.Get(x / static_cast<float>(255-1), y / static_cast<float>(255-1));
 			perlinVal += 1.0f;
 			perlinVal *= 0.5f;
 			perlinVal *= 255;
@@ -243,6 +245,12 @@ void unload(const ConstVolumeProxy<MaterialDensityPair44>& /*vol*/, const PolyVo
 	std::cout << "warning unloading region: " << reg.getLowerCorner() << " -> " << reg.getUpperCorner() << std::endl;
 }
 
+bool printProgress(uint32_t uNoOfBlocksGenerated, uint32_t uNoOfBlocks)
+{
+	std::cout << "Generated " << uNoOfBlocksGenerated << " of " << uNoOfBlocks << " blocks" << std::endl;
+	return true;
+}
+
 int main(int argc, char *argv[])
 {
 	//Create and show the Qt OpenGL window
@@ -270,8 +278,9 @@ int main(int argc, char *argv[])
 	std::cout << "Compression ratio: 1 to " << (1.0/(volData.calculateCompressionRatio())) << std::endl;
 	//volData.setBlockCacheSize(64);
 	PolyVox::Region reg(Vector3DInt32(-255,0,0), Vector3DInt32(255,255,255));
-	std::cout << "Prefetching region: " << reg.getLowerCorner() << " -> " << reg.getUpperCorner() << std::endl;
-	volData.prefetch(reg);
+	std::cout << "Generating region: " << reg.getLowerCorner() << " -> " << reg.getUpperCorner() << std::endl;
+	g_perlin.Get(0.0f, 0.0f);
+	volData.generate(reg, &load, 0, &printProgress);
 	std::cout << "Memory usage: " << (volData.calculateSizeInBytes()/1024.0/1024.0) << "MB" << std::endl;
 	std::cout << "Compression ratio: 1 to " << (1.0/(volData.calculateCompressionRatio())) << std::endl;
 	PolyVox::Region reg2(Vector3DInt32(0,0,0), Vector3DInt32(255,255,255));
@@ -91,22 +91,25 @@ int main(int argc, char *argv[])
 	//smoothRegion<SimpleVolume, Density8>(volData, volData.getEnclosingRegion());
 	//smoothRegion<SimpleVolume, Density8>(volData, volData.getEnclosingRegion());
 
-	RawVolume<uint8_t> volDataLowLOD(PolyVox::Region(Vector3DInt32(0,0,0), Vector3DInt32(15, 31, 31)));
+	//Going from 63 voxels to 32 keeps every second voxel, which is what the transition cells expect.
+	RawVolume<uint8_t> volDataLowLOD(PolyVox::Region(Vector3DInt32(0,0,0), Vector3DInt32(31, 31, 31)));
 
-	VolumeResampler< SimpleVolume<uint8_t>, RawVolume<uint8_t> > volumeResampler(&volData, PolyVox::Region(Vector3DInt32(0,0,0), Vector3DInt32(31, 63, 63)), &volDataLowLOD, volDataLowLOD.getEnclosingRegion());
+	VolumeResampler< SimpleVolume<uint8_t>, RawVolume<uint8_t> > volumeResampler(&volData, PolyVox::Region(Vector3DInt32(0,0,0), Vector3DInt32(62, 62, 62)), &volDataLowLOD, volDataLowLOD.getEnclosingRegion());
 	volumeResampler.execute();
 
 	//Extract the surface
 	SurfaceMesh<PositionMaterialNormal> meshLowLOD;
-	MarchingCubesSurfaceExtractor< RawVolume<uint8_t> > surfaceExtractor(&volDataLowLOD, volDataLowLOD.getEnclosingRegion(), &meshLowLOD);
+	MarchingCubesSurfaceExtractor< RawVolume<uint8_t> > surfaceExtractor(&volDataLowLOD, PolyVox::Region(Vector3DInt32(0,0,0), Vector3DInt32(16, 31, 31)), &meshLowLOD);
 	surfaceExtractor.execute();
-	meshLowLOD.scaleVertices(/*2.0f*/63.0f / 31.0f);
+	meshLowLOD.scaleVertices(2.0f);
 
-	//Extract the surface
+	//Extract the surface. The low detail mesh is on the other side of its negative x face, so
+	//transition cells are added there to join the two meshes up without any cracks.
 	SurfaceMesh<PositionMaterialNormal> meshHighLOD;
-	MarchingCubesSurfaceExtractor< SimpleVolume<uint8_t> > surfaceExtractorHigh(&volData, PolyVox::Region(Vector3DInt32(30,0,0), Vector3DInt32(63, 63, 63)), &meshHighLOD);
+	MarchingCubesSurfaceExtractor< SimpleVolume<uint8_t> > surfaceExtractorHigh(&volData, PolyVox::Region(Vector3DInt32(32,0,0), Vector3DInt32(63, 62, 62)), &meshHighLOD);
+	surfaceExtractorHigh.setTransitionFace(RegionFaces::NegativeX, true);
 	surfaceExtractorHigh.execute();
-	meshHighLOD.translateVertices(Vector3DFloat(30, 0, 0));
+	meshHighLOD.translateVertices(Vector3DFloat(32, 0, 0));
 
 	//Pass the surface to the OpenGL window
 	openGLWidget.setSurfaceMeshToRender(meshHighLOD);
@@ -128,6 +128,8 @@ namespace PolyVox
 		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
 		/// Gets a voxel at the position given by a 3D vector
 		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
 
 		/// Sets the value used for voxels which are outside the volume
 		void setBorderValue(const VoxelType& tBorder);
@@ -135,6 +137,14 @@ namespace PolyVox
 		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
 		/// Sets the voxel at the position given by a 3D vector
 		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+
+		/// Finds the smallest and largest densities in a region, if the volume keeps track of them
+		template <typename DensityType>
+		bool calculateDensityRange(const Region& region, DensityType& tMin, DensityType& tMax) const;
 
 		/// Calculates approximatly how many bytes of memory the volume is currently using.
 		uint32_t calculateSizeInBytes(void);
@@ -177,6 +177,21 @@ namespace PolyVox
 		return VoxelType();
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels are written to the buffer with \c x varying fastest, then \c y, then \c z, so the buffer must
+	/// have space for as many voxels as the region contains. Voxels which are outside the volume are given the
+	/// border value. Derived volumes copy whole rows of voxels at a time, which is much faster than calling
+	/// getVoxelAt() for each one. Subclasses don't have to provide it, as the surface extractors and the
+	/// VolumeResampler fall back on getVoxelAt() and setVoxelAt() for volumes which don't.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void BaseVolume<VoxelType>::readRegion(const Region& /*regRead*/, VoxelType* /*pDestination*/) const
+	{
+		assert(false);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// \param tBorder The value to use for voxels outside the volume.
 	////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +227,45 @@ namespace PolyVox
 		return false;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// The buffer is laid out as for readRegion(). Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void BaseVolume<VoxelType>::writeRegion(const Region& /*regWrite*/, const VoxelType* /*pSource*/)
+	{
+		assert(false);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. Volumes which store uniform blocks
+	/// compactly will do so for any blocks which are completely covered by the region.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void BaseVolume<VoxelType>::fillRegion(const Region& /*regFill*/, VoxelType /*tValue*/)
+	{
+		assert(false);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The densities are the ones given by the DefaultMarchingCubesController for the voxel type. Volumes which store
+	/// their voxels in blocks keep a summary of each block's densities, which lets the surface extractors skip over
+	/// blocks that can't contain any of the surface. Other volumes don't, and just return false.
+	/// \param region The region to look at, which may extend outside the volume
+	/// \param tMin Set to the smallest density in the region
+	/// \param tMax Set to the largest density in the region
+	/// \return Whether the range could be found
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	template <typename DensityType>
+	bool BaseVolume<VoxelType>::calculateDensityRange(const Region& /*region*/, DensityType& /*tMin*/, DensityType& /*tMax*/) const
+	{
+		return false;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// Note: This function needs reviewing for accuracy...
 	////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,128 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_BlockCompressor_H__
+#define __PolyVox_BlockCompressor_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/Impl/VoxelRuns.h"
+
+#include <vector>
+
+namespace PolyVox
+{
+	/// The interface for the codecs which the LargeVolume uses to compress its blocks.
+	////////////////////////////////////////////////////////////////////////////////
+	/// Which compression scheme works best depends heavily on your data, so the LargeVolume lets you choose
+	/// one with LargeVolume::setCompressor(). PolyVox provides the following implementations:
+	///
+	/// - RLECompressor: Simple run length encoding along the x axis. This is the default, and works well for
+	///   data which is made of large areas of a single value.
+	/// - MortonRLECompressor: Run length encoding along a Morton (Z-order) curve. Runs continue across
+	///   neighbouring rows and slices, so this usually does better on caves, overhangs and other 3D structure.
+	/// - PaletteCompressor: Stores each distinct value once and then a 1, 2, 4, 8 or 16 bit index per voxel.
+	///   This gives a fixed size which doesn't depend on the shape of the data, so it suits noisy blocks with
+	///   only a handful of materials.
+	/// - LZCompressor: A byte oriented LZ77 compressor in the style of LZ4. It finds repeated patterns as well
+	///   as runs, at the cost of slower compression.
+	///
+	/// You can use LargeVolume::calculateCompressionRatio() to see how each of them performs on your data.
+	///
+	/// The voxels are passed to the compressors in whatever order the block stores them (see LargeVolume::setBlockLayout()).
+	/// With the Morton layout the RLECompressor therefore already follows a Morton curve, and the MortonRLECompressor is
+	/// not needed.
+	///
+	/// As well as compressing and decompressing, the LargeVolume can ask a compressor to answer some queries directly from the
+	/// compressed data: reading a single voxel (getVoxelAt()) and summarising the values in a block (visitRuns()). This lets it
+	/// inspect blocks which aren't in its cache without uncompressing them and pushing out the blocks which are being used.
+	/// The default implementations just decompress the data into a temporary buffer, so compressors should override them
+	/// where they can do better.
+	///
+	/// You can also implement your own. Compressors may be called from several threads at once (see
+	/// LargeVolume::setNumberOfPagingThreads()) so the functions are const and should not modify any state.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class BlockCompressor
+	{
+	public:
+		virtual ~BlockCompressor() {}
+
+		/// Compresses the uSideLength^3 voxels of a block, replacing the contents of vecCompressedData.
+		virtual void compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const = 0;
+		/// Restores the uSideLength^3 voxels of a block from the data written by compress().
+		virtual void decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const = 0;
+
+		/// Compresses a block in which every voxel has the same value.
+		////////////////////////////////////////////////////////////////////////////////
+		/// The LargeVolume stores such blocks as a single value rather than compressing them, but it
+		/// still uses this when measuring compressors (see LargeVolume::calculateCompressionRatio()).
+		/// Compressors should override it if they can avoid building the whole block first.
+		////////////////////////////////////////////////////////////////////////////////
+		virtual void compressUniform(VoxelType tValue, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+		{
+			std::vector<VoxelType> vecVoxels(uSideLength * uSideLength * uSideLength, tValue);
+			compress(&vecVoxels[0], uSideLength, vecCompressedData);
+		}
+
+		/// Reads one voxel from the data written by compress().
+		////////////////////////////////////////////////////////////////////////////////
+		/// \param vecCompressedData The compressed block.
+		/// \param uSideLength The side length of the block.
+		/// \param uIndex The position of the voxel in the array which was passed to compress().
+		/// \return The value of the voxel.
+		////////////////////////////////////////////////////////////////////////////////
+		virtual VoxelType getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, uint32_t uIndex) const
+		{
+			std::vector<VoxelType> vecVoxels(uSideLength * uSideLength * uSideLength);
+			decompress(vecCompressedData, &vecVoxels[0], uSideLength);
+			return vecVoxels[uIndex];
+		}
+
+		/// Passes every voxel in the data written by compress() to a function, grouped into runs of the same value.
+		////////////////////////////////////////////////////////////////////////////////
+		/// The function is called with a value and the number of voxels in the run. The runs may be visited in any order,
+		/// and neighbouring runs can have the same value, so this is only suitable for things which don't depend on where
+		/// the voxels are such as finding the range of values or counting voxels.
+		/// \param vecCompressedData The compressed block.
+		/// \param uSideLength The side length of the block.
+		/// \param funcVisitor The function to call for each run.
+		////////////////////////////////////////////////////////////////////////////////
+		virtual void visitRuns(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const
+		{
+			const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+			std::vector<VoxelType> vecVoxels(uNoOfVoxels);
+			decompress(vecCompressedData, &vecVoxels[0], uSideLength);
+			for(uint32_t ct = 0; ct < uNoOfVoxels; )
+			{
+				const uint32_t uLength = findRunLength(&vecVoxels[ct], uNoOfVoxels - ct);
+				funcVisitor(vecVoxels[ct], uLength);
+				ct += uLength;
+			}
+		}
+
+		/// Gets a short name for the compressor, for use when reporting results.
+		virtual const char* getName(void) const = 0;
+	};
+}
+
+#endif //__PolyVox_BlockCompressor_H__
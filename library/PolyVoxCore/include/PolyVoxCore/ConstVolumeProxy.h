@@ -24,11 +24,19 @@ freely, subject to the following restrictions:
 #ifndef __PolyVox_ConstVolumeProxy_H__
 #define __PolyVox_ConstVolumeProxy_H__
 
+#include "PolyVoxCore/Impl/Block.h"
 #include "PolyVoxCore/Region.h"
 #include "PolyVoxCore/Vector.h"
 
 namespace PolyVox
 {
+	/// Gives the LargeVolume's paging handlers access to the block which is being paged in or out.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The proxy reads and writes the block directly rather than going back through the volume.
+	/// This means a handler never touches the block table or the block cache, so it is safe for
+	/// the volume to call it while holding its own locks (see LargeVolume::setConcurrentAccessEnabled()).
+	/// It also means that only the voxels within the given region can be accessed.
+	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	class ConstVolumeProxy
 	{
@@ -38,7 +46,12 @@ namespace PolyVox
 		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
 		{
 			assert(m_regValid.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
-			return m_pVolume.getVoxelAt(uXPos, uYPos, uZPos);
+			return m_block.getVoxelAt
+			(
+				static_cast<uint16_t>(uXPos - m_regValid.getLowerCorner().getX()),
+				static_cast<uint16_t>(uYPos - m_regValid.getLowerCorner().getY()),
+				static_cast<uint16_t>(uZPos - m_regValid.getLowerCorner().getZ())
+			);
 		}
 
 		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const
@@ -50,7 +63,13 @@ namespace PolyVox
 		void setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue) const
 		{
 			assert(m_regValid.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
-			m_pVolume.setVoxelAtConst(uXPos, uYPos, uZPos, tValue);
+			m_block.setVoxelAt
+			(
+				static_cast<uint16_t>(uXPos - m_regValid.getLowerCorner().getX()),
+				static_cast<uint16_t>(uYPos - m_regValid.getLowerCorner().getY()),
+				static_cast<uint16_t>(uZPos - m_regValid.getLowerCorner().getZ()),
+				tValue
+			);
 		}
 
 		void setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue) const
@@ -59,9 +78,10 @@ namespace PolyVox
 			setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
 		}
 	private:
-		//Private constructor, so client code can't abuse this class.
-		ConstVolumeProxy(const LargeVolume<VoxelType>& pVolume, const Region& regValid)
-			:m_pVolume(pVolume)
+		//Private constructor, so client code can't abuse this class. The
+		//block must be uncompressed for as long as the proxy is in use.
+		ConstVolumeProxy(Block<VoxelType>& block, const Region& regValid)
+			:m_block(block)
 			,m_regValid(regValid)
 		{
 		}
@@ -71,7 +91,7 @@ namespace PolyVox
 		{
 		}
 
-		const LargeVolume<VoxelType>& m_pVolume;
+		Block<VoxelType>& m_block;
 		const Region& m_regValid;
 	};
 }
@@ -0,0 +1,209 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_FixedRawVolume_H__
+#define __PolyVox_FixedRawVolume_H__
+
+#include "Impl/RegionCopy.h"
+
+#include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/Log.h"
+#include "PolyVoxCore/Region.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <cassert>
+#include <limits>
+#include <memory>
+
+namespace PolyVox
+{
+	/// A RawVolume whose dimensions are fixed at compile time.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The FixedRawVolume stores its voxels in the same way as the RawVolume (a single array with \c x varying fastest, then \c y, then \c z)
+	/// but its width, height and depth are template parameters. This means the strides between rows and slices are constants, so indexing
+	/// the volume is just a few additions and the offsets used by the Sampler's peek functions are all known to the compiler. It is intended
+	/// for the small fixed size chunks (e.g. 32x32x32 or 64x64x64) which are often copied out of a larger volume for surface extraction or
+	/// filtering:
+	///
+	/// \code
+	/// FixedRawVolume<MaterialDensityPair44, 33, 33, 33> volChunk(v3dChunkLowerCorner);
+	/// volLarge.readRegion(volChunk.getEnclosingRegion(), volChunk.getData());
+	/// MarchingCubesSurfaceExtractor< FixedRawVolume<MaterialDensityPair44, 33, 33, 33> > extractor(&volChunk, volChunk.getEnclosingRegion(), &mesh);
+	/// extractor.execute();
+	/// \endcode
+	///
+	/// Only the size is fixed. The position of the volume is passed to the constructor and can be changed with setLowerCorner(), so a
+	/// single FixedRawVolume can be reused for every chunk.
+	///
+	/// The Sampler keeps track of whether it is at least one voxel inside the volume on every side. When it is (which is nearly always the
+	/// case for the larger sizes) each peek is a single read at a constant offset from the current voxel. Otherwise it falls back on
+	/// getVoxelAt().
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	class FixedRawVolume : public BaseVolume<VoxelType>
+	{
+	public:
+		/// The number of voxels between neighbours in the \c y direction.
+		static const int32_t YStride = Width;
+		/// The number of voxels between neighbours in the \c z direction.
+		static const int32_t ZStride = Width * Height;
+		/// The total number of voxels in the volume.
+		static const uint32_t NoOfVoxels = Width * Height * Depth;
+
+		#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< FixedRawVolume<VoxelType, Width, Height, Depth> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< FixedRawVolume<VoxelType, Width, Height, Depth> > //This line works on GCC
+#endif
+		{
+		public:
+			Sampler(FixedRawVolume<VoxelType, Width, Height, Depth>* volume);
+			~Sampler();
+
+			inline VoxelType getVoxel(void) const;
+
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			inline bool setVoxel(VoxelType tValue);
+
+			inline void movePositiveX(void);
+			inline void movePositiveY(void);
+			inline void movePositiveZ(void);
+
+			inline void moveNegativeX(void);
+			inline void moveNegativeY(void);
+			inline void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			//All of the peek functions are implemented by this one.
+			template <int32_t iXOffset, int32_t iYOffset, int32_t iZOffset>
+			inline VoxelType peekVoxel(void) const;
+
+			//Updates the flags below after the position has changed.
+			inline void updateFlags(void);
+
+			//Points at the current voxel. Only valid if mIsInside is set.
+			VoxelType* mCurrentVoxel;
+
+			//The current position relative to the lower corner of the volume.
+			int32_t mXPosInData;
+			int32_t mYPosInData;
+			int32_t mZPosInData;
+
+			//Whether the current position is inside the volume, and whether all of its neighbours are too.
+			bool mIsInside;
+			bool mIsInterior;
+		};
+		#endif
+
+	public:
+		/// Constructor for creating a volume with its lower corner at the given position.
+		FixedRawVolume(const Vector3DInt32& v3dLowerCorner = Vector3DInt32(0,0,0));
+
+		/// Destructor
+		~FixedRawVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		VoxelType getBorderValue(void) const;
+		/// Gets the voxels, with \c x varying fastest, then \c y, then \c z
+		VoxelType* getData(void);
+		/// Gets the voxels, with \c x varying fastest, then \c y, then \c z
+		const VoxelType* getData(void) const;
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(const VoxelType& tBorder);
+		/// Moves the volume so that its lower corner is at the given position
+		void setLowerCorner(const Vector3DInt32& v3dLowerCorner);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		FixedRawVolume(const FixedRawVolume& rhs);
+
+		/// Assignment operator
+		FixedRawVolume& operator=(const FixedRawVolume& rhs);
+
+	private:
+		//Whether a position relative to the lower corner is inside the volume. Negative positions wrap
+		//round to large unsigned ones, so each axis only needs a single comparison.
+		static bool containsPointInData(int32_t iXPos, int32_t iYPos, int32_t iZPos);
+
+		//The voxel data
+		VoxelType* m_pData;
+
+		//The border value
+		VoxelType m_tBorderValue;
+	};
+}
+
+#include "PolyVoxCore/FixedRawVolume.inl"
+#include "PolyVoxCore/FixedRawVolumeSampler.inl"
+
+#endif //__PolyVox_FixedRawVolume_H__
@@ -0,0 +1,306 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+namespace PolyVox
+{
+	//Definitions for the static constants, needed when they are bound to references (e.g. by QCOMPARE).
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	const int32_t FixedRawVolume<VoxelType, Width, Height, Depth>::YStride;
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	const int32_t FixedRawVolume<VoxelType, Width, Height, Depth>::ZStride;
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	const uint32_t FixedRawVolume<VoxelType, Width, Height, Depth>::NoOfVoxels;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a volume with its lower corner at the given position. Its size is given by the template parameters.
+	/// \param v3dLowerCorner The position of the lowest voxel in the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>::FixedRawVolume(const Vector3DInt32& v3dLowerCorner)
+		:BaseVolume<VoxelType>(Region(v3dLowerCorner, v3dLowerCorner + Vector3DInt32(Width - 1, Height - 1, Depth - 1)))
+		,m_pData(0)
+	{
+		//Ensure the dimensions are valid
+		assert(Width > 0);
+		assert(Height > 0);
+		assert(Depth > 0);
+
+		setBorderValue(VoxelType());
+
+		m_pData = new VoxelType[NoOfVoxels];
+
+		//Other properties we might find useful later
+		this->m_uLongestSideLength = (std::max)((std::max)(Width, Height), Depth);
+		this->m_uShortestSideLength = (std::min)((std::min)(Width, Height), Depth);
+		this->m_fDiagonalLength = sqrtf(static_cast<float>(Width * Width + Height * Height + Depth * Depth));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>::FixedRawVolume(const FixedRawVolume<VoxelType, Width, Height, Depth>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>::~FixedRawVolume()
+	{
+		delete[] m_pData;
+		m_pData = 0;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>& FixedRawVolume<VoxelType, Width, Height, Depth>::operator=(const FixedRawVolume<VoxelType, Width, Height, Depth>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::getBorderValue(void) const
+	{
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels can be read and written directly, for example to fill the whole volume with a single call to another volume's readRegion().
+	/// \return The voxel data, which holds Width * Height * Depth voxels
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType* FixedRawVolume<VoxelType, Width, Height, Depth>::getData(void)
+	{
+		return m_pData;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The voxel data, which holds Width * Height * Depth voxels
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	const VoxelType* FixedRawVolume<VoxelType, Width, Height, Depth>::getData(void) const
+	{
+		return m_pData;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		const Vector3DInt32& v3dLowerCorner = this->m_regValidRegion.getLowerCorner();
+		const int32_t iLocalXPos = uXPos - v3dLowerCorner.getX();
+		const int32_t iLocalYPos = uYPos - v3dLowerCorner.getY();
+		const int32_t iLocalZPos = uZPos - v3dLowerCorner.getZ();
+
+		if(containsPointInData(iLocalXPos, iLocalYPos, iLocalZPos))
+		{
+			return m_pData[iLocalXPos + iLocalYPos * YStride + iLocalZPos * ZStride];
+		}
+		else
+		{
+			return m_tBorderValue;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::getVoxelAt(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Each row of voxels is copied with a single std::copy().
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		if(regRead == this->m_regValidRegion)
+		{
+			std::copy(m_pData, m_pData + NoOfVoxels, pDestination);
+			return;
+		}
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value.
+			fillRegionPart(pDestination, regRead, regRead, m_tBorderValue);
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		copyRegionPart(m_pData, this->m_regValidRegion, pDestination, regRead, regCropped);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::setBorderValue(const VoxelType& tBorder)
+	{
+		m_tBorderValue = tBorder;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels themselves are not changed, so this is just a way of reusing the same memory for a different part of the world.
+	/// Any Samplers which are using the volume must have their positions set again afterwards.
+	/// \param v3dLowerCorner The new position of the lowest voxel in the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::setLowerCorner(const Vector3DInt32& v3dLowerCorner)
+	{
+		this->m_regValidRegion = Region(v3dLowerCorner, v3dLowerCorner + Vector3DInt32(Width - 1, Height - 1, Depth - 1));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	bool FixedRawVolume<VoxelType, Width, Height, Depth>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		const Vector3DInt32& v3dLowerCorner = this->m_regValidRegion.getLowerCorner();
+		const int32_t iLocalXPos = uXPos - v3dLowerCorner.getX();
+		const int32_t iLocalYPos = uYPos - v3dLowerCorner.getY();
+		const int32_t iLocalZPos = uZPos - v3dLowerCorner.getZ();
+
+		if(containsPointInData(iLocalXPos, iLocalYPos, iLocalZPos))
+		{
+			m_pData[iLocalXPos + iLocalYPos * YStride + iLocalZPos * ZStride] = tValue;
+
+			//Return true to indicate that we modified a voxel.
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	bool FixedRawVolume<VoxelType, Width, Height, Depth>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		if(regWrite == this->m_regValidRegion)
+		{
+			std::copy(pSource, pSource + NoOfVoxels, m_pData);
+			return;
+		}
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		copyRegionPart(pSource, regWrite, m_pData, this->m_regValidRegion, regCropped);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		fillRegionPart(m_pData, this->m_regValidRegion, regCropped, tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Unlike the RawVolume, the size is known at compile time.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	uint32_t FixedRawVolume<VoxelType, Width, Height, Depth>::calculateSizeInBytes(void)
+	{
+		return NoOfVoxels * sizeof(VoxelType);
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	bool FixedRawVolume<VoxelType, Width, Height, Depth>::containsPointInData(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+	{
+		return (static_cast<uint32_t>(iXPos) < Width) && (static_cast<uint32_t>(iYPos) < Height) && (static_cast<uint32_t>(iZPos) < Depth);
+	}
+}
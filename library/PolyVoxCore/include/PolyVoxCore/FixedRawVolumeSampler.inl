@@ -0,0 +1,332 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+namespace PolyVox
+{
+	/**
+	 * \param volume The FixedRawVolume you want to sample
+	 */
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::Sampler(FixedRawVolume<VoxelType, Width, Height, Depth>* volume)
+		:BaseVolume<VoxelType>::template Sampler< FixedRawVolume<VoxelType, Width, Height, Depth> >(volume)
+		,mCurrentVoxel(0)
+		,mXPosInData(0)
+		,mYPosInData(0)
+		,mZPosInData(0)
+		,mIsInside(false)
+		,mIsInterior(false)
+	{
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::~Sampler()
+	{
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::getVoxel(void) const
+	{
+		return mIsInside ? *mCurrentVoxel : this->mVolume->m_tBorderValue;
+	}
+
+	/**
+	 * \param v3dNewPos The position to move to
+	 */
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	{
+		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
+	}
+
+	/**
+	 * \param xPos The \a x position to move to
+	 * \param yPos The \a y position to move to
+	 * \param zPos The \a z position to move to
+	 */
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	{
+		this->mXPosInVolume = xPos;
+		this->mYPosInVolume = yPos;
+		this->mZPosInVolume = zPos;
+
+		const Vector3DInt32& v3dLowerCorner = this->mVolume->m_regValidRegion.getLowerCorner();
+		mXPosInData = xPos - v3dLowerCorner.getX();
+		mYPosInData = yPos - v3dLowerCorner.getY();
+		mZPosInData = zPos - v3dLowerCorner.getZ();
+
+		updateFlags();
+	}
+
+	/**
+	 * \param tValue The value to set the voxel to
+	 * \return Whether the current position is inside the volume
+	 */
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	bool FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::setVoxel(VoxelType tValue)
+	{
+		if(mIsInside)
+		{
+			*mCurrentVoxel = tValue;
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::movePositiveX(void)
+	{
+		this->mXPosInVolume++;
+		mXPosInData++;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::movePositiveY(void)
+	{
+		this->mYPosInVolume++;
+		mYPosInData++;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::movePositiveZ(void)
+	{
+		this->mZPosInVolume++;
+		mZPosInData++;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::moveNegativeX(void)
+	{
+		this->mXPosInVolume--;
+		mXPosInData--;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::moveNegativeY(void)
+	{
+		this->mYPosInVolume--;
+		mYPosInData--;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::moveNegativeZ(void)
+	{
+		this->mZPosInVolume--;
+		mZPosInData--;
+		updateFlags();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1ny1nz(void) const
+	{
+		return peekVoxel<-1, -1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1ny0pz(void) const
+	{
+		return peekVoxel<-1, -1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1ny1pz(void) const
+	{
+		return peekVoxel<-1, -1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx0py1nz(void) const
+	{
+		return peekVoxel<-1, 0, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx0py0pz(void) const
+	{
+		return peekVoxel<-1, 0, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx0py1pz(void) const
+	{
+		return peekVoxel<-1, 0, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1py1nz(void) const
+	{
+		return peekVoxel<-1, 1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1py0pz(void) const
+	{
+		return peekVoxel<-1, 1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1nx1py1pz(void) const
+	{
+		return peekVoxel<-1, 1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1ny1nz(void) const
+	{
+		return peekVoxel<0, -1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1ny0pz(void) const
+	{
+		return peekVoxel<0, -1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1ny1pz(void) const
+	{
+		return peekVoxel<0, -1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px0py1nz(void) const
+	{
+		return peekVoxel<0, 0, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px0py0pz(void) const
+	{
+		return getVoxel();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px0py1pz(void) const
+	{
+		return peekVoxel<0, 0, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1py1nz(void) const
+	{
+		return peekVoxel<0, 1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1py0pz(void) const
+	{
+		return peekVoxel<0, 1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel0px1py1pz(void) const
+	{
+		return peekVoxel<0, 1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1ny1nz(void) const
+	{
+		return peekVoxel<1, -1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1ny0pz(void) const
+	{
+		return peekVoxel<1, -1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1ny1pz(void) const
+	{
+		return peekVoxel<1, -1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px0py1nz(void) const
+	{
+		return peekVoxel<1, 0, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px0py0pz(void) const
+	{
+		return peekVoxel<1, 0, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px0py1pz(void) const
+	{
+		return peekVoxel<1, 0, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1py1nz(void) const
+	{
+		return peekVoxel<1, 1, -1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1py0pz(void) const
+	{
+		return peekVoxel<1, 1, 0>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel1px1py1pz(void) const
+	{
+		return peekVoxel<1, 1, 1>();
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	template <int32_t iXOffset, int32_t iYOffset, int32_t iZOffset>
+	VoxelType FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::peekVoxel(void) const
+	{
+		//The offset is a constant, so this is a single read.
+		if(mIsInterior)
+		{
+			return *(mCurrentVoxel + iXOffset + iYOffset * FixedRawVolume<VoxelType, Width, Height, Depth>::YStride + iZOffset * FixedRawVolume<VoxelType, Width, Height, Depth>::ZStride);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume + iXOffset, this->mYPosInVolume + iYOffset, this->mZPosInVolume + iZOffset);
+	}
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	void FixedRawVolume<VoxelType, Width, Height, Depth>::Sampler::updateFlags(void)
+	{
+		mIsInside = FixedRawVolume<VoxelType, Width, Height, Depth>::containsPointInData(mXPosInData, mYPosInData, mZPosInData);
+
+		//A volume which is less than three voxels across in any direction has no interior.
+		mIsInterior = FixedRawVolume<VoxelType, Width, Height, Depth>::containsPointInData(mXPosInData - 1, mYPosInData - 1, mZPosInData - 1) &&
+			(mXPosInData < static_cast<int32_t>(Width) - 1) && (mYPosInData < static_cast<int32_t>(Height) - 1) && (mZPosInData < static_cast<int32_t>(Depth) - 1);
+
+		mCurrentVoxel = mIsInside ? (this->mVolume->m_pData + mXPosInData + mYPosInData * FixedRawVolume<VoxelType, Width, Height, Depth>::YStride + mZPosInData * FixedRawVolume<VoxelType, Width, Height, Depth>::ZStride) : 0;
+	}
+}
@@ -24,10 +24,14 @@ freely, subject to the following restrictions:
 #ifndef __PolyVox_Block_H__
 #define __PolyVox_Block_H__
 
+#include "PolyVoxCore/Impl/BlockBufferPool.h"
+#include "PolyVoxCore/Impl/BlockLayout.h"
+#include "PolyVoxCore/Impl/DensityRange.h"
 #include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/Impl/VoxelRuns.h"
+#include "PolyVoxCore/BlockCompressor.h"
 #include "PolyVoxCore/Vector.h"
 
-#include <limits>
 #include <vector>
 
 namespace PolyVox
@@ -35,19 +39,8 @@ namespace PolyVox
 	template <typename VoxelType>
 	class Block
 	{
-		template <typename LengthType>
-		struct RunlengthEntry
-		{
-			LengthType length;
-			VoxelType value;
-
-			//We can parametise the length on anything up to uint32_t.
-			//This lets us experiment with the optimal size in the future.
-			static uint32_t maxRunlength(void) {return (std::numeric_limits<LengthType>::max)();}
-		};
-
 	public:
-		Block(uint16_t uSideLength = 0);
+		Block(uint16_t uSideLength = 0, BlockCompressor<VoxelType>* pCompressor = 0, BlockLayout eLayout = BlockLayouts::Linear, BlockBufferPool<VoxelType>* pBufferPool = 0);
 
 		uint16_t getSideLength(void) const;
 		VoxelType getVoxelAt(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos) const;
@@ -60,16 +53,45 @@ namespace PolyVox
 		void initialise(uint16_t uSideLength);
 		uint32_t calculateSizeInBytes(void);
 
+		bool isUniform(void) const;
+		void visitRuns(polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const;
+		DensityRange<VoxelType> calculateDensityRange(void) const;
+
+		BlockCompressor<VoxelType>* getCompressor(void) const;
+		void setCompressor(BlockCompressor<VoxelType>* pCompressor);
+
+		BlockLayout getLayout(void) const;
+		void setLayout(BlockLayout eLayout);
+
 	public:
 		void compress(void);
 		void uncompress(void);
+		void detachFromBufferPool(void);
 
-		std::vector< RunlengthEntry<uint16_t> > m_vecCompressedData;
+		BlockCompressor<VoxelType>* m_pCompressor;
+		//Where the uncompressed data comes from. If this is null it is just allocated on the heap.
+		BlockBufferPool<VoxelType>* m_pBufferPool;
+		std::vector<uint8_t> m_vecCompressedData;
 		VoxelType* m_tUncompressedData;
 		uint16_t m_uSideLength;
 		uint8_t m_uSideLengthPower;	
+		BlockLayout m_eLayout;
 		bool m_bIsCompressed;
 		bool m_bIsUncompressedDataModified;
+
+		//A block in which every voxel has the same value is stored as just that value, with no compressed data.
+		//Like m_vecCompressedData this describes the compressed form, so it is only up to date while the block
+		//is compressed or its uncompressed data hasn't been modified.
+		bool m_bIsUniform;
+		VoxelType m_tUniformValue;
+
+		//Also describes the compressed form, but it is only calculated when it is first needed.
+		mutable DensityRange<VoxelType> m_rangeDensities;
+
+	private:
+		bool isUncompressedDataUniform(void) const;
+		VoxelType* allocateUncompressedData(void) const;
+		void freeUncompressedData(VoxelType* pData) const;
 	};
 }
 
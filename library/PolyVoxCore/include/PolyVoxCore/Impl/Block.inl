@@ -32,12 +32,17 @@ freely, subject to the following restrictions:
 namespace PolyVox
 {
 	template <typename VoxelType>
-	Block<VoxelType>::Block(uint16_t uSideLength)
-		:m_tUncompressedData(0)
+	Block<VoxelType>::Block(uint16_t uSideLength, BlockCompressor<VoxelType>* pCompressor, BlockLayout eLayout, BlockBufferPool<VoxelType>* pBufferPool)
+		:m_pCompressor(pCompressor)
+		,m_pBufferPool(pBufferPool)
+		,m_tUncompressedData(0)
 		,m_uSideLength(0)
 		,m_uSideLengthPower(0)
+		,m_eLayout(eLayout)
 		,m_bIsCompressed(true)
 		,m_bIsUncompressedDataModified(true)
+		,m_bIsUniform(false)
+		,m_tUniformValue()
 	{
 		if(uSideLength != 0)
 		{
@@ -58,14 +63,20 @@ namespace PolyVox
 		assert(uYPos < m_uSideLength);
 		assert(uZPos < m_uSideLength);
 
+		//A compressed block can be read without uncompressing it. That's trivial if it is uniform,
+		//and otherwise the compressor has to find the voxel (which is much slower than an array lookup).
+		if(m_bIsCompressed)
+		{
+			if(m_bIsUniform)
+			{
+				return m_tUniformValue;
+			}
+			return m_pCompressor->getVoxelAt(m_vecCompressedData, m_uSideLength, getVoxelIndexInBlock(uXPos, uYPos, uZPos, m_uSideLengthPower, m_eLayout));
+		}
+
 		assert(m_tUncompressedData);
 
-		return m_tUncompressedData
-			[
-				uXPos + 
-				uYPos * m_uSideLength + 
-				uZPos * m_uSideLength * m_uSideLength
-			];
+		return m_tUncompressedData[getVoxelIndexInBlock(uXPos, uYPos, uZPos, m_uSideLengthPower, m_eLayout)];
 	}
 
 	template <typename VoxelType>
@@ -83,12 +94,7 @@ namespace PolyVox
 
 		assert(m_tUncompressedData);
 
-		m_tUncompressedData
-		[
-			uXPos + 
-			uYPos * m_uSideLength + 
-			uZPos * m_uSideLength * m_uSideLength
-		] = tValue;
+		m_tUncompressedData[getVoxelIndexInBlock(uXPos, uYPos, uZPos, m_uSideLengthPower, m_eLayout)] = tValue;
 
 		m_bIsUncompressedDataModified = true;
 	}
@@ -113,11 +119,10 @@ namespace PolyVox
 		} 
 		else
 		{
-			RunlengthEntry<uint16_t> rle;
-			rle.length = m_uSideLength*m_uSideLength*m_uSideLength;
-			rle.value = tValue;
-			m_vecCompressedData.clear();
-			m_vecCompressedData.push_back(rle);
+			m_bIsUniform = true;
+			m_tUniformValue = tValue;
+			m_rangeDensities.isValid = false;
+			std::vector<uint8_t>().swap(m_vecCompressedData);
 		}
 	}
 
@@ -133,6 +138,12 @@ namespace PolyVox
 			throw std::invalid_argument("Block side length must be a power of two.");
 		}
 
+		assert(m_pCompressor);
+		if(!m_pCompressor)
+		{
+			throw std::invalid_argument("Block must have a compressor.");
+		}
+
 		//Compute the side length		
 		m_uSideLength = uSideLength;
 		m_uSideLengthPower = logBase2(uSideLength);
@@ -144,10 +155,156 @@ namespace PolyVox
 	uint32_t Block<VoxelType>::calculateSizeInBytes(void)
 	{
 		uint32_t uSizeInBytes = sizeof(Block<VoxelType>);
-		uSizeInBytes += m_vecCompressedData.capacity() * sizeof(RunlengthEntry<uint16_t>);
+		uSizeInBytes += m_vecCompressedData.capacity();
 		return  uSizeInBytes;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Compressed blocks know whether they are uniform, but a block whose uncompressed data
+	/// has been modified since it was last compressed has to be scanned.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool Block<VoxelType>::isUniform(void) const
+	{
+		if(m_bIsCompressed || !m_bIsUncompressedDataModified)
+		{
+			return m_bIsUniform;
+		}
+
+		return isUncompressedDataUniform();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Passes the voxels to a function as runs of the same value, in no particular order (see
+	/// BlockCompressor::visitRuns()). A compressed block is left compressed.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void Block<VoxelType>::visitRuns(polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const
+	{
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+
+		if(m_bIsCompressed)
+		{
+			if(m_bIsUniform)
+			{
+				funcVisitor(m_tUniformValue, uNoOfVoxels);
+			}
+			else
+			{
+				m_pCompressor->visitRuns(m_vecCompressedData, m_uSideLength, funcVisitor);
+			}
+			return;
+		}
+
+		for(uint32_t ct = 0; ct < uNoOfVoxels; )
+		{
+			const uint32_t uLength = findRunLength(m_tUncompressedData + ct, uNoOfVoxels - ct);
+			funcVisitor(m_tUncompressedData[ct], uLength);
+			ct += uLength;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The range is calculated from the runs (see visitRuns()), so a compressed block is left compressed. It is kept
+	/// until the block is compressed again after being modified.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	DensityRange<VoxelType> Block<VoxelType>::calculateDensityRange(void) const
+	{
+		//The uncompressed data might have been changed since the range was calculated.
+		const bool bIsRangeUpToDate = m_bIsCompressed || !m_bIsUncompressedDataModified;
+		if(bIsRangeUpToDate && m_rangeDensities.isValid)
+		{
+			return m_rangeDensities;
+		}
+
+		DensityRange<VoxelType> range;
+		visitRuns(polyvox_bind(&addRunToDensityRange<VoxelType>, polyvox_placeholder_1, polyvox_placeholder_2, &range));
+		if(bIsRangeUpToDate)
+		{
+			m_rangeDensities = range;
+		}
+		return range;
+	}
+
+	template <typename VoxelType>
+	BlockCompressor<VoxelType>* Block<VoxelType>::getCompressor(void) const
+	{
+		return m_pCompressor;
+	}
+
+	template <typename VoxelType>
+	void Block<VoxelType>::setCompressor(BlockCompressor<VoxelType>* pCompressor)
+	{
+		assert(pCompressor);
+
+		//Uniform blocks don't have any compressed data to convert.
+		if(m_bIsCompressed && m_bIsUniform)
+		{
+			m_pCompressor = pCompressor;
+			return;
+		}
+
+		//Compressed data has to be decoded with the compressor which wrote it.
+		const bool bWasCompressed = m_bIsCompressed;
+		if(bWasCompressed)
+		{
+			uncompress();
+		}
+
+		m_pCompressor = pCompressor;
+
+		//Force the data to be compressed again, even if it hasn't been modified.
+		m_bIsUncompressedDataModified = true;
+
+		if(bWasCompressed)
+		{
+			compress();
+		}
+	}
+
+	template <typename VoxelType>
+	BlockLayout Block<VoxelType>::getLayout(void) const
+	{
+		return m_eLayout;
+	}
+
+	template <typename VoxelType>
+	void Block<VoxelType>::setLayout(BlockLayout eLayout)
+	{
+		if(eLayout == m_eLayout)
+		{
+			return;
+		}
+
+		//The order doesn't matter if every voxel is the same.
+		if(m_bIsCompressed && m_bIsUniform)
+		{
+			m_eLayout = eLayout;
+			return;
+		}
+
+		const bool bWasCompressed = m_bIsCompressed;
+		if(bWasCompressed)
+		{
+			uncompress();
+		}
+
+		VoxelType* pRearrangedData = allocateUncompressedData();
+		changeBlockLayout(m_tUncompressedData, m_eLayout, pRearrangedData, eLayout, m_uSideLengthPower);
+		freeUncompressedData(m_tUncompressedData);
+		m_tUncompressedData = pRearrangedData;
+		m_eLayout = eLayout;
+
+		//The compressed data is in the old order.
+		m_bIsUncompressedDataModified = true;
+
+		if(bWasCompressed)
+		{
+			compress();
+		}
+	}
+
 	template <typename VoxelType>
 	void Block<VoxelType>::compress(void)
 	{
@@ -158,57 +315,118 @@ namespace PolyVox
 		//modified then we don't need to redo the compression.
 		if(m_bIsUncompressedDataModified)
 		{
-			uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
-			m_vecCompressedData.clear();
-
-			RunlengthEntry<uint16_t> entry;
-			entry.length = 1;
-			entry.value = m_tUncompressedData[0];
-
-			for(uint32_t ct = 1; ct < uNoOfVoxels; ++ct)
-			{		
-				VoxelType value = m_tUncompressedData[ct];
-				if((value == entry.value) && (entry.length < entry.maxRunlength()))
-				{
-					entry.length++;
-				}
-				else
+			m_rangeDensities.isValid = false;
+			m_bIsUniform = isUncompressedDataUniform();
+			if(m_bIsUniform)
+			{
+				//There's no need to involve the compressor, as the single value is all we need to keep.
+				m_tUniformValue = m_tUncompressedData[0];
+				std::vector<uint8_t>().swap(m_vecCompressedData);
+			}
+			else
+			{
+				//The compressors keep the capacity of the vector they write into, and a block which is compressed
+				//again usually needs about as much space as before, so this doesn't normally have to allocate.
+				m_pCompressor->compress(m_tUncompressedData, m_uSideLength, m_vecCompressedData);
+
+				//Shrink the vector to its contents if it is holding on to a lot more than it needs:
+				//http://stackoverflow.com/questions/1111078/reduce-the-capacity-of-an-stl-vector
+				if(m_vecCompressedData.capacity() > m_vecCompressedData.size() * 2)
 				{
-					m_vecCompressedData.push_back(entry);
-					entry.value = value;
-					entry.length = 1;
+					std::vector<uint8_t>(m_vecCompressedData).swap(m_vecCompressedData);
 				}
 			}
-
-			m_vecCompressedData.push_back(entry);
-
-			//Shrink the vectors to their contents (maybe slow?):
-			//http://stackoverflow.com/questions/1111078/reduce-the-capacity-of-an-stl-vector
-			//C++0x may have a shrink_to_fit() function?
-			std::vector< RunlengthEntry<uint16_t> >(m_vecCompressedData).swap(m_vecCompressedData);
 		}
 
 		//Flag the uncompressed data as no longer being used.
-		delete[] m_tUncompressedData;
+		freeUncompressedData(m_tUncompressedData);
 		m_tUncompressedData = 0;
 		m_bIsCompressed = true;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// The buffer pool isn't thread safe, so a block which is going to be compressed or uncompressed without the
+	/// owner's lock (such as one which is being written back on a paging thread) takes its data out of the pool and
+	/// uses the heap from then on.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void Block<VoxelType>::detachFromBufferPool(void)
+	{
+		if(m_pBufferPool == 0)
+		{
+			return;
+		}
+
+		if(!m_bIsCompressed)
+		{
+			const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+			VoxelType* pHeapData = new VoxelType[uNoOfVoxels];
+			std::copy(m_tUncompressedData, m_tUncompressedData + uNoOfVoxels, pHeapData);
+			m_pBufferPool->deallocateBuffer(m_tUncompressedData);
+			m_tUncompressedData = pHeapData;
+		}
+
+		m_pBufferPool = 0;
+	}
+
 	template <typename VoxelType>
 	void Block<VoxelType>::uncompress(void)
 	{
 		assert(m_bIsCompressed == true);
 		assert(m_tUncompressedData == 0);
-		m_tUncompressedData = new VoxelType[m_uSideLength * m_uSideLength * m_uSideLength];
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+		m_tUncompressedData = allocateUncompressedData();
 
-		VoxelType* pUncompressedData = m_tUncompressedData;		
-		for(uint32_t ct = 0; ct < m_vecCompressedData.size(); ++ct)
+		if(m_bIsUniform)
+		{
+			std::fill(m_tUncompressedData, m_tUncompressedData + uNoOfVoxels, m_tUniformValue);
+		}
+		else
 		{
-			std::fill(pUncompressedData, pUncompressedData + m_vecCompressedData[ct].length, m_vecCompressedData[ct].value);
-			pUncompressedData += m_vecCompressedData[ct].length;
+			m_pCompressor->decompress(m_vecCompressedData, m_tUncompressedData, m_uSideLength);
 		}
 
 		m_bIsCompressed = false;
 		m_bIsUncompressedDataModified = false;
 	}
+
+	template <typename VoxelType>
+	bool Block<VoxelType>::isUncompressedDataUniform(void) const
+	{
+		assert(m_tUncompressedData != 0);
+
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+		const VoxelType tFirstValue = m_tUncompressedData[0];
+		for(uint32_t ct = 1; ct < uNoOfVoxels; ct++)
+		{
+			if(!(m_tUncompressedData[ct] == tFirstValue))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename VoxelType>
+	VoxelType* Block<VoxelType>::allocateUncompressedData(void) const
+	{
+		if(m_pBufferPool)
+		{
+			return m_pBufferPool->allocateBuffer();
+		}
+		return new VoxelType[m_uSideLength * m_uSideLength * m_uSideLength];
+	}
+
+	template <typename VoxelType>
+	void Block<VoxelType>::freeUncompressedData(VoxelType* pData) const
+	{
+		if(m_pBufferPool)
+		{
+			m_pBufferPool->deallocateBuffer(pData);
+		}
+		else
+		{
+			delete[] pData;
+		}
+	}
 }
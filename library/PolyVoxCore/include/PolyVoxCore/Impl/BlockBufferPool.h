@@ -0,0 +1,98 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_BlockBufferPool_H__
+#define __PolyVox_BlockBufferPool_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include <vector>
+
+namespace PolyVox
+{
+	/// Recycles the memory which blocks use while they are uncompressed.
+	////////////////////////////////////////////////////////////////////////////////
+	/// Blocks are uncompressed and compressed again all the time as they pass through the LargeVolume's cache,
+	/// and allocating a new buffer for each one makes the heap show up in profiles. Instead the pool carves
+	/// block sized buffers out of slabs and hands them out from a free list. The slabs are only allocated when
+	/// the free list runs dry, each one as big as all of the previous ones together, until the pool holds as
+	/// many buffers as its capacity. Beyond that (for example because many blocks are pinned) the extra buffers
+	/// come from the heap as before.
+	///
+	/// The pool doesn't lock anything itself. The LargeVolume only uses it while holding its cache lock (when
+	/// concurrent access is enabled), and blocks which are handed to a paging thread are detached from it first.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class BlockBufferPool
+	{
+	public:
+		BlockBufferPool();
+		~BlockBufferPool();
+
+		/// Sets the number of voxels in each buffer. This can only be called while no buffers are allocated.
+		void setBufferSize(uint32_t uNoOfVoxelsPerBuffer);
+		/// Sets the most buffers to keep for reuse, releasing slabs which are no longer needed if possible.
+		void setCapacity(uint32_t uNoOfBuffers);
+		/// Gets the most buffers which will be kept for reuse.
+		uint32_t getCapacity(void) const;
+
+		/// Gets a buffer of the size given to setBufferSize(). The voxels are not initialised.
+		VoxelType* allocateBuffer(void);
+		/// Returns a buffer which was given out by allocateBuffer().
+		void deallocateBuffer(VoxelType* pBuffer);
+
+		/// Calculates how many bytes the pool holds, whether or not the buffers are in use.
+		uint32_t calculateSizeInBytes(void) const;
+		/// Calculates how many bytes are in the buffers which have been given out and not yet returned.
+		uint32_t calculateSizeInUseInBytes(void) const;
+
+	private:
+		struct Slab
+		{
+			VoxelType* pVoxels;
+			uint32_t uNoOfBuffers;
+			uint32_t uNoOfFreeBuffers;
+		};
+
+		//Not implemented
+		BlockBufferPool(const BlockBufferPool& rhs);
+		BlockBufferPool& operator=(const BlockBufferPool& rhs);
+
+		Slab* findSlab(VoxelType* pBuffer);
+		void addSlab(uint32_t uNoOfBuffers);
+		void releaseSlab(uint32_t uSlabIndex);
+
+		uint32_t m_uNoOfVoxelsPerBuffer;
+		uint32_t m_uCapacity;
+		//The number of buffers in the slabs, which never goes above the capacity (except while
+		//buffers which are in use stop a slab from being released when the capacity is reduced).
+		uint32_t m_uNoOfSlabBuffers;
+		uint32_t m_uNoOfHeapBuffers;
+		std::vector<Slab> m_vecSlabs;
+		std::vector<VoxelType*> m_vecFreeBuffers;
+	};
+}
+
+#include "PolyVoxCore/Impl/BlockBufferPool.inl"
+
+#endif //__PolyVox_BlockBufferPool_H__
@@ -0,0 +1,213 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept> //For invalid_argument
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	BlockBufferPool<VoxelType>::BlockBufferPool()
+		:m_uNoOfVoxelsPerBuffer(0)
+		,m_uCapacity(0)
+		,m_uNoOfSlabBuffers(0)
+		,m_uNoOfHeapBuffers(0)
+	{
+	}
+
+	template <typename VoxelType>
+	BlockBufferPool<VoxelType>::~BlockBufferPool()
+	{
+		//Every buffer should have been returned by now.
+		assert(m_uNoOfHeapBuffers == 0);
+		for(uint32_t ct = 0; ct < m_vecSlabs.size(); ct++)
+		{
+			assert(m_vecSlabs[ct].uNoOfFreeBuffers == m_vecSlabs[ct].uNoOfBuffers);
+			delete[] m_vecSlabs[ct].pVoxels;
+		}
+	}
+
+	template <typename VoxelType>
+	void BlockBufferPool<VoxelType>::setBufferSize(uint32_t uNoOfVoxelsPerBuffer)
+	{
+		if(uNoOfVoxelsPerBuffer == m_uNoOfVoxelsPerBuffer)
+		{
+			return;
+		}
+
+		assert(uNoOfVoxelsPerBuffer > 0);
+		assert(m_uNoOfHeapBuffers == 0);
+		assert(m_vecFreeBuffers.size() == m_uNoOfSlabBuffers);
+		if((m_uNoOfHeapBuffers != 0) || (m_vecFreeBuffers.size() != m_uNoOfSlabBuffers))
+		{
+			throw std::invalid_argument("Cannot change the buffer size while buffers are allocated.");
+		}
+
+		//The existing slabs are the wrong size. New ones will be added as buffers are needed.
+		while(m_vecSlabs.empty() == false)
+		{
+			releaseSlab(static_cast<uint32_t>(m_vecSlabs.size()) - 1);
+		}
+		m_uNoOfVoxelsPerBuffer = uNoOfVoxelsPerBuffer;
+	}
+
+	template <typename VoxelType>
+	void BlockBufferPool<VoxelType>::setCapacity(uint32_t uNoOfBuffers)
+	{
+		m_uCapacity = uNoOfBuffers;
+
+		//A slab can only be released if none of its buffers are in use, so we may not get all the way down.
+		for(uint32_t uSlabIndex = static_cast<uint32_t>(m_vecSlabs.size()); (uSlabIndex > 0) && (m_uNoOfSlabBuffers > m_uCapacity); uSlabIndex--)
+		{
+			if(m_vecSlabs[uSlabIndex - 1].uNoOfFreeBuffers == m_vecSlabs[uSlabIndex - 1].uNoOfBuffers)
+			{
+				releaseSlab(uSlabIndex - 1);
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	uint32_t BlockBufferPool<VoxelType>::getCapacity(void) const
+	{
+		return m_uCapacity;
+	}
+
+	template <typename VoxelType>
+	VoxelType* BlockBufferPool<VoxelType>::allocateBuffer(void)
+	{
+		assert(m_uNoOfVoxelsPerBuffer > 0);
+
+		if(m_vecFreeBuffers.empty() && (m_uNoOfSlabBuffers < m_uCapacity))
+		{
+			//Doubling the pool each time keeps the number of slabs (and so the cost of findSlab()) small.
+			addSlab((std::min)((std::max)(m_uNoOfSlabBuffers, static_cast<uint32_t>(1)), m_uCapacity - m_uNoOfSlabBuffers));
+		}
+
+		if(m_vecFreeBuffers.empty())
+		{
+			m_uNoOfHeapBuffers++;
+			return new VoxelType[m_uNoOfVoxelsPerBuffer];
+		}
+
+		VoxelType* pBuffer = m_vecFreeBuffers.back();
+		m_vecFreeBuffers.pop_back();
+		findSlab(pBuffer)->uNoOfFreeBuffers--;
+		return pBuffer;
+	}
+
+	template <typename VoxelType>
+	void BlockBufferPool<VoxelType>::deallocateBuffer(VoxelType* pBuffer)
+	{
+		Slab* pSlab = findSlab(pBuffer);
+		if(pSlab == 0)
+		{
+			assert(m_uNoOfHeapBuffers > 0);
+			m_uNoOfHeapBuffers--;
+			delete[] pBuffer;
+			return;
+		}
+
+		pSlab->uNoOfFreeBuffers++;
+		m_vecFreeBuffers.push_back(pBuffer);
+
+		//The capacity may have been reduced while this slab was in use.
+		if((m_uNoOfSlabBuffers > m_uCapacity) && (pSlab->uNoOfFreeBuffers == pSlab->uNoOfBuffers))
+		{
+			releaseSlab(static_cast<uint32_t>(pSlab - &m_vecSlabs[0]));
+		}
+	}
+
+	template <typename VoxelType>
+	uint32_t BlockBufferPool<VoxelType>::calculateSizeInBytes(void) const
+	{
+		uint32_t uSizeInBytes = sizeof(BlockBufferPool<VoxelType>);
+		uSizeInBytes += (m_uNoOfSlabBuffers + m_uNoOfHeapBuffers) * m_uNoOfVoxelsPerBuffer * sizeof(VoxelType);
+		uSizeInBytes += static_cast<uint32_t>(m_vecFreeBuffers.capacity() * sizeof(VoxelType*));
+		return uSizeInBytes;
+	}
+
+	template <typename VoxelType>
+	uint32_t BlockBufferPool<VoxelType>::calculateSizeInUseInBytes(void) const
+	{
+		const uint32_t uNoOfBuffersInUse = m_uNoOfSlabBuffers - static_cast<uint32_t>(m_vecFreeBuffers.size()) + m_uNoOfHeapBuffers;
+		return uNoOfBuffersInUse * m_uNoOfVoxelsPerBuffer * sizeof(VoxelType);
+	}
+
+	template <typename VoxelType>
+	typename BlockBufferPool<VoxelType>::Slab* BlockBufferPool<VoxelType>::findSlab(VoxelType* pBuffer)
+	{
+		//There are only ever a few slabs, as each one doubles the size of the pool.
+		for(uint32_t ct = 0; ct < m_vecSlabs.size(); ct++)
+		{
+			Slab& slab = m_vecSlabs[ct];
+			if((pBuffer >= slab.pVoxels) && (pBuffer < slab.pVoxels + slab.uNoOfBuffers * m_uNoOfVoxelsPerBuffer))
+			{
+				return &slab;
+			}
+		}
+		return 0;
+	}
+
+	template <typename VoxelType>
+	void BlockBufferPool<VoxelType>::addSlab(uint32_t uNoOfBuffers)
+	{
+		assert(uNoOfBuffers > 0);
+
+		Slab slab;
+		slab.uNoOfBuffers = uNoOfBuffers;
+		slab.uNoOfFreeBuffers = uNoOfBuffers;
+		slab.pVoxels = new VoxelType[uNoOfBuffers * m_uNoOfVoxelsPerBuffer];
+		m_vecSlabs.push_back(slab);
+
+		for(uint32_t ct = 0; ct < uNoOfBuffers; ct++)
+		{
+			m_vecFreeBuffers.push_back(slab.pVoxels + ct * m_uNoOfVoxelsPerBuffer);
+		}
+		m_uNoOfSlabBuffers += uNoOfBuffers;
+	}
+
+	template <typename VoxelType>
+	void BlockBufferPool<VoxelType>::releaseSlab(uint32_t uSlabIndex)
+	{
+		Slab& slab = m_vecSlabs[uSlabIndex];
+		assert(slab.uNoOfFreeBuffers == slab.uNoOfBuffers);
+
+		//Take this slab's buffers out of the free list.
+		VoxelType* pBegin = slab.pVoxels;
+		VoxelType* pEnd = slab.pVoxels + slab.uNoOfBuffers * m_uNoOfVoxelsPerBuffer;
+		uint32_t uNoOfKeptBuffers = 0;
+		for(uint32_t ct = 0; ct < m_vecFreeBuffers.size(); ct++)
+		{
+			if((m_vecFreeBuffers[ct] < pBegin) || (m_vecFreeBuffers[ct] >= pEnd))
+			{
+				m_vecFreeBuffers[uNoOfKeptBuffers++] = m_vecFreeBuffers[ct];
+			}
+		}
+		m_vecFreeBuffers.resize(uNoOfKeptBuffers);
+
+		m_uNoOfSlabBuffers -= slab.uNoOfBuffers;
+		delete[] slab.pVoxels;
+		m_vecSlabs.erase(m_vecSlabs.begin() + uSlabIndex);
+	}
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_BlockLayout_H__
+#define __PolyVox_BlockLayout_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+namespace PolyVox
+{
+	namespace BlockLayouts
+	{
+		/**
+		 * The order in which the voxels of a block are stored in memory.
+		 */
+		enum BlockLayout
+		{
+			Linear, ///< Row by row and then slice by slice, so the index is x + y * side + z * side * side.
+			Morton ///< Along a Morton (Z-order) curve, so voxels which are close together in 3D are usually close together in memory.
+		};
+	}
+	typedef BlockLayouts::BlockLayout BlockLayout;
+
+	//The bits of a Morton index are interleaved as ...zyxzyx. This is enough for blocks with sides of up to 1024 voxels.
+	const uint32_t uMortonXMask = 0x09249249;
+	const uint32_t uMortonYMask = 0x12492492;
+	const uint32_t uMortonZMask = 0x24924924;
+
+	/// Inserts two zero bits between each of the low ten bits of the input.
+	inline uint32_t spreadBits(uint32_t uInput)
+	{
+		//See http://fgiesen.wordpress.com/2009/12/13/decoding-morton-codes/
+		uInput &= 0x000003ff;
+		uInput = (uInput ^ (uInput << 16)) & 0xff0000ff;
+		uInput = (uInput ^ (uInput <<  8)) & 0x0300f00f;
+		uInput = (uInput ^ (uInput <<  4)) & 0x030c30c3;
+		uInput = (uInput ^ (uInput <<  2)) & 0x09249249;
+		return uInput;
+	}
+
+	/// Keeps every third bit of the input and packs them together. This is the inverse of spreadBits().
+	inline uint32_t compactBits(uint32_t uInput)
+	{
+		uInput &= 0x09249249;
+		uInput = (uInput ^ (uInput >>  2)) & 0x030c30c3;
+		uInput = (uInput ^ (uInput >>  4)) & 0x0300f00f;
+		uInput = (uInput ^ (uInput >>  8)) & 0xff0000ff;
+		uInput = (uInput ^ (uInput >> 16)) & 0x000003ff;
+		return uInput;
+	}
+
+	/// Gets the Morton index of the voxel at the given position within a block.
+	inline uint32_t encodeMortonIndex(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos)
+	{
+		return spreadBits(uXPos) | (spreadBits(uYPos) << 1) | (spreadBits(uZPos) << 2);
+	}
+
+	/// Adds one to the coordinate selected by the mask, without decoding the index. The caller must make sure it doesn't overflow.
+	inline uint32_t incrementMortonIndex(uint32_t uMortonIndex, uint32_t uMask)
+	{
+		//Setting the other coordinates' bits makes the carry skip over them.
+		return (((uMortonIndex | ~uMask) + 1) & uMask) | (uMortonIndex & ~uMask);
+	}
+
+	/// Subtracts one from the coordinate selected by the mask, without decoding the index. The caller must make sure it doesn't underflow.
+	inline uint32_t decrementMortonIndex(uint32_t uMortonIndex, uint32_t uMask)
+	{
+		//Clearing the other coordinates' bits makes the borrow skip over them.
+		return (((uMortonIndex & uMask) - 1) & uMask) | (uMortonIndex & ~uMask);
+	}
+
+	/// Gets the index of the voxel at the given position within a block, for either layout.
+	inline uint32_t getVoxelIndexInBlock(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos, uint8_t uSideLengthPower, BlockLayout eLayout)
+	{
+		if(eLayout == BlockLayouts::Morton)
+		{
+			return encodeMortonIndex(uXPos, uYPos, uZPos);
+		}
+		return uXPos + (uYPos << uSideLengthPower) + (uZPos << (uSideLengthPower * 2));
+	}
+
+	/// Copies the voxels of a block, rearranging them from one layout to another.
+	template <typename VoxelType>
+	void changeBlockLayout(const VoxelType* pSrcVoxels, BlockLayout eSrcLayout, VoxelType* pDstVoxels, BlockLayout eDstLayout, uint8_t uSideLengthPower)
+	{
+		const uint16_t uSideLength = 1 << uSideLengthPower;
+		for(uint16_t z = 0; z < uSideLength; z++)
+		{
+			for(uint16_t y = 0; y < uSideLength; y++)
+			{
+				for(uint16_t x = 0; x < uSideLength; x++)
+				{
+					pDstVoxels[getVoxelIndexInBlock(x, y, z, uSideLengthPower, eDstLayout)] = pSrcVoxels[getVoxelIndexInBlock(x, y, z, uSideLengthPower, eSrcLayout)];
+				}
+			}
+		}
+	}
+}
+
+#endif //__PolyVox_BlockLayout_H__
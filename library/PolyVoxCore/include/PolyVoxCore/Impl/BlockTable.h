@@ -0,0 +1,96 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_BlockTable_H__
+#define __PolyVox_BlockTable_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <vector>
+
+namespace PolyVox
+{
+	/// An open-addressing hash table mapping block positions to blocks.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The LargeVolume used to keep its blocks in a std::map, but that meant every block
+	/// miss paid for a tree walk with a lot of pointer chasing. This class replaces it
+	/// with a linearly probed hash table in which the key (the block position) and a
+	/// pointer to the value are stored inline in a single flat array, so that a lookup
+	/// usually touches just one or two cache lines.
+	///
+	/// The table only stores pointers and does not take ownership of the values. This
+	/// means that the address of a value never changes when the table grows or when
+	/// other entries are erased, so callers are free to hold on to it.
+	///
+	/// Erasing uses backward shift deletion rather than tombstones, so lookup performance
+	/// does not degrade as blocks are repeatedly paged in and out.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename ValueType>
+	class BlockTable
+	{
+		struct Slot
+		{
+			int32_t x;
+			int32_t y;
+			int32_t z;
+			ValueType* pValue; //Null for an empty slot.
+		};
+
+	public:
+		BlockTable(uint32_t uInitialCapacity = 64);
+
+		/// Gets the value stored for the given block position, or null if there is none.
+		ValueType* find(const Vector3DInt32& v3dBlockPos) const;
+		/// Stores a value for the given block position, which must not already be present.
+		void insert(const Vector3DInt32& v3dBlockPos, ValueType* pValue);
+		/// Removes the given block position from the table, returning the value which was stored.
+		ValueType* erase(const Vector3DInt32& v3dBlockPos);
+		/// Removes all entries from the table.
+		void clear(void);
+
+		/// Gets the number of entries in the table.
+		uint32_t size(void) const;
+		/// Gets the number of slots in the table, for iterating with getValueInSlot().
+		uint32_t getNoOfSlots(void) const;
+		/// Gets the value in the given slot, or null if the slot is empty.
+		ValueType* getValueInSlot(uint32_t uSlot) const;
+		/// Calculates how many bytes of memory the table itself is using (not including the values).
+		uint32_t calculateSizeInBytes(void) const;
+
+		/// Hashes a block position. The table uses the low bits, so callers which split blocks
+		/// across several tables (such as the LargeVolume's shards) should use the high bits.
+		static uint32_t hash(int32_t x, int32_t y, int32_t z);
+
+	private:
+		void grow(void);
+
+		std::vector<Slot> m_vecSlots;
+		uint32_t m_uSlotMask;
+		uint32_t m_uSize;
+	};
+}
+
+#include "PolyVoxCore/Impl/BlockTable.inl"
+
+#endif
@@ -0,0 +1,223 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "PolyVoxCore/Impl/Utility.h"
+
+#include <cassert>
+#include <stdexcept> //For invalid_argument
+
+namespace PolyVox
+{
+	template <typename ValueType>
+	BlockTable<ValueType>::BlockTable(uint32_t uInitialCapacity)
+		:m_uSlotMask(0)
+		,m_uSize(0)
+	{
+		//Debug mode validation
+		assert(isPowerOf2(uInitialCapacity));
+
+		//Release mode validation
+		if(!isPowerOf2(uInitialCapacity))
+		{
+			throw std::invalid_argument("Block table capacity must be a power of two.");
+		}
+
+		Slot emptySlot = {0, 0, 0, 0};
+		m_vecSlots.resize(uInitialCapacity, emptySlot);
+		m_uSlotMask = uInitialCapacity - 1;
+	}
+
+	template <typename ValueType>
+	ValueType* BlockTable<ValueType>::find(const Vector3DInt32& v3dBlockPos) const
+	{
+		const int32_t x = v3dBlockPos.getX();
+		const int32_t y = v3dBlockPos.getY();
+		const int32_t z = v3dBlockPos.getZ();
+
+		uint32_t uSlot = hash(x, y, z) & m_uSlotMask;
+		while(m_vecSlots[uSlot].pValue)
+		{
+			const Slot& slot = m_vecSlots[uSlot];
+			if((slot.x == x) && (slot.y == y) && (slot.z == z))
+			{
+				return slot.pValue;
+			}
+			uSlot = (uSlot + 1) & m_uSlotMask;
+		}
+
+		return 0;
+	}
+
+	template <typename ValueType>
+	void BlockTable<ValueType>::insert(const Vector3DInt32& v3dBlockPos, ValueType* pValue)
+	{
+		assert(pValue);
+		assert(find(v3dBlockPos) == 0);
+
+		//Keep the load factor at or below one half, so that probe sequences stay short.
+		if((m_uSize + 1) * 2 > m_vecSlots.size())
+		{
+			grow();
+		}
+
+		const int32_t x = v3dBlockPos.getX();
+		const int32_t y = v3dBlockPos.getY();
+		const int32_t z = v3dBlockPos.getZ();
+
+		uint32_t uSlot = hash(x, y, z) & m_uSlotMask;
+		while(m_vecSlots[uSlot].pValue)
+		{
+			uSlot = (uSlot + 1) & m_uSlotMask;
+		}
+
+		Slot& slot = m_vecSlots[uSlot];
+		slot.x = x;
+		slot.y = y;
+		slot.z = z;
+		slot.pValue = pValue;
+		++m_uSize;
+	}
+
+	template <typename ValueType>
+	ValueType* BlockTable<ValueType>::erase(const Vector3DInt32& v3dBlockPos)
+	{
+		const int32_t x = v3dBlockPos.getX();
+		const int32_t y = v3dBlockPos.getY();
+		const int32_t z = v3dBlockPos.getZ();
+
+		uint32_t uHole = hash(x, y, z) & m_uSlotMask;
+		while(true)
+		{
+			const Slot& slot = m_vecSlots[uHole];
+			if(slot.pValue == 0)
+			{
+				//Not present.
+				return 0;
+			}
+			if((slot.x == x) && (slot.y == y) && (slot.z == z))
+			{
+				break;
+			}
+			uHole = (uHole + 1) & m_uSlotMask;
+		}
+
+		ValueType* pErasedValue = m_vecSlots[uHole].pValue;
+		m_vecSlots[uHole].pValue = 0;
+		--m_uSize;
+
+		//Backward shift deletion. Walk the cluster following the hole, and move back any entry
+		//whose home slot does not lie (cyclically) between the hole and its current position.
+		uint32_t uSlot = (uHole + 1) & m_uSlotMask;
+		while(m_vecSlots[uSlot].pValue)
+		{
+			const Slot& slot = m_vecSlots[uSlot];
+			const uint32_t uHome = hash(slot.x, slot.y, slot.z) & m_uSlotMask;
+			const uint32_t uDistanceToHome = (uSlot - uHome) & m_uSlotMask;
+			const uint32_t uDistanceToHole = (uSlot - uHole) & m_uSlotMask;
+			if(uDistanceToHome >= uDistanceToHole)
+			{
+				m_vecSlots[uHole] = slot;
+				m_vecSlots[uSlot].pValue = 0;
+				uHole = uSlot;
+			}
+			uSlot = (uSlot + 1) & m_uSlotMask;
+		}
+
+		return pErasedValue;
+	}
+
+	template <typename ValueType>
+	void BlockTable<ValueType>::clear(void)
+	{
+		for(uint32_t ct = 0; ct < m_vecSlots.size(); ct++)
+		{
+			m_vecSlots[ct].pValue = 0;
+		}
+		m_uSize = 0;
+	}
+
+	template <typename ValueType>
+	uint32_t BlockTable<ValueType>::size(void) const
+	{
+		return m_uSize;
+	}
+
+	template <typename ValueType>
+	uint32_t BlockTable<ValueType>::getNoOfSlots(void) const
+	{
+		return static_cast<uint32_t>(m_vecSlots.size());
+	}
+
+	template <typename ValueType>
+	ValueType* BlockTable<ValueType>::getValueInSlot(uint32_t uSlot) const
+	{
+		assert(uSlot < m_vecSlots.size());
+		return m_vecSlots[uSlot].pValue;
+	}
+
+	template <typename ValueType>
+	uint32_t BlockTable<ValueType>::calculateSizeInBytes(void) const
+	{
+		return sizeof(BlockTable<ValueType>) + static_cast<uint32_t>(m_vecSlots.capacity() * sizeof(Slot));
+	}
+
+	template <typename ValueType>
+	uint32_t BlockTable<ValueType>::hash(int32_t x, int32_t y, int32_t z)
+	{
+		//Pack the coordinates by multiplying each with a large odd constant, and then run the
+		//result through the MurmurHash3 finaliser so that neighbouring blocks (which differ
+		//only in their low bits) get spread over the whole table.
+		uint32_t h = (static_cast<uint32_t>(x) * 0x8da6b343u) ^ (static_cast<uint32_t>(y) * 0xd8163841u) ^ (static_cast<uint32_t>(z) * 0xcb1ab31fu);
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	template <typename ValueType>
+	void BlockTable<ValueType>::grow(void)
+	{
+		std::vector<Slot> vecOldSlots;
+		vecOldSlots.swap(m_vecSlots);
+
+		Slot emptySlot = {0, 0, 0, 0};
+		m_vecSlots.resize(vecOldSlots.size() * 2, emptySlot);
+		m_uSlotMask = static_cast<uint32_t>(m_vecSlots.size()) - 1;
+
+		for(uint32_t ct = 0; ct < vecOldSlots.size(); ct++)
+		{
+			const Slot& oldSlot = vecOldSlots[ct];
+			if(oldSlot.pValue)
+			{
+				uint32_t uSlot = hash(oldSlot.x, oldSlot.y, oldSlot.z) & m_uSlotMask;
+				while(m_vecSlots[uSlot].pValue)
+				{
+					uSlot = (uSlot + 1) & m_uSlotMask;
+				}
+				m_vecSlots[uSlot] = oldSlot;
+			}
+		}
+	}
+}
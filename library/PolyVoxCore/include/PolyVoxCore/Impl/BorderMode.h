@@ -0,0 +1,100 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_BorderMode_H__
+#define __PolyVox_BorderMode_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include "PolyVoxCore/Region.h"
+#include "PolyVoxCore/Vector.h"
+
+namespace PolyVox
+{
+	namespace BorderModes
+	{
+		/**
+		 * What a volume returns when a voxel outside of it is read.
+		 */
+		enum BorderMode
+		{
+			Constant, ///< Every voxel outside the volume has the border value (see setBorderValue()).
+			Clamp, ///< Each voxel outside the volume has the value of the nearest voxel on the edge of the volume.
+			Wrap ///< The volume repeats in every direction, so it can be used for tiled or periodic worlds.
+		};
+	}
+	typedef BorderModes::BorderMode BorderMode;
+
+	//Maps a coordinate which is outside [iLower, iUpper] to the coordinate inside it which should be read instead.
+	//The volumes only call this once they know the voxel is outside, so the voxels inside don't pay for it.
+	template <BorderMode eMode>
+	struct BorderCoordinate;
+
+	template <>
+	struct BorderCoordinate<BorderModes::Clamp>
+	{
+		static int32_t map(int32_t iPos, int32_t iLower, int32_t iUpper)
+		{
+			return (iPos < iLower) ? iLower : ((iPos > iUpper) ? iUpper : iPos);
+		}
+	};
+
+	template <>
+	struct BorderCoordinate<BorderModes::Wrap>
+	{
+		static int32_t map(int32_t iPos, int32_t iLower, int32_t iUpper)
+		{
+			//The arithmetic is done in 64 bits so that very large volumes can't overflow it.
+			const int64_t iLength = static_cast<int64_t>(iUpper) - iLower + 1;
+			int64_t iOffset = (static_cast<int64_t>(iPos) - iLower) % iLength;
+			if(iOffset < 0)
+			{
+				iOffset += iLength;
+			}
+			return static_cast<int32_t>(iLower + iOffset);
+		}
+	};
+
+	template <BorderMode eMode>
+	Vector3DInt32 mapIntoRegion(int32_t iXPos, int32_t iYPos, int32_t iZPos, const Region& region)
+	{
+		return Vector3DInt32
+		(
+			BorderCoordinate<eMode>::map(iXPos, region.getLowerCorner().getX(), region.getUpperCorner().getX()),
+			BorderCoordinate<eMode>::map(iYPos, region.getLowerCorner().getY(), region.getUpperCorner().getY()),
+			BorderCoordinate<eMode>::map(iZPos, region.getLowerCorner().getZ(), region.getUpperCorner().getZ())
+		);
+	}
+
+	/// Gets the position inside the region which a position outside it reads from. Not valid for the Constant mode.
+	inline Vector3DInt32 mapIntoRegion(int32_t iXPos, int32_t iYPos, int32_t iZPos, const Region& region, BorderMode eMode)
+	{
+		if(eMode == BorderModes::Wrap)
+		{
+			return mapIntoRegion<BorderModes::Wrap>(iXPos, iYPos, iZPos, region);
+		}
+		return mapIntoRegion<BorderModes::Clamp>(iXPos, iYPos, iZPos, region);
+	}
+}
+
+#endif //__PolyVox_BorderMode_H__
@@ -0,0 +1,139 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_DensityRange_H__
+#define __PolyVox_DensityRange_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/Impl/VoxelRuns.h"
+#include "PolyVoxCore/DefaultMarchingCubesController.h"
+#include "PolyVoxCore/Region.h"
+
+namespace PolyVox
+{
+	//The volumes keep a summary of the densities in each block so that the surface extractors can skip over blocks
+	//which can't contain any of the surface. The densities are the ones given by the DefaultMarchingCubesController,
+	//and we store the voxels which have the smallest and largest densities rather than the densities themselves. That
+	//way the controller is only used when a range is actually calculated, so voxel types which don't have densities
+	//(or which don't support comparisons) can still be stored in the volumes.
+	template <typename VoxelType>
+	struct DensityRange
+	{
+		DensityRange()
+			:isValid(false)
+			,minVoxel()
+			,maxVoxel()
+		{
+		}
+
+		//False if the range is empty, or (for a block's range) if it is out of date.
+		bool isValid;
+		VoxelType minVoxel;
+		VoxelType maxVoxel;
+	};
+
+	template <typename VoxelType>
+	void addToDensityRange(const VoxelType& tValue, DensityRange<VoxelType>& range)
+	{
+		DefaultMarchingCubesController<VoxelType> controller;
+		if(!range.isValid)
+		{
+			range.minVoxel = tValue;
+			range.maxVoxel = tValue;
+			range.isValid = true;
+		}
+		else if(controller.convertToDensity(tValue) < controller.convertToDensity(range.minVoxel))
+		{
+			range.minVoxel = tValue;
+		}
+		else if(controller.convertToDensity(range.maxVoxel) < controller.convertToDensity(tValue))
+		{
+			range.maxVoxel = tValue;
+		}
+	}
+
+	template <typename VoxelType>
+	void addToDensityRange(const DensityRange<VoxelType>& rangeToAdd, DensityRange<VoxelType>& range)
+	{
+		if(rangeToAdd.isValid)
+		{
+			addToDensityRange(rangeToAdd.minVoxel, range);
+			addToDensityRange(rangeToAdd.maxVoxel, range);
+		}
+	}
+
+	//For use with the visitRuns() functions.
+	template <typename VoxelType>
+	void addRunToDensityRange(const VoxelType& tValue, uint32_t /*uLength*/, DensityRange<VoxelType>* pRange)
+	{
+		addToDensityRange(tValue, *pRange);
+	}
+
+	template <typename VoxelType>
+	void addVoxelsToDensityRange(const VoxelType* pVoxels, uint32_t uNoOfVoxels, DensityRange<VoxelType>& range)
+	{
+		//Each run only has to be converted to a density once.
+		for(uint32_t ct = 0; ct < uNoOfVoxels; )
+		{
+			addToDensityRange(pVoxels[ct], range);
+			ct += findRunLength(pVoxels + ct, uNoOfVoxels - ct);
+		}
+	}
+
+	//The extractors can only use the volumes' ranges when they use the same densities, which is the case when their
+	//controller is a DefaultMarchingCubesController (whatever its threshold). Otherwise calculate() always fails, just
+	//as it does for volumes which don't keep track of their densities (see BaseVolume::calculateDensityRange()).
+	template <typename Controller, typename VoxelType>
+	struct UsesDefaultDensities
+	{
+		static const bool value = false;
+	};
+
+	template <typename VoxelType>
+	struct UsesDefaultDensities<DefaultMarchingCubesController<VoxelType>, VoxelType>
+	{
+		static const bool value = true;
+	};
+
+	template <bool bUsesDefaultDensities>
+	struct DensityRangeCalculator
+	{
+		template <typename VolumeType, typename DensityType>
+		static bool calculate(const VolumeType* /*pVolume*/, const Region& /*region*/, DensityType& /*tMin*/, DensityType& /*tMax*/)
+		{
+			return false;
+		}
+	};
+
+	template <>
+	struct DensityRangeCalculator<true>
+	{
+		template <typename VolumeType, typename DensityType>
+		static bool calculate(const VolumeType* pVolume, const Region& region, DensityType& tMin, DensityType& tMax)
+		{
+			return pVolume->calculateDensityRange(region, tMin, tMax);
+		}
+	};
+}
+
+#endif //__PolyVox_DensityRange_H__
@@ -0,0 +1,146 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_EvictionList_H__
+#define __PolyVox_EvictionList_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+namespace PolyVox
+{
+	namespace EvictionPolicies
+	{
+		/**
+		 * The policy used to decide which block is removed when a cache is full.
+		 */
+		enum EvictionPolicy
+		{
+			LeastRecentlyUsed, ///< Evict the block which was touched least recently. Every touch reorders the list.
+			SecondChance ///< CLOCK approximation of LRU. A touch only sets a flag, and blocks get a second chance before eviction.
+		};
+	}
+	typedef EvictionPolicies::EvictionPolicy EvictionPolicy;
+
+	/// Counters describing how well one of the caches is performing.
+	struct CacheStatistics
+	{
+		CacheStatistics()
+			:hits(0)
+			,misses(0)
+			,evictions(0)
+		{
+		}
+
+		uint32_t hits;
+		uint32_t misses;
+		uint32_t evictions;
+	};
+
+	/// The links which allow a node to be stored in an EvictionList.
+	template <typename NodeType>
+	struct EvictionListHook
+	{
+		EvictionListHook()
+			:pPrev(0)
+			,pNext(0)
+			,bReferenced(false)
+			,bLinked(false)
+		{
+		}
+
+		NodeType* pPrev;
+		NodeType* pNext;
+		polyvox_atomic<bool> bReferenced; //Atomic so that mark() can be called without holding the list's lock.
+		bool bLinked;
+	};
+
+	/// An intrusive list which selects eviction candidates in constant time.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The nodes carry their own links (an EvictionListHook member, passed as the second
+	/// template parameter) so that touching, inserting and removing a node never allocates
+	/// or searches. The front of the list holds the most recently used nodes and the back
+	/// holds the eviction candidates.
+	///
+	/// With the LeastRecentlyUsed policy a touch moves the node to the front, so the back
+	/// is always the exact LRU node. With the SecondChance policy a touch just sets the
+	/// node's referenced flag. When a victim is needed, referenced nodes at the back have
+	/// their flag cleared and are moved to the front. This is the classic CLOCK algorithm
+	/// and gives amortised constant time eviction with even cheaper touches.
+	///
+	/// When the nodes differ in size, the second form of selectVictim() gathers a few
+	/// candidates from the back (in the order the first form would return them) and picks
+	/// the heaviest. Evicting one large node then frees as much as evicting many small
+	/// ones, while recently used nodes are still protected.
+	///
+	/// The list itself is not thread safe, but mark() only sets a node's referenced flag
+	/// and so may be called while another thread (holding whatever lock protects the list)
+	/// is modifying it. Referenced nodes always get a second chance in selectVictim(), so
+	/// a list which is only ever marked behaves like SecondChance under either policy.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	class EvictionList
+	{
+	public:
+		EvictionList(EvictionPolicy ePolicy = EvictionPolicies::LeastRecentlyUsed);
+
+		/// Adds a node to the front of the list.
+		void insert(NodeType* pNode);
+		/// Removes a node from the list.
+		void remove(NodeType* pNode);
+		/// Records that a node has just been used.
+		void touch(NodeType* pNode);
+		/// Records that a node has just been used, without reordering the list.
+		void mark(NodeType* pNode);
+		/// Selects the node which should be evicted next, without removing it.
+		NodeType* selectVictim(bool (*pIsEvictable)(const NodeType*) = 0);
+		/// Selects the heaviest of the nodes which would be evicted next, without removing it.
+		NodeType* selectVictim(bool (*pIsEvictable)(const NodeType*), uint32_t (*pGetWeight)(const NodeType*), uint32_t uNoOfCandidates);
+
+		/// Checks whether a node is currently stored in the list.
+		bool contains(const NodeType* pNode) const;
+		/// Gets the most recently inserted or touched node.
+		NodeType* front(void) const;
+		/// Gets the node following the given one, for walking the list from front to back.
+		NodeType* next(const NodeType* pNode) const;
+		/// Gets the number of nodes in the list.
+		uint32_t size(void) const;
+
+		/// Gets the policy used to select victims.
+		EvictionPolicy getPolicy(void) const;
+		/// Sets the policy used to select victims.
+		void setPolicy(EvictionPolicy ePolicy);
+
+	private:
+		void linkAtFront(NodeType* pNode);
+		void unlink(NodeType* pNode);
+
+		NodeType* m_pFront;
+		NodeType* m_pBack;
+		uint32_t m_uSize;
+		EvictionPolicy m_ePolicy;
+	};
+}
+
+#include "PolyVoxCore/Impl/EvictionList.inl"
+
+#endif
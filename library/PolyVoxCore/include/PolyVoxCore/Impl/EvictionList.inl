@@ -0,0 +1,252 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <cassert>
+
+namespace PolyVox
+{
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	EvictionList<NodeType, Hook>::EvictionList(EvictionPolicy ePolicy)
+		:m_pFront(0)
+		,m_pBack(0)
+		,m_uSize(0)
+		,m_ePolicy(ePolicy)
+	{
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::insert(NodeType* pNode)
+	{
+		assert(!contains(pNode));
+
+		(pNode->*Hook).bReferenced = false;
+		(pNode->*Hook).bLinked = true;
+		linkAtFront(pNode);
+		++m_uSize;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::remove(NodeType* pNode)
+	{
+		assert(contains(pNode));
+
+		unlink(pNode);
+		(pNode->*Hook).bLinked = false;
+		--m_uSize;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::touch(NodeType* pNode)
+	{
+		assert(contains(pNode));
+
+		if(m_ePolicy == EvictionPolicies::LeastRecentlyUsed)
+		{
+			if(pNode != m_pFront)
+			{
+				unlink(pNode);
+				linkAtFront(pNode);
+			}
+		}
+		else
+		{
+			(pNode->*Hook).bReferenced = true;
+		}
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::mark(NodeType* pNode)
+	{
+		//No assert on contains() here, as bLinked may be being written by another thread.
+		(pNode->*Hook).bReferenced = true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pIsEvictable An optional predicate for nodes which must not be evicted
+	/// right now (such as blocks which are in use). These are moved to the front as
+	/// if they had just been used.
+	/// \return The node to evict, or null if the list is empty or no node is evictable.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	NodeType* EvictionList<NodeType, Hook>::selectVictim(bool (*pIsEvictable)(const NodeType*))
+	{
+		//Each node can be passed over at most twice (once to clear its flag and once if it isn't
+		//evictable) so this loop is bounded, and the cost of skipping referenced nodes is paid
+		//for by the touches which set the flags in the first place.
+		uint32_t uNoOfNodesToExamine = m_uSize * 2;
+		while(m_pBack && (uNoOfNodesToExamine > 0))
+		{
+			NodeType* pNode = m_pBack;
+			if((pNode->*Hook).bReferenced)
+			{
+				(pNode->*Hook).bReferenced = false;
+			}
+			else if((pIsEvictable == 0) || pIsEvictable(pNode))
+			{
+				return pNode;
+			}
+
+			unlink(pNode);
+			linkAtFront(pNode);
+			--uNoOfNodesToExamine;
+		}
+
+		return 0;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is a size-weighted LRU. Referenced nodes get their second chance as usual,
+	/// but nodes which aren't evictable are left where they are.
+	/// \param pIsEvictable An optional predicate for nodes which must not be evicted right now.
+	/// \param pGetWeight Gives the weight (typically the size in bytes) of a node.
+	/// \param uNoOfCandidates The number of evictable nodes to choose between.
+	/// \return The node to evict, or null if the list is empty or no node is evictable.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	NodeType* EvictionList<NodeType, Hook>::selectVictim(bool (*pIsEvictable)(const NodeType*), uint32_t (*pGetWeight)(const NodeType*), uint32_t uNoOfCandidates)
+	{
+		assert(pGetWeight);
+
+		NodeType* pVictim = 0;
+		uint32_t uVictimWeight = 0;
+		uint32_t uNoOfCandidatesFound = 0;
+
+		//Nodes given a second chance are moved to the front, where the walk reaches them
+		//again after the rest of the list. As in the other form each node is passed over
+		//at most twice, so this loop is bounded.
+		uint32_t uNoOfNodesToExamine = m_uSize * 2;
+		NodeType* pNode = m_pBack;
+		while(pNode && (uNoOfNodesToExamine > 0) && (uNoOfCandidatesFound < uNoOfCandidates))
+		{
+			NodeType* pPrevNode = (pNode->*Hook).pPrev;
+			if((pNode->*Hook).bReferenced)
+			{
+				(pNode->*Hook).bReferenced = false;
+				unlink(pNode);
+				linkAtFront(pNode);
+
+				//If it was already at the front then it is the next node to look at.
+				if(pPrevNode == 0)
+				{
+					pPrevNode = pNode;
+				}
+			}
+			else if((pIsEvictable == 0) || pIsEvictable(pNode))
+			{
+				const uint32_t uWeight = pGetWeight(pNode);
+				if((pVictim == 0) || (uWeight > uVictimWeight))
+				{
+					pVictim = pNode;
+					uVictimWeight = uWeight;
+				}
+				++uNoOfCandidatesFound;
+			}
+
+			pNode = pPrevNode;
+			--uNoOfNodesToExamine;
+		}
+
+		return pVictim;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	bool EvictionList<NodeType, Hook>::contains(const NodeType* pNode) const
+	{
+		return (pNode->*Hook).bLinked;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	NodeType* EvictionList<NodeType, Hook>::front(void) const
+	{
+		return m_pFront;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	NodeType* EvictionList<NodeType, Hook>::next(const NodeType* pNode) const
+	{
+		return (pNode->*Hook).pNext;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	uint32_t EvictionList<NodeType, Hook>::size(void) const
+	{
+		return m_uSize;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	EvictionPolicy EvictionList<NodeType, Hook>::getPolicy(void) const
+	{
+		return m_ePolicy;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::setPolicy(EvictionPolicy ePolicy)
+	{
+		//The list order is meaningful to both policies (the front is the most recent) so we can
+		//switch at any time. The referenced flags are simply ignored when running as LRU.
+		m_ePolicy = ePolicy;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::linkAtFront(NodeType* pNode)
+	{
+		EvictionListHook<NodeType>& hook = pNode->*Hook;
+		hook.pPrev = 0;
+		hook.pNext = m_pFront;
+		if(m_pFront)
+		{
+			(m_pFront->*Hook).pPrev = pNode;
+		}
+		else
+		{
+			m_pBack = pNode;
+		}
+		m_pFront = pNode;
+	}
+
+	template <typename NodeType, EvictionListHook<NodeType> NodeType::*Hook>
+	void EvictionList<NodeType, Hook>::unlink(NodeType* pNode)
+	{
+		EvictionListHook<NodeType>& hook = pNode->*Hook;
+		if(hook.pPrev)
+		{
+			(hook.pPrev->*Hook).pNext = hook.pNext;
+		}
+		else
+		{
+			m_pFront = hook.pNext;
+		}
+
+		if(hook.pNext)
+		{
+			(hook.pNext->*Hook).pPrev = hook.pPrev;
+		}
+		else
+		{
+			m_pBack = hook.pPrev;
+		}
+
+		hook.pPrev = 0;
+		hook.pNext = 0;
+	}
+}
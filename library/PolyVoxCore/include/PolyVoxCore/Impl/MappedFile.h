@@ -0,0 +1,78 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_MappedFile_H__
+#define __PolyVox_MappedFile_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include <string>
+
+namespace PolyVox
+{
+	/// A file whose contents are mapped into memory.
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is used by the MappedVolume. Reading from or writing to the mapped data
+	/// reads from or writes to the file, with the operating system paging the data
+	/// in and out as required. Nothing is read when the file is opened, so even a
+	/// very large file can be opened almost instantly.
+	////////////////////////////////////////////////////////////////////////////////
+	class POLYVOX_API MappedFile
+	{
+	public:
+		/// Creates (or replaces) a file of the given size and maps it.
+		MappedFile(const std::string& strFilename, uint64_t uSizeInBytes);
+		/// Maps an existing file.
+		MappedFile(const std::string& strFilename);
+		/// Unmaps the file, which writes back any modified data.
+		~MappedFile();
+
+		/// Gets the start of the mapped data.
+		uint8_t* getData(void) const;
+		/// Gets the size of the file.
+		uint64_t getSizeInBytes(void) const;
+
+		/// Writes any modified data back to the file, and waits for it to finish.
+		void flush(void);
+
+	private:
+		//Not copyable.
+		MappedFile(const MappedFile& rhs);
+		MappedFile& operator=(const MappedFile& rhs);
+
+		void open(const std::string& strFilename, bool bCreate, uint64_t uSizeInBytes);
+		void close(void);
+
+		uint8_t* m_pData;
+		uint64_t m_uSizeInBytes;
+
+#if defined _WIN32
+		void* m_hFile;
+		void* m_hMapping;
+#else
+		int m_iFile;
+#endif
+	};
+}
+
+#endif
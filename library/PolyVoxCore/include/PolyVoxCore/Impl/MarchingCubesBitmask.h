@@ -0,0 +1,296 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution.
+*******************************************************************************/
+
+#ifndef __PolyVox_MarchingCubesBitmask_H__
+#define __PolyVox_MarchingCubesBitmask_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/PolyVoxForwardDeclarations.h"
+
+#if defined(POLYVOX_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace PolyVox
+{
+	//The MarchingCubesSurfaceExtractor can compute the bitmasks for a whole slice at once rather than cell by cell.
+	//It reads each plane of voxels a row at a time, marks which voxels are below the threshold, and then combines
+	//the marks for neighbouring voxels into the four bits which each plane contributes to a cell's bitmask. This
+	//is only worth doing for volumes which can copy out a row of voxels quickly, which are the ones below.
+	template <typename VolumeType>
+	struct IsContiguousVolume
+	{
+		static const bool value = false;
+	};
+
+	template <typename VoxelType>
+	struct IsContiguousVolume< RawVolume<VoxelType> >
+	{
+		static const bool value = true;
+	};
+
+	template <typename VoxelType>
+	struct IsContiguousVolume< SimpleVolume<VoxelType> >
+	{
+		static const bool value = true;
+	};
+
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth>
+	struct IsContiguousVolume< FixedRawVolume<VoxelType, Width, Height, Depth> >
+	{
+		static const bool value = true;
+	};
+
+#if defined(POLYVOX_SSE2)
+	//Compares sixteen densities with the threshold, giving a byte for each which is 0xFF if it is below the threshold
+	//and zero otherwise. SSE2 only has signed comparisons for integers, so unsigned values have their top bit flipped
+	//first. The primary template is for the density types which can't be compared this way.
+	template <typename DensityType>
+	struct SixteenDensities
+	{
+		static const bool isVectorised = false;
+
+		static __m128i lessThan(const DensityType* /*pDensities*/, const DensityType& /*tThreshold*/)
+		{
+			return _mm_setzero_si128();
+		}
+	};
+
+	template <>
+	struct SixteenDensities<int8_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const int8_t* pDensities, const int8_t& tThreshold)
+		{
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities));
+			return _mm_cmplt_epi8(data, _mm_set1_epi8(tThreshold));
+		}
+	};
+
+	template <>
+	struct SixteenDensities<uint8_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const uint8_t* pDensities, const uint8_t& tThreshold)
+		{
+			const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities));
+			return _mm_cmplt_epi8(_mm_xor_si128(data, flip), _mm_xor_si128(_mm_set1_epi8(static_cast<char>(tThreshold)), flip));
+		}
+	};
+
+	template <>
+	struct SixteenDensities<int16_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const int16_t* pDensities, const int16_t& tThreshold)
+		{
+			const __m128i threshold = _mm_set1_epi16(tThreshold);
+			const __m128i lower = _mm_cmplt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities)), threshold);
+			const __m128i upper = _mm_cmplt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities + 8)), threshold);
+			return _mm_packs_epi16(lower, upper);
+		}
+	};
+
+	template <>
+	struct SixteenDensities<uint16_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const uint16_t* pDensities, const uint16_t& tThreshold)
+		{
+			const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+			const __m128i threshold = _mm_xor_si128(_mm_set1_epi16(static_cast<short>(tThreshold)), flip);
+			const __m128i lower = _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities)), flip), threshold);
+			const __m128i upper = _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities + 8)), flip), threshold);
+			return _mm_packs_epi16(lower, upper);
+		}
+	};
+
+	template <>
+	struct SixteenDensities<int32_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const int32_t* pDensities, const int32_t& tThreshold)
+		{
+			const __m128i threshold = _mm_set1_epi32(tThreshold);
+			__m128i results[4];
+			for(uint32_t ct = 0; ct < 4; ct++)
+			{
+				results[ct] = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities + ct * 4)), threshold);
+			}
+			return _mm_packs_epi16(_mm_packs_epi32(results[0], results[1]), _mm_packs_epi32(results[2], results[3]));
+		}
+	};
+
+	template <>
+	struct SixteenDensities<uint32_t>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const uint32_t* pDensities, const uint32_t& tThreshold)
+		{
+			const __m128i flip = _mm_set1_epi32(static_cast<int>(0x80000000));
+			const __m128i threshold = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(tThreshold)), flip);
+			__m128i results[4];
+			for(uint32_t ct = 0; ct < 4; ct++)
+			{
+				results[ct] = _mm_cmplt_epi32(_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDensities + ct * 4)), flip), threshold);
+			}
+			return _mm_packs_epi16(_mm_packs_epi32(results[0], results[1]), _mm_packs_epi32(results[2], results[3]));
+		}
+	};
+
+	template <>
+	struct SixteenDensities<float>
+	{
+		static const bool isVectorised = true;
+
+		static __m128i lessThan(const float* pDensities, const float& tThreshold)
+		{
+			const __m128 threshold = _mm_set1_ps(tThreshold);
+			__m128i results[4];
+			for(uint32_t ct = 0; ct < 4; ct++)
+			{
+				results[ct] = _mm_castps_si128(_mm_cmplt_ps(_mm_loadu_ps(pDensities + ct * 4), threshold));
+			}
+			return _mm_packs_epi16(_mm_packs_epi32(results[0], results[1]), _mm_packs_epi32(results[2], results[3]));
+		}
+	};
+
+	//Counts the bits which are set in the lower sixteen bits of the value.
+	inline uint32_t countSetBits16(uint32_t uValue)
+	{
+		uValue = uValue - ((uValue >> 1) & 0x5555);
+		uValue = (uValue & 0x3333) + ((uValue >> 2) & 0x3333);
+		uValue = (uValue + (uValue >> 4)) & 0x0F0F;
+		return (uValue + (uValue >> 8)) & 0x1F;
+	}
+#endif //POLYVOX_SSE2
+
+	/// Sets each byte of pBelow to one if the corresponding density is below the threshold, and to zero otherwise.
+	template <typename DensityType>
+	void findDensitiesBelowThreshold(const DensityType* pDensities, uint32_t uNoOfDensities, const DensityType& tThreshold, uint8_t* pBelow)
+	{
+		uint32_t uOffset = 0;
+
+	#if defined(POLYVOX_SSE2)
+		if(SixteenDensities<DensityType>::isVectorised)
+		{
+			const __m128i one = _mm_set1_epi8(1);
+			for(; uOffset + 16 <= uNoOfDensities; uOffset += 16)
+			{
+				const __m128i below = SixteenDensities<DensityType>::lessThan(pDensities + uOffset, tThreshold);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pBelow + uOffset), _mm_and_si128(below, one));
+			}
+		}
+	#endif
+
+		for(; uOffset < uNoOfDensities; uOffset++)
+		{
+			pBelow[uOffset] = (pDensities[uOffset] < tThreshold) ? 1 : 0;
+		}
+	}
+
+	/// Combines two rows of the marks made by findDensitiesBelowThreshold() into the four bits which they contribute to
+	/// the bitmasks of the cells between them. Each row has one more mark than there are cells.
+	inline void combineCornerBits(const uint8_t* pLowerRow, const uint8_t* pUpperRow, uint32_t uNoOfCells, uint8_t* pCornerBits)
+	{
+		uint32_t uOffset = 0;
+
+	#if defined(POLYVOX_SSE2)
+		//The marks are zero or one, so shifting the 16-bit lanes can't carry a bit from one byte into the next.
+		for(; uOffset + 16 <= uNoOfCells; uOffset += 16)
+		{
+			const __m128i v00 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLowerRow + uOffset));
+			const __m128i v10 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLowerRow + uOffset + 1));
+			const __m128i v01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pUpperRow + uOffset));
+			const __m128i v11 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pUpperRow + uOffset + 1));
+			const __m128i bits = _mm_or_si128(_mm_or_si128(v00, _mm_slli_epi16(v10, 1)), _mm_or_si128(_mm_slli_epi16(v01, 2), _mm_slli_epi16(v11, 3)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pCornerBits + uOffset), bits);
+		}
+	#endif
+
+		for(; uOffset < uNoOfCells; uOffset++)
+		{
+			pCornerBits[uOffset] = pLowerRow[uOffset] | (pUpperRow[uOffset] << 2) | (pLowerRow[uOffset + 1] << 1) | (pUpperRow[uOffset + 1] << 3);
+		}
+	}
+
+	/// The corner bits are computed a row at a time (with x varying fastest) but the extractor stores its bitmasks with
+	/// y varying fastest. This copies them across, shifted into the upper half of the bitmask where a slice's upper
+	/// plane of voxels goes.
+	inline void transposeCornerBits(const uint8_t* pCornerBits, uint32_t uWidth, uint32_t uHeight, uint8_t* pBitmask)
+	{
+		for(uint32_t uY = 0; uY < uHeight; uY++)
+		{
+			const uint8_t* pRow = pCornerBits + uY * uWidth;
+			for(uint32_t uX = 0; uX < uWidth; uX++)
+			{
+				pBitmask[uX * uHeight + uY] = static_cast<uint8_t>(pRow[uX] << 4);
+			}
+		}
+	}
+
+	/// Completes the bitmasks for a slice by copying in the lower halves, which are the upper halves of the bitmasks for
+	/// the previous slice. Returns the number of cells which contain part of the surface, which are those which have
+	/// some but not all of their corners below the threshold.
+	inline uint32_t mergeSliceBitmasks(const uint8_t* pPreviousBitmask, uint8_t* pCurrentBitmask, uint32_t uNoOfCells)
+	{
+		uint32_t uNoOfOccupiedCells = 0;
+		uint32_t uOffset = 0;
+
+	#if defined(POLYVOX_SSE2)
+		const __m128i lowerHalf = _mm_set1_epi8(0x0F);
+		const __m128i allCorners = _mm_set1_epi8(static_cast<char>(0xFF));
+		for(; uOffset + 16 <= uNoOfCells; uOffset += 16)
+		{
+			const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPreviousBitmask + uOffset));
+			const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCurrentBitmask + uOffset));
+			const __m128i bitmask = _mm_or_si128(current, _mm_and_si128(_mm_srli_epi16(previous, 4), lowerHalf));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pCurrentBitmask + uOffset), bitmask);
+
+			const __m128i unoccupied = _mm_or_si128(_mm_cmpeq_epi8(bitmask, _mm_setzero_si128()), _mm_cmpeq_epi8(bitmask, allCorners));
+			uNoOfOccupiedCells += 16 - countSetBits16(static_cast<uint32_t>(_mm_movemask_epi8(unoccupied)));
+		}
+	#endif
+
+		for(; uOffset < uNoOfCells; uOffset++)
+		{
+			const uint8_t uBitmask = pCurrentBitmask[uOffset] | (pPreviousBitmask[uOffset] >> 4);
+			pCurrentBitmask[uOffset] = uBitmask;
+			if((uBitmask != 0) && (uBitmask != 255))
+			{
+				uNoOfOccupiedCells++;
+			}
+		}
+
+		return uNoOfOccupiedCells;
+	}
+}
+
+#endif //__PolyVox_MarchingCubesBitmask_H__
@@ -30,6 +30,8 @@ namespace PolyVox
 {
 	extern const POLYVOX_API int edgeTable[256];
 	extern const POLYVOX_API int triTable[256][16];
+	extern const POLYVOX_API uint8_t triangleCountTable[256];
+	extern const POLYVOX_API uint8_t edgeCornersTable[12][2];
 }
 
 #endif
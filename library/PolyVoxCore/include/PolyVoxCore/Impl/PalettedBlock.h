@@ -0,0 +1,88 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_PalettedBlock_H__
+#define __PolyVox_PalettedBlock_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+#include "PolyVoxCore/Impl/VoxelPalette.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <vector>
+
+namespace PolyVox
+{
+	/// A block which stores each distinct value once, and then a small index for each voxel.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The indices are packed into 32-bit words using 0, 1, 2, 4, 8, 16 or 32 bits each, whichever is the
+	/// smallest that can address the palette. Voxels can be read and written in place, and when a write adds
+	/// a value which doesn't fit the current index size all the indices are widened to the next size up.
+	/// Values are never removed from the palette (except by fill()) so it only ever grows.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class PalettedBlock
+	{
+	public:
+		PalettedBlock(uint16_t uSideLength = 0);
+
+		uint16_t getSideLength(void) const;
+		VoxelType getVoxelAt(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos) const;
+		VoxelType getVoxelAt(const Vector3DUint16& v3dPos) const;
+		inline VoxelType getVoxelAtIndex(uint32_t uIndex) const;
+
+		void setVoxelAt(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos, VoxelType tValue);
+		void setVoxelAt(const Vector3DUint16& v3dPos, VoxelType tValue);
+		void setVoxelAtIndex(uint32_t uIndex, VoxelType tValue);
+
+		void fill(VoxelType tValue);
+		void initialise(uint16_t uSideLength);
+		uint32_t calculateSizeInBytes(void);
+
+		uint8_t getBitsPerIndex(void) const;
+		uint32_t getPaletteSize(void) const;
+
+	private:
+		void setBitsPerIndex(uint8_t uBitsPerIndex);
+		inline uint32_t getPaletteIndex(uint32_t uIndex) const;
+		inline void setPaletteIndex(uint32_t uIndex, uint32_t uPaletteIndex);
+
+		VoxelPalette<VoxelType> m_palette;
+		std::vector<uint32_t> m_vecPackedIndices;
+
+		//These are derived from the number of bits per index, so that finding an
+		//index is just shifts and masks. With zero bits every voxel maps to word
+		//zero and the mask is zero, so a uniform block needs no special case.
+		uint8_t m_uBitsPerIndex;
+		uint8_t m_uBitsPerIndexPower;
+		uint8_t m_uIndicesPerWordPower;
+		uint32_t m_uIndexInWordMask;
+		uint32_t m_uPaletteIndexMask;
+
+		uint16_t m_uSideLength;
+		uint8_t m_uSideLengthPower;
+	};
+}
+
+#include "PolyVoxCore/Impl/PalettedBlock.inl"
+
+#endif
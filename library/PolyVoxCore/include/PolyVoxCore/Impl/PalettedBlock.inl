@@ -0,0 +1,227 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "PolyVoxCore/Impl/Utility.h"
+
+#include <cassert>
+#include <stdexcept> //for std::invalid_argument
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	PalettedBlock<VoxelType>::PalettedBlock(uint16_t uSideLength)
+		:m_uBitsPerIndex(0)
+		,m_uBitsPerIndexPower(0)
+		,m_uIndicesPerWordPower(31)
+		,m_uIndexInWordMask(0)
+		,m_uPaletteIndexMask(0)
+		,m_uSideLength(0)
+		,m_uSideLengthPower(0)
+	{
+		if(uSideLength != 0)
+		{
+			initialise(uSideLength);
+		}
+	}
+
+	template <typename VoxelType>
+	uint16_t PalettedBlock<VoxelType>::getSideLength(void) const
+	{
+		return m_uSideLength;
+	}
+
+	template <typename VoxelType>
+	VoxelType PalettedBlock<VoxelType>::getVoxelAt(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos) const
+	{
+		assert(uXPos < m_uSideLength);
+		assert(uYPos < m_uSideLength);
+		assert(uZPos < m_uSideLength);
+
+		return getVoxelAtIndex
+			(
+				uXPos + 
+				uYPos * m_uSideLength + 
+				uZPos * m_uSideLength * m_uSideLength
+			);
+	}
+
+	template <typename VoxelType>
+	VoxelType PalettedBlock<VoxelType>::getVoxelAt(const Vector3DUint16& v3dPos) const
+	{
+		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	template <typename VoxelType>
+	VoxelType PalettedBlock<VoxelType>::getVoxelAtIndex(uint32_t uIndex) const
+	{
+		return m_palette.getValue(getPaletteIndex(uIndex));
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::setVoxelAt(uint16_t uXPos, uint16_t uYPos, uint16_t uZPos, VoxelType tValue)
+	{
+		assert(uXPos < m_uSideLength);
+		assert(uYPos < m_uSideLength);
+		assert(uZPos < m_uSideLength);
+
+		setVoxelAtIndex
+		(
+			uXPos + 
+			uYPos * m_uSideLength + 
+			uZPos * m_uSideLength * m_uSideLength,
+			tValue
+		);
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::setVoxelAt(const Vector3DUint16& v3dPos, VoxelType tValue)
+	{
+		setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::setVoxelAtIndex(uint32_t uIndex, VoxelType tValue)
+	{
+		assert(uIndex < static_cast<uint32_t>(m_uSideLength * m_uSideLength * m_uSideLength));
+
+		const uint32_t uPaletteIndex = m_palette.findOrAdd(tValue);
+
+		//Widen the indices if the new value doesn't fit.
+		if(uPaletteIndex > m_uPaletteIndexMask)
+		{
+			setBitsPerIndex(VoxelPalette<VoxelType>::getBitsPerIndex(m_palette.size()));
+		}
+
+		setPaletteIndex(uIndex, uPaletteIndex);
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::fill(VoxelType tValue)
+	{
+		//Start again with a palette holding just this value.
+		m_palette.clear();
+		m_palette.findOrAdd(tValue);
+		m_vecPackedIndices.clear();
+		setBitsPerIndex(0);
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::initialise(uint16_t uSideLength)
+	{
+		//Debug mode validation
+		assert(isPowerOf2(uSideLength));
+
+		//Release mode validation
+		if(!isPowerOf2(uSideLength))
+		{
+			throw std::invalid_argument("Block side length must be a power of two.");
+		}
+
+		//Compute the side length		
+		m_uSideLength = uSideLength;
+		m_uSideLengthPower = logBase2(uSideLength);
+
+		PalettedBlock<VoxelType>::fill(VoxelType());
+	}
+
+	template <typename VoxelType>
+	uint32_t PalettedBlock<VoxelType>::calculateSizeInBytes(void)
+	{
+		uint32_t uSizeInBytes = sizeof(PalettedBlock<VoxelType>);
+		uSizeInBytes += m_palette.calculateSizeInBytes() - sizeof(VoxelPalette<VoxelType>);
+		uSizeInBytes += static_cast<uint32_t>(m_vecPackedIndices.capacity() * sizeof(uint32_t));
+		return  uSizeInBytes;
+	}
+
+	template <typename VoxelType>
+	uint8_t PalettedBlock<VoxelType>::getBitsPerIndex(void) const
+	{
+		return m_uBitsPerIndex;
+	}
+
+	template <typename VoxelType>
+	uint32_t PalettedBlock<VoxelType>::getPaletteSize(void) const
+	{
+		return m_palette.size();
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::setBitsPerIndex(uint8_t uBitsPerIndex)
+	{
+		assert(isPowerOf2(uBitsPerIndex) || (uBitsPerIndex == 0));
+		assert(uBitsPerIndex >= m_uBitsPerIndex || m_vecPackedIndices.empty());
+
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+
+		//Read out the existing indices before the layout changes.
+		std::vector<uint32_t> vecOldIndices;
+		if(!m_vecPackedIndices.empty())
+		{
+			vecOldIndices.resize(uNoOfVoxels);
+			for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+			{
+				vecOldIndices[ct] = getPaletteIndex(ct);
+			}
+		}
+
+		m_uBitsPerIndex = uBitsPerIndex;
+		if(uBitsPerIndex == 0)
+		{
+			m_uBitsPerIndexPower = 0;
+			m_uIndicesPerWordPower = 31;
+			m_uIndexInWordMask = 0;
+			m_uPaletteIndexMask = 0;
+		}
+		else
+		{
+			m_uBitsPerIndexPower = logBase2(uBitsPerIndex);
+			m_uIndicesPerWordPower = 5 - m_uBitsPerIndexPower;
+			m_uIndexInWordMask = (1u << m_uIndicesPerWordPower) - 1;
+			m_uPaletteIndexMask = (uBitsPerIndex == 32) ? 0xFFFFFFFF : ((1u << uBitsPerIndex) - 1);
+		}
+
+		const uint32_t uNoOfWords = (uBitsPerIndex == 0) ? 1 : ((uNoOfVoxels << m_uBitsPerIndexPower) + 31) / 32;
+		std::vector<uint32_t>(uNoOfWords, 0).swap(m_vecPackedIndices);
+
+		for(uint32_t ct = 0; ct < vecOldIndices.size(); ct++)
+		{
+			setPaletteIndex(ct, vecOldIndices[ct]);
+		}
+	}
+
+	template <typename VoxelType>
+	uint32_t PalettedBlock<VoxelType>::getPaletteIndex(uint32_t uIndex) const
+	{
+		const uint32_t uWord = m_vecPackedIndices[uIndex >> m_uIndicesPerWordPower];
+		const uint32_t uShift = (uIndex & m_uIndexInWordMask) << m_uBitsPerIndexPower;
+		return (uWord >> uShift) & m_uPaletteIndexMask;
+	}
+
+	template <typename VoxelType>
+	void PalettedBlock<VoxelType>::setPaletteIndex(uint32_t uIndex, uint32_t uPaletteIndex)
+	{
+		uint32_t& uWord = m_vecPackedIndices[uIndex >> m_uIndicesPerWordPower];
+		const uint32_t uShift = (uIndex & m_uIndexInWordMask) << m_uBitsPerIndexPower;
+		uWord = (uWord & ~(m_uPaletteIndexMask << uShift)) | ((uPaletteIndex & m_uPaletteIndexMask) << uShift);
+	}
+}
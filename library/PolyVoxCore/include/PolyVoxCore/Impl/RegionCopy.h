@@ -0,0 +1,196 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_RegionCopy_H__
+#define __PolyVox_RegionCopy_H__
+
+#include "PolyVoxCore/Impl/BlockLayout.h"
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include "PolyVoxCore/Region.h"
+
+#include <algorithm>
+
+//These are the building blocks of the readRegion(), writeRegion() and fillRegion() functions of the volumes. A buffer
+//holding a region stores its voxels with x varying fastest, then y, then z, as does a block with the linear layout. In
+//each function regPart is in volume coordinates, and must lie within all of the regions and blocks which are involved.
+namespace PolyVox
+{
+	/// Gets the index of the voxel at the given position within a buffer holding the given region.
+	inline uint32_t getVoxelIndexInRegion(int32_t iXPos, int32_t iYPos, int32_t iZPos, const Region& regRegion)
+	{
+		const uint32_t uWidth = regRegion.getWidthInVoxels();
+		const uint32_t uHeight = regRegion.getHeightInVoxels();
+		return (iXPos - regRegion.getLowerCorner().getX())
+			+ (iYPos - regRegion.getLowerCorner().getY()) * uWidth
+			+ (iZPos - regRegion.getLowerCorner().getZ()) * uWidth * uHeight;
+	}
+
+	/// Gets the voxels covered by the block at the given block position.
+	inline Region getRegionOfBlock(int32_t iBlockX, int32_t iBlockY, int32_t iBlockZ, uint8_t uSideLengthPower)
+	{
+		const Vector3DInt32 v3dLowerCorner(iBlockX << uSideLengthPower, iBlockY << uSideLengthPower, iBlockZ << uSideLengthPower);
+		const int32_t iOffsetToUpperCorner = (1 << uSideLengthPower) - 1;
+		return Region(v3dLowerCorner, v3dLowerCorner + Vector3DInt32(iOffsetToUpperCorner, iOffsetToUpperCorner, iOffsetToUpperCorner));
+	}
+
+	/// Gets the positions of the blocks which the given region touches.
+	inline Region getBlocksInRegion(const Region& regRegion, uint8_t uSideLengthPower)
+	{
+		return Region(regRegion.getLowerCorner().getX() >> uSideLengthPower, regRegion.getLowerCorner().getY() >> uSideLengthPower, regRegion.getLowerCorner().getZ() >> uSideLengthPower,
+			regRegion.getUpperCorner().getX() >> uSideLengthPower, regRegion.getUpperCorner().getY() >> uSideLengthPower, regRegion.getUpperCorner().getZ() >> uSideLengthPower);
+	}
+
+	/// Copies part of one region buffer into another, a row at a time.
+	template <typename VoxelType>
+	void copyRegionPart(const VoxelType* pSrcVoxels, const Region& regSrc, VoxelType* pDstVoxels, const Region& regDst, const Region& regPart)
+	{
+		const uint32_t uRowLength = regPart.getWidthInVoxels();
+		for(int32_t z = regPart.getLowerCorner().getZ(); z <= regPart.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regPart.getLowerCorner().getY(); y <= regPart.getUpperCorner().getY(); y++)
+			{
+				const VoxelType* pSrcRow = pSrcVoxels + getVoxelIndexInRegion(regPart.getLowerCorner().getX(), y, z, regSrc);
+				std::copy(pSrcRow, pSrcRow + uRowLength, pDstVoxels + getVoxelIndexInRegion(regPart.getLowerCorner().getX(), y, z, regDst));
+			}
+		}
+	}
+
+	/// Sets part of a region buffer to the given value, a row at a time.
+	template <typename VoxelType>
+	void fillRegionPart(VoxelType* pVoxels, const Region& regRegion, const Region& regPart, const VoxelType& tValue)
+	{
+		const uint32_t uRowLength = regPart.getWidthInVoxels();
+		for(int32_t z = regPart.getLowerCorner().getZ(); z <= regPart.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regPart.getLowerCorner().getY(); y <= regPart.getUpperCorner().getY(); y++)
+			{
+				VoxelType* pRow = pVoxels + getVoxelIndexInRegion(regPart.getLowerCorner().getX(), y, z, regRegion);
+				std::fill(pRow, pRow + uRowLength, tValue);
+			}
+		}
+	}
+
+	/// Reads the voxels of a region buffer which are outside regInside from the volume, one at a time. This is for volumes
+	/// whose border isn't a single value, so that they can map each position on to a voxel inside them.
+	template <typename VolumeType, typename VoxelType>
+	void readRegionOutside(const VolumeType* pVolume, VoxelType* pVoxels, const Region& regRegion, const Region& regInside)
+	{
+		for(int32_t z = regRegion.getLowerCorner().getZ(); z <= regRegion.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regRegion.getLowerCorner().getY(); y <= regRegion.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regRegion.getLowerCorner().getX(); x <= regRegion.getUpperCorner().getX(); x++)
+				{
+					if(!regInside.containsPoint(Vector3DInt32(x, y, z)))
+					{
+						pVoxels[getVoxelIndexInRegion(x, y, z, regRegion)] = pVolume->getVoxelAt(x, y, z);
+					}
+				}
+			}
+		}
+	}
+
+	/// Copies part of a block (which covers regBlock) into a region buffer.
+	template <typename VoxelType>
+	void copyBlockToRegion(const VoxelType* pBlockVoxels, const Region& regBlock, BlockLayout eLayout, VoxelType* pRegionVoxels, const Region& regRegion, const Region& regPart)
+	{
+		if(eLayout == BlockLayouts::Linear)
+		{
+			copyRegionPart(pBlockVoxels, regBlock, pRegionVoxels, regRegion, regPart);
+			return;
+		}
+
+		//With the Morton layout each row is walked by incrementing the index, rather than encoding every position.
+		const uint32_t uRowLength = regPart.getWidthInVoxels();
+		const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+		for(int32_t z = regPart.getLowerCorner().getZ(); z <= regPart.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regPart.getLowerCorner().getY(); y <= regPart.getUpperCorner().getY(); y++)
+			{
+				VoxelType* pRow = pRegionVoxels + getVoxelIndexInRegion(regPart.getLowerCorner().getX(), y, z, regRegion);
+				uint32_t uMortonIndex = encodeMortonIndex(regPart.getLowerCorner().getX() - v3dBlockLowerCorner.getX(), y - v3dBlockLowerCorner.getY(), z - v3dBlockLowerCorner.getZ());
+				for(uint32_t x = 0; x < uRowLength; x++)
+				{
+					pRow[x] = pBlockVoxels[uMortonIndex];
+					uMortonIndex = incrementMortonIndex(uMortonIndex, uMortonXMask);
+				}
+			}
+		}
+	}
+
+	/// Copies part of a region buffer into a block. This is the reverse of copyBlockToRegion().
+	template <typename VoxelType>
+	void copyRegionToBlock(const VoxelType* pRegionVoxels, const Region& regRegion, VoxelType* pBlockVoxels, const Region& regBlock, BlockLayout eLayout, const Region& regPart)
+	{
+		if(eLayout == BlockLayouts::Linear)
+		{
+			copyRegionPart(pRegionVoxels, regRegion, pBlockVoxels, regBlock, regPart);
+			return;
+		}
+
+		const uint32_t uRowLength = regPart.getWidthInVoxels();
+		const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+		for(int32_t z = regPart.getLowerCorner().getZ(); z <= regPart.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regPart.getLowerCorner().getY(); y <= regPart.getUpperCorner().getY(); y++)
+			{
+				const VoxelType* pRow = pRegionVoxels + getVoxelIndexInRegion(regPart.getLowerCorner().getX(), y, z, regRegion);
+				uint32_t uMortonIndex = encodeMortonIndex(regPart.getLowerCorner().getX() - v3dBlockLowerCorner.getX(), y - v3dBlockLowerCorner.getY(), z - v3dBlockLowerCorner.getZ());
+				for(uint32_t x = 0; x < uRowLength; x++)
+				{
+					pBlockVoxels[uMortonIndex] = pRow[x];
+					uMortonIndex = incrementMortonIndex(uMortonIndex, uMortonXMask);
+				}
+			}
+		}
+	}
+
+	/// Sets part of a block to the given value.
+	template <typename VoxelType>
+	void fillBlockPart(VoxelType* pBlockVoxels, const Region& regBlock, BlockLayout eLayout, const Region& regPart, const VoxelType& tValue)
+	{
+		if(eLayout == BlockLayouts::Linear)
+		{
+			fillRegionPart(pBlockVoxels, regBlock, regPart, tValue);
+			return;
+		}
+
+		const uint32_t uRowLength = regPart.getWidthInVoxels();
+		const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+		for(int32_t z = regPart.getLowerCorner().getZ(); z <= regPart.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regPart.getLowerCorner().getY(); y <= regPart.getUpperCorner().getY(); y++)
+			{
+				uint32_t uMortonIndex = encodeMortonIndex(regPart.getLowerCorner().getX() - v3dBlockLowerCorner.getX(), y - v3dBlockLowerCorner.getY(), z - v3dBlockLowerCorner.getZ());
+				for(uint32_t x = 0; x < uRowLength; x++)
+				{
+					pBlockVoxels[uMortonIndex] = tValue;
+					uMortonIndex = incrementMortonIndex(uMortonIndex, uMortonXMask);
+				}
+			}
+		}
+	}
+}
+
+#endif //__PolyVox_RegionCopy_H__
@@ -0,0 +1,73 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_ThreadPool_H__
+#define __PolyVox_ThreadPool_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include <deque>
+#include <vector>
+
+namespace PolyVox
+{
+	/// A fixed set of worker threads which run tasks from a shared queue.
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is used by the LargeVolume to page blocks in and out in the background.
+	/// Tasks are run in the order they were enqueued, though with more than one
+	/// thread they can of course finish in a different order.
+	////////////////////////////////////////////////////////////////////////////////
+	class POLYVOX_API ThreadPool
+	{
+	public:
+		/// Creates the pool and starts its threads.
+		ThreadPool(uint32_t uNoOfThreads);
+		/// Finishes any tasks which are still queued and then stops the threads.
+		~ThreadPool();
+
+		/// Adds a task to the queue, to be run by the next free thread.
+		void enqueue(polyvox_function<void()> funcTask);
+		/// Blocks until the queue is empty and no task is running.
+		void waitForAll(void);
+
+		/// Gets the number of threads in the pool.
+		uint32_t getNoOfThreads(void) const;
+
+	private:
+		//Not copyable.
+		ThreadPool(const ThreadPool& rhs);
+		ThreadPool& operator=(const ThreadPool& rhs);
+
+		void runWorker(void);
+
+		std::vector<polyvox_thread*> m_vecThreads;
+		std::deque< polyvox_function<void()> > m_queueTasks;
+		polyvox_mutex m_mutexTasks;
+		polyvox_condition_variable m_condTaskAvailable;
+		polyvox_condition_variable m_condAllTasksDone;
+		uint32_t m_uNoOfRunningTasks;
+		bool m_bStopping;
+	};
+}
+
+#endif
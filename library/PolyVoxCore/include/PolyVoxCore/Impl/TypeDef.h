@@ -79,6 +79,18 @@ freely, subject to the following restrictions:
 	#include <boost/static_assert.hpp>
 	#define static_assert BOOST_STATIC_ASSERT
 
+	#include <boost/atomic.hpp>
+	#define polyvox_atomic boost::atomic
+
+	#include <boost/thread.hpp>
+	#define polyvox_thread boost::thread
+	#define polyvox_mutex boost::mutex
+	#define polyvox_lock_guard boost::lock_guard
+	#define polyvox_unique_lock boost::unique_lock
+	#define polyvox_defer_lock boost::defer_lock
+	#define polyvox_condition_variable boost::condition_variable
+	#define polyvox_condition_variable_any boost::condition_variable_any
+
 
 	//As long as we're requiring boost, we'll use it to compensate
 	//for the missing cstdint header too.
@@ -89,17 +101,42 @@ freely, subject to the following restrictions:
 	using boost::uint8_t;
 	using boost::uint16_t;
 	using boost::uint32_t;
+	using boost::int64_t;
+	using boost::uint64_t;
 #else
 	//We have a decent compiler - use real C++0x features
+	#include <atomic>
+	#include <condition_variable>
 	#include <cstdint>
 	#include <functional>
 	#include <memory>
+	#include <mutex>
+	#include <thread>
 	#define polyvox_shared_ptr std::shared_ptr
 	#define polyvox_function std::function
 	#define polyvox_bind std::bind
 	#define polyvox_placeholder_1 std::placeholders::_1
 	#define polyvox_placeholder_2 std::placeholders::_2
+	#define polyvox_atomic std::atomic
+	#define polyvox_thread std::thread
+	#define polyvox_mutex std::mutex
+	#define polyvox_lock_guard std::lock_guard
+	#define polyvox_unique_lock std::unique_lock
+	#define polyvox_defer_lock std::defer_lock
+	#define polyvox_condition_variable std::condition_variable
+	#define polyvox_condition_variable_any std::condition_variable_any
 	//#define static_assert static_assert //we can use this
 #endif
 
+//Check which SIMD instruction sets we are allowed to use. SSE2 is part of x86-64 so it is always available there, while AVX2
+//has to be enabled on the compiler's command line (e.g. -mavx2 or /arch:AVX2). Define POLYVOX_DISABLE_SIMD to use plain C++.
+#if !defined(POLYVOX_DISABLE_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+		#define POLYVOX_SSE2
+	#endif
+	#if defined(POLYVOX_SSE2) && defined(__AVX2__)
+		#define POLYVOX_AVX2
+	#endif
+#endif
+
 #endif
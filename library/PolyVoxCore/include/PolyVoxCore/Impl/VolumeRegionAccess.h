@@ -0,0 +1,94 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution.
+*******************************************************************************/
+
+#ifndef __PolyVox_VolumeRegionAccess_H__
+#define __PolyVox_VolumeRegionAccess_H__
+
+#include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/Region.h"
+
+//BaseVolume's readRegion() and writeRegion() are not virtual and only assert, so a subclass of BaseVolume which doesn't
+//provide its own versions can't be used with them. Code which works on any volume type goes through the functions below
+//instead. They call the volume's own versions when it has them, and otherwise fall back on getVoxelAt() and setVoxelAt().
+namespace PolyVox
+{
+	//Taking the address of a function which a volume inherits gives a pointer to a member of BaseVolume. These overloads
+	//only match such pointers, so the size of their result tells whether the volume provides its own version.
+	template <typename VoxelType>
+	char isBaseVolumeFunction(void (BaseVolume<VoxelType>::*)(const Region&, VoxelType*) const);
+	template <typename VoxelType>
+	char isBaseVolumeFunction(void (BaseVolume<VoxelType>::*)(const Region&, const VoxelType*));
+	template <typename FunctionType>
+	long isBaseVolumeFunction(FunctionType);
+
+	/// Copies the voxels in a region into a buffer, as BaseVolume::readRegion() does.
+	template <typename VolumeType>
+	void readVolumeRegion(const VolumeType* pVolume, const Region& regRead, typename VolumeType::VoxelType* pDestination)
+	{
+		if(sizeof(isBaseVolumeFunction(&VolumeType::readRegion)) != sizeof(char))
+		{
+			pVolume->readRegion(regRead, pDestination);
+			return;
+		}
+
+		for(int32_t z = regRead.getLowerCorner().getZ(); z <= regRead.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regRead.getLowerCorner().getY(); y <= regRead.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regRead.getLowerCorner().getX(); x <= regRead.getUpperCorner().getX(); x++)
+				{
+					*pDestination++ = pVolume->getVoxelAt(x, y, z);
+				}
+			}
+		}
+	}
+
+	/// Copies the voxels in a region from a buffer, as BaseVolume::writeRegion() does.
+	template <typename VolumeType>
+	void writeVolumeRegion(VolumeType* pVolume, const Region& regWrite, const typename VolumeType::VoxelType* pSource)
+	{
+		if(sizeof(isBaseVolumeFunction(&VolumeType::writeRegion)) != sizeof(char))
+		{
+			pVolume->writeRegion(regWrite, pSource);
+			return;
+		}
+
+		const Region regValid = pVolume->getEnclosingRegion();
+		for(int32_t z = regWrite.getLowerCorner().getZ(); z <= regWrite.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regWrite.getLowerCorner().getY(); y <= regWrite.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regWrite.getLowerCorner().getX(); x <= regWrite.getUpperCorner().getX(); x++)
+				{
+					if(regValid.containsPoint(Vector3DInt32(x, y, z)))
+					{
+						pVolume->setVoxelAt(x, y, z, *pSource);
+					}
+					pSource++;
+				}
+			}
+		}
+	}
+}
+
+#endif //__PolyVox_VolumeRegionAccess_H__
@@ -0,0 +1,75 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_VoxelPalette_H__
+#define __PolyVox_VoxelPalette_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include <vector>
+
+namespace PolyVox
+{
+	/// Assigns a small index to each distinct voxel value it is given.
+	////////////////////////////////////////////////////////////////////////////////
+	/// Voxel types only have to provide operator==, so the values are hashed and compared by their bytes.
+	/// This means values which compare equal but have different representations (such as 0.0f and -0.0f)
+	/// get separate entries, which costs a little space but means every value is reproduced exactly.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class VoxelPalette
+	{
+	public:
+		VoxelPalette();
+
+		/// Gets the index of the given value, adding it to the palette if necessary.
+		uint32_t findOrAdd(const VoxelType& tValue);
+		/// Gets the index of the given value, or returns false if it isn't in the palette.
+		bool find(const VoxelType& tValue, uint32_t& uIndex) const;
+		/// Removes all the values from the palette.
+		void clear(void);
+
+		/// Gets the value with the given index.
+		const VoxelType& getValue(uint32_t uIndex) const;
+		/// Gets the number of values in the palette.
+		uint32_t size(void) const;
+		/// Calculates approximately how many bytes of memory the palette is using.
+		uint32_t calculateSizeInBytes(void) const;
+
+		/// Gets the number of bits needed for each index into a palette of the given size.
+		static uint8_t getBitsPerIndex(uint32_t uPaletteSize);
+
+	private:
+		static uint32_t hash(const VoxelType& tValue);
+		static bool isIdentical(const VoxelType& tValue1, const VoxelType& tValue2);
+		void grow(void);
+
+		std::vector<VoxelType> m_vecValues;
+		//Open addressing hash table holding an index into m_vecValues plus one, or zero for an empty slot.
+		std::vector<uint32_t> m_vecSlots;
+	};
+}
+
+#include "PolyVoxCore/Impl/VoxelPalette.inl"
+
+#endif
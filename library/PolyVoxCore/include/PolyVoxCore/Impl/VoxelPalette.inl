@@ -0,0 +1,154 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <cassert>
+#include <cstring> //For memcmp
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	VoxelPalette<VoxelType>::VoxelPalette()
+		:m_vecSlots(16, 0)
+	{
+	}
+
+	template <typename VoxelType>
+	uint32_t VoxelPalette<VoxelType>::findOrAdd(const VoxelType& tValue)
+	{
+		uint32_t uIndex;
+		if(find(tValue, uIndex))
+		{
+			return uIndex;
+		}
+
+		//Keep the table at most half full so that probe sequences stay short.
+		if((m_vecValues.size() + 1) * 2 > m_vecSlots.size())
+		{
+			grow();
+		}
+
+		const uint32_t uSlotMask = static_cast<uint32_t>(m_vecSlots.size()) - 1;
+		uint32_t uSlot = hash(tValue) & uSlotMask;
+		while(m_vecSlots[uSlot] != 0)
+		{
+			uSlot = (uSlot + 1) & uSlotMask;
+		}
+
+		m_vecValues.push_back(tValue);
+		m_vecSlots[uSlot] = static_cast<uint32_t>(m_vecValues.size());
+		return static_cast<uint32_t>(m_vecValues.size()) - 1;
+	}
+
+	template <typename VoxelType>
+	bool VoxelPalette<VoxelType>::find(const VoxelType& tValue, uint32_t& uIndex) const
+	{
+		const uint32_t uSlotMask = static_cast<uint32_t>(m_vecSlots.size()) - 1;
+		for(uint32_t uSlot = hash(tValue) & uSlotMask; m_vecSlots[uSlot] != 0; uSlot = (uSlot + 1) & uSlotMask)
+		{
+			if(isIdentical(m_vecValues[m_vecSlots[uSlot] - 1], tValue))
+			{
+				uIndex = m_vecSlots[uSlot] - 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template <typename VoxelType>
+	void VoxelPalette<VoxelType>::clear(void)
+	{
+		m_vecValues.clear();
+		std::fill(m_vecSlots.begin(), m_vecSlots.end(), 0);
+	}
+
+	template <typename VoxelType>
+	const VoxelType& VoxelPalette<VoxelType>::getValue(uint32_t uIndex) const
+	{
+		assert(uIndex < m_vecValues.size());
+		return m_vecValues[uIndex];
+	}
+
+	template <typename VoxelType>
+	uint32_t VoxelPalette<VoxelType>::size(void) const
+	{
+		return static_cast<uint32_t>(m_vecValues.size());
+	}
+
+	template <typename VoxelType>
+	uint32_t VoxelPalette<VoxelType>::calculateSizeInBytes(void) const
+	{
+		uint32_t uSizeInBytes = sizeof(VoxelPalette<VoxelType>);
+		uSizeInBytes += static_cast<uint32_t>(m_vecValues.capacity() * sizeof(VoxelType));
+		uSizeInBytes += static_cast<uint32_t>(m_vecSlots.capacity() * sizeof(uint32_t));
+		return uSizeInBytes;
+	}
+
+	template <typename VoxelType>
+	uint8_t VoxelPalette<VoxelType>::getBitsPerIndex(uint32_t uPaletteSize)
+	{
+		//Only powers of two are used, so that an index never straddles two bytes (or words).
+		if(uPaletteSize <= 1) return 0;
+		if(uPaletteSize <= 2) return 1;
+		if(uPaletteSize <= 4) return 2;
+		if(uPaletteSize <= 16) return 4;
+		if(uPaletteSize <= 256) return 8;
+		if(uPaletteSize <= 65536) return 16;
+		return 32; //Only possible with very large blocks.
+	}
+
+	template <typename VoxelType>
+	uint32_t VoxelPalette<VoxelType>::hash(const VoxelType& tValue)
+	{
+		//FNV-1a over the bytes of the value.
+		const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&tValue);
+		uint32_t uHash = 2166136261u;
+		for(uint32_t ct = 0; ct < sizeof(VoxelType); ct++)
+		{
+			uHash = (uHash ^ pBytes[ct]) * 16777619u;
+		}
+		return uHash;
+	}
+
+	template <typename VoxelType>
+	bool VoxelPalette<VoxelType>::isIdentical(const VoxelType& tValue1, const VoxelType& tValue2)
+	{
+		return memcmp(&tValue1, &tValue2, sizeof(VoxelType)) == 0;
+	}
+
+	template <typename VoxelType>
+	void VoxelPalette<VoxelType>::grow(void)
+	{
+		m_vecSlots.assign(m_vecSlots.size() * 2, 0);
+
+		const uint32_t uSlotMask = static_cast<uint32_t>(m_vecSlots.size()) - 1;
+		for(uint32_t uIndex = 0; uIndex < m_vecValues.size(); uIndex++)
+		{
+			uint32_t uSlot = hash(m_vecValues[uIndex]) & uSlotMask;
+			while(m_vecSlots[uSlot] != 0)
+			{
+				uSlot = (uSlot + 1) & uSlotMask;
+			}
+			m_vecSlots[uSlot] = uIndex + 1;
+		}
+	}
+}
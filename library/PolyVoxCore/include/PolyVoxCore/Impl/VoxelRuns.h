@@ -0,0 +1,200 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_VoxelRuns_H__
+#define __PolyVox_VoxelRuns_H__
+
+#include "PolyVoxCore/Impl/TypeDef.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring> //For memcpy
+
+#if defined(POLYVOX_SSE2)
+	#include <emmintrin.h>
+#endif
+#if defined(POLYVOX_AVX2)
+	#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h> //For _BitScanForward
+#endif
+
+namespace PolyVox
+{
+	//Run detection and expansion for the run length encoders. When the voxel is one, two or four bytes in size
+	//a 16 (or with AVX2, 32) byte vector holds a whole number of voxels, so runs can be found by comparing the
+	//data against a vector filled with the run's value and looking for the first byte which differs. This
+	//compares the bytes of the voxels rather than using operator==, which is the same thing for all the voxel
+	//types PolyVox provides. The scalar code then finishes off whatever is left.
+
+#if defined(POLYVOX_SSE2)
+	inline uint32_t countTrailingZeros(uint32_t uValue)
+	{
+		assert(uValue != 0);
+	#if defined(_MSC_VER)
+		unsigned long uIndex;
+		_BitScanForward(&uIndex, uValue);
+		return static_cast<uint32_t>(uIndex);
+	#else
+		return static_cast<uint32_t>(__builtin_ctz(uValue));
+	#endif
+	}
+
+	//Fills a vector with copies of the voxel. The voxel must be one, two or four bytes in size.
+	template <typename VoxelType>
+	__m128i makeRunPattern(const VoxelType& tValue)
+	{
+		if(sizeof(VoxelType) == 1)
+		{
+			uint8_t uBits;
+			memcpy(&uBits, &tValue, 1);
+			return _mm_set1_epi8(static_cast<char>(uBits));
+		}
+		else if(sizeof(VoxelType) == 2)
+		{
+			uint16_t uBits;
+			memcpy(&uBits, &tValue, 2);
+			return _mm_set1_epi16(static_cast<short>(uBits));
+		}
+		else
+		{
+			uint32_t uBits;
+			memcpy(&uBits, &tValue, 4);
+			return _mm_set1_epi32(static_cast<int>(uBits));
+		}
+	}
+
+	//Returns the number of bytes from the start of pData which match the pattern, only looking at whole
+	//vectors. It stops at the first byte which differs, or at the last whole vector within uNoOfBytes.
+	inline uint32_t countMatchingBytes(const uint8_t* pData, uint32_t uNoOfBytes, __m128i pattern128)
+	{
+		uint32_t uOffset = 0;
+
+	#if defined(POLYVOX_AVX2)
+		const __m256i pattern256 = _mm256_broadcastsi128_si256(pattern128);
+		for(; uOffset + 32 <= uNoOfBytes; uOffset += 32)
+		{
+			const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + uOffset));
+			const uint32_t uMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, pattern256)));
+			if(uMask != 0xFFFFFFFF)
+			{
+				return uOffset + countTrailingZeros(~uMask);
+			}
+		}
+	#endif
+
+		for(; uOffset + 16 <= uNoOfBytes; uOffset += 16)
+		{
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + uOffset));
+			const uint32_t uMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, pattern128)));
+			if(uMask != 0xFFFF)
+			{
+				return uOffset + countTrailingZeros(~uMask & 0xFFFF);
+			}
+		}
+
+		return uOffset;
+	}
+
+	//Writes the pattern over uNoOfBytes bytes, which must be at least one vector. The last store
+	//overlaps the one before it rather than falling back to a loop for the remainder. This is safe
+	//because the number of bytes is a whole number of voxels, so the overlap starts on a voxel.
+	inline void storePattern(uint8_t* pData, uint32_t uNoOfBytes, __m128i pattern128)
+	{
+		assert(uNoOfBytes >= 16);
+		uint32_t uOffset = 0;
+
+	#if defined(POLYVOX_AVX2)
+		if(uNoOfBytes >= 32)
+		{
+			const __m256i pattern256 = _mm256_broadcastsi128_si256(pattern128);
+			for(; uOffset + 32 <= uNoOfBytes; uOffset += 32)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pData + uOffset), pattern256);
+			}
+			if(uOffset < uNoOfBytes)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pData + uNoOfBytes - 32), pattern256);
+			}
+			return;
+		}
+	#endif
+
+		for(; uOffset + 16 <= uNoOfBytes; uOffset += 16)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pData + uOffset), pattern128);
+		}
+		if(uOffset < uNoOfBytes)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pData + uNoOfBytes - 16), pattern128);
+		}
+	}
+#endif //POLYVOX_SSE2
+
+	/// Returns the number of voxels at the start of pVoxels which have the same value as the first one, up to uMaxLength.
+	template <typename VoxelType>
+	uint32_t findRunLength(const VoxelType* pVoxels, uint32_t uMaxLength)
+	{
+		assert(uMaxLength > 0);
+		const VoxelType tValue = pVoxels[0];
+		uint32_t uLength = 1;
+
+	#if defined(POLYVOX_SSE2)
+		if((sizeof(VoxelType) == 1) || (sizeof(VoxelType) == 2) || (sizeof(VoxelType) == 4))
+		{
+			//Most runs in real data are short, so only check the next voxel before setting up the vectors.
+			if((uMaxLength == 1) || !(pVoxels[1] == tValue))
+			{
+				return 1;
+			}
+
+			const uint32_t uNoOfBytes = countMatchingBytes(reinterpret_cast<const uint8_t*>(pVoxels), uMaxLength * sizeof(VoxelType), makeRunPattern(tValue));
+			uLength = (std::max)(uNoOfBytes / static_cast<uint32_t>(sizeof(VoxelType)), static_cast<uint32_t>(1));
+		}
+	#endif
+
+		while((uLength < uMaxLength) && (pVoxels[uLength] == tValue))
+		{
+			uLength++;
+		}
+		return uLength;
+	}
+
+	/// Sets uLength voxels, starting at pVoxels, to the given value.
+	template <typename VoxelType>
+	void fillRun(VoxelType* pVoxels, uint32_t uLength, const VoxelType& tValue)
+	{
+	#if defined(POLYVOX_SSE2)
+		if(((sizeof(VoxelType) == 1) || (sizeof(VoxelType) == 2) || (sizeof(VoxelType) == 4)) && (uLength * sizeof(VoxelType) >= 16))
+		{
+			storePattern(reinterpret_cast<uint8_t*>(pVoxels), uLength * sizeof(VoxelType), makeRunPattern(tValue));
+			return;
+		}
+	#endif
+
+		std::fill(pVoxels, pVoxels + uLength, tValue);
+	}
+}
+
+#endif //__PolyVox_VoxelRuns_H__
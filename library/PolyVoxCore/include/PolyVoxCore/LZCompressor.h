@@ -0,0 +1,67 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_LZCompressor_H__
+#define __PolyVox_LZCompressor_H__
+
+#include "PolyVoxCore/BlockCompressor.h"
+
+namespace PolyVox
+{
+	/// Compresses blocks with a byte oriented LZ77 scheme in the style of LZ4.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxel data is treated as a stream of bytes and each repeated sequence of four or more bytes
+	/// is replaced by a reference to an earlier copy of it. This handles runs (which are just matches
+	/// against the previous voxel) but also repeating patterns such as layers or stripes which defeat
+	/// run length encoding. Compression is noticeably slower than for the other schemes, while
+	/// decompression is comparable.
+	///
+	/// The data is a sequence of tokens. The high four bits of each token give the number of literal
+	/// bytes which follow it and the low four bits give the length of the following match minus four.
+	/// A value of 15 in either field means that extra bytes follow, which are added to the length until
+	/// one of them is not 255. The match is given by a 16-bit little endian offset back from the current
+	/// position. The final token has only literals.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class LZCompressor : public BlockCompressor<VoxelType>
+	{
+	public:
+		void compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		void decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const;
+		const char* getName(void) const;
+
+	private:
+		static void appendLength(uint32_t uLength, std::vector<uint8_t>& vecCompressedData);
+		static uint32_t readLength(const std::vector<uint8_t>& vecCompressedData, uint32_t& uPosition);
+		static void appendSequence(const uint8_t* pLiterals, uint32_t uNoOfLiterals, uint32_t uMatchOffset, uint32_t uMatchLength, std::vector<uint8_t>& vecCompressedData);
+		static uint32_t hashSequence(const uint8_t* pSequence);
+
+		static const uint32_t uMinMatchLength = 4;
+		static const uint32_t uMaxMatchOffset = 65535;
+		static const uint32_t uHashTablePower = 12;
+	};
+}
+
+#include "PolyVoxCore/LZCompressor.inl"
+
+#endif //__PolyVox_LZCompressor_H__
@@ -0,0 +1,197 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <cassert>
+#include <cstring> //For memcpy
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	void LZCompressor<VoxelType>::compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+	{
+		vecCompressedData.clear();
+
+		const uint8_t* pInput = reinterpret_cast<const uint8_t*>(pVoxels);
+		const uint32_t uInputSize = uSideLength * uSideLength * uSideLength * sizeof(VoxelType);
+
+		//The position (plus one, so that zero means empty) at which each hashed sequence was last seen.
+		//This is local so the compressor has no state and can be shared between threads.
+		std::vector<uint32_t> vecHashTable(1 << uHashTablePower, 0);
+
+		uint32_t uLiteralStart = 0;
+		uint32_t uPosition = 0;
+		while(uPosition + uMinMatchLength <= uInputSize)
+		{
+			const uint32_t uHash = hashSequence(pInput + uPosition);
+			const uint32_t uCandidate = vecHashTable[uHash];
+			vecHashTable[uHash] = uPosition + 1;
+
+			if((uCandidate == 0) || (uPosition - (uCandidate - 1) > uMaxMatchOffset) ||
+				(memcmp(pInput + uCandidate - 1, pInput + uPosition, uMinMatchLength) != 0))
+			{
+				uPosition++;
+				continue;
+			}
+
+			//Extend the match as far as it goes. It may overlap the current position, which
+			//is how runs get encoded.
+			const uint32_t uMatchStart = uCandidate - 1;
+			uint32_t uMatchLength = uMinMatchLength;
+			while((uPosition + uMatchLength < uInputSize) && (pInput[uMatchStart + uMatchLength] == pInput[uPosition + uMatchLength]))
+			{
+				uMatchLength++;
+			}
+
+			appendSequence(pInput + uLiteralStart, uPosition - uLiteralStart, uPosition - uMatchStart, uMatchLength, vecCompressedData);
+
+			uPosition += uMatchLength;
+			uLiteralStart = uPosition;
+		}
+
+		//Whatever is left over goes out as literals.
+		appendSequence(pInput + uLiteralStart, uInputSize - uLiteralStart, 0, 0, vecCompressedData);
+	}
+
+	template <typename VoxelType>
+	void LZCompressor<VoxelType>::decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const
+	{
+		uint8_t* pOutput = reinterpret_cast<uint8_t*>(pVoxels);
+		const uint32_t uOutputSize = uSideLength * uSideLength * uSideLength * sizeof(VoxelType);
+
+		uint32_t uInputPosition = 0;
+		uint32_t uOutputPosition = 0;
+		while(uInputPosition < vecCompressedData.size())
+		{
+			const uint8_t uToken = vecCompressedData[uInputPosition++];
+
+			uint32_t uNoOfLiterals = uToken >> 4;
+			if(uNoOfLiterals == 15)
+			{
+				uNoOfLiterals += readLength(vecCompressedData, uInputPosition);
+			}
+			assert(uOutputPosition + uNoOfLiterals <= uOutputSize);
+			if(uNoOfLiterals > 0)
+			{
+				memcpy(pOutput + uOutputPosition, &vecCompressedData[uInputPosition], uNoOfLiterals);
+			}
+			uInputPosition += uNoOfLiterals;
+			uOutputPosition += uNoOfLiterals;
+
+			//The last sequence has no match.
+			if(uInputPosition >= vecCompressedData.size())
+			{
+				break;
+			}
+
+			const uint32_t uMatchOffset = vecCompressedData[uInputPosition] | (vecCompressedData[uInputPosition + 1] << 8);
+			uInputPosition += 2;
+
+			uint32_t uMatchLength = (uToken & 0x0F);
+			if(uMatchLength == 15)
+			{
+				uMatchLength += readLength(vecCompressedData, uInputPosition);
+			}
+			uMatchLength += uMinMatchLength;
+
+			assert(uMatchOffset > 0 && uMatchOffset <= uOutputPosition);
+			assert(uOutputPosition + uMatchLength <= uOutputSize);
+
+			//The match may overlap the bytes being written, so they have to be copied one at a time.
+			const uint8_t* pMatch = pOutput + uOutputPosition - uMatchOffset;
+			for(uint32_t ct = 0; ct < uMatchLength; ct++)
+			{
+				pOutput[uOutputPosition + ct] = pMatch[ct];
+			}
+			uOutputPosition += uMatchLength;
+		}
+
+		assert(uOutputPosition == uOutputSize);
+	}
+
+	template <typename VoxelType>
+	const char* LZCompressor<VoxelType>::getName(void) const
+	{
+		return "LZ";
+	}
+
+	template <typename VoxelType>
+	void LZCompressor<VoxelType>::appendLength(uint32_t uLength, std::vector<uint8_t>& vecCompressedData)
+	{
+		while(uLength >= 255)
+		{
+			vecCompressedData.push_back(255);
+			uLength -= 255;
+		}
+		vecCompressedData.push_back(static_cast<uint8_t>(uLength));
+	}
+
+	template <typename VoxelType>
+	uint32_t LZCompressor<VoxelType>::readLength(const std::vector<uint8_t>& vecCompressedData, uint32_t& uPosition)
+	{
+		uint32_t uLength = 0;
+		uint8_t uByte;
+		do
+		{
+			uByte = vecCompressedData[uPosition++];
+			uLength += uByte;
+		} while(uByte == 255);
+		return uLength;
+	}
+
+	template <typename VoxelType>
+	void LZCompressor<VoxelType>::appendSequence(const uint8_t* pLiterals, uint32_t uNoOfLiterals, uint32_t uMatchOffset, uint32_t uMatchLength, std::vector<uint8_t>& vecCompressedData)
+	{
+		//A match length of zero marks the final, literal only, sequence.
+		const uint32_t uMatchCode = (uMatchLength > 0) ? uMatchLength - uMinMatchLength : 0;
+
+		const uint8_t uToken = static_cast<uint8_t>(((uNoOfLiterals < 15 ? uNoOfLiterals : 15) << 4) | (uMatchCode < 15 ? uMatchCode : 15));
+		vecCompressedData.push_back(uToken);
+
+		if(uNoOfLiterals >= 15)
+		{
+			appendLength(uNoOfLiterals - 15, vecCompressedData);
+		}
+		vecCompressedData.insert(vecCompressedData.end(), pLiterals, pLiterals + uNoOfLiterals);
+
+		if(uMatchLength > 0)
+		{
+			assert(uMatchOffset > 0 && uMatchOffset <= uMaxMatchOffset);
+			vecCompressedData.push_back(static_cast<uint8_t>(uMatchOffset & 0xFF));
+			vecCompressedData.push_back(static_cast<uint8_t>(uMatchOffset >> 8));
+
+			if(uMatchCode >= 15)
+			{
+				appendLength(uMatchCode - 15, vecCompressedData);
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	uint32_t LZCompressor<VoxelType>::hashSequence(const uint8_t* pSequence)
+	{
+		uint32_t uSequence;
+		memcpy(&uSequence, pSequence, sizeof(uSequence));
+		//Knuth's multiplicative hash, keeping the top bits.
+		return (uSequence * 2654435761u) >> (32 - uHashTablePower);
+	}
+}
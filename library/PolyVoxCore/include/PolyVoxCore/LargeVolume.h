@@ -25,7 +25,13 @@ freely, subject to the following restrictions:
 #define __PolyVox_LargeVolume_H__
 
 #include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/RLECompressor.h"
 #include "Impl/Block.h"
+#include "Impl/BlockTable.h"
+#include "Impl/BorderMode.h"
+#include "Impl/EvictionList.h"
+#include "Impl/RegionCopy.h"
+#include "Impl/ThreadPool.h"
 #include "PolyVoxCore/Log.h"
 #include "PolyVoxCore/Region.h"
 #include "PolyVoxCore/Vector.h"
@@ -35,7 +41,6 @@ freely, subject to the following restrictions:
 #include <cstdlib> //For abort()
 #include <cstring> //For memcpy
 #include <list>
-#include <map>
 #include <memory>
 #include <stdexcept> //For invalid_argument
 #include <vector>
@@ -68,7 +73,8 @@ namespace PolyVox
 	/// 
 	/// The LargeVolume constructor takes a Region as a parameter. This specifies the valid range of voxels which can be held in the volume, so in this
 	/// particular case the valid voxel positions are (0,0,0) to (63, 127, 255). Attempts to access voxels outside this range will result is accessing the
-	/// border value (see getBorderValue() and setBorderValue()). PolyVox also has support for near infinite volumes which will be discussed later.
+	/// border value (see getBorderValue() and setBorderValue()), or the volume can be clamped or wrapped instead (see setBorderMode()). PolyVox also
+	/// has support for near infinite volumes which will be discussed later.
 	/// 
 	/// Access to individual voxels is provided via the setVoxelAt() and getVoxelAt() member functions. Advanced users may also be interested in
 	/// the Sampler class for faster read-only access to a large number of voxels.
@@ -89,8 +95,12 @@ namespace PolyVox
 	///
 	/// The compression and decompression of block is a relatively slow process and so we aim to do this as rarely as possible. In order
 	/// to achive this, the volume class stores a cache of recently used blocks and their associated uncompressed data. Each time a voxel
-	/// is touched a timestamp is updated on the corresponding block. When the cache becomes full the block with the oldest timestamp is
-	/// recompressed and moved out of the cache.
+	/// is touched the corresponding block is marked as recently used. When the cache becomes full the least recently used block is
+	/// recompressed and moved out of the cache. The same approach is used to decide which blocks get paged out (see below), and in both
+	/// cases you can choose between exact LRU and the cheaper 'second chance' (CLOCK) approximation with setEvictionPolicy(). The hit,
+	/// miss and eviction counts for both caches are available through getLoadedBlockStatistics() and getUncompressedBlockStatistics().
+	/// The memory for the uncompressed data comes from a pool which grows as needed up to setMaxNumberOfUncompressedBlocks() blocks, so
+	/// blocks moving in and out of the cache don't have to go to the heap. calculateBufferPoolSizeInBytes() tells you how much it holds.
 	///
 	/// Achieving high compression rates
 	/// --------------------------------
@@ -99,6 +109,21 @@ namespace PolyVox
 	/// voxel then this will probably happen naturally. Games such as Minecraft which use this approach will typically involve large areas
 	/// of the same material which will compress down well.
 	///
+	/// By default the blocks are run length encoded, but you can choose a different scheme by passing a BlockCompressor to setCompressor().
+	/// PolyVox provides several (see the BlockCompressor documentation) and calculateCompressionRatio() can tell you how well each of them
+	/// does on the data which is currently loaded, so you can pick the best one for your data.
+	///
+	/// Within each block the voxels are normally stored a row at a time, so the voxels above and behind a given voxel are a long way from it in
+	/// memory. Algorithms such as the MarchingCubesSurfaceExtractor and the LowPassFilter look at all of a voxel's neighbours, and may run faster
+	/// if you call setBlockLayout() to store the blocks in Morton (Z-order) instead. This keeps small cubes of voxels together. The Sampler
+	/// handles both layouts, so nothing else needs to change.
+	///
+	/// Blocks in which every voxel has the same value (such as those filled with air or solid rock) are treated specially. They are stored
+	/// as just that value, and reading from them (through getVoxelAt() or a Sampler) never uncompresses them. They only get uncompressed
+	/// if a voxel is set to a different value. Blocks which your dataRequiredHandler() fills with a single value are stored this way as soon as
+	/// it returns. Surface extractors and other algorithms can use isBlockUniform() to skip over such blocks. Note that a Sampler which is
+	/// inside a uniform block will not see any changes made to that block until it moves into a different block.
+	///
 	/// However, if you are storing density values then you may want to take some care. The advantage of storing smoothly changing values
 	/// is that you can get smooth surfaces extracted, but storing smoothly changing values inside or outside objects (rather than just
 	/// on the boundary) does not benefit the surface and is very hard to compress effectively. You may wish to apply some thresholding to 
@@ -135,6 +160,26 @@ namespace PolyVox
 	/// that you don't actually have to do anything with the data - you could simply decide that once it gets removed from memory it doesn't matter
 	/// anymore. But you still need to be ready to then provide something to PolyVox (even if it's just default data) in the event that it is requested.
 	///
+	/// By default the callbacks are run synchronously, so a voxel access can end up waiting for your terrain generator or your disk. If you call
+	/// setNumberOfPagingThreads() then they are instead run by a pool of background threads. The prefetch() function then just queues up the blocks
+	/// to be loaded and returns straight away, and an access only has to wait if it touches a block which is still being loaded. Blocks which are
+	/// paged out are collected into batches and written back on the same threads. In this mode your callbacks may be called from several threads
+	/// at once (though never for the same region) so they must be thread safe.
+	///
+	/// If you know up front which part of the world you want then generate() is usually a better way to fill it in. It takes the region and a
+	/// generator with the same signature as the dataRequiredHandler(), and runs the generator once for every block in the region across all
+	/// the cores, writing straight into the blocks. It can report its progress and be cancelled part way through.
+	///
+	/// Memory budgets
+	/// --------------
+	/// The limits above are counts of blocks, but how much memory a compressed block uses depends on its contents and can vary by orders of
+	/// magnitude. If you need to keep the volume within a real memory budget then call setMaxCompressedSizeInBytes(). When the loaded blocks
+	/// would go over it, the paging system unloads blocks until they fit, choosing the largest of the few least recently used blocks so that
+	/// a single large block is paged out in preference to many small ones. The uncompressed blocks all have the same size, so
+	/// setMaxUncompressedSizeInBytes() simply works out how many of them fit. getCompressedSizeInBytes() and getUncompressedSizeInBytes() report
+	/// the current usage of each tier, and setMemoryWatermarkHandler() lets you be told when their total goes above a high watermark and later
+	/// drops back below a low one (for example so that you can stop generating new terrain until the paging system catches up).
+	///
 	/// Cache-aware traversal
 	/// ---------------------
 	/// You might be suprised at just how many cache misses can occur when you traverse the volume in a naive manner. Consider a 1024x1024x1024 volume
@@ -151,14 +196,29 @@ namespace PolyVox
 	///
 	/// Threading
 	/// ---------
-	/// The LargeVolume class does not make any guarentees about thread safety. You should ensure that all accesses are performed from the same thread.
+	/// By default the LargeVolume class does not make any guarentees about thread safety. You should ensure that all accesses are performed from the same thread.
 	/// This is true even if you are only reading data from the volume, as concurrently reading from different threads can invalidate the contents
 	/// of the block cache (amoung other problems).
+	///
+	/// If you want to read from several threads at once (for example to run a number of surface extractors or raycasts in parallel) then you can call
+	/// setConcurrentAccessEnabled(). In this mode the block table is split into shards which are locked independently, and getVoxelAt() on a block
+	/// which is already uncompressed (or uniform) only needs the lock for its shard. Compressing, uncompressing and paging blocks is serialised by a
+	/// separate cache lock. Each Sampler pins the block it is currently in, so that block cannot be compressed or paged out while the Sampler is using
+	/// it and the Sampler can then read from it without any locking at all. For this reason it is much faster to read through a Sampler than through
+	/// getVoxelAt(). Note that in concurrent mode the cache only records that a block has been used rather than reordering itself, so it effectively
+	/// runs the SecondChance eviction policy.
+	///
+	/// setVoxelAt(), writeRegion() and fillRegion() can also be called from several threads in this mode. They are serialised by the cache lock
+	/// and change each block under its shard lock, so getVoxelAt() always sees a write either completely or not at all. Samplers don't lock, so a
+	/// Sampler must not read voxels which another thread is writing. flush(), flushAll() and the configuration functions still require that no other
+	/// thread is using the volume.
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	class LargeVolume : public BaseVolume<VoxelType>
 	{
 	public:
+		struct LoadedBlock;
+
 		//There seems to be some descrepency between Visual Studio and GCC about how the following class should be declared.
 		//There is a work around (see also See http://goo.gl/qu1wn) given below which appears to work on VS2010 and GCC, but
 		//which seems to cause internal compiler errors on VS2008 when building with the /Gm 'Enable Minimal Rebuild' compiler
@@ -174,6 +234,7 @@ namespace PolyVox
 		{
 		public:
 			Sampler(LargeVolume<VoxelType>* volume);
+			Sampler(const Sampler& rhs);
 			~Sampler();
 
 			Sampler& operator=(const Sampler& rhs);
@@ -224,8 +285,33 @@ namespace PolyVox
 			inline VoxelType peekVoxel1px1py1pz(void) const;
 
 		private:
+			//Reads a neighbouring voxel which the Linear fast path in the peek functions couldn't, from within the
+			//current block if it uses the Morton layout and from the volume otherwise.
+			template <int iXOffset, int iYOffset, int iZOffset>
+			inline VoxelType peekNeighbourVoxel(void) const;
+
 			//Other current position information
 			VoxelType* mCurrentVoxel;
+
+			//The voxels of the current block. For a uniform block these are shared rather than belonging to the block.
+			VoxelType* mCurrentBlockVoxels;
+
+			//The index of the current voxel within mCurrentBlockVoxels. This is only kept up to date with
+			//the Morton layout, as the Linear layout just moves mCurrentVoxel by a fixed amount instead.
+			uint32_t mCurrentVoxelIndex;
+
+			//The block containing the current voxel, which is pinned in memory while the Sampler
+			//is in it. Null when the Sampler is outside the volume and reading the border data.
+			LoadedBlock* mCurrentBlock;
+
+			//The size of the block which the Sampler can move around in using pointer arithmetic. Outside a volume
+			//which is clamped or wrapped this is a single voxel, so that every move and peek goes to the volume.
+			uint16_t mBlockSideLength;
+			uint8_t mBlockSideLengthPower;
+
+			//The size of the current block if it uses the Morton layout, otherwise zero. The block side length
+			//above is then a single voxel, so that the moves and peeks always take their slow paths.
+			uint16_t mMortonBlockSideLength;
 		};
 
 		// Make the ConstVolumeProxy a friend
@@ -234,14 +320,33 @@ namespace PolyVox
 		struct LoadedBlock
 		{
 		public:
-			LoadedBlock(uint16_t uSideLength = 0)
-				:block(uSideLength)
-				,timestamp(0)
+			LoadedBlock(uint16_t uSideLength = 0, const Vector3DInt32& v3dPosition = Vector3DInt32(0,0,0), BlockCompressor<VoxelType>* pCompressor = 0, BlockLayout eLayout = BlockLayouts::Linear, BlockBufferPool<VoxelType>* pBufferPool = 0)
+				:block(uSideLength, pCompressor, eLayout, pBufferPool)
+				,position(v3dPosition)
+				,pinCount(0)
+				,isLoading(false)
+				,sizeInBytes(0)
 			{
 			}
 
 			Block<VoxelType> block;
-			uint32_t timestamp;
+			Vector3DInt32 position;
+
+			//The number of Samplers (and voxel accesses in progress) which are using this block's uncompressed
+			//data. A pinned block is never compressed or paged out, so its data can be read without any locking.
+			polyvox_atomic<uint32_t> pinCount;
+
+			//Set while the dataRequiredHandler() is filling the block on a paging thread. The block is
+			//pinned meanwhile, and accesses to it wait for the load to finish. See setNumberOfPagingThreads().
+			bool isLoading;
+
+			//The size of the block when it was last counted in the volume's memory usage. See updateBlockSize().
+			uint32_t sizeInBytes;
+
+			//Links for the list of all loaded blocks (used for paging) and the
+			//list of blocks with uncompressed data (used for the block cache).
+			EvictionListHook<LoadedBlock> loadedHook;
+			EvictionListHook<LoadedBlock> uncompressedHook;
 		};
 
 	public:		
@@ -266,36 +371,107 @@ namespace PolyVox
 
 		/// Gets the value used for voxels which are outside the volume
 		VoxelType getBorderValue(void) const;
+		/// Gets what is read from the voxels which are outside the volume
+		BorderMode getBorderMode(void) const;
 		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
 		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
 		/// Gets a voxel at the position given by a 3D vector
 		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Gets a voxel without bringing the block containing it into the cache of uncompressed blocks
+		VoxelType getVoxelAtWithoutUncompressing(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
 
 		//Sets whether or not blocks are compressed in memory
 		void setCompressionEnabled(bool bCompressionEnabled);
+		/// Sets the scheme used to compress the blocks
+		void setCompressor(BlockCompressor<VoxelType>* pCompressor);
+		/// Sets the order in which the voxels of each block are stored in memory
+		void setBlockLayout(BlockLayout eLayout);
 		/// Sets the number of blocks for which uncompressed data is stored
 		void setMaxNumberOfUncompressedBlocks(uint32_t uMaxNumberOfUncompressedBlocks);
 		/// Sets the number of blocks which can be in memory before the paging system starts unloading them
 		void setMaxNumberOfBlocksInMemory(uint32_t uMaxNumberOfBlocksInMemory);
+		/// Sets the number of bytes which the uncompressed blocks can use
+		void setMaxUncompressedSizeInBytes(uint32_t uMaxUncompressedSizeInBytes);
+		/// Sets the number of bytes which the loaded blocks can use before the paging system starts unloading them
+		void setMaxCompressedSizeInBytes(uint32_t uMaxCompressedSizeInBytes);
+		/// Sets a function to be called when the memory used by the blocks crosses the given watermarks
+		void setMemoryWatermarkHandler(polyvox_function<void(uint32_t, bool)> funcWatermarkHandler, uint32_t uLowWatermarkInBytes, uint32_t uHighWatermarkInBytes);
+		/// Sets the policy used to choose which blocks are compressed or paged out when the limits are reached
+		void setEvictionPolicy(EvictionPolicy ePolicy);
+		/// Sets whether the volume can be read from several threads at once
+		void setConcurrentAccessEnabled(bool bConcurrentAccessEnabled);
+		/// Sets the number of background threads used to page blocks in and out
+		void setNumberOfPagingThreads(uint32_t uNoOfPagingThreads);
 		/// Sets the value used for voxels which are outside the volume
 		void setBorderValue(const VoxelType& tBorder);
+		/// Sets what is read from the voxels which are outside the volume
+		void setBorderMode(BorderMode eMode);
 		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
 		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
 		/// Sets the voxel at the position given by a 3D vector
 		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
 		/// Tries to ensure that the voxels within the specified Region are loaded into memory.
 		void prefetch(Region regPrefetch);
+		/// Fills in the blocks covering the specified Region by running a generator on each of them in parallel.
+		bool generate(const Region& regGenerate, polyvox_function<void(const ConstVolumeProxy<VoxelType>&, const Region&)> funcGenerator,
+			uint32_t uNoOfThreads = 0, polyvox_function<bool(uint32_t, uint32_t)> funcProgressHandler = 0);
 		/// Ensures that any voxels within the specified Region are removed from memory.
 		void flush(Region regFlush);
 		/// Removes all voxels from memory
 		void flushAll();
 
+		/// Gets the scheme used to compress the blocks
+		BlockCompressor<VoxelType>* getCompressor(void) const;
+		/// Gets the length of the sides of the blocks making up the volume
+		uint16_t getBlockSideLength(void) const;
+		/// Gets the order in which the voxels of each block are stored in memory
+		BlockLayout getBlockLayout(void) const;
+		/// Gets whether every voxel in the given block has the same value
+		bool isBlockUniform(const Vector3DInt32& v3dBlockPos) const;
+		/// Finds the smallest and largest values in the given block, without uncompressing it
+		void calculateBlockRange(const Vector3DInt32& v3dBlockPos, VoxelType& tMin, VoxelType& tMax) const;
+		/// Counts the voxels in the given block which have the given value, without uncompressing it
+		uint32_t countVoxelsInBlock(const Vector3DInt32& v3dBlockPos, const VoxelType& tValue) const;
+		/// Passes the voxels in the given block to a function as runs of the same value, without uncompressing it
+		void visitBlockRuns(const Vector3DInt32& v3dBlockPos, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const;
+		/// Finds the smallest and largest densities in a region, using the summary kept for each block
+		template <typename DensityType>
+		bool calculateDensityRange(const Region& region, DensityType& tMin, DensityType& tMax) const;
+		/// Gets the policy used to choose which blocks are compressed or paged out when the limits are reached
+		EvictionPolicy getEvictionPolicy(void) const;
+		/// Gets whether the volume can be read from several threads at once
+		bool isConcurrentAccessEnabled(void) const;
+		/// Gets the number of background threads used to page blocks in and out
+		uint32_t getNumberOfPagingThreads(void) const;
+		/// Gets the number of bytes which the loaded blocks can use, or zero if there is no limit
+		uint32_t getMaxCompressedSizeInBytes(void) const;
+		/// Gets the number of bytes currently used by the loaded blocks, not counting their uncompressed data
+		uint32_t getCompressedSizeInBytes(void) const;
+		/// Gets the number of bytes currently used by the uncompressed data of the blocks
+		uint32_t getUncompressedSizeInBytes(void) const;
+		/// Gets the hit, miss and eviction counts for the blocks which are loaded in memory
+		CacheStatistics getLoadedBlockStatistics(void) const;
+		/// Gets the hit, miss and eviction counts for the cache of uncompressed blocks
+		CacheStatistics getUncompressedBlockStatistics(void) const;
+		/// Sets all the hit, miss and eviction counts back to zero
+		void resetStatistics(void);
+
 		/// Empties the cache of uncompressed blocks
 		void clearBlockCache(void);
 		/// Calculates the approximate compression ratio of the store volume data
 		float calculateCompressionRatio(void);
+		/// Calculates the compression ratio which the given compressor achieves on the loaded blocks
+		float calculateCompressionRatio(const BlockCompressor<VoxelType>* pCompressor);
 		/// Calculates approximatly how many bytes of memory the volume is currently using.
 		uint32_t calculateSizeInBytes(void);
+		/// Calculates how many bytes of memory are held for the uncompressed blocks.
+		uint32_t calculateBufferPoolSizeInBytes(void) const;
 
 	protected:
 		/// Copy constructor
@@ -305,6 +481,33 @@ namespace PolyVox
 		LargeVolume& operator=(const LargeVolume& rhs);
 
 	private:
+		//The block table is split into shards which are locked independently, so that
+		//threads reading from different blocks in concurrent mode rarely contend.
+		struct BlockTableShard
+		{
+			BlockTableShard()
+				:uNoOfLoadedBlockHits(0)
+				,uNoOfUncompressedBlockHits(0)
+			{
+			}
+
+			BlockTable<LoadedBlock> table;
+			polyvox_mutex mutex;
+			//Accesses which found their block without taking the cache lock, for each of the two caches. A uniform block
+			//is only a hit for the loaded blocks, as it is read without being uncompressed. These are not counted in the
+			//main statistics, as those are protected by the cache lock.
+			uint32_t uNoOfLoadedBlockHits;
+			uint32_t uNoOfUncompressedBlockHits;
+		};
+		static const uint32_t uNoOfBlockTableShardsPower = 4;
+		static const uint32_t uNoOfBlockTableShards = 1 << uNoOfBlockTableShardsPower;
+		//The number of paged out blocks which are collected before being handed to a paging thread.
+		static const uint32_t uWriteBackBatchSize = 16;
+		//The number of least recently used blocks from which the largest is paged out, when there is a memory budget.
+		static const uint32_t uNoOfEvictionCandidates = 8;
+		//The number of distinct values for which uniform block data is kept (see getUniformBlockData()).
+		static const uint32_t uMaxNoOfUniformBlockData = 16;
+
 		void initialise(const Region& regValidRegion, uint16_t uBlockSideLength);
 
 		/// gets called when a new region is allocated and needs to be filled
@@ -317,30 +520,93 @@ namespace PolyVox
 		/// is absolutely unsafe
 		polyvox_function<void(const ConstVolumeProxy<VoxelType>&, const Region&)> m_funcDataOverflowHandler;
 	
+		LoadedBlock* getReadableBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const;
 		Block<VoxelType>* getUncompressedBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const;
-		void eraseBlock(typename std::map<Vector3DInt32, LoadedBlock >::iterator itBlock) const;
-		/// this function can be called by m_funcDataRequiredHandler without causing any weird effects
-		bool setVoxelAtConst(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue) const;
-
-		//The block data
-		mutable std::map<Vector3DInt32, LoadedBlock > m_pBlocks;
-
-		//The cache of uncompressed blocks. The uncompressed block data and the timestamps are stored here rather
-		//than in the Block class. This is so that in the future each VolumeIterator might to maintain its own cache
-		//of blocks. However, this could mean the same block data is uncompressed and modified in more than one
-		//location in memory... could be messy with threading.
-		mutable std::vector< LoadedBlock* > m_vecUncompressedBlockCache;
-		mutable uint32_t m_uTimestamper;
+		LoadedBlock* pinBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ, VoxelType*& pVoxels) const;
+		void unpinBlock(LoadedBlock* pLoadedBlock) const;
+		VoxelType* getUniformBlockData(const VoxelType& tValue) const;
+		VoxelType getBorderVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+
+		//These functions must be called with m_mutexCache held when concurrent access is enabled.
+		//They take the lock for the relevant shard themselves when they need it.
+		BlockTableShard& getShard(const Vector3DInt32& v3dBlockPos) const;
+		LoadedBlock* findBlock(const Vector3DInt32& v3dBlockPos) const;
+		LoadedBlock* loadBlock(const Vector3DInt32& v3dBlockPos, bool bForGeneration = false) const;
+		void uncompressBlock(LoadedBlock* pLoadedBlock) const;
+		void makeRoomForUncompressedBlock(void) const;
+		bool compressBlock(LoadedBlock* pLoadedBlock) const;
+		bool eraseBlock(LoadedBlock* pLoadedBlock) const;
+		void makeRoomForLoadedBlock(void) const;
+		bool isOverCompressedSizeLimit(void) const;
+		void updateBlockSize(LoadedBlock* pLoadedBlock) const;
+		void checkMemoryWatermarks(void) const;
+		void waitForBlockToLoad(LoadedBlock* pLoadedBlock) const;
+		void finishLoadingBlock(LoadedBlock* pLoadedBlock, bool bIsUniform) const;
+		void submitWriteBacks(void) const;
+		void waitForPaging(void) const;
+		Region getBlockRegion(const Vector3DInt32& v3dBlockPos) const;
+
+		//These are run on the paging threads (or the threads created by generate()).
+		void runDataRequiredHandler(LoadedBlock* pLoadedBlock) const;
+		void runGenerator(LoadedBlock* pLoadedBlock, polyvox_function<void(const ConstVolumeProxy<VoxelType>&, const Region&)> funcGenerator, uint32_t* pNoOfBlocksInProgress, uint32_t* pNoOfBlocksGenerated) const;
+		void runDataOverflowHandler(std::vector<LoadedBlock*> vecLoadedBlocks) const;
+		//Used with visitBlockRuns() to build the other block queries.
+		static void addRunToRange(const VoxelType& tValue, uint32_t uLength, VoxelType* pMin, VoxelType* pMax, bool* pIsEmpty);
+		static void addRunToCount(const VoxelType& tValue, uint32_t uLength, const VoxelType& tValueToCount, uint32_t* pCount);
+
+		static bool isBlockUnpinned(const LoadedBlock* pLoadedBlock);
+		static uint32_t getBlockSizeInBytes(const LoadedBlock* pLoadedBlock);
+
+		//The block data. The LoadedBlocks are allocated individually so that their
+		//addresses stay stable while the tables grow and other blocks are erased.
+		mutable BlockTableShard m_arrayBlockTableShards[uNoOfBlockTableShards];
+		//Protects the eviction lists and statistics, and serialises compression and paging.
+		mutable polyvox_mutex m_mutexCache;
+
+		//Used for asynchronous paging, and null otherwise.
+		ThreadPool* m_pPagingThreadPool;
+		//Signalled (with m_mutexCache) whenever a paging thread finishes loading or writing back blocks, or generate() finishes a block.
+		mutable polyvox_condition_variable_any m_condPagingFinished;
+		mutable uint32_t m_uNoOfBlocksBeingLoaded;
+		//Blocks which have been paged out but not yet written back. They are kept here so that if one of
+		//them is needed again we can wait for it, rather than loading stale data. The vector holds those
+		//which are still to be passed to the paging threads.
+		mutable BlockTable<LoadedBlock> m_tableBlocksBeingWrittenBack;
+		mutable std::vector<LoadedBlock*> m_vecBlocksToWriteBack;
+
+		//All the loaded blocks, and the subset of them which currently have uncompressed data. Each list is kept
+		//in recency order so that the block to page out or compress can be found without searching.
+		mutable EvictionList<LoadedBlock, &LoadedBlock::loadedHook> m_listLoadedBlocks;
+		mutable EvictionList<LoadedBlock, &LoadedBlock::uncompressedHook> m_listUncompressedBlocks;
+		mutable CacheStatistics m_statsLoadedBlocks;
+		mutable CacheStatistics m_statsUncompressedBlocks;
 		mutable Vector3DInt32 m_v3dLastAccessedBlockPos;
-		mutable Block<VoxelType>* m_pLastAccessedBlock;
+		mutable LoadedBlock* m_pLastAccessedBlock;
 		uint32_t m_uMaxNumberOfUncompressedBlocks;
 		uint32_t m_uMaxNumberOfBlocksInMemory;
 
-		//We don't store an actual Block for the border, just the uncompressed data. This is partly because the border
-		//block does not have a position (so can't be passed to getUncompressedBlock()) and partly because there's a
-		//good chance we'll often hit it anyway. It's a chunk of homogenous data (rather than a single value) so that
-		//the VolumeIterator can do it's usual pointer arithmetic without needing to know it's gone outside the volume.
-		VoxelType* m_pUncompressedBorderData;
+		//The total of the LoadedBlocks' sizeInBytes, and the limit on it (or zero for no limit).
+		mutable uint32_t m_uCompressedSizeInBytes;
+		uint32_t m_uMaxCompressedSizeInBytes;
+
+		//Called with the total memory usage whenever it goes above the high watermark, and then again
+		//once it has dropped below the low watermark. The flag records which of these happened last.
+		polyvox_function<void(uint32_t, bool)> m_funcWatermarkHandler;
+		uint32_t m_uLowWatermarkInBytes;
+		uint32_t m_uHighWatermarkInBytes;
+		mutable bool m_bIsAboveHighWatermark;
+
+		//We don't store any voxels for the border. With the Constant mode a Sampler outside the volume uses the
+		//uniform block data for the border value (see below), so it can still do its usual pointer arithmetic.
+		//With the other modes it reads the voxels inside the volume which the border maps on to.
+		VoxelType m_tBorderValue;
+		BorderMode m_eBorderMode;
+
+		//Uniform blocks are never uncompressed just to be read. Samplers still need some voxels to do their
+		//pointer arithmetic on though, so they are given one of these arrays (each filled with a single value)
+		//instead. They are shared by all the uniform blocks with that value, and live as long as the volume.
+		mutable std::vector<VoxelType*> m_vecUniformBlockData;
+		mutable polyvox_mutex m_mutexUniformBlockData;
 
 		//The size of the volume
 		Region m_regValidRegionInBlocks;
@@ -348,9 +614,18 @@ namespace PolyVox
 		//The size of the blocks
 		uint16_t m_uBlockSideLength;
 		uint8_t m_uBlockSideLengthPower;
+		BlockLayout m_eBlockLayout;
+
+		//Used for all the blocks. It points at m_defaultCompressor unless the user has provided their own.
+		RLECompressor<VoxelType> m_defaultCompressor;
+		BlockCompressor<VoxelType>* m_pCompressor;
+
+		//Provides the uncompressed data for all the blocks.
+		mutable BlockBufferPool<VoxelType> m_bufferPool;
 
 		bool m_bCompressionEnabled;
 		bool m_bPagingEnabled;
+		bool m_bConcurrentAccessEnabled;
 	};
 }
 
@@ -95,7 +95,12 @@ namespace PolyVox
 	LargeVolume<VoxelType>::~LargeVolume()
 	{
 		flushAll();
-		delete[] m_pUncompressedBorderData;
+		delete m_pPagingThreadPool;
+
+		for(uint32_t ct = 0; ct < m_vecUniformBlockData.size(); ct++)
+		{
+			delete[] m_vecUniformBlockData[ct];
+		}
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -119,7 +124,16 @@ namespace PolyVox
 	template <typename VoxelType>
 	VoxelType LargeVolume<VoxelType>::getBorderValue(void) const
 	{
-		return *m_pUncompressedBorderData;
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return What is read from the voxels which are outside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	BorderMode LargeVolume<VoxelType>::getBorderMode(void) const
+	{
+		return m_eBorderMode;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -141,13 +155,44 @@ namespace PolyVox
 			const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
 			const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
 
-			Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(blockX, blockY, blockZ);
+			if(m_bConcurrentAccessEnabled)
+			{
+				//Fast path - blocks are only uncompressed, compressed, written to or paged out under their shard lock, so
+				//if the block can be read as it is then that lock is all we need and the block doesn't have to be pinned.
+				const Vector3DInt32 v3dBlockPos(blockX, blockY, blockZ);
+				BlockTableShard& shard = getShard(v3dBlockPos);
+				{
+					polyvox_lock_guard<polyvox_mutex> lockShard(shard.mutex);
+					LoadedBlock* pLoadedBlock = shard.table.find(v3dBlockPos);
+					if((pLoadedBlock != 0) && (pLoadedBlock->isLoading == false) && (!pLoadedBlock->block.m_bIsCompressed || pLoadedBlock->block.m_bIsUniform))
+					{
+						++(shard.uNoOfLoadedBlockHits);
+						m_listLoadedBlocks.mark(pLoadedBlock);
+						if(!pLoadedBlock->block.m_bIsCompressed)
+						{
+							++(shard.uNoOfUncompressedBlockHits);
+							m_listUncompressedBlocks.mark(pLoadedBlock);
+						}
+						return pLoadedBlock->block.getVoxelAt(xOffset,yOffset,zOffset);
+					}
+				}
+
+				//Slow path - the block has to be loaded and/or uncompressed.
+				VoxelType* pVoxels;
+				LoadedBlock* pLoadedBlock = pinBlock(blockX, blockY, blockZ, pVoxels);
+				VoxelType tValue = pVoxels[getVoxelIndexInBlock(xOffset, yOffset, zOffset, m_uBlockSideLengthPower, m_eBlockLayout)];
+				unpinBlock(pLoadedBlock);
+				return tValue;
+			}
+
+			//Uniform blocks are read without being uncompressed.
+			LoadedBlock* pLoadedBlock = getReadableBlock(blockX, blockY, blockZ);
 
-			return pUncompressedBlock->getVoxelAt(xOffset,yOffset,zOffset);
+			return pLoadedBlock->block.getVoxelAt(xOffset,yOffset,zOffset);
 		}
 		else
 		{
-			return getBorderValue();
+			return getBorderVoxelAt(uXPos, uYPos, uZPos);
 		}
 	}
 
@@ -161,6 +206,113 @@ namespace PolyVox
 		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Unlike getVoxelAt(), this never moves a compressed block into the cache of uncompressed blocks. Instead the
+	/// voxel is read straight out of the compressed data, which the RLE based compressors can do with a binary
+	/// search over their runs. This is useful for scattered reads (such as picking or collision queries) which would
+	/// otherwise evict the blocks that the application is actually working on.
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType LargeVolume<VoxelType>::getVoxelAtWithoutUncompressing(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(!this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)))
+		{
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				return getBorderValue();
+			}
+
+			const Vector3DInt32 v3dMappedPos = mapIntoRegion(uXPos, uYPos, uZPos, this->m_regValidRegion, m_eBorderMode);
+			return getVoxelAtWithoutUncompressing(v3dMappedPos.getX(), v3dMappedPos.getY(), v3dMappedPos.getZ());
+		}
+
+		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+		const uint16_t xOffset = static_cast<uint16_t>(uXPos - (blockX << m_uBlockSideLengthPower));
+		const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
+		const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		LoadedBlock* pLoadedBlock = loadBlock(Vector3DInt32(blockX, blockY, blockZ));
+		waitForBlockToLoad(pLoadedBlock);
+		return pLoadedBlock->block.getVoxelAt(xOffset, yOffset, zOffset);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels are copied block by block, a row at a time. As with getVoxelAt(), uniform blocks are read
+	/// without being uncompressed and the blocks are pinned when concurrent access is enabled.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value, or read from where they map on to.
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				fillRegionPart(pDestination, regRead, regRead, getBorderValue());
+			}
+			else
+			{
+				readRegionOutside(this, pDestination, regRead, regCropped);
+			}
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					if(m_bConcurrentAccessEnabled)
+					{
+						VoxelType* pVoxels;
+						LoadedBlock* pLoadedBlock = pinBlock(x, y, z, pVoxels);
+						copyBlockToRegion(pVoxels, regBlock, pLoadedBlock->block.m_eLayout, pDestination, regRead, regPart);
+						unpinBlock(pLoadedBlock);
+						continue;
+					}
+
+					const Block<VoxelType>& block = getReadableBlock(x, y, z)->block;
+					if(block.m_bIsCompressed)
+					{
+						fillRegionPart(pDestination, regRead, regPart, block.m_tUniformValue);
+					}
+					else
+					{
+						copyBlockToRegion(block.m_tUncompressedData, regBlock, block.m_eLayout, pDestination, regRead, regPart);
+					}
+				}
+			}
+		}
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// Enabling compression allows significantly more data to be stored in memory.
 	/// \param bCompressionEnabled Specifies whether compression is enabled.
@@ -185,10 +337,96 @@ namespace PolyVox
 		}
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Blocks which are already loaded are recompressed with the new compressor straight away, so this can be
+	/// slow for a large volume. The compressor is not copied, so it must remain valid until it is replaced or the
+	/// volume is destroyed. It may be used from several threads at once (see BlockCompressor). This function
+	/// must not be called while other threads are accessing the volume.
+	/// \param pCompressor The compressor to use, or null to restore the default (an RLECompressor).
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::setCompressor(BlockCompressor<VoxelType>* pCompressor)
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		//The paging threads may be compressing blocks with the old compressor.
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+
+		m_pCompressor = pCompressor ? pCompressor : &m_defaultCompressor;
+
+		for(LoadedBlock* pLoadedBlock = m_listLoadedBlocks.front(); pLoadedBlock != 0; pLoadedBlock = m_listLoadedBlocks.next(pLoadedBlock))
+		{
+			{
+				polyvox_unique_lock<polyvox_mutex> lockShard(getShard(pLoadedBlock->position).mutex, polyvox_defer_lock);
+				if(m_bConcurrentAccessEnabled)
+				{
+					lockShard.lock();
+				}
+
+				pLoadedBlock->block.setCompressor(m_pCompressor);
+			}
+			updateBlockSize(pLoadedBlock);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The Morton layout keeps each voxel close in memory to all of its neighbours, rather than just the ones
+	/// along the x axis. This can reduce cache misses for algorithms which look at the neighbourhood of each
+	/// voxel (through a Sampler). Blocks which are already loaded are rearranged straight away. This function
+	/// must not be called while other threads are accessing the volume, or while any Samplers exist.
+	/// \param eLayout The order in which to store the voxels of each block.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::setBlockLayout(BlockLayout eLayout)
+	{
+		//The Morton index only has room for ten bits of each coordinate.
+		if((eLayout == BlockLayouts::Morton) && (m_uBlockSideLength > 1024))
+		{
+			throw std::invalid_argument("Block side length must be at most 1024 to use the Morton layout.");
+		}
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		//The paging threads may be filling blocks with the old layout.
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+
+		m_eBlockLayout = eLayout;
+
+		for(LoadedBlock* pLoadedBlock = m_listLoadedBlocks.front(); pLoadedBlock != 0; pLoadedBlock = m_listLoadedBlocks.next(pLoadedBlock))
+		{
+			{
+				polyvox_unique_lock<polyvox_mutex> lockShard(getShard(pLoadedBlock->position).mutex, polyvox_defer_lock);
+				if(m_bConcurrentAccessEnabled)
+				{
+					lockShard.lock();
+				}
+
+				pLoadedBlock->block.setLayout(m_eBlockLayout);
+			}
+			updateBlockSize(pLoadedBlock);
+		}
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// Increasing the size of the block cache will increase memory but may improve performance.
 	/// You may want to set this to a large value (e.g. 1024) when you are first loading your
 	/// volume data and then set it to a smaller value (e.g.64) for general processing.
+	/// The pool which the uncompressed data comes from grows as needed up to this many blocks (see
+	/// calculateBufferPoolSizeInBytes()).
 	/// \param uMaxNumberOfUncompressedBlocks The number of blocks for which uncompressed data can be cached.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
@@ -196,7 +434,16 @@ namespace PolyVox
 	{
 		clearBlockCache();
 
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
 		m_uMaxNumberOfUncompressedBlocks = uMaxNumberOfUncompressedBlocks;
+
+		//Blocks which are pinned (or being paged) may still be using the pool, so it might not shrink straight away.
+		m_bufferPool.setCapacity(m_uMaxNumberOfUncompressedBlocks);
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -206,7 +453,7 @@ namespace PolyVox
 	template <typename VoxelType>
 	void LargeVolume<VoxelType>::setMaxNumberOfBlocksInMemory(uint32_t uMaxNumberOfBlocksInMemory)
 	{
-		if(m_pBlocks.size() > uMaxNumberOfBlocksInMemory)
+		if(m_listLoadedBlocks.size() > uMaxNumberOfBlocksInMemory)
 		{
 			flushAll();
 		}
@@ -214,191 +461,1010 @@ namespace PolyVox
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// \param tBorder The value to use for voxels outside the volume.
+	/// The uncompressed blocks all have the same size, so this is just a more convenient way of calling
+	/// setMaxNumberOfUncompressedBlocks(). There is always room for at least one block.
+	/// \param uMaxUncompressedSizeInBytes The number of bytes which can be used for uncompressed data.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
+	void LargeVolume<VoxelType>::setMaxUncompressedSizeInBytes(uint32_t uMaxUncompressedSizeInBytes)
 	{
-		/*Block<VoxelType>* pUncompressedBorderBlock = getUncompressedBlock(&m_pBorderBlock);
-		return pUncompressedBorderBlock->fill(tBorder);*/
-		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength, tBorder);
+		const uint32_t uBlockSizeInBytes = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
+		setMaxNumberOfUncompressedBlocks((std::max)(uMaxUncompressedSizeInBytes / uBlockSizeInBytes, static_cast<uint32_t>(1)));
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// \param uXPos the \c x position of the voxel
-	/// \param uYPos the \c y position of the voxel
-	/// \param uZPos the \c z position of the voxel
-	/// \param tValue the value to which the voxel will be set
-	/// \return whether the requested position is inside the volume
+	/// This applies as well as the limit set by setMaxNumberOfBlocksInMemory(), and whichever is reached first causes
+	/// blocks to be paged out. The size of a block is given by Block::calculateSizeInBytes() and so counts its compressed
+	/// data, but not its uncompressed data (see setMaxUncompressedSizeInBytes()). The budget is checked whenever a block
+	/// is loaded, so modifying blocks which are already loaded can take the volume over it until the next block is loaded.
+	/// Like the other paging limits it only applies when paging is enabled. If the loaded blocks already use more than
+	/// this then some of them are paged out straight away.
+	/// \param uMaxCompressedSizeInBytes The number of bytes which the loaded blocks can use, or zero for no limit.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	bool LargeVolume<VoxelType>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	void LargeVolume<VoxelType>::setMaxCompressedSizeInBytes(uint32_t uMaxCompressedSizeInBytes)
 	{
-		assert(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
-
-		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
-		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
-		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
-
-		const uint16_t xOffset = static_cast<uint16_t>(uXPos - (blockX << m_uBlockSideLengthPower));
-		const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
-		const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
-
-		Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(blockX, blockY, blockZ);
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
 
-		pUncompressedBlock->setVoxelAt(xOffset,yOffset,zOffset, tValue);
+		m_uMaxCompressedSizeInBytes = uMaxCompressedSizeInBytes;
 
-		//Return true to indicate that we modified a voxel.
-		return true;
+		if(m_bPagingEnabled)
+		{
+			makeRoomForLoadedBlock();
+		}
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// \param v3dPos the 3D position of the voxel
-	/// \param tValue the value to which the voxel will be set
-	/// \return whether the requested position is inside the volume
+	/// The memory usage is the total of getCompressedSizeInBytes() and getUncompressedSizeInBytes(). The handler is called
+	/// with <tt>true</tt> when it goes above the high watermark, and then with <tt>false</tt> once it has dropped below the
+	/// low watermark, so it isn't called repeatedly while the usage hovers around one of them. It is called straight away if the
+	/// usage is already above the high watermark. The handler is run by whichever thread changed the memory usage (which may be
+	/// a paging thread) while the volume is locked, so it must not access the volume itself.
+	/// \param funcWatermarkHandler The function to call with the memory usage and whether it is above the high watermark, or null for none.
+	/// \param uLowWatermarkInBytes The usage below which the handler is called with <tt>false</tt>.
+	/// \param uHighWatermarkInBytes The usage above which the handler is called with <tt>true</tt>.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	bool LargeVolume<VoxelType>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	void LargeVolume<VoxelType>::setMemoryWatermarkHandler(polyvox_function<void(uint32_t, bool)> funcWatermarkHandler, uint32_t uLowWatermarkInBytes, uint32_t uHighWatermarkInBytes)
 	{
-		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
-	}
-
+		//Debug mode validation
+		assert(uLowWatermarkInBytes <= uHighWatermarkInBytes);
 
-	////////////////////////////////////////////////////////////////////////////////
-	/// Note that if MaxNumberOfBlocksInMemory is not large enough to support the region this function will only load part of the region. In this case it is undefined which parts will actually be loaded. If all the voxels in the given region are already loaded, this function will not do anything. Other voxels might be unloaded to make space for the new voxels.
-	/// \param regPrefetch The Region of voxels to prefetch into memory.
-	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	void LargeVolume<VoxelType>::prefetch(Region regPrefetch)
-	{
-		Vector3DInt32 v3dStart;
-		for(int i = 0; i < 3; i++)
+		//Release mode validation
+		if(uLowWatermarkInBytes > uHighWatermarkInBytes)
 		{
-			v3dStart.setElement(i, regPrefetch.getLowerCorner().getElement(i) >> m_uBlockSideLengthPower);
+			throw std::invalid_argument("The low watermark cannot be above the high watermark.");
 		}
 
-		Vector3DInt32 v3dEnd;
-		for(int i = 0; i < 3; i++)
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
 		{
-			v3dEnd.setElement(i, regPrefetch.getUpperCorner().getElement(i) >> m_uBlockSideLengthPower);
+			lockCache.lock();
 		}
 
-		Vector3DInt32 v3dSize = v3dEnd - v3dStart + Vector3DInt32(1,1,1);
-		uint32_t numblocks = static_cast<uint32_t>(v3dSize.getX() * v3dSize.getY() * v3dSize.getZ());
-		if(numblocks > m_uMaxNumberOfBlocksInMemory)
+		m_funcWatermarkHandler = funcWatermarkHandler;
+		m_uLowWatermarkInBytes = uLowWatermarkInBytes;
+		m_uHighWatermarkInBytes = uHighWatermarkInBytes;
+		m_bIsAboveHighWatermark = false;
+
+		checkMemoryWatermarks();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The LeastRecentlyUsed policy always evicts the block which was used least recently, but has to reorder
+	/// a list every time a different block is accessed. The SecondChance policy only sets a flag on access and
+	/// approximates LRU when a block actually needs evicting. The policy applies to both the paging of loaded
+	/// blocks and the cache of uncompressed blocks. The lists are only reordered with the cache lock held, so
+	/// this can be called while other threads (including the paging threads) are using the volume.
+	/// \param ePolicy The policy to use when choosing which block to evict.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::setEvictionPolicy(EvictionPolicy ePolicy)
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
 		{
-			// cannot support the amount of blocks... so only load the maximum possible
-			numblocks = m_uMaxNumberOfBlocksInMemory;
+			lockCache.lock();
 		}
-		for(int32_t x = v3dStart.getX(); x <= v3dEnd.getX(); x++)
-		{
-			for(int32_t y = v3dStart.getY(); y <= v3dEnd.getY(); y++)
-			{
-				for(int32_t z = v3dStart.getZ(); z <= v3dEnd.getZ(); z++)
-				{
-					Vector3DInt32 pos(x,y,z);
-					typename std::map<Vector3DInt32, LoadedBlock>::iterator itBlock = m_pBlocks.find(pos);
-					
-					if(itBlock != m_pBlocks.end())
-					{
-						// If the block is already loaded then we don't load it again. This means it does not get uncompressed,
-						// whereas if we were to call getUncompressedBlock() regardless then it would also get uncompressed.
-						// This might be nice, but on the prefetch region could be bigger than the uncompressed cache size.
-						// This would limit the amount of prefetching we could do.
-						continue;
-					}
 
-					if(numblocks == 0)
-					{
-						// Loading any more blocks would attempt to overflow the memory and therefore erase blocks
-						// we loaded in the beginning. This wouldn't cause logic problems but would be wasteful.
-						return;
-					}
-					// load a block
-					numblocks--;
-					getUncompressedBlock(x,y,z);
-				} // for z
-			} // for y
-		} // for x
+		m_listLoadedBlocks.setPolicy(ePolicy);
+		m_listUncompressedBlocks.setPolicy(ePolicy);
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// Removes all voxels from memory, and calls dataOverflowHandler() to ensure the application has a chance to store the data.
+	/// When concurrent access is enabled several threads can read from the volume at once, either through
+	/// getVoxelAt() or (much faster) through their own Samplers, and can write to it too. Please see the LargeVolume class documentation
+	/// for the details and restrictions. The small cost of the extra locking is only paid when this is enabled.
+	/// This function must not be called while other threads are accessing the volume.
+	/// \param bConcurrentAccessEnabled Specifies whether concurrent access is enabled.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::flushAll()
+	void LargeVolume<VoxelType>::setConcurrentAccessEnabled(bool bConcurrentAccessEnabled)
 	{
-		typename std::map<Vector3DInt32, LoadedBlock >::iterator i;
-		//Replaced the for loop here as the call to
-		//eraseBlock was invalidating the iterator.
-		while(m_pBlocks.size() > 0)
+		//Debug mode validation
+		assert(bConcurrentAccessEnabled || (m_pPagingThreadPool == 0));
+
+		//Release mode validation
+		if(!bConcurrentAccessEnabled && (m_pPagingThreadPool != 0))
 		{
-			eraseBlock(m_pBlocks.begin());
+			throw std::invalid_argument("Concurrent access cannot be disabled while there are paging threads.");
 		}
+
+		m_bConcurrentAccessEnabled = bConcurrentAccessEnabled;
+
+		//The last accessed block is shared state, so it isn't used in concurrent mode.
+		m_pLastAccessedBlock = 0;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// Removes all voxels in the specified Region from memory, and calls dataOverflowHandler() to ensure the application has a chance to store the data. It is possible that there are no voxels loaded in the Region, in which case the function will have no effect.
+	/// When this is greater than zero the dataRequiredHandler() and dataOverflowHandler() are run on a pool of
+	/// background threads, rather than on whichever thread happened to access the volume. Please see the
+	/// LargeVolume class documentation for the details. The paging threads access the volume at the same time
+	/// as your own threads, so this also enables concurrent access (see setConcurrentAccessEnabled()).
+	/// This function waits for any paging which is in progress before changing the number of threads.
+	/// \param uNoOfPagingThreads The number of threads, or zero to page synchronously.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::flush(Region regFlush)
+	void LargeVolume<VoxelType>::setNumberOfPagingThreads(uint32_t uNoOfPagingThreads)
 	{
-		Vector3DInt32 v3dStart;
-		for(int i = 0; i < 3; i++)
+		if(m_pPagingThreadPool)
 		{
-			v3dStart.setElement(i, regFlush.getLowerCorner().getElement(i) >> m_uBlockSideLengthPower);
+			{
+				polyvox_lock_guard<polyvox_mutex> lockCache(m_mutexCache);
+				waitForPaging();
+			}
+			delete m_pPagingThreadPool;
+			m_pPagingThreadPool = 0;
 		}
 
-		Vector3DInt32 v3dEnd;
-		for(int i = 0; i < 3; i++)
+		if(uNoOfPagingThreads > 0)
 		{
-			v3dEnd.setElement(i, regFlush.getUpperCorner().getElement(i) >> m_uBlockSideLengthPower);
+			setConcurrentAccessEnabled(true);
+			m_pPagingThreadPool = new ThreadPool(uNoOfPagingThreads);
 		}
+	}
 
-		for(int32_t x = v3dStart.getX(); x <= v3dEnd.getX(); x++)
-		{
-			for(int32_t y = v3dStart.getY(); y <= v3dEnd.getY(); y++)
-			{
-				for(int32_t z = v3dStart.getZ(); z <= v3dEnd.getZ(); z++)
-				{
-					Vector3DInt32 pos(x,y,z);
-					typename std::map<Vector3DInt32, LoadedBlock>::iterator itBlock = m_pBlocks.find(pos);
-					if(itBlock == m_pBlocks.end())
-					{
-						// not loaded, not unloading
-						continue;
-					}
-					eraseBlock(itBlock);
-					// eraseBlock might cause a call to getUncompressedBlock, which again sets m_pLastAccessedBlock
-					if(m_v3dLastAccessedBlockPos == pos)
-					{
-						m_pLastAccessedBlock = 0;
-					}
-				} // for z
-			} // for y
-		} // for x
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
+	{
+		m_tBorderValue = tBorder;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
+	/// By default every voxel outside the volume has the border value. The volume can instead be clamped, so that
+	/// they have the value of the nearest voxel on its edge, or wrapped, so that it repeats in every direction. The
+	/// wrapped mode is intended for tiled or periodic worlds, and should not be used with a near infinite volume.
+	/// Either way the voxels outside the volume can't be written to.
 	///
+	/// Only reads which are outside the volume have to check the mode, so it doesn't slow down those inside it.
+	/// Note that a Sampler reads the voxels in the blocks along the edge of the volume directly, so if the sides of the
+	/// volume aren't a multiple of the block side length it will see the voxels of those blocks which are outside it.
+	/// \param eMode What to read from the voxels outside the volume.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::clearBlockCache(void)
+	void LargeVolume<VoxelType>::setBorderMode(BorderMode eMode)
 	{
-		for(uint32_t ct = 0; ct < m_vecUncompressedBlockCache.size(); ct++)
-		{
-			m_vecUncompressedBlockCache[ct]->block.compress();
-		}
-		m_vecUncompressedBlockCache.clear();
+		m_eBorderMode = eMode;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// This function should probably be made internal...
+	/// \return The scheme used to compress the blocks.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::initialise(const Region& regValidRegion, uint16_t uBlockSideLength)
+	BlockCompressor<VoxelType>* LargeVolume<VoxelType>::getCompressor(void) const
 	{
-		//Debug mode validation
+		return m_pCompressor;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The length of the sides of the blocks, in voxels.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint16_t LargeVolume<VoxelType>::getBlockSideLength(void) const
+	{
+		return m_uBlockSideLength;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The order in which the voxels of each block are stored in memory.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	BlockLayout LargeVolume<VoxelType>::getBlockLayout(void) const
+	{
+		return m_eBlockLayout;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This lets algorithms such as surface extractors skip over large areas of empty space (or solid rock). It
+	/// is cheap for blocks which are stored as uniform, but an uncompressed block which has been modified has to
+	/// be scanned. The block is loaded if necessary, but it isn't uncompressed. Block positions are voxel positions
+	/// divided by getBlockSideLength() (rounding down). Blocks outside the volume are read according to the border
+	/// mode, so they are uniform unless it is clamped or wrapped (see setBorderMode()).
+	/// \param v3dBlockPos The position of the block.
+	/// \return Whether every voxel in the block has the same value.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::isBlockUniform(const Vector3DInt32& v3dBlockPos) const
+	{
+		if(!m_regValidRegionInBlocks.containsPoint(v3dBlockPos))
+		{
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				return true;
+			}
+
+			//The block is made up of whichever voxels it maps on to.
+			const uint32_t uNoOfVoxels = static_cast<uint32_t>(m_uBlockSideLength) * m_uBlockSideLength * m_uBlockSideLength;
+			return countVoxelsInBlock(v3dBlockPos, getVoxelAt(getBlockRegion(v3dBlockPos).getLowerCorner())) == uNoOfVoxels;
+		}
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		//Holding the cache lock means the block can't be compressed or uncompressed meanwhile.
+		LoadedBlock* pLoadedBlock = loadBlock(v3dBlockPos);
+		waitForBlockToLoad(pLoadedBlock);
+		return pLoadedBlock->block.isUniform();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The range is built from the runs of the block (see visitBlockRuns()) so it costs one comparison per run
+	/// rather than one per voxel. This is enough for a surface extractor to decide whether a block can contain
+	/// the threshold. Only this function requires the voxel type to provide \c operator<.
+	/// \param v3dBlockPos The position of the block.
+	/// \param tMin Set to the smallest value in the block.
+	/// \param tMax Set to the largest value in the block.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::calculateBlockRange(const Vector3DInt32& v3dBlockPos, VoxelType& tMin, VoxelType& tMax) const
+	{
+		bool bIsEmpty = true;
+		visitBlockRuns(v3dBlockPos, polyvox_bind(&LargeVolume<VoxelType>::addRunToRange, polyvox_placeholder_1, polyvox_placeholder_2, &tMin, &tMax, &bIsEmpty));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Like calculateBlockRange() this is built from the runs of the block, so counting the solid voxels of a
+	/// mostly empty block is cheap.
+	/// \param v3dBlockPos The position of the block.
+	/// \param tValue The value to count.
+	/// \return The number of voxels in the block which are equal to \a tValue.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::countVoxelsInBlock(const Vector3DInt32& v3dBlockPos, const VoxelType& tValue) const
+	{
+		uint32_t uCount = 0;
+		visitBlockRuns(v3dBlockPos, polyvox_bind(&LargeVolume<VoxelType>::addRunToCount, polyvox_placeholder_1, polyvox_placeholder_2, tValue, &uCount));
+		return uCount;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The block is loaded if necessary, but it isn't uncompressed. The function is called once for each run of
+	/// identical voxels (in the order the block stores them) with the value and the length of the run. The lengths
+	/// always add up to the number of voxels in the block, but the runs are not necessarily maximal and the
+	/// palette compressor reports each distinct value only once. A uniform block is a single run, as is a block
+	/// outside the volume when the border is constant. With the other border modes such a block is read from the
+	/// voxels it maps on to, and its runs are reported in the order of the linear layout.
+	///
+	/// When concurrent access is enabled the cache is locked while the function runs, so it must not access the
+	/// volume itself.
+	/// \param v3dBlockPos The position of the block.
+	/// \param funcVisitor The function to call for each run.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::visitBlockRuns(const Vector3DInt32& v3dBlockPos, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const
+	{
+		if(!m_regValidRegionInBlocks.containsPoint(v3dBlockPos))
+		{
+			const uint32_t uNoOfVoxels = static_cast<uint32_t>(m_uBlockSideLength) * m_uBlockSideLength * m_uBlockSideLength;
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				funcVisitor(getBorderValue(), uNoOfVoxels);
+				return;
+			}
+
+			std::vector<VoxelType> vecVoxels(uNoOfVoxels);
+			readRegion(getBlockRegion(v3dBlockPos), &vecVoxels[0]);
+			for(uint32_t ct = 0; ct < uNoOfVoxels; )
+			{
+				const uint32_t uRunLength = findRunLength(&vecVoxels[ct], uNoOfVoxels - ct);
+				funcVisitor(vecVoxels[ct], uRunLength);
+				ct += uRunLength;
+			}
+			return;
+		}
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		LoadedBlock* pLoadedBlock = loadBlock(v3dBlockPos);
+		waitForBlockToLoad(pLoadedBlock);
+		pLoadedBlock->block.visitRuns(funcVisitor);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// See BaseVolume::calculateDensityRange(). The range of each block is calculated from its runs when it is first
+	/// needed (so the blocks are loaded, but not uncompressed) and then kept until the block is modified. The range
+	/// covers every voxel in the blocks which the region touches, so it may be a little wider than the range of the
+	/// region itself.
+	/// \param region The region to look at, which may extend outside the volume
+	/// \param tMin Set to the smallest density in the region
+	/// \param tMax Set to the largest density in the region
+	/// \return False if the region extends outside a volume which is clamped or wrapped, otherwise true
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	template <typename DensityType>
+	bool LargeVolume<VoxelType>::calculateDensityRange(const Region& region, DensityType& tMin, DensityType& tMax) const
+	{
+		assert(region.isValid());
+
+		DensityRange<VoxelType> range;
+
+		Region regCropped(region);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != region)
+		{
+			//The voxels which the border maps on to could be anywhere in the volume.
+			if(m_eBorderMode != BorderModes::Constant)
+			{
+				return false;
+			}
+			addToDensityRange(getBorderValue(), range);
+		}
+
+		if(regCropped.isValid())
+		{
+			polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockCache.lock();
+			}
+
+			const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+			for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+			{
+				for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+				{
+					for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+					{
+						LoadedBlock* pLoadedBlock = loadBlock(Vector3DInt32(x, y, z));
+						waitForBlockToLoad(pLoadedBlock);
+						addToDensityRange(pLoadedBlock->block.calculateDensityRange(), range);
+					}
+				}
+			}
+		}
+
+		DefaultMarchingCubesController<VoxelType> controller;
+		tMin = controller.convertToDensity(range.minVoxel);
+		tMax = controller.convertToDensity(range.maxVoxel);
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The policy used when choosing which block to evict.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	EvictionPolicy LargeVolume<VoxelType>::getEvictionPolicy(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		return m_listLoadedBlocks.getPolicy();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return Whether the volume can be read from several threads at once.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::isConcurrentAccessEnabled(void) const
+	{
+		return m_bConcurrentAccessEnabled;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The number of background paging threads, or zero if paging is synchronous.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::getNumberOfPagingThreads(void) const
+	{
+		return m_pPagingThreadPool ? m_pPagingThreadPool->getNoOfThreads() : 0;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The number of bytes which the loaded blocks can use, or zero if there is no limit.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::getMaxCompressedSizeInBytes(void) const
+	{
+		return m_uMaxCompressedSizeInBytes;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is the total of Block::calculateSizeInBytes() for the loaded blocks, which is what setMaxCompressedSizeInBytes()
+	/// limits. It is kept up to date as blocks are loaded and compressed, so unlike calculateSizeInBytes() it is cheap to call.
+	/// \return The number of bytes used by the loaded blocks.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::getCompressedSizeInBytes(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		return m_uCompressedSizeInBytes;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The number of bytes used by the uncompressed data of the blocks in the block cache.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::getUncompressedSizeInBytes(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		return m_listUncompressedBlocks.size() * m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// A hit is counted when a voxel access finds its block already loaded in memory, a miss when the block
+	/// has to be created (and filled by the dataRequiredHandler() if paging is enabled), and an eviction each
+	/// time a block is paged out to stay within the limit set by setMaxNumberOfBlocksInMemory().
+	/// \return The statistics for the loaded blocks.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	CacheStatistics LargeVolume<VoxelType>::getLoadedBlockStatistics(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		CacheStatistics stats = m_statsLoadedBlocks;
+		for(uint32_t ct = 0; ct < uNoOfBlockTableShards; ct++)
+		{
+			polyvox_unique_lock<polyvox_mutex> lockShard(m_arrayBlockTableShards[ct].mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
+			stats.hits += m_arrayBlockTableShards[ct].uNoOfLoadedBlockHits;
+		}
+		return stats;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// A hit is counted when a voxel access finds its block already uncompressed, a miss when the block has to
+	/// be uncompressed, and an eviction each time a block is compressed to stay within the limit set by
+	/// setMaxNumberOfUncompressedBlocks(). Accesses to the same block as the previous access are not counted.
+	/// \return The statistics for the uncompressed block cache.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	CacheStatistics LargeVolume<VoxelType>::getUncompressedBlockStatistics(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		CacheStatistics stats = m_statsUncompressedBlocks;
+		for(uint32_t ct = 0; ct < uNoOfBlockTableShards; ct++)
+		{
+			polyvox_unique_lock<polyvox_mutex> lockShard(m_arrayBlockTableShards[ct].mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
+			stats.hits += m_arrayBlockTableShards[ct].uNoOfUncompressedBlockHits;
+		}
+		return stats;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	///
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::resetStatistics(void)
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		m_statsLoadedBlocks = CacheStatistics();
+		m_statsUncompressedBlocks = CacheStatistics();
+		for(uint32_t ct = 0; ct < uNoOfBlockTableShards; ct++)
+		{
+			//The fast paths count their hits under the shard lock alone.
+			polyvox_unique_lock<polyvox_mutex> lockShard(m_arrayBlockTableShards[ct].mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
+			m_arrayBlockTableShards[ct].uNoOfLoadedBlockHits = 0;
+			m_arrayBlockTableShards[ct].uNoOfUncompressedBlockHits = 0;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		assert(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
+
+		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+		const uint16_t xOffset = static_cast<uint16_t>(uXPos - (blockX << m_uBlockSideLengthPower));
+		const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
+		const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
+
+		if(m_bConcurrentAccessEnabled)
+		{
+			//Writers are serialised by the cache lock, which also stops the block being compressed or paged out. The
+			//voxel is changed under the shard lock as getVoxelAt() reads uncompressed blocks with only that lock held.
+			polyvox_lock_guard<polyvox_mutex> lockCache(m_mutexCache);
+			Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(blockX, blockY, blockZ);
+			polyvox_lock_guard<polyvox_mutex> lockShard(getShard(Vector3DInt32(blockX, blockY, blockZ)).mutex);
+			pUncompressedBlock->setVoxelAt(xOffset,yOffset,zOffset, tValue);
+			return true;
+		}
+
+		//Writing the value a uniform block already has doesn't need to uncompress it.
+		LoadedBlock* pLoadedBlock = getReadableBlock(blockX, blockY, blockZ);
+		if(pLoadedBlock->block.m_bIsCompressed && (pLoadedBlock->block.m_tUniformValue == tValue))
+		{
+			return true;
+		}
+
+		Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(blockX, blockY, blockZ);
+
+		pUncompressedBlock->setVoxelAt(xOffset,yOffset,zOffset, tValue);
+
+		//Return true to indicate that we modified a voxel.
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		//As in setVoxelAt(), the cache lock is held throughout and each block is written under its shard lock.
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(x, y, z);
+
+					polyvox_unique_lock<polyvox_mutex> lockShard(getShard(Vector3DInt32(x, y, z)).mutex, polyvox_defer_lock);
+					if(m_bConcurrentAccessEnabled)
+					{
+						lockShard.lock();
+					}
+					copyRegionToBlock(pSource, regWrite, pUncompressedBlock->m_tUncompressedData, regBlock, pUncompressedBlock->m_eLayout, regPart);
+					pUncompressedBlock->m_bIsUncompressedDataModified = true;
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. As with setVoxelAt(), uniform blocks
+	/// which already have the value aren't uncompressed. Blocks which are completely covered by the region
+	/// will become uniform when they are next compressed.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		//As in setVoxelAt(), the cache lock is held throughout and each block is written under its shard lock.
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					if(!m_bConcurrentAccessEnabled)
+					{
+						const Block<VoxelType>& block = getReadableBlock(x, y, z)->block;
+						if(block.m_bIsCompressed && (block.m_tUniformValue == tValue))
+						{
+							continue;
+						}
+					}
+					Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(x, y, z);
+
+					polyvox_unique_lock<polyvox_mutex> lockShard(getShard(Vector3DInt32(x, y, z)).mutex, polyvox_defer_lock);
+					if(m_bConcurrentAccessEnabled)
+					{
+						lockShard.lock();
+					}
+					fillBlockPart(pUncompressedBlock->m_tUncompressedData, regBlock, pUncompressedBlock->m_eLayout, regPart, tValue);
+					pUncompressedBlock->m_bIsUncompressedDataModified = true;
+				}
+			}
+		}
+	}
+
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Note that if MaxNumberOfBlocksInMemory is not large enough to support the region this function will only load part of the region. In this case it is undefined which parts will actually be loaded. If all the voxels in the given region are already loaded, this function will not do anything. Other voxels might be unloaded to make space for the new voxels. If there are paging threads (see setNumberOfPagingThreads()) then the blocks are only queued for loading, and this function returns without waiting for them.
+	/// \param regPrefetch The Region of voxels to prefetch into memory.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::prefetch(Region regPrefetch)
+	{
+		Vector3DInt32 v3dStart;
+		for(int i = 0; i < 3; i++)
+		{
+			v3dStart.setElement(i, regPrefetch.getLowerCorner().getElement(i) >> m_uBlockSideLengthPower);
+		}
+
+		Vector3DInt32 v3dEnd;
+		for(int i = 0; i < 3; i++)
+		{
+			v3dEnd.setElement(i, regPrefetch.getUpperCorner().getElement(i) >> m_uBlockSideLengthPower);
+		}
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		Vector3DInt32 v3dSize = v3dEnd - v3dStart + Vector3DInt32(1,1,1);
+		uint32_t numblocks = static_cast<uint32_t>(v3dSize.getX() * v3dSize.getY() * v3dSize.getZ());
+		if(numblocks > m_uMaxNumberOfBlocksInMemory)
+		{
+			// cannot support the amount of blocks... so only load the maximum possible
+			numblocks = m_uMaxNumberOfBlocksInMemory;
+		}
+		for(int32_t x = v3dStart.getX(); x <= v3dEnd.getX(); x++)
+		{
+			for(int32_t y = v3dStart.getY(); y <= v3dEnd.getY(); y++)
+			{
+				for(int32_t z = v3dStart.getZ(); z <= v3dEnd.getZ(); z++)
+				{
+					Vector3DInt32 pos(x,y,z);
+					if(findBlock(pos) != 0)
+					{
+						// If the block is already loaded then we don't load it again. This means it does not get uncompressed,
+						// whereas if we were to call getUncompressedBlock() regardless then it would also get uncompressed.
+						// This might be nice, but on the prefetch region could be bigger than the uncompressed cache size.
+						// This would limit the amount of prefetching we could do.
+						continue;
+					}
+
+					if(numblocks == 0)
+					{
+						// Loading any more blocks would attempt to overflow the memory and therefore erase blocks
+						// we loaded in the beginning. This wouldn't cause logic problems but would be wasteful.
+						return;
+					}
+					// load a block
+					numblocks--;
+					loadBlock(pos);
+				} // for z
+			} // for y
+		} // for x
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is an alternative to letting the dataRequiredHandler() fill in the blocks one at a time as they are first
+	/// touched. Each block which intersects the region is handed to \a funcGenerator exactly once, on one of a set of
+	/// threads created for the purpose, and the generator writes straight into the block's uncompressed data through
+	/// the ConstVolumeProxy. The block is pinned and flagged as loading while this happens (just as for asynchronous
+	/// paging) so it is never locked per-voxel. Blocks which already exist are regenerated, and any Sampler which has
+	/// one of them pinned on another thread will see the data change underneath it.
+	///
+	/// The number of blocks being generated at once is limited by the size of the caches, so if the region is larger
+	/// than setMaxNumberOfBlocksInMemory() allows then the earlier blocks will be paged out (via the dataOverflowHandler())
+	/// to make room for the later ones.
+	///
+	/// The generator threads access the volume at the same time as the thread which called this function (including
+	/// from within the \a funcProgressHandler, which may use the volume), so this enables concurrent access (see
+	/// setConcurrentAccessEnabled()) until it returns, when the previous setting is restored.
+	/// \param regGenerate The Region of voxels to generate. It is cropped to the volume.
+	/// \param funcGenerator Called with a proxy for each block and the region which that block covers.
+	/// \param uNoOfThreads The number of threads to generate on, or zero to use one per core.
+	/// \param funcProgressHandler If set, called on this thread with the number of blocks generated and the total. Returning false cancels the generation.
+	/// \return Whether all the blocks were generated, rather than it being cancelled. The blocks which were already being generated are always finished.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::generate(const Region& regGenerate, polyvox_function<void(const ConstVolumeProxy<VoxelType>&, const Region&)> funcGenerator,
+		uint32_t uNoOfThreads, polyvox_function<bool(uint32_t, uint32_t)> funcProgressHandler)
+	{
+		assert(funcGenerator);
+		if(!funcGenerator)
+		{
+			throw std::invalid_argument("A generator must be provided");
+		}
+
+		Region regCropped = regGenerate;
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return true;
+		}
+
+		const bool bWasConcurrentAccessEnabled = m_bConcurrentAccessEnabled;
+		setConcurrentAccessEnabled(true);
+
+		Vector3DInt32 v3dStart;
+		Vector3DInt32 v3dEnd;
+		for(int i = 0; i < 3; i++)
+		{
+			v3dStart.setElement(i, regCropped.getLowerCorner().getElement(i) >> m_uBlockSideLengthPower);
+			v3dEnd.setElement(i, regCropped.getUpperCorner().getElement(i) >> m_uBlockSideLengthPower);
+		}
+		const Vector3DInt32 v3dSize = v3dEnd - v3dStart + Vector3DInt32(1,1,1);
+		const uint32_t uNoOfBlocks = static_cast<uint32_t>(v3dSize.getX() * v3dSize.getY() * v3dSize.getZ());
+
+		if(uNoOfThreads == 0)
+		{
+			uNoOfThreads = (std::max)(static_cast<uint32_t>(polyvox_thread::hardware_concurrency()), static_cast<uint32_t>(1));
+		}
+
+		//Every block being generated is pinned and uncompressed, so keep enough of them queued
+		//to keep the threads busy but not so many that the caches have to go over their limits.
+		uint32_t uMaxNoOfBlocksInProgress = (std::min)(uNoOfThreads * 2, (std::min)(m_uMaxNumberOfUncompressedBlocks, m_uMaxNumberOfBlocksInMemory));
+		uMaxNoOfBlocksInProgress = (std::max)(uMaxNoOfBlocksInProgress, static_cast<uint32_t>(1));
+
+		//These are only touched with the cache lock held.
+		uint32_t uNoOfBlocksInProgress = 0;
+		uint32_t uNoOfBlocksGenerated = 0;
+		uint32_t uNoOfBlocksReported = 0;
+		bool bCancelled = false;
+
+		try
+		{
+			//Declared before the lock, so that it is destroyed (and its threads are joined) after the lock is released.
+			ThreadPool threadPool(uNoOfThreads);
+
+			polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache);
+			for(uint32_t uBlock = 0; uBlock < uNoOfBlocks; uBlock++)
+			{
+				while(uNoOfBlocksInProgress >= uMaxNoOfBlocksInProgress)
+				{
+					m_condPagingFinished.wait(m_mutexCache);
+				}
+
+				//The handler is called without the lock, so that it can use the volume if it wants to.
+				if(funcProgressHandler && (uNoOfBlocksGenerated != uNoOfBlocksReported))
+				{
+					uNoOfBlocksReported = uNoOfBlocksGenerated;
+					lockCache.unlock();
+					const bool bContinue = funcProgressHandler(uNoOfBlocksReported, uNoOfBlocks);
+					lockCache.lock();
+					if(!bContinue)
+					{
+						bCancelled = true;
+						break;
+					}
+				}
+
+				const Vector3DInt32 v3dBlockPos
+				(
+					v3dStart.getX() + static_cast<int32_t>(uBlock % v3dSize.getX()),
+					v3dStart.getY() + static_cast<int32_t>((uBlock / v3dSize.getX()) % v3dSize.getY()),
+					v3dStart.getZ() + static_cast<int32_t>(uBlock / (v3dSize.getX() * v3dSize.getY()))
+				);
+
+				LoadedBlock* pLoadedBlock = loadBlock(v3dBlockPos, true);
+				uNoOfBlocksInProgress++;
+				threadPool.enqueue(polyvox_bind(&LargeVolume<VoxelType>::runGenerator, this, pLoadedBlock, funcGenerator, &uNoOfBlocksInProgress, &uNoOfBlocksGenerated));
+			}
+
+			while(uNoOfBlocksInProgress > 0)
+			{
+				m_condPagingFinished.wait(m_mutexCache);
+			}
+			lockCache.unlock();
+		}
+		catch(...)
+		{
+			setConcurrentAccessEnabled(bWasConcurrentAccessEnabled);
+			throw;
+		}
+
+		//The generator threads have all been joined, so the volume can go back to the way it was.
+		setConcurrentAccessEnabled(bWasConcurrentAccessEnabled);
+
+		if(funcProgressHandler)
+		{
+			funcProgressHandler(uNoOfBlocksGenerated, uNoOfBlocks);
+		}
+
+		return !bCancelled;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Removes all voxels from memory, and calls dataOverflowHandler() to ensure the application has a chance to store the data.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::flushAll()
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		//Blocks which are still being loaded are pinned and can't be erased.
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+
+		//Gather the blocks first, as erasing them
+		//rearranges the slots in the block table.
+		std::vector<LoadedBlock*> vecBlocksToErase;
+		vecBlocksToErase.reserve(m_listLoadedBlocks.size());
+		for(LoadedBlock* pLoadedBlock = m_listLoadedBlocks.front(); pLoadedBlock != 0; pLoadedBlock = m_listLoadedBlocks.next(pLoadedBlock))
+		{
+			vecBlocksToErase.push_back(pLoadedBlock);
+		}
+
+		for(uint32_t ct = 0; ct < vecBlocksToErase.size(); ct++)
+		{
+			eraseBlock(vecBlocksToErase[ct]);
+		}
+
+		//Make sure the data has actually been written back before we return.
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Removes all voxels in the specified Region from memory, and calls dataOverflowHandler() to ensure the application has a chance to store the data. It is possible that there are no voxels loaded in the Region, in which case the function will have no effect.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::flush(Region regFlush)
+	{
+		Vector3DInt32 v3dStart;
+		for(int i = 0; i < 3; i++)
+		{
+			v3dStart.setElement(i, regFlush.getLowerCorner().getElement(i) >> m_uBlockSideLengthPower);
+		}
+
+		Vector3DInt32 v3dEnd;
+		for(int i = 0; i < 3; i++)
+		{
+			v3dEnd.setElement(i, regFlush.getUpperCorner().getElement(i) >> m_uBlockSideLengthPower);
+		}
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+
+		for(int32_t x = v3dStart.getX(); x <= v3dEnd.getX(); x++)
+		{
+			for(int32_t y = v3dStart.getY(); y <= v3dEnd.getY(); y++)
+			{
+				for(int32_t z = v3dStart.getZ(); z <= v3dEnd.getZ(); z++)
+				{
+					Vector3DInt32 pos(x,y,z);
+					LoadedBlock* pLoadedBlock = findBlock(pos);
+					if(pLoadedBlock == 0)
+					{
+						// not loaded, not unloading
+						continue;
+					}
+					eraseBlock(pLoadedBlock);
+				} // for z
+			} // for y
+		} // for x
+
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Blocks which are pinned by a Sampler stay uncompressed until the Sampler leaves them.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::clearBlockCache(void)
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		LoadedBlock* pLoadedBlock = m_listUncompressedBlocks.front();
+		while(pLoadedBlock)
+		{
+			LoadedBlock* pNextBlock = m_listUncompressedBlocks.next(pLoadedBlock);
+			compressBlock(pLoadedBlock);
+			pLoadedBlock = pNextBlock;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should probably be made internal...
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::initialise(const Region& regValidRegion, uint16_t uBlockSideLength)
+	{
+		//Debug mode validation
 		assert(uBlockSideLength > 0);
 		
 		//Release mode validation
@@ -406,221 +1472,747 @@ namespace PolyVox
 		{
 			throw std::invalid_argument("Block side length cannot be zero.");
 		}
-		if(!isPowerOf2(uBlockSideLength))
+		if(!isPowerOf2(uBlockSideLength))
+		{
+			throw std::invalid_argument("Block side length must be a power of two.");
+		}
+
+		m_uMaxNumberOfUncompressedBlocks = 16;
+		m_uBlockSideLength = uBlockSideLength;
+		m_tBorderValue = VoxelType();
+		m_eBorderMode = BorderModes::Constant;
+		m_uMaxNumberOfBlocksInMemory = 1024;
+		m_uCompressedSizeInBytes = 0;
+		m_uMaxCompressedSizeInBytes = 0;
+		m_funcWatermarkHandler = 0;
+		m_uLowWatermarkInBytes = 0;
+		m_uHighWatermarkInBytes = 0;
+		m_bIsAboveHighWatermark = false;
+		m_v3dLastAccessedBlockPos = Vector3DInt32(0,0,0); //There are no invalid positions, but initially the m_pLastAccessedBlock pointer will be null;
+		m_pLastAccessedBlock = 0;
+		m_bCompressionEnabled = true;
+		m_bConcurrentAccessEnabled = false;
+		m_pPagingThreadPool = 0;
+		m_uNoOfBlocksBeingLoaded = 0;
+		m_pCompressor = &m_defaultCompressor;
+		m_eBlockLayout = BlockLayouts::Linear;
+
+		this->m_regValidRegion = regValidRegion;
+
+		//m_regValidRegionInBlocks.setLowerCorner(this->m_regValidRegion.getLowerCorner()  / static_cast<int32_t>(uBlockSideLength));
+		//m_regValidRegionInBlocks.setUpperCorner(this->m_regValidRegion.getUpperCorner()  / static_cast<int32_t>(uBlockSideLength));
+		//Compute the block side length
+		m_uBlockSideLength = uBlockSideLength;
+		m_uBlockSideLengthPower = logBase2(m_uBlockSideLength);
+		m_bufferPool.setBufferSize(m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength);
+		//m_regValidRegionInBlocks.setLowerX(this->m_regValidRegion.getLowerX() >> m_uBlockSideLengthPower);
+		//m_regValidRegionInBlocks.setLowerY(this->m_regValidRegion.getLowerY() >> m_uBlockSideLengthPower);
+		//m_regValidRegionInBlocks.setLowerZ(this->m_regValidRegion.getLowerZ() >> m_uBlockSideLengthPower);
+		m_regValidRegionInBlocks.setLowerCorner(Vector3DInt32(this->m_regValidRegion.getLowerCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getZ() >> m_uBlockSideLengthPower));
+		//m_regValidRegionInBlocks.setUpperX(this->m_regValidRegion.getUpperX() >> m_uBlockSideLengthPower);
+		//m_regValidRegionInBlocks.setUpperY(this->m_regValidRegion.getUpperY() >> m_uBlockSideLengthPower);
+		//m_regValidRegionInBlocks.setUpperZ(this->m_regValidRegion.getUpperZ() >> m_uBlockSideLengthPower);
+		m_regValidRegionInBlocks.setUpperCorner(Vector3DInt32(this->m_regValidRegion.getUpperCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getZ() >> m_uBlockSideLengthPower));
+
+		setMaxNumberOfUncompressedBlocks(m_uMaxNumberOfUncompressedBlocks);
+
+		//Clear the previous data
+		flushAll();
+
+		//Other properties we might find useful later
+		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_fDiagonalLength = sqrtf(static_cast<float>(this->getWidth() * this->getWidth() + this->getHeight() * this->getHeight() + this->getDepth() * this->getDepth()));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The returned block is uncompressed, unless it is uniform in which case its
+	/// voxels can be read without uncompressing it.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	typename LargeVolume<VoxelType>::LoadedBlock* LargeVolume<VoxelType>::getReadableBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const
+	{
+		//The concurrent code paths pin their blocks instead.
+		assert(!m_bConcurrentAccessEnabled);
+
+		Vector3DInt32 v3dBlockPos(uBlockX, uBlockY, uBlockZ);
+
+		//Check if we have the same block as last time, if so there's no need to even mark it as
+		//recently used (it's already at the front of the lists). This check should also provide
+		//a significant speed boost as usually it is true.
+		if((v3dBlockPos == m_v3dLastAccessedBlockPos) && (m_pLastAccessedBlock != 0))
+		{
+			assert(!m_pLastAccessedBlock->block.m_bIsCompressed || m_pLastAccessedBlock->block.m_bIsUniform);
+			return m_pLastAccessedBlock;
+		}		
+
+		LoadedBlock* pLoadedBlock = loadBlock(v3dBlockPos);
+		if(!pLoadedBlock->block.m_bIsCompressed || !pLoadedBlock->block.m_bIsUniform)
+		{
+			uncompressBlock(pLoadedBlock);
+		}
+
+		//Remember the block for next time
+		m_v3dLastAccessedBlockPos = v3dBlockPos;
+		m_pLastAccessedBlock = pLoadedBlock;
+		return m_pLastAccessedBlock;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// When concurrent access is enabled this must be called with m_mutexCache held, and the
+	/// block only stays uncompressed and in memory for as long as the lock is held.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	Block<VoxelType>* LargeVolume<VoxelType>::getUncompressedBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const
+	{
+		if(m_bConcurrentAccessEnabled)
+		{
+			LoadedBlock* pLoadedBlock = loadBlock(Vector3DInt32(uBlockX, uBlockY, uBlockZ));
+			waitForBlockToLoad(pLoadedBlock);
+			uncompressBlock(pLoadedBlock);
+			return &(pLoadedBlock->block);
+		}
+
+		LoadedBlock* pLoadedBlock = getReadableBlock(uBlockX, uBlockY, uBlockZ);
+		if(pLoadedBlock->block.m_bIsCompressed)
+		{
+			uncompressBlock(pLoadedBlock);
+		}
+
+		assert(pLoadedBlock->block.m_tUncompressedData);
+		return &(pLoadedBlock->block);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The returned block stays in memory until unpinBlock() is called. If it is uniform it is left compressed
+	/// and pVoxels is pointed at some shared data instead, otherwise it stays uncompressed until it is unpinned.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	typename LargeVolume<VoxelType>::LoadedBlock* LargeVolume<VoxelType>::pinBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ, VoxelType*& pVoxels) const
+	{
+		Vector3DInt32 v3dBlockPos(uBlockX, uBlockY, uBlockZ);
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			//Fast path - if the block can be used as it is then we only need the lock for its shard. Compressing
+			//a block also requires the shard lock, so once the block is pinned its data is safe to use. We can't
+			//reorder the eviction lists without the cache lock, so we just mark the block as being referenced.
+			BlockTableShard& shard = getShard(v3dBlockPos);
+			{
+				polyvox_lock_guard<polyvox_mutex> lockShard(shard.mutex);
+				LoadedBlock* pLoadedBlock = shard.table.find(v3dBlockPos);
+				if((pLoadedBlock != 0) && (pLoadedBlock->isLoading == false))
+				{
+					const Block<VoxelType>& block = pLoadedBlock->block;
+					pVoxels = block.m_bIsCompressed ? (block.m_bIsUniform ? getUniformBlockData(block.m_tUniformValue) : 0) : block.m_tUncompressedData;
+					if(pVoxels != 0)
+					{
+						++(pLoadedBlock->pinCount);
+						++(shard.uNoOfLoadedBlockHits);
+						m_listLoadedBlocks.mark(pLoadedBlock);
+						if(!block.m_bIsCompressed)
+						{
+							++(shard.uNoOfUncompressedBlockHits);
+							m_listUncompressedBlocks.mark(pLoadedBlock);
+						}
+						return pLoadedBlock;
+					}
+				}
+			}
+
+			//Slow path - the block has to be loaded and/or uncompressed.
+			lockCache.lock();
+		}
+
+		LoadedBlock* pLoadedBlock = loadBlock(v3dBlockPos);
+		waitForBlockToLoad(pLoadedBlock);
+
+		pVoxels = 0;
+		if(pLoadedBlock->block.m_bIsCompressed && pLoadedBlock->block.m_bIsUniform)
+		{
+			pVoxels = getUniformBlockData(pLoadedBlock->block.m_tUniformValue);
+		}
+
+		//If there are already too many distinct uniform values then we just uncompress the block.
+		if(pVoxels == 0)
+		{
+			uncompressBlock(pLoadedBlock);
+			pVoxels = pLoadedBlock->block.m_tUncompressedData;
+		}
+
+		//No need for the shard lock, as blocks are only compressed or paged out by a thread holding the cache lock.
+		++(pLoadedBlock->pinCount);
+		return pLoadedBlock;
+	}
+
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::unpinBlock(LoadedBlock* pLoadedBlock) const
+	{
+		assert(pLoadedBlock->pinCount > 0);
+		--(pLoadedBlock->pinCount);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return A block's worth of voxels with the given value, or null if data is
+	/// already being kept for too many other values.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType* LargeVolume<VoxelType>::getUniformBlockData(const VoxelType& tValue) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockUniformBlockData(m_mutexUniformBlockData, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockUniformBlockData.lock();
+		}
+
+		for(uint32_t ct = 0; ct < m_vecUniformBlockData.size(); ct++)
+		{
+			if(m_vecUniformBlockData[ct][0] == tValue)
+			{
+				return m_vecUniformBlockData[ct];
+			}
+		}
+
+		if(m_vecUniformBlockData.size() >= uMaxNoOfUniformBlockData)
+		{
+			return 0;
+		}
+
+		const uint32_t uNoOfVoxels = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
+		VoxelType* pVoxels = new VoxelType[uNoOfVoxels];
+		std::fill(pVoxels, pVoxels + uNoOfVoxels, tValue);
+		m_vecUniformBlockData.push_back(pVoxels);
+		return pVoxels;
+	}
+
+	template <typename VoxelType>
+	VoxelType LargeVolume<VoxelType>::getBorderVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(m_eBorderMode == BorderModes::Constant)
+		{
+			return m_tBorderValue;
+		}
+
+		return getVoxelAt(mapIntoRegion(uXPos, uYPos, uZPos, this->m_regValidRegion, m_eBorderMode));
+	}
+
+	template <typename VoxelType>
+	typename LargeVolume<VoxelType>::BlockTableShard& LargeVolume<VoxelType>::getShard(const Vector3DInt32& v3dBlockPos) const
+	{
+		//The tables use the low bits of the hash, so we use the high bits to choose the shard.
+		const uint32_t uHash = BlockTable<LoadedBlock>::hash(v3dBlockPos.getX(), v3dBlockPos.getY(), v3dBlockPos.getZ());
+		return m_arrayBlockTableShards[uHash >> (32 - uNoOfBlockTableShardsPower)];
+	}
+
+	template <typename VoxelType>
+	typename LargeVolume<VoxelType>::LoadedBlock* LargeVolume<VoxelType>::findBlock(const Vector3DInt32& v3dBlockPos) const
+	{
+		BlockTableShard& shard = getShard(v3dBlockPos);
+
+		polyvox_unique_lock<polyvox_mutex> lockShard(shard.mutex, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockShard.lock();
+		}
+
+		return shard.table.find(v3dBlockPos);
+	}
+
+	template <typename VoxelType>
+	typename LargeVolume<VoxelType>::LoadedBlock* LargeVolume<VoxelType>::loadBlock(const Vector3DInt32& v3dBlockPos, bool bForGeneration) const
+	{
+		LoadedBlock* pLoadedBlock = findBlock(v3dBlockPos);
+
+		//If the block was paged out recently it might still be waiting to be written back,
+		//in which case we have to let that finish or we would be loading stale data.
+		while((pLoadedBlock == 0) && (m_tableBlocksBeingWrittenBack.find(v3dBlockPos) != 0))
+		{
+			submitWriteBacks();
+			m_condPagingFinished.wait(m_mutexCache);
+			pLoadedBlock = findBlock(v3dBlockPos);
+		}
+
+		// check whether the block is already loaded
+		if(pLoadedBlock != 0)
+		{
+			m_statsLoadedBlocks.hits++;
+			m_listLoadedBlocks.touch(pLoadedBlock);
+
+			if(bForGeneration)
+			{
+				//Set it up the same way as a new block below, once any loading which is already underway has finished.
+				waitForBlockToLoad(pLoadedBlock);
+				uncompressBlock(pLoadedBlock);
+				++(pLoadedBlock->pinCount);
+
+				BlockTableShard& shard = getShard(v3dBlockPos);
+				polyvox_lock_guard<polyvox_mutex> lockShard(shard.mutex);
+				pLoadedBlock->isLoading = true;
+			}
+			return pLoadedBlock;
+		}
+
+		m_statsLoadedBlocks.misses++;
+
+		//The block is not in the table, so we will have to create a new block and add it.
+		//Before we do so, we might want to dump some existing data to make space. We 
+		//Only do this if paging is enabled.
+		if(m_bPagingEnabled)
+		{
+			makeRoomForLoadedBlock();
+		}
+		
+		// create the new block
+		pLoadedBlock = new LoadedBlock(m_uBlockSideLength, v3dBlockPos, m_pCompressor, m_eBlockLayout, &m_bufferPool);
+
+		//We have created the new block. If paging is enabled it should be used to
+		//fill in the required data. Otherwise it is just left in the default state.
+		if(bForGeneration)
+		{
+			//generate() will fill in the block on one of its threads, so there's no point asking
+			//the handler for the data. Until then it is pinned and flagged as loading, as below.
+			makeRoomForUncompressedBlock();
+			m_listUncompressedBlocks.insert(pLoadedBlock);
+			pLoadedBlock->block.uncompress();
+			++(pLoadedBlock->pinCount);
+			pLoadedBlock->isLoading = true;
+		}
+		else if(m_bPagingEnabled && m_funcDataRequiredHandler)
+		{
+			//The handler writes straight into the uncompressed block.
+			makeRoomForUncompressedBlock();
+			m_listUncompressedBlocks.insert(pLoadedBlock);
+			pLoadedBlock->block.uncompress();
+
+			if(m_pPagingThreadPool)
+			{
+				//The block goes into the table straight away, but pinned and flagged as loading
+				//so that it isn't evicted and nobody else touches the data until it's ready.
+				++(pLoadedBlock->pinCount);
+				pLoadedBlock->isLoading = true;
+				m_uNoOfBlocksBeingLoaded++;
+				m_pPagingThreadPool->enqueue(polyvox_bind(&LargeVolume<VoxelType>::runDataRequiredHandler, this, pLoadedBlock));
+			}
+			else
+			{
+				//The block isn't in the table yet, so no other thread
+				//can see it until the handler has finished with it.
+				Region reg = getBlockRegion(v3dBlockPos);
+				ConstVolumeProxy<VoxelType> ConstVolumeProxy(pLoadedBlock->block, reg);
+				m_funcDataRequiredHandler(ConstVolumeProxy, reg);
+
+				//There's no point keeping the uncompressed data for a block which only holds one value.
+				if(pLoadedBlock->block.isUniform())
+				{
+					m_listUncompressedBlocks.remove(pLoadedBlock);
+					pLoadedBlock->block.compress();
+				}
+			}
+		}
+
 		{
-			throw std::invalid_argument("Block side length must be a power of two.");
+			BlockTableShard& shard = getShard(v3dBlockPos);
+			polyvox_unique_lock<polyvox_mutex> lockShard(shard.mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
+			shard.table.insert(v3dBlockPos, pLoadedBlock);
 		}
+		m_listLoadedBlocks.insert(pLoadedBlock);
+		updateBlockSize(pLoadedBlock);
 
-		m_uTimestamper = 0;
-		m_uMaxNumberOfUncompressedBlocks = 16;
-		m_uBlockSideLength = uBlockSideLength;
-		m_pUncompressedBorderData = 0;
-		m_uMaxNumberOfBlocksInMemory = 1024;
-		m_v3dLastAccessedBlockPos = Vector3DInt32(0,0,0); //There are no invalid positions, but initially the m_pLastAccessedBlock pointer will be null;
-		m_pLastAccessedBlock = 0;
-		m_bCompressionEnabled = true;
+		return pLoadedBlock;
+	}
 
-		this->m_regValidRegion = regValidRegion;
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::uncompressBlock(LoadedBlock* pLoadedBlock) const
+	{
+		if(pLoadedBlock->block.m_bIsCompressed == false)
+		{ 			
+			m_statsUncompressedBlocks.hits++;
+			m_listUncompressedBlocks.touch(pLoadedBlock);
+			return;
+		}
 
-		//m_regValidRegionInBlocks.setLowerCorner(this->m_regValidRegion.getLowerCorner()  / static_cast<int32_t>(uBlockSideLength));
-		//m_regValidRegionInBlocks.setUpperCorner(this->m_regValidRegion.getUpperCorner()  / static_cast<int32_t>(uBlockSideLength));
-		//Compute the block side length
-		m_uBlockSideLength = uBlockSideLength;
-		m_uBlockSideLengthPower = logBase2(m_uBlockSideLength);
-		//m_regValidRegionInBlocks.setLowerX(this->m_regValidRegion.getLowerX() >> m_uBlockSideLengthPower);
-		//m_regValidRegionInBlocks.setLowerY(this->m_regValidRegion.getLowerY() >> m_uBlockSideLengthPower);
-		//m_regValidRegionInBlocks.setLowerZ(this->m_regValidRegion.getLowerZ() >> m_uBlockSideLengthPower);
-		m_regValidRegionInBlocks.setLowerCorner(Vector3DInt32(this->m_regValidRegion.getLowerCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getZ() >> m_uBlockSideLengthPower));
-		//m_regValidRegionInBlocks.setUpperX(this->m_regValidRegion.getUpperX() >> m_uBlockSideLengthPower);
-		//m_regValidRegionInBlocks.setUpperY(this->m_regValidRegion.getUpperY() >> m_uBlockSideLengthPower);
-		//m_regValidRegionInBlocks.setUpperZ(this->m_regValidRegion.getUpperZ() >> m_uBlockSideLengthPower);
-		m_regValidRegionInBlocks.setUpperCorner(Vector3DInt32(this->m_regValidRegion.getUpperCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getZ() >> m_uBlockSideLengthPower));
+		m_statsUncompressedBlocks.misses++;
 
-		setMaxNumberOfUncompressedBlocks(m_uMaxNumberOfUncompressedBlocks);
+		makeRoomForUncompressedBlock();
 
-		//Clear the previous data
-		m_pBlocks.clear();
+		m_listUncompressedBlocks.insert(pLoadedBlock);
+		checkMemoryWatermarks();
 
-		//Clear the previous data
-		m_pBlocks.clear();
+		//The fast paths in getVoxelAt() and pinBlock() check the compression flag under the shard lock.
+		BlockTableShard& shard = getShard(pLoadedBlock->position);
+		polyvox_unique_lock<polyvox_mutex> lockShard(shard.mutex, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockShard.lock();
+		}
+		pLoadedBlock->block.uncompress();
+	}
+
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::makeRoomForUncompressedBlock(void) const
+	{
+		//If we are allowed to compress then check whether we need to
+		if((m_bCompressionEnabled) && (m_listUncompressedBlocks.size() >= m_uMaxNumberOfUncompressedBlocks))
+		{
+			//Compress the least recently used block which isn't pinned. If they
+			//are all pinned then the cache has to go over the limit for a while.
+			LoadedBlock* pLeastRecentlyUsedBlock = m_listUncompressedBlocks.selectVictim(&isBlockUnpinned);
+			if(pLeastRecentlyUsedBlock && compressBlock(pLeastRecentlyUsedBlock))
+			{
+				m_statsUncompressedBlocks.evictions++;
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return Whether the block was compressed, which it won't be if it is pinned.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::compressBlock(LoadedBlock* pLoadedBlock) const
+	{
+		{
+			BlockTableShard& shard = getShard(pLoadedBlock->position);
+			polyvox_unique_lock<polyvox_mutex> lockShard(shard.mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
 
-		//Create the border block
-		m_pUncompressedBorderData = new VoxelType[m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength];
-		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength, VoxelType());
+			//Checked under the shard lock as the fast path in pinBlock() may have just pinned it.
+			if(pLoadedBlock->pinCount > 0)
+			{
+				return false;
+			}
 
-		//Other properties we might find useful later
-		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
-		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
-		this->m_fDiagonalLength = sqrtf(static_cast<float>(this->getWidth() * this->getWidth() + this->getHeight() * this->getHeight() + this->getDepth() * this->getDepth()));
+			pLoadedBlock->block.compress();
+			m_listUncompressedBlocks.remove(pLoadedBlock);
+
+			if(m_pLastAccessedBlock == pLoadedBlock)
+			{
+				m_pLastAccessedBlock = 0;
+			}
+		}
+
+		//The compressed data may have changed size if the block was modified.
+		updateBlockSize(pLoadedBlock);
+
+		return true;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return Whether the block was erased, which it won't be if it is pinned.
+	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	void LargeVolume<VoxelType>::eraseBlock(typename std::map<Vector3DInt32, LoadedBlock >::iterator itBlock) const
+	bool LargeVolume<VoxelType>::eraseBlock(LoadedBlock* pLoadedBlock) const
 	{
-		if(m_funcDataOverflowHandler)
+		//Take the block out of the table first so that no other thread can find it.
 		{
-			Vector3DInt32 v3dPos = itBlock->first;
-			Vector3DInt32 v3dLower(v3dPos.getX() << m_uBlockSideLengthPower, v3dPos.getY() << m_uBlockSideLengthPower, v3dPos.getZ() << m_uBlockSideLengthPower);
-			Vector3DInt32 v3dUpper = v3dLower + Vector3DInt32(m_uBlockSideLength-1, m_uBlockSideLength-1, m_uBlockSideLength-1);
+			BlockTableShard& shard = getShard(pLoadedBlock->position);
+			polyvox_unique_lock<polyvox_mutex> lockShard(shard.mutex, polyvox_defer_lock);
+			if(m_bConcurrentAccessEnabled)
+			{
+				lockShard.lock();
+			}
 
-			Region reg(v3dLower, v3dUpper);
-			ConstVolumeProxy<VoxelType> ConstVolumeProxy(*this, reg);
+			if(pLoadedBlock->pinCount > 0)
+			{
+				return false;
+			}
 
-			m_funcDataOverflowHandler(ConstVolumeProxy, reg);
+			shard.table.erase(pLoadedBlock->position);
+		}
+
+		if(m_pLastAccessedBlock == pLoadedBlock)
+		{
+			m_pLastAccessedBlock = 0;
+		}
+
+		if(m_listUncompressedBlocks.contains(pLoadedBlock))
+		{
+			m_listUncompressedBlocks.remove(pLoadedBlock);
 		}
-		if(m_bCompressionEnabled) {
-			for(uint32_t ct = 0; ct < m_vecUncompressedBlockCache.size(); ct++)
+		m_listLoadedBlocks.remove(pLoadedBlock);
+		m_uCompressedSizeInBytes -= pLoadedBlock->sizeInBytes;
+		checkMemoryWatermarks();
+
+		if(m_funcDataOverflowHandler)
+		{
+			if(m_pPagingThreadPool)
 			{
-				// find the block in the uncompressed cache
-				if(m_vecUncompressedBlockCache[ct] == &(itBlock->second))
+				//Leave the block to be written back (and deleted) by a paging thread. That happens without
+				//the cache lock, so the block can no longer use the buffer pool.
+				pLoadedBlock->block.detachFromBufferPool();
+				m_tableBlocksBeingWrittenBack.insert(pLoadedBlock->position, pLoadedBlock);
+				m_vecBlocksToWriteBack.push_back(pLoadedBlock);
+				if(m_vecBlocksToWriteBack.size() >= uWriteBackBatchSize)
 				{
-					// TODO: compression is unneccessary? or will not compressing this cause a memleak?
-					itBlock->second.block.compress();
-					// put last object in cache here
-					m_vecUncompressedBlockCache[ct] = m_vecUncompressedBlockCache.back();
-					// decrease cache size by one since last element is now in here twice
-					m_vecUncompressedBlockCache.resize(m_vecUncompressedBlockCache.size()-1);
-					break;
+					submitWriteBacks();
 				}
+				return true;
 			}
+
+			//The handler reads straight from the block, so it needs to be uncompressed unless it is uniform.
+			if(pLoadedBlock->block.m_bIsCompressed && !pLoadedBlock->block.m_bIsUniform)
+			{
+				pLoadedBlock->block.uncompress();
+			}
+
+			Region reg = getBlockRegion(pLoadedBlock->position);
+			ConstVolumeProxy<VoxelType> ConstVolumeProxy(pLoadedBlock->block, reg);
+			m_funcDataOverflowHandler(ConstVolumeProxy, reg);
+		}
+
+		//Compressing frees the uncompressed data, as Block has no destructor.
+		if(pLoadedBlock->block.m_bIsCompressed == false)
+		{
+			pLoadedBlock->block.compress();
 		}
-		m_pBlocks.erase(itBlock);
+		delete pLoadedBlock;
+
+		return true;
 	}
 
 	template <typename VoxelType>
-	bool LargeVolume<VoxelType>::setVoxelAtConst(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue) const
+	void LargeVolume<VoxelType>::makeRoomForLoadedBlock(void) const
 	{
-		//We don't have any range checks in this function because it
-		//is a private function only called by the ConstVolumeProxy. The
-		//ConstVolumeProxy takes care of ensuring the range is appropriate.
+		//Unload blocks until there is room for another one. If the ones
+		//we want are all pinned then we have to go over the limits for a while.
+		while((m_listLoadedBlocks.size() > 0) && ((m_listLoadedBlocks.size() >= m_uMaxNumberOfBlocksInMemory) || isOverCompressedSizeLimit()))
+		{
+			//With a memory budget the size of a block matters as well as how recently it was used.
+			LoadedBlock* pVictim = (m_uMaxCompressedSizeInBytes > 0) ?
+				m_listLoadedBlocks.selectVictim(&isBlockUnpinned, &getBlockSizeInBytes, uNoOfEvictionCandidates) :
+				m_listLoadedBlocks.selectVictim(&isBlockUnpinned);
+			if((pVictim == 0) || !eraseBlock(pVictim))
+			{
+				break;
+			}
+			m_statsLoadedBlocks.evictions++;
+		}
+	}
 
-		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
-		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
-		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return Whether another (uniform) block would take the loaded blocks over the limit set by setMaxCompressedSizeInBytes().
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::isOverCompressedSizeLimit(void) const
+	{
+		return (m_uMaxCompressedSizeInBytes > 0) && (m_uCompressedSizeInBytes + sizeof(Block<VoxelType>) > m_uMaxCompressedSizeInBytes);
+	}
 
-		const uint16_t xOffset = uXPos - (blockX << m_uBlockSideLengthPower);
-		const uint16_t yOffset = uYPos - (blockY << m_uBlockSideLengthPower);
-		const uint16_t zOffset = uZPos - (blockZ << m_uBlockSideLengthPower);
+	////////////////////////////////////////////////////////////////////////////////
+	/// Recounts the size of a block in the memory usage, after it has been loaded or its compressed data has changed.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::updateBlockSize(LoadedBlock* pLoadedBlock) const
+	{
+		const uint32_t uSizeInBytes = pLoadedBlock->block.calculateSizeInBytes();
+		m_uCompressedSizeInBytes = m_uCompressedSizeInBytes - pLoadedBlock->sizeInBytes + uSizeInBytes;
+		pLoadedBlock->sizeInBytes = uSizeInBytes;
 
-		Block<VoxelType>* pUncompressedBlock = getUncompressedBlock(blockX, blockY, blockZ);
+		checkMemoryWatermarks();
+	}
 
-		pUncompressedBlock->setVoxelAt(xOffset,yOffset,zOffset, tValue);
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::checkMemoryWatermarks(void) const
+	{
+		if(!m_funcWatermarkHandler)
+		{
+			return;
+		}
 
-		//Return true to indicate that we modified a voxel.
-		return true;
+		const uint32_t uSizeInBytes = m_uCompressedSizeInBytes + m_listUncompressedBlocks.size() * m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
+		if(!m_bIsAboveHighWatermark && (uSizeInBytes > m_uHighWatermarkInBytes))
+		{
+			m_bIsAboveHighWatermark = true;
+			m_funcWatermarkHandler(uSizeInBytes, true);
+		}
+		else if(m_bIsAboveHighWatermark && (uSizeInBytes < m_uLowWatermarkInBytes))
+		{
+			m_bIsAboveHighWatermark = false;
+			m_funcWatermarkHandler(uSizeInBytes, false);
+		}
 	}
 
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::waitForBlockToLoad(LoadedBlock* pLoadedBlock) const
+	{
+		if(pLoadedBlock->isLoading)
+		{
+			//Pin the block so that it can't be paged out between the paging
+			//thread finishing with it and this thread getting the lock back.
+			++(pLoadedBlock->pinCount);
+			while(pLoadedBlock->isLoading)
+			{
+				m_condPagingFinished.wait(m_mutexCache);
+			}
+			unpinBlock(pLoadedBlock);
+		}
+	}
 
 	template <typename VoxelType>
-	Block<VoxelType>* LargeVolume<VoxelType>::getUncompressedBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const
+	void LargeVolume<VoxelType>::submitWriteBacks(void) const
 	{
-		Vector3DInt32 v3dBlockPos(uBlockX, uBlockY, uBlockZ);
+		if(m_vecBlocksToWriteBack.empty() == false)
+		{
+			m_pPagingThreadPool->enqueue(polyvox_bind(&LargeVolume<VoxelType>::runDataOverflowHandler, this, m_vecBlocksToWriteBack));
+			m_vecBlocksToWriteBack.clear();
+		}
+	}
 
-		//Check if we have the same block as last time, if so there's no need to even update
-		//the time stamp. If we updated it everytime then that would be every time we touched
-		//a voxel, which would overflow a uint32_t and require us to use a uint64_t instead.
-		//This check should also provide a significant speed boost as usually it is true.
-		if((v3dBlockPos == m_v3dLastAccessedBlockPos) && (m_pLastAccessedBlock != 0))
+	////////////////////////////////////////////////////////////////////////////////
+	/// Waits until the paging threads have finished all the loads and write backs which have been queued.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::waitForPaging(void) const
+	{
+		submitWriteBacks();
+		while((m_uNoOfBlocksBeingLoaded > 0) || (m_tableBlocksBeingWrittenBack.size() > 0))
 		{
-			assert(m_pLastAccessedBlock->m_tUncompressedData);
-			return m_pLastAccessedBlock;
-		}		
+			m_condPagingFinished.wait(m_mutexCache);
+		}
+	}
 
-		typename std::map<Vector3DInt32, LoadedBlock >::iterator itBlock = m_pBlocks.find(v3dBlockPos);
-		// check whether the block is already loaded
-		if(itBlock == m_pBlocks.end())
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::finishLoadingBlock(LoadedBlock* pLoadedBlock, bool bIsUniform) const
+	{
 		{
-			//The block is not in the map, so we will have to create a new block and add it.
-			//Before we do so, we might want to dump some existing data to make space. We 
-			//Only do this if paging is enabled.
-			if(m_bPagingEnabled)
+			//The fast paths in getVoxelAt() and pinBlock() check the loading flag under the shard lock.
+			BlockTableShard& shard = getShard(pLoadedBlock->position);
+			polyvox_lock_guard<polyvox_mutex> lockShard(shard.mutex);
+			pLoadedBlock->isLoading = false;
+
+			//There's no point keeping the uncompressed data for a block which only holds one value.
+			if(bIsUniform)
 			{
-				// check wether another block needs to be unloaded before this one can be loaded
-				if(m_pBlocks.size() == m_uMaxNumberOfBlocksInMemory)
-				{
-					// find the least recently used block
-					typename std::map<Vector3DInt32, LoadedBlock >::iterator i;
-					typename std::map<Vector3DInt32, LoadedBlock >::iterator itUnloadBlock = m_pBlocks.begin();
-					for(i = m_pBlocks.begin(); i != m_pBlocks.end(); i++)
-					{
-						if(i->second.timestamp < itUnloadBlock->second.timestamp)
-						{
-							itUnloadBlock = i;
-						}
-					}
-					eraseBlock(itUnloadBlock);
-				}
+				m_listUncompressedBlocks.remove(pLoadedBlock);
+				pLoadedBlock->block.compress();
 			}
-			
-			// create the new block
-			LoadedBlock newBlock(m_uBlockSideLength);
-			itBlock = m_pBlocks.insert(std::make_pair(v3dBlockPos, newBlock)).first;
+		}
+		if(bIsUniform)
+		{
+			updateBlockSize(pLoadedBlock);
+		}
+		unpinBlock(pLoadedBlock);
+	}
+
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::runDataRequiredHandler(LoadedBlock* pLoadedBlock) const
+	{
+		//The block is pinned and flagged as loading, so nothing else will touch its data.
+		Region reg = getBlockRegion(pLoadedBlock->position);
+		ConstVolumeProxy<VoxelType> ConstVolumeProxy(pLoadedBlock->block, reg);
+		m_funcDataRequiredHandler(ConstVolumeProxy, reg);
+
+		//Checked before taking the locks, as it may have to look at every voxel.
+		const bool bIsUniform = pLoadedBlock->block.isUniform();
+
+		polyvox_lock_guard<polyvox_mutex> lockCache(m_mutexCache);
+		finishLoadingBlock(pLoadedBlock, bIsUniform);
+		m_uNoOfBlocksBeingLoaded--;
+		m_condPagingFinished.notify_all();
+	}
 
-			//We have created the new block. If paging is enabled it should be used to
-			//fill in the required data. Otherwise it is just left in the default state.
-			if(m_bPagingEnabled)
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::runGenerator(LoadedBlock* pLoadedBlock, polyvox_function<void(const ConstVolumeProxy<VoxelType>&, const Region&)> funcGenerator, uint32_t* pNoOfBlocksInProgress, uint32_t* pNoOfBlocksGenerated) const
+	{
+		//As in runDataRequiredHandler(), the block is ours until it is no longer flagged as loading.
+		Region reg = getBlockRegion(pLoadedBlock->position);
+		ConstVolumeProxy<VoxelType> ConstVolumeProxy(pLoadedBlock->block, reg);
+		funcGenerator(ConstVolumeProxy, reg);
+
+		const bool bIsUniform = pLoadedBlock->block.isUniform();
+
+		polyvox_lock_guard<polyvox_mutex> lockCache(m_mutexCache);
+		finishLoadingBlock(pLoadedBlock, bIsUniform);
+		(*pNoOfBlocksInProgress)--;
+		(*pNoOfBlocksGenerated)++;
+		m_condPagingFinished.notify_all();
+	}
+
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::runDataOverflowHandler(std::vector<LoadedBlock*> vecLoadedBlocks) const
+	{
+		//These blocks have already been removed from the volume, so no other thread can touch them.
+		for(uint32_t ct = 0; ct < vecLoadedBlocks.size(); ct++)
+		{
+			LoadedBlock* pLoadedBlock = vecLoadedBlocks[ct];
+			if(pLoadedBlock->block.m_bIsCompressed && !pLoadedBlock->block.m_bIsUniform)
 			{
-				if(m_funcDataRequiredHandler)
-				{
-					// "load" will actually call setVoxel, which will in turn call this function again but the block will be found
-					// so this if(itBlock == m_pBlocks.end()) never is entered		
-					//FIXME - can we pass the block around so that we don't have to find  it again when we recursively call this function?
-					Vector3DInt32 v3dLower(v3dBlockPos.getX() << m_uBlockSideLengthPower, v3dBlockPos.getY() << m_uBlockSideLengthPower, v3dBlockPos.getZ() << m_uBlockSideLengthPower);
-					Vector3DInt32 v3dUpper = v3dLower + Vector3DInt32(m_uBlockSideLength-1, m_uBlockSideLength-1, m_uBlockSideLength-1);
-					Region reg(v3dLower, v3dUpper);
-					ConstVolumeProxy<VoxelType> ConstVolumeProxy(*this, reg);
-					m_funcDataRequiredHandler(ConstVolumeProxy, reg);
-				}
+				pLoadedBlock->block.uncompress();
 			}
-		}		
 
-		//Get the block and mark that we accessed it
-		LoadedBlock& loadedBlock = itBlock->second;
-		loadedBlock.timestamp = ++m_uTimestamper;
-		m_v3dLastAccessedBlockPos = v3dBlockPos;
-		m_pLastAccessedBlock = &(loadedBlock.block);
+			Region reg = getBlockRegion(pLoadedBlock->position);
+			ConstVolumeProxy<VoxelType> ConstVolumeProxy(pLoadedBlock->block, reg);
+			m_funcDataOverflowHandler(ConstVolumeProxy, reg);
 
-		if(loadedBlock.block.m_bIsCompressed == false)
-		{ 			
-			assert(m_pLastAccessedBlock->m_tUncompressedData);
-			return m_pLastAccessedBlock;
+			//Compressing frees the uncompressed data, as Block has no destructor.
+			if(pLoadedBlock->block.m_bIsCompressed == false)
+			{
+				pLoadedBlock->block.compress();
+			}
 		}
 
-		//If we are allowed to compress then check whether we need to
-		if((m_bCompressionEnabled) && (m_vecUncompressedBlockCache.size() == m_uMaxNumberOfUncompressedBlocks))
+		polyvox_lock_guard<polyvox_mutex> lockCache(m_mutexCache);
+		for(uint32_t ct = 0; ct < vecLoadedBlocks.size(); ct++)
 		{
-			int32_t leastRecentlyUsedBlockIndex = -1;
-			uint32_t uLeastRecentTimestamp = (std::numeric_limits<uint32_t>::max)();
+			m_tableBlocksBeingWrittenBack.erase(vecLoadedBlocks[ct]->position);
+			delete vecLoadedBlocks[ct];
+		}
+		m_condPagingFinished.notify_all();
+	}
 
-			//Currently we find the oldest block by iterating over the whole array. Of course we could store the blocks sorted by
-			//timestamp (set, priority_queue, etc) but then we'll need to move them around as the timestamp changes. Can come back 
-			//to this if it proves to be a bottleneck (compraed to the cost of actually doing the compression/decompression).
-			for(uint32_t ct = 0; ct < m_vecUncompressedBlockCache.size(); ct++)
-			{
-				if(m_vecUncompressedBlockCache[ct]->timestamp < uLeastRecentTimestamp)
-				{
-					uLeastRecentTimestamp = m_vecUncompressedBlockCache[ct]->timestamp;
-					leastRecentlyUsedBlockIndex = ct;
-				}
-			}
-			
-			//Compress the least recently used block.
-			m_vecUncompressedBlockCache[leastRecentlyUsedBlockIndex]->block.compress();
+	template <typename VoxelType>
+	Region LargeVolume<VoxelType>::getBlockRegion(const Vector3DInt32& v3dBlockPos) const
+	{
+		Vector3DInt32 v3dLower(v3dBlockPos.getX() << m_uBlockSideLengthPower, v3dBlockPos.getY() << m_uBlockSideLengthPower, v3dBlockPos.getZ() << m_uBlockSideLengthPower);
+		Vector3DInt32 v3dUpper = v3dLower + Vector3DInt32(m_uBlockSideLength-1, m_uBlockSideLength-1, m_uBlockSideLength-1);
+		return Region(v3dLower, v3dUpper);
+	}
 
-			//We don't actually remove any elements from this vector, we
-			//simply change the pointer to point at the new uncompressed bloack.			
-			m_vecUncompressedBlockCache[leastRecentlyUsedBlockIndex] = &loadedBlock;
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::addRunToRange(const VoxelType& tValue, uint32_t /*uLength*/, VoxelType* pMin, VoxelType* pMax, bool* pIsEmpty)
+	{
+		if(*pIsEmpty)
+		{
+			*pMin = tValue;
+			*pMax = tValue;
+			*pIsEmpty = false;
 		}
-		else
+		else if(tValue < *pMin)
 		{
-			m_vecUncompressedBlockCache.push_back(&loadedBlock);
+			*pMin = tValue;
 		}
-		
-		loadedBlock.block.uncompress();
+		else if(*pMax < tValue)
+		{
+			*pMax = tValue;
+		}
+	}
 
-		m_pLastAccessedBlock = &(loadedBlock.block);
-		assert(m_pLastAccessedBlock->m_tUncompressedData);
-		return m_pLastAccessedBlock;
+	template <typename VoxelType>
+	void LargeVolume<VoxelType>::addRunToCount(const VoxelType& tValue, uint32_t uLength, const VoxelType& tValueToCount, uint32_t* pCount)
+	{
+		if(tValue == tValueToCount)
+		{
+			*pCount += uLength;
+		}
+	}
+
+	template <typename VoxelType>
+	bool LargeVolume<VoxelType>::isBlockUnpinned(const LoadedBlock* pLoadedBlock)
+	{
+		return pLoadedBlock->pinCount == 0;
+	}
+
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::getBlockSizeInBytes(const LoadedBlock* pLoadedBlock)
+	{
+		return pLoadedBlock->sizeInBytes;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -629,39 +2221,128 @@ namespace PolyVox
 	template <typename VoxelType>
 	float LargeVolume<VoxelType>::calculateCompressionRatio(void)
 	{
-		float fRawSize = m_pBlocks.size() * m_uBlockSideLength * m_uBlockSideLength* m_uBlockSideLength * sizeof(VoxelType);
+		float fRawSize = m_listLoadedBlocks.size() * m_uBlockSideLength * m_uBlockSideLength* m_uBlockSideLength * sizeof(VoxelType);
 		float fCompressedSize = calculateSizeInBytes();
 		return fCompressedSize/fRawSize;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Each loaded block is compressed with the given compressor (without changing how it is actually stored)
+	/// and the result is compared with the size of the raw voxel data. Unlike the other version of this function
+	/// it ignores the memory used for the volume's own bookkeeping, so the results for different compressors can
+	/// be compared directly. This is slow, as every block is decompressed and compressed again.
+	/// \param pCompressor The compressor to measure.
+	/// \return The compressed size of the loaded blocks as a fraction of their uncompressed size.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	float LargeVolume<VoxelType>::calculateCompressionRatio(const BlockCompressor<VoxelType>* pCompressor)
+	{
+		assert(pCompressor);
+
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		//Blocks which are still being loaded don't have their data yet.
+		if(m_pPagingThreadPool)
+		{
+			waitForPaging();
+		}
+
+		const uint32_t uNoOfVoxels = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
+		std::vector<VoxelType> vecVoxels(uNoOfVoxels);
+		std::vector<uint8_t> vecCompressedData;
+
+		float fRawSize = 0.0f;
+		float fCompressedSize = 0.0f;
+		for(LoadedBlock* pLoadedBlock = m_listLoadedBlocks.front(); pLoadedBlock != 0; pLoadedBlock = m_listLoadedBlocks.next(pLoadedBlock))
+		{
+			const Block<VoxelType>& block = pLoadedBlock->block;
+
+			if(block.m_bIsCompressed && block.m_bIsUniform)
+			{
+				pCompressor->compressUniform(block.m_tUniformValue, m_uBlockSideLength, vecCompressedData);
+			}
+			else
+			{
+				const VoxelType* pVoxels = block.m_tUncompressedData;
+				if(block.m_bIsCompressed)
+				{
+					block.m_pCompressor->decompress(block.m_vecCompressedData, &vecVoxels[0], m_uBlockSideLength);
+					pVoxels = &vecVoxels[0];
+				}
+
+				pCompressor->compress(pVoxels, m_uBlockSideLength, vecCompressedData);
+			}
+
+			fRawSize += uNoOfVoxels * sizeof(VoxelType);
+			fCompressedSize += vecCompressedData.size();
+		}
+
+		return (fRawSize > 0.0f) ? fCompressedSize / fRawSize : 1.0f;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// Note: This function needs reviewing for accuracy...
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	uint32_t LargeVolume<VoxelType>::calculateSizeInBytes(void)
 	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
 		uint32_t uSizeInBytes = sizeof(LargeVolume);
 
 		//Memory used by the blocks
-		typename std::map<Vector3DInt32, LoadedBlock >::iterator i;
-		for(i = m_pBlocks.begin(); i != m_pBlocks.end(); i++)
+		for(uint32_t ct = 0; ct < uNoOfBlockTableShards; ct++)
+		{
+			uSizeInBytes += m_arrayBlockTableShards[ct].table.calculateSizeInBytes();
+		}
+		for(LoadedBlock* pLoadedBlock = m_listLoadedBlocks.front(); pLoadedBlock != 0; pLoadedBlock = m_listLoadedBlocks.next(pLoadedBlock))
 		{
 			//Inaccurate - account for rest of loaded block.
-			uSizeInBytes += i->second.block.calculateSizeInBytes();
+			uSizeInBytes += pLoadedBlock->block.calculateSizeInBytes();
 		}
 
 		//Memory used by the block cache.
-		uSizeInBytes += m_vecUncompressedBlockCache.capacity() * sizeof(LoadedBlock);
-		uSizeInBytes += m_vecUncompressedBlockCache.size() * m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
+		uSizeInBytes += m_listLoadedBlocks.size() * (sizeof(LoadedBlock) - sizeof(Block<VoxelType>));
 
-		//Memory used by border data.
-		if(m_pUncompressedBorderData)
+		//Memory used by the uncompressed blocks. The buffers which the pool is keeping for reuse are not counted.
+		uSizeInBytes += m_bufferPool.calculateSizeInUseInBytes();
+
+		//Memory used by the data which Samplers use for uniform blocks.
+		polyvox_unique_lock<polyvox_mutex> lockUniformBlockData(m_mutexUniformBlockData, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
 		{
-			uSizeInBytes += m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
+			lockUniformBlockData.lock();
 		}
+		uSizeInBytes += m_vecUniformBlockData.size() * m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength * sizeof(VoxelType);
 
 		return uSizeInBytes;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// The pool only grows when the uncompressed blocks need more memory than it has, and never holds more than enough for
+	/// setMaxNumberOfUncompressedBlocks() blocks, plus any blocks which have had to be allocated separately because the cache
+	/// was temporarily over its limit. Only the part of it which is in use is included in calculateSizeInBytes().
+	/// \return The number of bytes held by the pool of uncompressed block data, whether or not they are in use.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t LargeVolume<VoxelType>::calculateBufferPoolSizeInBytes(void) const
+	{
+		polyvox_unique_lock<polyvox_mutex> lockCache(m_mutexCache, polyvox_defer_lock);
+		if(m_bConcurrentAccessEnabled)
+		{
+			lockCache.lock();
+		}
+
+		return m_bufferPool.calculateSizeInBytes();
+	}
+
 }
 
@@ -21,8 +21,8 @@ freely, subject to the following restrictions:
     distribution. 	
 *******************************************************************************/
 
-#define BORDER_LOW(x) ((( x >> this->mVolume->m_uBlockSideLengthPower) << this->mVolume->m_uBlockSideLengthPower) != x)
-#define BORDER_HIGH(x) ((( (x+1) >> this->mVolume->m_uBlockSideLengthPower) << this->mVolume->m_uBlockSideLengthPower) != (x+1))
+#define BORDER_LOW(x) ((( x >> this->mBlockSideLengthPower) << this->mBlockSideLengthPower) != x)
+#define BORDER_HIGH(x) ((( (x+1) >> this->mBlockSideLengthPower) << this->mBlockSideLengthPower) != (x+1))
 //#define BORDER_LOW(x) (( x % mVolume->m_uBlockSideLength) != 0)
 //#define BORDER_HIGH(x) (( x % mVolume->m_uBlockSideLength) != mVolume->m_uBlockSideLength - 1)
 
@@ -31,12 +31,41 @@ namespace PolyVox
 	template <typename VoxelType>
 	LargeVolume<VoxelType>::Sampler::Sampler(LargeVolume<VoxelType>* volume)
 		:BaseVolume<VoxelType>::template Sampler< LargeVolume<VoxelType> >(volume)
+		,mCurrentVoxel(0)
+		,mCurrentBlockVoxels(0)
+		,mCurrentVoxelIndex(0)
+		,mCurrentBlock(0)
+		,mBlockSideLength(volume->m_uBlockSideLength)
+		,mBlockSideLengthPower(volume->m_uBlockSideLengthPower)
+		,mMortonBlockSideLength(0)
 	{
 	}
 
+	template <typename VoxelType>
+	LargeVolume<VoxelType>::Sampler::Sampler(const typename LargeVolume<VoxelType>::Sampler& rhs)
+		:BaseVolume<VoxelType>::template Sampler< LargeVolume<VoxelType> >(rhs)
+		,mCurrentVoxel(rhs.mCurrentVoxel)
+		,mCurrentBlockVoxels(rhs.mCurrentBlockVoxels)
+		,mCurrentVoxelIndex(rhs.mCurrentVoxelIndex)
+		,mCurrentBlock(rhs.mCurrentBlock)
+		,mBlockSideLength(rhs.mBlockSideLength)
+		,mBlockSideLengthPower(rhs.mBlockSideLengthPower)
+		,mMortonBlockSideLength(rhs.mMortonBlockSideLength)
+	{
+		//The copy is using the same block, so it needs its own pin.
+		if(mCurrentBlock)
+		{
+			++(mCurrentBlock->pinCount);
+		}
+	}
+
 	template <typename VoxelType>
 	LargeVolume<VoxelType>::Sampler::~Sampler()
 	{
+		if(mCurrentBlock)
+		{
+			this->mVolume->unpinBlock(mCurrentBlock);
+		}
 	}
 
 	template <typename VoxelType>
@@ -46,11 +75,28 @@ namespace PolyVox
 		{
 			return *this;
 		}
+
+		//Pin the new block before unpinning the old one, in case they are the same.
+		if(rhs.mCurrentBlock)
+		{
+			++(rhs.mCurrentBlock->pinCount);
+		}
+		if(mCurrentBlock)
+		{
+			this->mVolume->unpinBlock(mCurrentBlock);
+		}
+		mCurrentBlock = rhs.mCurrentBlock;
+
         this->mVolume = rhs.mVolume;
 		this->mXPosInVolume = rhs.mXPosInVolume;
 		this->mYPosInVolume = rhs.mYPosInVolume;
 		this->mZPosInVolume = rhs.mZPosInVolume;
 		mCurrentVoxel = rhs.mCurrentVoxel;
+		mCurrentBlockVoxels = rhs.mCurrentBlockVoxels;
+		mCurrentVoxelIndex = rhs.mCurrentVoxelIndex;
+		mBlockSideLength = rhs.mBlockSideLength;
+		mBlockSideLengthPower = rhs.mBlockSideLengthPower;
+		mMortonBlockSideLength = rhs.mMortonBlockSideLength;
         return *this;
 	}
 
@@ -111,27 +157,86 @@ namespace PolyVox
 		this->mYPosInVolume = yPos;
 		this->mZPosInVolume = zPos;
 
-		const int32_t uXBlock = this->mXPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
-		const int32_t uYBlock = this->mYPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
-		const int32_t uZBlock = this->mZPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
+		mBlockSideLength = this->mVolume->m_uBlockSideLength;
+		mBlockSideLengthPower = this->mVolume->m_uBlockSideLengthPower;
 
-		const uint16_t uXPosInBlock = static_cast<uint16_t>(this->mXPosInVolume - (uXBlock << this->mVolume->m_uBlockSideLengthPower));
-		const uint16_t uYPosInBlock = static_cast<uint16_t>(this->mYPosInVolume - (uYBlock << this->mVolume->m_uBlockSideLengthPower));
-		const uint16_t uZPosInBlock = static_cast<uint16_t>(this->mZPosInVolume - (uZBlock << this->mVolume->m_uBlockSideLengthPower));
+		int32_t uXBlock = xPos >> this->mVolume->m_uBlockSideLengthPower;
+		int32_t uYBlock = yPos >> this->mVolume->m_uBlockSideLengthPower;
+		int32_t uZBlock = zPos >> this->mVolume->m_uBlockSideLengthPower;
 
-		const uint32_t uVoxelIndexInBlock = uXPosInBlock + 
-				uYPosInBlock * this->mVolume->m_uBlockSideLength + 
-				uZPosInBlock * this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
+		if((!this->mVolume->m_regValidRegionInBlocks.containsPoint(Vector3DInt32(uXBlock, uYBlock, uZBlock))) && (this->mVolume->m_eBorderMode != BorderModes::Constant))
+		{
+			//Point at (and pin) the voxel which this position maps on to. The voxels next to it needn't be the ones
+			//which the neighbouring positions map on to, so we pretend the block is a single voxel. That way every
+			//move and peek goes through the volume, without the Sampler needing any extra checks inside the volume.
+			const Vector3DInt32 v3dMappedPos = mapIntoRegion(xPos, yPos, zPos, this->mVolume->m_regValidRegion, this->mVolume->m_eBorderMode);
+			xPos = v3dMappedPos.getX();
+			yPos = v3dMappedPos.getY();
+			zPos = v3dMappedPos.getZ();
+
+			uXBlock = xPos >> this->mVolume->m_uBlockSideLengthPower;
+			uYBlock = yPos >> this->mVolume->m_uBlockSideLengthPower;
+			uZBlock = zPos >> this->mVolume->m_uBlockSideLengthPower;
+
+			mBlockSideLength = 1;
+			mBlockSideLengthPower = 0;
+		}
+
+		const uint16_t uXPosInBlock = static_cast<uint16_t>(xPos - (uXBlock << this->mVolume->m_uBlockSideLengthPower));
+		const uint16_t uYPosInBlock = static_cast<uint16_t>(yPos - (uYBlock << this->mVolume->m_uBlockSideLengthPower));
+		const uint16_t uZPosInBlock = static_cast<uint16_t>(zPos - (uZBlock << this->mVolume->m_uBlockSideLengthPower));
+
+		mCurrentVoxelIndex = getVoxelIndexInBlock(uXPosInBlock, uYPosInBlock, uZPosInBlock, this->mVolume->m_uBlockSideLengthPower, this->mVolume->m_eBlockLayout);
 
 		if(this->mVolume->m_regValidRegionInBlocks.containsPoint(Vector3DInt32(uXBlock, uYBlock, uZBlock)))
 		{
-			Block<VoxelType>* pUncompressedCurrentBlock = this->mVolume->getUncompressedBlock(uXBlock, uYBlock, uZBlock);
+			//We keep our current block pinned, so we only need to go back to the volume when
+			//we move into a different one. This also means we never take any locks within a block.
+			if((mCurrentBlock == 0) || (mCurrentBlock->position != Vector3DInt32(uXBlock, uYBlock, uZBlock)))
+			{
+				LoadedBlock* pNewBlock = this->mVolume->pinBlock(uXBlock, uYBlock, uZBlock, mCurrentBlockVoxels);
+				if(mCurrentBlock)
+				{
+					this->mVolume->unpinBlock(mCurrentBlock);
+				}
+				mCurrentBlock = pNewBlock;
+			}
 
-			mCurrentVoxel = pUncompressedCurrentBlock->m_tUncompressedData + uVoxelIndexInBlock;
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
 		}
 		else
 		{
-			mCurrentVoxel = this->mVolume->m_pUncompressedBorderData + uVoxelIndexInBlock;
+			if(mCurrentBlock)
+			{
+				this->mVolume->unpinBlock(mCurrentBlock);
+				mCurrentBlock = 0;
+			}
+
+			//The border is read from the same (read only) data as a uniform block with the border value.
+			//Every voxel of it has the same value, so the layout doesn't matter here.
+			mCurrentBlockVoxels = this->mVolume->getUniformBlockData(this->mVolume->m_tBorderValue);
+			if(mCurrentBlockVoxels)
+			{
+				mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+			}
+			else
+			{
+				//There are already too many distinct uniform values, so go through the volume instead.
+				mCurrentVoxel = &(this->mVolume->m_tBorderValue);
+				mBlockSideLength = 1;
+				mBlockSideLengthPower = 0;
+			}
+		}
+
+		//The layout is chosen here rather than in every move and peek. The fast paths in those assume the Linear layout,
+		//so for the Morton layout we make sure they are never taken (as for a single voxel above) and let the slow paths
+		//step through the block instead.
+		mMortonBlockSideLength = 0;
+		if((this->mVolume->m_eBlockLayout == BlockLayouts::Morton) && (mBlockSideLength > 1))
+		{
+			mMortonBlockSideLength = mBlockSideLength;
+			mBlockSideLength = 1;
+			mBlockSideLengthPower = 0;
 		}
 	}
 
@@ -148,10 +253,16 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::movePositiveX(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mXPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mXPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
-			++mCurrentVoxel;			
+			++mCurrentVoxel;
+		}
+		else if((mMortonBlockSideLength != 0) && ((this->mXPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonXMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
 		}
 		else
 		{
@@ -164,11 +275,17 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::movePositiveY(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mYPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mYPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel += this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && ((this->mYPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonYMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -180,11 +297,17 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::movePositiveZ(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mZPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mZPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel += this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && ((this->mZPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonZMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -196,10 +319,16 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::moveNegativeX(void)
 	{
 		//Note the *post* decreament here
-		if((this->mXPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mXPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
-			--mCurrentVoxel;			
+			--mCurrentVoxel;
+		}
+		else if((mMortonBlockSideLength != 0) && (((this->mXPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonXMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
 		}
 		else
 		{
@@ -212,11 +341,17 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::moveNegativeY(void)
 	{
 		//Note the *post* decreament here
-		if((this->mYPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mYPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel -= this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && (((this->mYPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonYMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -228,11 +363,17 @@ namespace PolyVox
 	void LargeVolume<VoxelType>::Sampler::moveNegativeZ(void)
 	{
 		//Note the *post* decreament here
-		if((this->mZPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mZPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel -= this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && (((this->mZPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonZMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -247,7 +388,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -257,7 +398,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -267,7 +408,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -277,7 +418,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -287,7 +428,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,0,0>();
 	}
 
 	template <typename VoxelType>
@@ -297,7 +438,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -307,7 +448,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -317,7 +458,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -327,7 +468,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,1,1>();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -339,7 +480,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -349,7 +490,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<0,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -359,7 +500,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -369,7 +510,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -385,7 +526,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -395,7 +536,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -405,7 +546,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<0,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -415,7 +556,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,1,1>();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -427,7 +568,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -437,7 +578,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -447,7 +588,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -457,7 +598,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -467,7 +608,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,0,0>();
 	}
 
 	template <typename VoxelType>
@@ -477,7 +618,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -487,7 +628,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -497,7 +638,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -507,7 +648,32 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,1,1>();
+	}
+
+	template <typename VoxelType>
+	template <int iXOffset, int iYOffset, int iZOffset>
+	VoxelType LargeVolume<VoxelType>::Sampler::peekNeighbourVoxel(void) const
+	{
+		//The offsets are known at compile time, so only the required checks and steps are left in.
+		const int32_t iMask = mMortonBlockSideLength - 1;
+		if((mMortonBlockSideLength == 0) ||
+			((iXOffset > 0) && (((this->mXPosInVolume + 1) & iMask) == 0)) || ((iXOffset < 0) && ((this->mXPosInVolume & iMask) == 0)) ||
+			((iYOffset > 0) && (((this->mYPosInVolume + 1) & iMask) == 0)) || ((iYOffset < 0) && ((this->mYPosInVolume & iMask) == 0)) ||
+			((iZOffset > 0) && (((this->mZPosInVolume + 1) & iMask) == 0)) || ((iZOffset < 0) && ((this->mZPosInVolume & iMask) == 0)))
+		{
+			return this->mVolume->getVoxelAt(this->mXPosInVolume + iXOffset, this->mYPosInVolume + iYOffset, this->mZPosInVolume + iZOffset);
+		}
+
+		//The neighbour is in the same block, which uses the Morton layout.
+		uint32_t uIndex = mCurrentVoxelIndex;
+		if(iXOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonXMask);
+		if(iXOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonXMask);
+		if(iYOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonYMask);
+		if(iYOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonYMask);
+		if(iZOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonZMask);
+		if(iZOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonZMask);
+		return mCurrentBlockVoxels[uIndex];
 	}
 }
 
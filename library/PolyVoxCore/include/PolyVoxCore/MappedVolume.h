@@ -0,0 +1,242 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_MappedVolume_H__
+#define __PolyVox_MappedVolume_H__
+
+#include "Impl/MappedFile.h"
+#include "Impl/RegionCopy.h"
+#include "Impl/Utility.h"
+
+#include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/Log.h"
+#include "PolyVoxCore/Region.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <cassert>
+#include <cstdlib> //For abort()
+#include <cstring> //For memcpy
+#include <limits>
+#include <memory>
+#include <stdexcept> //For invalid_argument
+#include <string>
+
+namespace PolyVox
+{
+	/// A fixed size volume which is stored in a file, and mapped into memory rather than loaded.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The MappedVolume is used in the same way as the SimpleVolume, but its voxels live in a file rather than in memory which the volume
+	/// has allocated. The file is mapped into the address space of the process, so the operating system's page cache takes care of loading
+	/// the parts which are accessed and writing back the parts which are modified. This means that the volume can be much larger than the
+	/// available memory (only limited by the address space, so in practice this needs a 64-bit build) without you having to write any
+	/// paging code, and that the data persists from one run of your application to the next.
+	///
+	/// You create a new volume (and its file) by passing a filename along with the usual Region, and open an existing one by passing just the
+	/// filename. Nothing is read when a volume is created or opened, so this is almost instant even for a volume of many gigabytes. On most file
+	/// systems a new file is sparse and takes up no disk space until it is written to. The voxels of a new volume have all their bytes set to
+	/// zero, which for the built in types and those provided by PolyVox is the same as the default value.
+	///
+	/// As in the SimpleVolume the voxels are grouped into blocks, and each block is stored contiguously in the file (after a one page header).
+	/// This means that a small region of the volume only touches a few pages of the file. The Sampler and the getVoxelAt()/setVoxelAt() functions
+	/// read and write the mapped data directly, so there is no copying and no per-block bookkeeping. Modified data is written back to the file
+	/// by the operating system in its own time, and at the latest when the volume is destroyed. Call flush() if you need it written back sooner.
+	///
+	/// The voxels are stored exactly as they are in memory, so the VoxelType must be a plain type which can be copied byte by byte (such as
+	/// the built in types, Density, Material and MaterialDensityPair). For the same reason the file can only be opened on a machine with the
+	/// same byte order, and with the same VoxelType. This is checked when the file is opened.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class MappedVolume : public BaseVolume<VoxelType>
+	{
+	public:
+		#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< MappedVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< MappedVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			/// Construct a new Sampler
+			Sampler(MappedVolume<VoxelType>* volume);
+			~Sampler();
+
+			Sampler& operator=(const Sampler& rhs);
+
+			VoxelType getSubSampledVoxel(uint8_t uLevel) const;
+			/// Get the value of the current voxel
+			inline VoxelType getVoxel(void) const;
+			
+			/// Set the current voxel position
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			/// Set the current voxel position
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			/// Set the value of the current voxel
+			inline bool setVoxel(VoxelType tValue);
+
+			/// Increase the \a x position by \a 1
+			void movePositiveX(void);
+			/// Increase the \a y position by \a 1
+			void movePositiveY(void);
+			/// Increase the \a z position by \a 1
+			void movePositiveZ(void);
+
+			/// Decrease the \a x position by \a 1
+			void moveNegativeX(void);
+			/// Decrease the \a y position by \a 1
+			void moveNegativeY(void);
+			/// Decrease the \a z position by \a 1
+			void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			//Points into the mapped file, or into the border data when the Sampler is outside the volume.
+			VoxelType* mCurrentVoxel;
+			bool mIsInsideVolume;
+		};
+		#endif
+
+	public:
+		/// Constructor for creating a new volume, and the file to store it in.
+		MappedVolume(const std::string& strFilename, const Region& regValid, uint16_t uBlockSideLength = 32);
+		/// Constructor for opening a volume which was previously created.
+		MappedVolume(const std::string& strFilename);
+
+		/// Destructor
+		~MappedVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		VoxelType getBorderValue(void) const;
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(const VoxelType& tBorder);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+		/// Writes any modified voxels back to the file
+		void flush(void);
+
+		/// Gets the length of the sides of the blocks making up the volume
+		uint16_t getBlockSideLength(void) const;
+		/// Gets the size of the file in which the volume is stored
+		uint64_t getFileSizeInBytes(void) const;
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		MappedVolume(const MappedVolume& rhs);
+
+		/// Assignment operator
+		MappedVolume& operator=(const MappedVolume& rhs);
+
+	private:
+		//The start of the file. The block data follows, starting at uFileHeaderSizeInBytes. The
+		//block side length is stored as a uint32_t to keep the other fields aligned.
+		struct FileHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t voxelSizeInBytes;
+			uint32_t blockSideLength;
+			int32_t lowerCorner[3];
+			int32_t upperCorner[3];
+		};
+		//The header takes up the whole of the first page, so that the blocks are page aligned.
+		static const uint32_t uFileHeaderSizeInBytes = 4096;
+		static const uint32_t uFileVersion = 1;
+
+		void initialise(const Region& regValidRegion, uint16_t uBlockSideLength);
+		void validateFileHeader(const std::string& strFilename) const;
+
+		VoxelType* getBlockData(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const;
+
+		//The file holding the voxels.
+		MappedFile* m_pMappedFile;
+		VoxelType* m_pBlockData;
+
+		//We don't store an actual Block for the border, just the uncompressed data. This is so
+		//that the Sampler can do its usual pointer arithmetic when it goes outside the volume.
+		VoxelType* m_pUncompressedBorderData;
+
+		//The size of the volume in vlocks
+		Region m_regValidRegionInBlocks;
+
+		//Volume size measured in blocks.
+		uint32_t m_uNoOfBlocksInVolume;
+		uint16_t m_uWidthInBlocks;
+		uint16_t m_uHeightInBlocks;
+		uint16_t m_uDepthInBlocks;
+
+		//The size of the blocks
+		uint32_t m_uNoOfVoxelsPerBlock;
+		uint16_t m_uBlockSideLength;
+		uint8_t m_uBlockSideLengthPower;
+	};
+}
+
+#include "PolyVoxCore/MappedVolume.inl"
+#include "PolyVoxCore/MappedVolumeSampler.inl"
+
+#endif //__PolyVox_MappedVolume_H__
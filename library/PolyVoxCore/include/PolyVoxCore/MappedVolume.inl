@@ -0,0 +1,483 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a new file of the size required to store the volume, replacing any existing file with the same name.
+	/// \param strFilename The name of the file in which to store the volume.
+	/// \param regValid Specifies the minimum and maximum valid voxel positions.
+	/// \param uBlockSideLength The size of the block to use within the volume. Blocks of at least 4KB (e.g. 16 voxels of one byte) start on a new page.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MappedVolume<VoxelType>::MappedVolume(const std::string& strFilename, const Region& regValid, uint16_t uBlockSideLength)
+		:BaseVolume<VoxelType>(regValid)
+		,m_pMappedFile(0)
+		,m_pBlockData(0)
+		,m_pUncompressedBorderData(0)
+	{
+		initialise(regValid,uBlockSideLength);
+
+		const uint64_t uFileSizeInBytes = uFileHeaderSizeInBytes + static_cast<uint64_t>(m_uNoOfBlocksInVolume) * m_uNoOfVoxelsPerBlock * sizeof(VoxelType);
+		try
+		{
+			m_pMappedFile = new MappedFile(strFilename, uFileSizeInBytes);
+		}
+		catch(...)
+		{
+			delete[] m_pUncompressedBorderData;
+			throw;
+		}
+
+		FileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, "PolyVoxM", sizeof(header.magic));
+		header.version = uFileVersion;
+		header.voxelSizeInBytes = sizeof(VoxelType);
+		header.blockSideLength = m_uBlockSideLength;
+		for(int i = 0; i < 3; i++)
+		{
+			header.lowerCorner[i] = regValid.getLowerCorner().getElement(i);
+			header.upperCorner[i] = regValid.getUpperCorner().getElement(i);
+		}
+		memcpy(m_pMappedFile->getData(), &header, sizeof(header));
+
+		m_pBlockData = reinterpret_cast<VoxelType*>(m_pMappedFile->getData() + uFileHeaderSizeInBytes);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor opens a file which was created by the other constructor. The size of the volume and its blocks are read from the
+	/// file, and none of the voxels are read until they are accessed.
+	/// \param strFilename The name of the file in which the volume is stored.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MappedVolume<VoxelType>::MappedVolume(const std::string& strFilename)
+		:BaseVolume<VoxelType>(Region())
+		,m_pMappedFile(0)
+		,m_pBlockData(0)
+		,m_pUncompressedBorderData(0)
+	{
+		m_pMappedFile = new MappedFile(strFilename);
+		try
+		{
+			validateFileHeader(strFilename);
+
+			FileHeader header;
+			memcpy(&header, m_pMappedFile->getData(), sizeof(header));
+			const Region regValid(Vector3DInt32(header.lowerCorner[0], header.lowerCorner[1], header.lowerCorner[2]), Vector3DInt32(header.upperCorner[0], header.upperCorner[1], header.upperCorner[2]));
+			initialise(regValid, static_cast<uint16_t>(header.blockSideLength));
+
+			if(m_pMappedFile->getSizeInBytes() != uFileHeaderSizeInBytes + static_cast<uint64_t>(m_uNoOfBlocksInVolume) * m_uNoOfVoxelsPerBlock * sizeof(VoxelType))
+			{
+				throw std::invalid_argument("The file '" + strFilename + "' is not the right size for the volume it contains.");
+			}
+		}
+		catch(...)
+		{
+			delete[] m_pUncompressedBorderData;
+			delete m_pMappedFile;
+			throw;
+		}
+
+		m_pBlockData = reinterpret_cast<VoxelType*>(m_pMappedFile->getData() + uFileHeaderSizeInBytes);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MappedVolume<VoxelType>::MappedVolume(const MappedVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume. Any modified voxels are written back to the file.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MappedVolume<VoxelType>::~MappedVolume()
+	{
+		delete m_pMappedFile;
+		delete[] m_pUncompressedBorderData;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MappedVolume<VoxelType>& MappedVolume<VoxelType>::operator=(const MappedVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume. It is not stored in the file.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MappedVolume<VoxelType>::getBorderValue(void) const
+	{
+		return *m_pUncompressedBorderData;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MappedVolume<VoxelType>::getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)))
+		{
+			const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+			const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+			const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+			const uint16_t xOffset = static_cast<uint16_t>(uXPos - (blockX << m_uBlockSideLengthPower));
+			const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
+			const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
+
+			return getBlockData(blockX, blockY, blockZ)[xOffset + yOffset * m_uBlockSideLength + zOffset * m_uBlockSideLength * m_uBlockSideLength];
+		}
+		else
+		{
+			return getBorderValue();
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MappedVolume<VoxelType>::getVoxelAt(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels are copied block by block, a row at a time.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value.
+			fillRegionPart(pDestination, regRead, regRead, getBorderValue());
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					copyRegionPart(getBlockData(x, y, z), regBlock, pDestination, regRead, regPart);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
+	{
+		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uNoOfVoxelsPerBlock, tBorder);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool MappedVolume<VoxelType>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		assert(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
+
+		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+		const uint16_t xOffset = uXPos - (blockX << m_uBlockSideLengthPower);
+		const uint16_t yOffset = uYPos - (blockY << m_uBlockSideLengthPower);
+		const uint16_t zOffset = uZPos - (blockZ << m_uBlockSideLengthPower);
+
+		getBlockData(blockX, blockY, blockZ)[xOffset + yOffset * m_uBlockSideLength + zOffset * m_uBlockSideLength * m_uBlockSideLength] = tValue;
+
+		//Return true to indicate that we modified a voxel.
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool MappedVolume<VoxelType>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					copyRegionPart(pSource, regWrite, getBlockData(x, y, z), regBlock, regPart);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					fillRegionPart(getBlockData(x, y, z), regBlock, regPart, tValue);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The operating system writes modified data back to the file in its own time anyway, so you only need to call this if you
+	/// need to be sure that the file is up to date (for example before letting another process read it). It waits for the writes
+	/// to finish, so it can be slow if a lot of data has been modified.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::flush(void)
+	{
+		m_pMappedFile->flush();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The length of the sides of the blocks, in voxels.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint16_t MappedVolume<VoxelType>::getBlockSideLength(void) const
+	{
+		return m_uBlockSideLength;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is the size of the header plus the size of all the blocks. The file may use less disk space than this if it is sparse.
+	/// \return The size of the file, in bytes.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint64_t MappedVolume<VoxelType>::getFileSizeInBytes(void) const
+	{
+		return m_pMappedFile->getSizeInBytes();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should probably be made internal...
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::initialise(const Region& regValidRegion, uint16_t uBlockSideLength)
+	{
+		//Debug mode validation
+		assert(uBlockSideLength > 0);
+		assert(isPowerOf2(uBlockSideLength));
+		
+		//Release mode validation
+		if(uBlockSideLength == 0)
+		{
+			throw std::invalid_argument("Block side length cannot be zero.");
+		}
+		if(!isPowerOf2(uBlockSideLength))
+		{
+			throw std::invalid_argument("Block side length must be a power of two.");
+		}
+
+		this->m_regValidRegion = regValidRegion;
+
+		//Compute the block side length
+		m_uBlockSideLength = uBlockSideLength;
+		m_uBlockSideLengthPower = logBase2(m_uBlockSideLength);
+		m_uNoOfVoxelsPerBlock = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
+
+		m_regValidRegionInBlocks.setLowerCorner(Vector3DInt32(this->m_regValidRegion.getLowerCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getZ() >> m_uBlockSideLengthPower));
+		m_regValidRegionInBlocks.setUpperCorner(Vector3DInt32(this->m_regValidRegion.getUpperCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getZ() >> m_uBlockSideLengthPower));
+
+		//Compute the size of the volume in blocks (and note +1 at the end)
+		m_uWidthInBlocks = m_regValidRegionInBlocks.getUpperCorner().getX() - m_regValidRegionInBlocks.getLowerCorner().getX() + 1;
+		m_uHeightInBlocks = m_regValidRegionInBlocks.getUpperCorner().getY() - m_regValidRegionInBlocks.getLowerCorner().getY() + 1;
+		m_uDepthInBlocks = m_regValidRegionInBlocks.getUpperCorner().getZ() - m_regValidRegionInBlocks.getLowerCorner().getZ() + 1;
+		m_uNoOfBlocksInVolume = m_uWidthInBlocks * m_uHeightInBlocks * m_uDepthInBlocks;
+
+		//Create the border block
+		m_pUncompressedBorderData = new VoxelType[m_uNoOfVoxelsPerBlock];
+		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uNoOfVoxelsPerBlock, VoxelType());
+
+		//Other properties we might find useful later
+		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_fDiagonalLength = sqrtf(static_cast<float>(this->getWidth() * this->getWidth() + this->getHeight() * this->getHeight() + this->getDepth() * this->getDepth()));
+	}
+
+	template <typename VoxelType>
+	void MappedVolume<VoxelType>::validateFileHeader(const std::string& strFilename) const
+	{
+		if(m_pMappedFile->getSizeInBytes() < uFileHeaderSizeInBytes)
+		{
+			throw std::invalid_argument("The file '" + strFilename + "' is too small to contain a volume.");
+		}
+
+		FileHeader header;
+		memcpy(&header, m_pMappedFile->getData(), sizeof(header));
+
+		if(memcmp(header.magic, "PolyVoxM", sizeof(header.magic)) != 0)
+		{
+			throw std::invalid_argument("The file '" + strFilename + "' does not contain a volume.");
+		}
+		if(header.version != uFileVersion)
+		{
+			throw std::invalid_argument("The file '" + strFilename + "' was written by an unsupported version of PolyVox.");
+		}
+		if(header.voxelSizeInBytes != sizeof(VoxelType))
+		{
+			throw std::invalid_argument("The file '" + strFilename + "' contains a different type of voxel.");
+		}
+		//Checked here rather than left to initialise(), which asserts on a bad length rather than throwing.
+		if((header.blockSideLength == 0) || (header.blockSideLength > (std::numeric_limits<uint16_t>::max)()) || !isPowerOf2(header.blockSideLength))
+		{
+			throw std::invalid_argument("The file '" + strFilename + "' has an invalid block side length.");
+		}
+	}
+
+	template <typename VoxelType>
+	VoxelType* MappedVolume<VoxelType>::getBlockData(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const
+	{
+		//The lower left corner of the volume could be
+		//anywhere, but array indices need to start at zero.
+		uBlockX -= m_regValidRegionInBlocks.getLowerCorner().getX();
+		uBlockY -= m_regValidRegionInBlocks.getLowerCorner().getY();
+		uBlockZ -= m_regValidRegionInBlocks.getLowerCorner().getZ();
+
+		//Compute the block index
+		uint32_t uBlockIndex =
+				uBlockX + 
+				uBlockY * m_uWidthInBlocks + 
+				uBlockZ * m_uWidthInBlocks * m_uHeightInBlocks;
+
+		//The file may be bigger than 4GB, so the offset needs to be calculated with a size_t.
+		return m_pBlockData + static_cast<size_t>(uBlockIndex) * m_uNoOfVoxelsPerBlock;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels themselves are in the file, and the operating system decides how much of it to keep in memory. So this only
+	/// counts the memory which the volume has allocated itself. Use getFileSizeInBytes() to find the size of the data.
+	///
+	/// \return The number of bytes used
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t MappedVolume<VoxelType>::calculateSizeInBytes(void)
+	{
+		uint32_t uSizeInBytes = sizeof(MappedVolume);
+
+		uSizeInBytes += sizeof(MappedFile);
+
+		//Memory used by border data.
+		uSizeInBytes += m_uNoOfVoxelsPerBlock * sizeof(VoxelType);
+
+		return uSizeInBytes;
+	}
+}
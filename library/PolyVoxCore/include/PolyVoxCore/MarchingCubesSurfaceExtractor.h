@@ -24,15 +24,53 @@ freely, subject to the following restrictions:
 #ifndef __PolyVox_SurfaceExtractor_H__
 #define __PolyVox_SurfaceExtractor_H__
 
+#include "Impl/DensityRange.h"
+#include "Impl/MarchingCubesBitmask.h"
 #include "Impl/MarchingCubesTables.h"
+#include "Impl/ThreadPool.h"
 #include "Impl/TypeDef.h"
+#include "Impl/VolumeRegionAccess.h"
 
 #include "PolyVoxCore/Array.h"
 #include "PolyVoxCore/SurfaceMesh.h"
 #include "PolyVoxCore/DefaultMarchingCubesController.h"
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 namespace PolyVox
 {
+	namespace RegionFaces
+	{
+		/**
+		 * The six faces of a Region. These are in pairs along each axis, so the axis of a face is half of its value.
+		 */
+		enum RegionFace
+		{
+			NegativeX,
+			PositiveX,
+			NegativeY,
+			PositiveY,
+			NegativeZ,
+			PositiveZ,
+			NoOfFaces
+		};
+	}
+	typedef RegionFaces::RegionFace RegionFace;
+
+	/// The parts of a mesh which were changed by MarchingCubesSurfaceExtractor::update(). The vertices and indices
+	/// in these ranges have to be uploaded again. Nothing after the end of the ranges has changed, though the mesh
+	/// can have grown or shrunk (in which case the ranges run to the end of it).
+	class MeshChange
+	{
+	public:
+		uint32_t beginVertex;
+		uint32_t endVertex; //Just past the end, STL style
+		uint32_t beginIndex;
+		uint32_t endIndex; //Just past the end, STL style
+	};
+
 	template< typename VolumeType, typename Controller = DefaultMarchingCubesController<typename VolumeType::VoxelType> >
 	class MarchingCubesSurfaceExtractor
 	{
@@ -41,11 +79,61 @@ namespace PolyVox
 
 		void execute();
 
+		/// Extracts the surface on several threads, giving exactly the same mesh as execute().
+		void executeInParallel(uint32_t uNoOfThreads = 0);
+
+		/// Counts the vertices and indices before extracting them, so that the mesh is only allocated once.
+		void setTwoPassEnabled(bool bTwoPassEnabled);
+
+		/// Patches the mesh after the voxels in the given region have been changed, re-extracting only the slices they affect.
+		MeshChange update(const Region& regDirty);
+
+		/// Says whether the mesh on the other side of a face of the region is extracted at half of this one's resolution.
+		void setTransitionFace(RegionFace eFace, bool bEnabled);
+
 	private:
+		//executeInParallel() doesn't give a thread a slab with fewer layers of cells than this, as the
+		//slice on the boundary between two slabs has its bitmasks and vertices computed by both of them.
+		static const uint32_t uMinSlabDepth = 8;
+
+		//Extracts one slab of a larger region into its own mesh. This is run on the threads created by executeInParallel().
+		static void executeSlab(VolumeType* volData, Region regSlab, Vector3DInt32 v3dMeshOrigin, SurfaceMesh<PositionMaterialNormal>* meshSlab,
+			Controller controller, bool bTwoPassEnabled, std::vector<uint32_t>* pSliceVertexOffsets, std::vector<uint32_t>* pLayerIndexOffsets);
+
+		//Re-extracts the given slices for update() and puts them in place of the old ones.
+		MeshChange replaceSlices(uint32_t uFirstSlice, uint32_t uLastSlice);
+
+		//Copies a slab's mesh into its place in the whole mesh, dropping the vertices it shares with the previous slab.
+		static void copySlabIntoMesh(const SurfaceMesh<PositionMaterialNormal>* meshSlab, uint32_t uNoOfSharedVertices, uint32_t uIndexOffset,
+			PositionMaterialNormal* pVertices, uint32_t* pIndices);
+
+		//The slices are divided into tiles of this many cells along each side, so that those tiles which lie
+		//entirely on one side of the threshold can be skipped (see computeBitmaskForSlice()).
+		static const uint32_t uTileSideLength = 16;
+
+		//Uses the volume's density ranges to work out whether every voxel in a region is on the same side of the
+		//threshold, in which case iBitmask is set to the bitmask which all the cells in the region must have.
+		//Otherwise it is set to -1. Returns false if the volume doesn't keep track of its densities.
+		bool calculateUniformBitmask(const Region& region, int16_t& iBitmask);
+
 		//Compute the cell bitmask for a particular slice in z.
 		template<bool isPrevZAvail>
 		uint32_t computeBitmaskForSlice(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask);
 
+		//Computes and stores the bitmasks for every slice, and counts the vertices and indices which they will generate.
+		void computeBitmasksForRegion(Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask, uint32_t& uNoOfVertices, uint32_t& uNoOfIndices);
+
+		//Gets the cell bitmask for a slice, either by computing it or from those stored by computeBitmasksForRegion().
+		template<bool isPrevZAvail>
+		void getBitmaskForSlice(uint32_t uSlice, const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask);
+
+		//Compute the cell bitmask for a slice from whole rows of voxels, for volumes which can copy them out quickly.
+		template<bool isPrevZAvail>
+		void computeBitmaskForSliceFromRows(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask);
+
+		//Reads a plane of voxels and computes the four bits which it contributes to the bitmask of each cell above or below it.
+		void computeCornerBitsForPlane(int32_t iZVolSpace);
+
 		//Compute the cell bitmask for a given cell.
 		template<bool isPrevXAvail, bool isPrevYAvail, bool isPrevZAvail>
 		void computeBitmaskForCell(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask, uint32_t uXRegSpace, uint32_t uYRegSpace);
@@ -178,6 +266,43 @@ namespace PolyVox
 			const Array2DInt32& m_pCurrentVertexIndicesX,
 			const Array2DInt32& m_pCurrentVertexIndicesY);
 
+		//An edge of the high or low resolution grid which a vertex of a transition cell lies on. The start is the lower end.
+		struct TransitionEdge
+		{
+			Vector3DInt32 v3dStart;
+			Vector3DInt32 v3dEnd;
+		};
+
+		//Part of the outline of the surface on the boundary of a transition cell, between the vertices on two of its edges.
+		//The segments taken from the marching cubes triangles on either side have to be followed in the given direction.
+		struct TransitionSegment
+		{
+			uint32_t uStartEdge;
+			uint32_t uEndEdge;
+			bool bDirected;
+		};
+
+		bool hasTransitionFaces(void) const;
+
+		//Moves a vertex in the layer of cells next to a transition face away from it, to make room for the transition cells.
+		Vector3DFloat shrinkForTransitionCells(Vector3DFloat v3dPosition) const;
+		void shrinkVerticesForTransitionCells(uint32_t uBeginVertex, uint32_t uEndVertex);
+
+		//Adds the transition cells for all of the transition faces to the end of the mesh.
+		void generateTransitionCells(void);
+		void generateTransitionCell(uint32_t uAxis, bool bPositiveFace, const Vector3DInt32& v3dCorner);
+
+		//Adds the outline of the surface on the given plane of a (high or low resolution) cube, taken from its triangles.
+		void addTransitionFaceSegments(const Vector3DInt32& v3dCubeLowerCorner, int32_t iStep, uint32_t uAxis, int32_t iPlane,
+			std::vector<TransitionEdge>& vecEdges, std::vector<TransitionSegment>& vecSegments);
+		//Adds the outline of the surface on one of the sides of a transition cell, which run from the face to the low resolution cube.
+		void addTransitionSideSegment(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dStep,
+			std::vector<TransitionEdge>& vecEdges, std::vector<TransitionSegment>& vecSegments);
+		uint32_t findTransitionEdge(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dEnd, std::vector<TransitionEdge>& vecEdges);
+
+		typename Controller::DensityType getDensityAt(const Vector3DInt32& v3dPos);
+		PositionMaterialNormal computeTransitionVertex(const TransitionEdge& edge);
+
 		//The volume data and a sampler to access it.
 		VolumeType* m_volData;
 		typename VolumeType::Sampler m_sampVolume;
@@ -185,9 +310,38 @@ namespace PolyVox
 		//Used to return the number of cells in a slice which contain triangles.
 		uint32_t m_uNoOfOccupiedCells;
 
+		//The bitmask shared by all the cells of each tile of the current slice, or -1 if they have to be computed.
+		std::vector<int16_t> m_vecTileBitmasks;
+		uint32_t m_uNoOfTilesX;
+		uint32_t m_uNoOfTilesY;
+
+		//Buffers used by computeBitmaskForSliceFromRows(). They are only allocated for contiguous volumes.
+		std::vector<typename VolumeType::VoxelType> m_vecPlaneVoxels;
+		std::vector<typename Controller::DensityType> m_vecPlaneDensities;
+		std::vector<uint8_t> m_vecPlaneBelowThreshold;
+		std::vector<uint8_t> m_vecPlaneCornerBits;
+		std::vector<uint8_t> m_vecFirstSliceLowerBits;
+
 		//The surface patch we are currently filling.
 		SurfaceMesh<PositionMaterialNormal>* m_meshCurrent;
 
+		//The vertex positions are relative to this. It is the lower corner of the region, unless
+		//this is extracting a slab of a larger region for executeInParallel().
+		Vector3DInt32 m_v3dMeshOrigin;
+
+		//The first vertex generated for each slice, and the first index for each layer of cells (which lies between a
+		//slice and the next one), followed by the total number of each. The vertices of a slab's first slice are also
+		//generated for the last slice of the previous slab, and executeInParallel() uses these to skip them. update()
+		//uses them to find the part of the mesh which it has to replace.
+		std::vector<uint32_t> m_vecSliceVertexOffsets;
+		std::vector<uint32_t> m_vecLayerIndexOffsets;
+
+		//In two pass mode the bitmasks of all the slices are computed before any vertices are generated, which
+		//costs a byte per voxel of the region. The number of occupied cells in each slice is kept with them.
+		bool m_bTwoPassEnabled;
+		std::vector<uint8_t> m_vecRegionBitmasks;
+		std::vector<uint32_t> m_vecNoOfOccupiedCellsInSlices;
+
 		//Information about the region we are currently processing
 		Region m_regSizeInVoxels;
 		Region m_regSizeInCells;
@@ -202,6 +356,9 @@ namespace PolyVox
 
 		//Used to convert arbitrary voxel types in densities and materials.
 		Controller m_controller;
+
+		//The faces of the region which border a mesh at half of this one's resolution, and so get transition cells.
+		bool m_bTransitionFaces[RegionFaces::NoOfFaces];
 	};
 }
 
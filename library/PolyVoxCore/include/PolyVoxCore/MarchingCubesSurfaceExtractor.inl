@@ -28,6 +28,8 @@ namespace PolyVox
 		:m_volData(volData)
 		,m_sampVolume(volData)
 		,m_meshCurrent(result)
+		,m_v3dMeshOrigin(region.getLowerCorner())
+		,m_bTwoPassEnabled(false)
 		,m_regSizeInVoxels(region)
 	{
 		//m_regSizeInVoxels.cropTo(m_volData->getEnclosingRegion());
@@ -36,6 +38,12 @@ namespace PolyVox
 
 		m_controller = controller;
 		m_tThreshold = m_controller.getThreshold();
+
+		m_uNoOfTilesX = (m_regSizeInVoxels.getWidthInVoxels() + uTileSideLength - 1) / uTileSideLength;
+		m_uNoOfTilesY = (m_regSizeInVoxels.getHeightInVoxels() + uTileSideLength - 1) / uTileSideLength;
+		m_vecTileBitmasks.resize(m_uNoOfTilesX * m_uNoOfTilesY);
+
+		std::fill(m_bTransitionFaces, m_bTransitionFaces + RegionFaces::NoOfFaces, false);
 	}
 
 	template<typename VolumeType, typename Controller>
@@ -58,6 +66,15 @@ namespace PolyVox
 		Array2DUint8 pPreviousBitmask(arraySizes);
 		Array2DUint8 pCurrentBitmask(arraySizes);
 
+		if(m_bTwoPassEnabled)
+		{
+			uint32_t uNoOfVertices = 0;
+			uint32_t uNoOfIndices = 0;
+			computeBitmasksForRegion(pPreviousBitmask, pCurrentBitmask, uNoOfVertices, uNoOfIndices);
+			m_meshCurrent->m_vecVertices.reserve(uNoOfVertices);
+			m_meshCurrent->m_vecTriangleIndices.reserve(uNoOfIndices);
+		}
+
 		//Create a region corresponding to the first slice
 		m_regSlicePrevious = m_regSizeInVoxels;
 		Vector3DInt32 v3dUpperCorner = m_regSlicePrevious.getUpperCorner();
@@ -68,8 +85,11 @@ namespace PolyVox
 		uint32_t uNoOfNonEmptyCellsForSlice0 = 0;
 		uint32_t uNoOfNonEmptyCellsForSlice1 = 0;
 
+		m_vecSliceVertexOffsets.assign(1, 0);
+		m_vecLayerIndexOffsets.clear();
+
 		//Process the first slice (previous slice not available)
-		computeBitmaskForSlice<false>(pPreviousBitmask, pCurrentBitmask);
+		getBitmaskForSlice<false>(0, pPreviousBitmask, pCurrentBitmask);
 		uNoOfNonEmptyCellsForSlice1 = m_uNoOfOccupiedCells;
 
 		if(uNoOfNonEmptyCellsForSlice1 != 0)
@@ -79,6 +99,7 @@ namespace PolyVox
 			memset(m_pCurrentVertexIndicesZ.getRawData(), 0xff, m_pCurrentVertexIndicesZ.getNoOfElements() * 4);
 			generateVerticesForSlice(pCurrentBitmask, m_pCurrentVertexIndicesX, m_pCurrentVertexIndicesY, m_pCurrentVertexIndicesZ);				
 		}
+		m_vecSliceVertexOffsets.push_back(m_meshCurrent->getNoOfVertices());
 
 		std::swap(uNoOfNonEmptyCellsForSlice0, uNoOfNonEmptyCellsForSlice1);
 		pPreviousBitmask.swap(pCurrentBitmask);
@@ -92,7 +113,7 @@ namespace PolyVox
 		//Process the other slices (previous slice is available)
 		for(int32_t uSlice = 1; uSlice <= m_regSizeInVoxels.getUpperCorner().getZ() - m_regSizeInVoxels.getLowerCorner().getZ(); uSlice++)
 		{	
-			computeBitmaskForSlice<true>(pPreviousBitmask, pCurrentBitmask);
+			getBitmaskForSlice<true>(uSlice, pPreviousBitmask, pCurrentBitmask);
 			uNoOfNonEmptyCellsForSlice1 = m_uNoOfOccupiedCells;
 
 			if(uNoOfNonEmptyCellsForSlice1 != 0)
@@ -103,6 +124,9 @@ namespace PolyVox
 				generateVerticesForSlice(pCurrentBitmask, m_pCurrentVertexIndicesX, m_pCurrentVertexIndicesY, m_pCurrentVertexIndicesZ);				
 			}
 
+			m_vecSliceVertexOffsets.push_back(m_meshCurrent->getNoOfVertices());
+
+			m_vecLayerIndexOffsets.push_back(m_meshCurrent->getNoOfIndices());
 			if((uNoOfNonEmptyCellsForSlice0 != 0) || (uNoOfNonEmptyCellsForSlice1 != 0))
 			{
 				generateIndicesForSlice(pPreviousBitmask, m_pPreviousVertexIndicesX, m_pPreviousVertexIndicesY, m_pPreviousVertexIndicesZ, m_pCurrentVertexIndicesX, m_pCurrentVertexIndicesY);
@@ -118,6 +142,14 @@ namespace PolyVox
 			m_regSliceCurrent.shift(Vector3DInt32(0,0,1));
 		}
 
+		m_vecLayerIndexOffsets.push_back(m_meshCurrent->getNoOfIndices());
+
+		if(hasTransitionFaces())
+		{
+			shrinkVerticesForTransitionCells(0, m_meshCurrent->getNoOfVertices());
+			generateTransitionCells();
+		}
+
 		m_meshCurrent->m_Region = m_regSizeInVoxels;
 
 		m_meshCurrent->m_vecLodRecords.clear();
@@ -127,6 +159,385 @@ namespace PolyVox
 		m_meshCurrent->m_vecLodRecords.push_back(lodRecord);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// The region is split along \c z into slabs, each of which is extracted into a separate mesh by one of a set of threads
+	/// created for the purpose. There are more slabs than threads so that the work is shared out evenly even when the surface
+	/// is only in one part of the region. The slice of voxels on the boundary between two slabs is processed by both of them,
+	/// and as they generate identical vertices for it the ones from the upper slab are dropped when the meshes are joined
+	/// together. The vertices and indices end up in the same order as they would for execute(), so the mesh is identical.
+	///
+	/// The volume is read from all of the threads at once, so it must support concurrent reads through separate Samplers.
+	/// For the LargeVolume this means that setConcurrentAccessEnabled() must have been called. The controller is copied
+	/// for each slab.
+	/// \param uNoOfThreads The number of threads to extract on, or zero to use one per core.
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::executeInParallel(uint32_t uNoOfThreads)
+	{
+		if(uNoOfThreads == 0)
+		{
+			uNoOfThreads = (std::max)(static_cast<uint32_t>(polyvox_thread::hardware_concurrency()), static_cast<uint32_t>(1));
+		}
+
+		const uint32_t uNoOfLayers = m_regSizeInVoxels.getDepthInVoxels() - 1;
+		const uint32_t uNoOfSlabs = (std::min)(uNoOfThreads * 4, uNoOfLayers / uMinSlabDepth);
+		if((uNoOfThreads == 1) || (uNoOfSlabs < 2))
+		{
+			execute();
+			return;
+		}
+
+		std::vector< SurfaceMesh<PositionMaterialNormal> > vecSlabMeshes(uNoOfSlabs);
+		std::vector< std::vector<uint32_t> > vecSlabVertexOffsets(uNoOfSlabs);
+		std::vector< std::vector<uint32_t> > vecSlabIndexOffsets(uNoOfSlabs);
+		ThreadPool threadPool(uNoOfThreads);
+		for(uint32_t uSlab = 0; uSlab < uNoOfSlabs; uSlab++)
+		{
+			Vector3DInt32 v3dLowerCorner = m_regSizeInVoxels.getLowerCorner();
+			Vector3DInt32 v3dUpperCorner = m_regSizeInVoxels.getUpperCorner();
+			v3dLowerCorner.setZ(m_regSizeInVoxels.getLowerCorner().getZ() + static_cast<int32_t>((uNoOfLayers * uSlab) / uNoOfSlabs));
+			v3dUpperCorner.setZ(m_regSizeInVoxels.getLowerCorner().getZ() + static_cast<int32_t>((uNoOfLayers * (uSlab + 1)) / uNoOfSlabs));
+			const Region regSlab(v3dLowerCorner, v3dUpperCorner);
+			threadPool.enqueue(polyvox_bind(&MarchingCubesSurfaceExtractor<VolumeType, Controller>::executeSlab, m_volData, regSlab,
+				m_v3dMeshOrigin, &vecSlabMeshes[uSlab], m_controller, m_bTwoPassEnabled, &vecSlabVertexOffsets[uSlab], &vecSlabIndexOffsets[uSlab]));
+		}
+		threadPool.waitForAll();
+
+		//The first vertices of each slab (after the first) are the same as the last ones of the previous slab, so they
+		//are dropped and the indices which referred to them are redirected. Once the sizes of the slabs are known the
+		//position of each one in the whole mesh is too, so they are copied across on the threads as well.
+		std::vector<uint32_t> vecVertexOffsets(uNoOfSlabs + 1, 0);
+		std::vector<uint32_t> vecIndexOffsets(uNoOfSlabs + 1, 0);
+		m_vecSliceVertexOffsets.assign(1, 0);
+		m_vecLayerIndexOffsets.clear();
+		for(uint32_t uSlab = 0; uSlab < uNoOfSlabs; uSlab++)
+		{
+			const std::vector<uint32_t>& vecSliceVertexOffsets = vecSlabVertexOffsets[uSlab];
+			const std::vector<uint32_t>& vecLayerIndexOffsets = vecSlabIndexOffsets[uSlab];
+			const uint32_t uNoOfSharedVertices = (uSlab > 0) ? vecSliceVertexOffsets[1] : 0;
+			vecVertexOffsets[uSlab + 1] = vecVertexOffsets[uSlab] + vecSlabMeshes[uSlab].getNoOfVertices() - uNoOfSharedVertices;
+			vecIndexOffsets[uSlab + 1] = vecIndexOffsets[uSlab] + vecSlabMeshes[uSlab].getNoOfIndices();
+
+			//Also work out where each slice and layer ended up, for update().
+			for(size_t uSlice = (uSlab > 0) ? 1 : 0; uSlice + 1 < vecSliceVertexOffsets.size(); uSlice++)
+			{
+				m_vecSliceVertexOffsets.push_back(vecVertexOffsets[uSlab] + vecSliceVertexOffsets[uSlice + 1] - uNoOfSharedVertices);
+			}
+			for(size_t uLayer = 0; uLayer + 1 < vecLayerIndexOffsets.size(); uLayer++)
+			{
+				m_vecLayerIndexOffsets.push_back(vecIndexOffsets[uSlab] + vecLayerIndexOffsets[uLayer]);
+			}
+		}
+		m_vecLayerIndexOffsets.push_back(vecIndexOffsets[uNoOfSlabs]);
+
+		m_meshCurrent->clear();
+		std::vector<PositionMaterialNormal>& vecVertices = m_meshCurrent->m_vecVertices;
+		std::vector<uint32_t>& vecIndices = m_meshCurrent->m_vecTriangleIndices;
+		vecVertices.resize(vecVertexOffsets[uNoOfSlabs]);
+		vecIndices.resize(vecIndexOffsets[uNoOfSlabs]);
+		if(!vecVertices.empty())
+		{
+			PositionMaterialNormal* pVertices = &vecVertices[0];
+			uint32_t* pIndices = vecIndices.empty() ? 0 : &vecIndices[0];
+			for(uint32_t uSlab = 0; uSlab < uNoOfSlabs; uSlab++)
+			{
+				const uint32_t uNoOfSharedVertices = (uSlab > 0) ? vecSlabVertexOffsets[uSlab][1] : 0;
+				threadPool.enqueue(polyvox_bind(&MarchingCubesSurfaceExtractor<VolumeType, Controller>::copySlabIntoMesh, &vecSlabMeshes[uSlab], uNoOfSharedVertices,
+					vecVertexOffsets[uSlab] - uNoOfSharedVertices, pVertices + vecVertexOffsets[uSlab], pIndices + vecIndexOffsets[uSlab]));
+			}
+			threadPool.waitForAll();
+		}
+
+		if(hasTransitionFaces())
+		{
+			shrinkVerticesForTransitionCells(0, m_meshCurrent->getNoOfVertices());
+			generateTransitionCells();
+		}
+
+		m_meshCurrent->m_Region = m_regSizeInVoxels;
+
+		LodRecord lodRecord;
+		lodRecord.beginIndex = 0;
+		lodRecord.endIndex = m_meshCurrent->getNoOfIndices();
+		m_meshCurrent->m_vecLodRecords.push_back(lodRecord);
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::executeSlab(VolumeType* volData, Region regSlab, Vector3DInt32 v3dMeshOrigin, SurfaceMesh<PositionMaterialNormal>* meshSlab,
+		Controller controller, bool bTwoPassEnabled, std::vector<uint32_t>* pSliceVertexOffsets, std::vector<uint32_t>* pLayerIndexOffsets)
+	{
+		MarchingCubesSurfaceExtractor<VolumeType, Controller> extractor(volData, regSlab, meshSlab, controller);
+		extractor.m_v3dMeshOrigin = v3dMeshOrigin;
+		extractor.m_bTwoPassEnabled = bTwoPassEnabled;
+		extractor.execute();
+		pSliceVertexOffsets->swap(extractor.m_vecSliceVertexOffsets);
+		pLayerIndexOffsets->swap(extractor.m_vecLayerIndexOffsets);
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::copySlabIntoMesh(const SurfaceMesh<PositionMaterialNormal>* meshSlab, uint32_t uNoOfSharedVertices, uint32_t uIndexOffset,
+		PositionMaterialNormal* pVertices, uint32_t* pIndices)
+	{
+		std::copy(meshSlab->m_vecVertices.begin() + uNoOfSharedVertices, meshSlab->m_vecVertices.end(), pVertices);
+		for(std::vector<uint32_t>::const_iterator iterIndex = meshSlab->m_vecTriangleIndices.begin(); iterIndex != meshSlab->m_vecTriangleIndices.end(); iterIndex++)
+		{
+			*pIndices++ = *iterIndex + uIndexOffset;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The extractor normally computes the bitmasks for each slice just before generating its vertices and triangles,
+	/// and adds them to the mesh as it goes. Because the mesh doesn't know how big it will get it is reallocated (and
+	/// copied) several times for a large region. In two pass mode the bitmasks for the whole region are computed first
+	/// and used to count the vertices and indices, so that the mesh can be allocated at the right size to begin with.
+	/// The bitmasks are kept for the second pass, which costs an extra byte for each voxel in the region.
+	///
+	/// This also applies to each slab extracted by executeInParallel(). The slabs are always copied into the mesh
+	/// in one go once they have all been extracted, so it only needs to be allocated once anyway.
+	/// \param bTwoPassEnabled Whether to count the vertices and indices before extracting them.
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::setTwoPassEnabled(bool bTwoPassEnabled)
+	{
+		m_bTwoPassEnabled = bTwoPassEnabled;
+		if(!m_bTwoPassEnabled)
+		{
+			std::vector<uint8_t>().swap(m_vecRegionBitmasks);
+			std::vector<uint32_t>().swap(m_vecNoOfOccupiedCellsInSlices);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The mesh is generated a slice at a time, so the vertices and triangles for each slice of the region are kept
+	/// together in it. This re-extracts the slices which the changed voxels affect (those within two voxels of them in
+	/// \c z, as the normals are computed from the neighbouring voxels) as a separate slab and splices it into the mesh in
+	/// place of the old ones. The slab includes an unaffected slice on either side so that its triangles can be joined
+	/// up to the rest of the mesh, and the vertices it generates for those slices are dropped.
+	///
+	/// The mesh must be the one filled in by the last call to execute(), executeInParallel() or update(), and must not
+	/// have been changed since. If the mesh hasn't been extracted yet then it is extracted in full. When the number of
+	/// vertices changes the indices for all of the later slices are adjusted, so the returned ranges run to the end of
+	/// the mesh. Otherwise they only cover the slices which were re-extracted. The transition cells (see
+	/// setTransitionFace()) are at the end of the mesh and are generated again whenever any voxels near them change, in
+	/// which case the ranges also run to the end of it.
+	/// \param regDirty The region containing the voxels which have been changed.
+	/// \return The ranges of vertices and indices which are different.
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename Controller>
+	MeshChange MarchingCubesSurfaceExtractor<VolumeType, Controller>::update(const Region& regDirty)
+	{
+		const uint32_t uNoOfSlices = m_regSizeInVoxels.getDepthInVoxels();
+
+		MeshChange change;
+		if(m_vecSliceVertexOffsets.size() != uNoOfSlices + 1)
+		{
+			execute();
+			change.beginVertex = 0;
+			change.endVertex = m_meshCurrent->getNoOfVertices();
+			change.beginIndex = 0;
+			change.endIndex = m_meshCurrent->getNoOfIndices();
+			return change;
+		}
+
+		//The extractor reads the voxels from one before the region to two after it, because of the normals. The transition
+		//cells read a cell of the lower resolution mesh beyond the region, and the normals either side of that.
+		const Vector3DInt32& v3dLowerCorner = m_regSizeInVoxels.getLowerCorner();
+		const Vector3DInt32& v3dUpperCorner = m_regSizeInVoxels.getUpperCorner();
+		Region regSlicesRead(v3dLowerCorner - Vector3DInt32(1,1,1), v3dUpperCorner + Vector3DInt32(2,2,2));
+		Region regTransitionsRead(v3dLowerCorner - Vector3DInt32(4,4,4), v3dUpperCorner + Vector3DInt32(4,4,4));
+		regSlicesRead.cropTo(regDirty);
+		regTransitionsRead.cropTo(regDirty);
+		const bool bSlicesChanged = regSlicesRead.isValid();
+		const bool bTransitionsChanged = hasTransitionFaces() && regTransitionsRead.isValid();
+
+		if(!bSlicesChanged && !bTransitionsChanged)
+		{
+			change.beginVertex = change.endVertex = m_meshCurrent->getNoOfVertices();
+			change.beginIndex = change.endIndex = m_meshCurrent->getNoOfIndices();
+			return change;
+		}
+
+		//The transition cells come after all of the slices, and are generated again from scratch.
+		if(hasTransitionFaces())
+		{
+			m_meshCurrent->m_vecVertices.resize(m_vecSliceVertexOffsets.back());
+			m_meshCurrent->m_vecTriangleIndices.resize(m_vecLayerIndexOffsets.back());
+		}
+
+		if(bSlicesChanged)
+		{
+			//The slices which are affected.
+			const int32_t iFirstSlice = (std::max)(regDirty.getLowerCorner().getZ() - 2, v3dLowerCorner.getZ()) - v3dLowerCorner.getZ();
+			const int32_t iLastSlice = (std::min)(regDirty.getUpperCorner().getZ() + 1, v3dUpperCorner.getZ()) - v3dLowerCorner.getZ();
+			change = replaceSlices(static_cast<uint32_t>(iFirstSlice), static_cast<uint32_t>(iLastSlice));
+		}
+		else
+		{
+			change.beginVertex = change.endVertex = m_vecSliceVertexOffsets.back();
+			change.beginIndex = change.endIndex = m_vecLayerIndexOffsets.back();
+		}
+
+		if(hasTransitionFaces())
+		{
+			generateTransitionCells();
+			change.endVertex = m_meshCurrent->getNoOfVertices();
+			change.endIndex = m_meshCurrent->getNoOfIndices();
+		}
+
+		m_meshCurrent->m_vecLodRecords.clear();
+		LodRecord lodRecord;
+		lodRecord.beginIndex = 0;
+		lodRecord.endIndex = m_meshCurrent->getNoOfIndices();
+		m_meshCurrent->m_vecLodRecords.push_back(lodRecord);
+		return change;
+	}
+
+	template<typename VolumeType, typename Controller>
+	MeshChange MarchingCubesSurfaceExtractor<VolumeType, Controller>::replaceSlices(uint32_t uFirstSlice, uint32_t uLastSlice)
+	{
+		const uint32_t uNoOfSlices = m_regSizeInVoxels.getDepthInVoxels();
+		const Vector3DInt32& v3dLowerCorner = m_regSizeInVoxels.getLowerCorner();
+		const Vector3DInt32& v3dUpperCorner = m_regSizeInVoxels.getUpperCorner();
+
+		//The slab has to include the slices either side of the ones which are affected.
+		const uint32_t uFirstSlabSlice = (uFirstSlice > 0) ? uFirstSlice - 1 : uFirstSlice;
+		const uint32_t uLastSlabSlice = (uLastSlice + 1 < uNoOfSlices) ? uLastSlice + 1 : uLastSlice;
+
+		Vector3DInt32 v3dSlabLowerCorner = v3dLowerCorner;
+		Vector3DInt32 v3dSlabUpperCorner = v3dUpperCorner;
+		v3dSlabLowerCorner.setZ(v3dLowerCorner.getZ() + static_cast<int32_t>(uFirstSlabSlice));
+		v3dSlabUpperCorner.setZ(v3dLowerCorner.getZ() + static_cast<int32_t>(uLastSlabSlice));
+
+		SurfaceMesh<PositionMaterialNormal> meshSlab;
+		std::vector<uint32_t> vecSlabVertexOffsets;
+		std::vector<uint32_t> vecSlabIndexOffsets;
+		executeSlab(m_volData, Region(v3dSlabLowerCorner, v3dSlabUpperCorner), m_v3dMeshOrigin, &meshSlab, m_controller, m_bTwoPassEnabled, &vecSlabVertexOffsets, &vecSlabIndexOffsets);
+
+		//The slab's vertices for the unaffected slices at either end are already in the mesh.
+		const uint32_t uNoOfSlabVertices = meshSlab.getNoOfVertices();
+		const uint32_t uNoOfSharedVerticesAtStart = (uFirstSlabSlice < uFirstSlice) ? vecSlabVertexOffsets[1] : 0;
+		const uint32_t uNoOfSharedVerticesAtEnd = (uLastSlabSlice > uLastSlice) ? uNoOfSlabVertices - vecSlabVertexOffsets[vecSlabVertexOffsets.size() - 2] : 0;
+
+		const uint32_t uOldBeginVertex = m_vecSliceVertexOffsets[uFirstSlice];
+		const uint32_t uOldEndVertex = m_vecSliceVertexOffsets[uLastSlice + 1];
+		const uint32_t uNewEndVertex = uOldBeginVertex + (uNoOfSlabVertices - uNoOfSharedVerticesAtStart - uNoOfSharedVerticesAtEnd);
+		const uint32_t uOldBeginIndex = m_vecLayerIndexOffsets[uFirstSlabSlice];
+		const uint32_t uOldEndIndex = m_vecLayerIndexOffsets[uLastSlabSlice];
+		const uint32_t uNewEndIndex = uOldBeginIndex + meshSlab.getNoOfIndices();
+
+		//Redirect the slab's indices to where its vertices are in the mesh, and move the later indices to follow the vertices
+		//they refer to. They are unsigned so this works even when there are fewer vertices than before.
+		std::vector<uint32_t>& vecIndices = m_meshCurrent->m_vecTriangleIndices;
+		for(std::vector<uint32_t>::iterator iterIndex = vecIndices.begin() + uOldEndIndex; iterIndex != vecIndices.end(); iterIndex++)
+		{
+			*iterIndex += uNewEndVertex - uOldEndVertex;
+		}
+
+		std::vector<uint32_t> vecSlabIndices(meshSlab.m_vecTriangleIndices);
+		for(std::vector<uint32_t>::iterator iterIndex = vecSlabIndices.begin(); iterIndex != vecSlabIndices.end(); iterIndex++)
+		{
+			if(*iterIndex < uNoOfSharedVerticesAtStart)
+			{
+				*iterIndex += m_vecSliceVertexOffsets[uFirstSlabSlice];
+			}
+			else if(*iterIndex < uNoOfSlabVertices - uNoOfSharedVerticesAtEnd)
+			{
+				*iterIndex = *iterIndex - uNoOfSharedVerticesAtStart + uOldBeginVertex;
+			}
+			else
+			{
+				*iterIndex = *iterIndex - (uNoOfSlabVertices - uNoOfSharedVerticesAtEnd) + uNewEndVertex;
+			}
+		}
+
+		vecIndices.erase(vecIndices.begin() + uOldBeginIndex, vecIndices.begin() + uOldEndIndex);
+		vecIndices.insert(vecIndices.begin() + uOldBeginIndex, vecSlabIndices.begin(), vecSlabIndices.end());
+
+		std::vector<PositionMaterialNormal>& vecVertices = m_meshCurrent->m_vecVertices;
+		vecVertices.erase(vecVertices.begin() + uOldBeginVertex, vecVertices.begin() + uOldEndVertex);
+		vecVertices.insert(vecVertices.begin() + uOldBeginVertex, meshSlab.m_vecVertices.begin() + uNoOfSharedVerticesAtStart, meshSlab.m_vecVertices.end() - uNoOfSharedVerticesAtEnd);
+
+		//Update the positions of the slices and layers.
+		for(uint32_t uSlice = uFirstSlice; uSlice <= uLastSlice + 1; uSlice++)
+		{
+			m_vecSliceVertexOffsets[uSlice] = uOldBeginVertex + vecSlabVertexOffsets[uSlice - uFirstSlabSlice] - uNoOfSharedVerticesAtStart;
+		}
+		for(uint32_t uSlice = uLastSlice + 2; uSlice <= uNoOfSlices; uSlice++)
+		{
+			m_vecSliceVertexOffsets[uSlice] += uNewEndVertex - uOldEndVertex;
+		}
+		for(uint32_t uLayer = uFirstSlabSlice; uLayer <= uLastSlabSlice; uLayer++)
+		{
+			m_vecLayerIndexOffsets[uLayer] = uOldBeginIndex + vecSlabIndexOffsets[uLayer - uFirstSlabSlice];
+		}
+		for(uint32_t uLayer = uLastSlabSlice + 1; uLayer < uNoOfSlices; uLayer++)
+		{
+			m_vecLayerIndexOffsets[uLayer] += uNewEndIndex - uOldEndIndex;
+		}
+
+		if(hasTransitionFaces())
+		{
+			shrinkVerticesForTransitionCells(uOldBeginVertex, uNewEndVertex);
+		}
+
+		MeshChange change;
+		change.beginVertex = uOldBeginVertex;
+		change.endVertex = (uNewEndVertex == uOldEndVertex) ? uNewEndVertex : m_meshCurrent->getNoOfVertices();
+		change.beginIndex = uOldBeginIndex;
+		change.endIndex = ((uNewEndVertex == uOldEndVertex) && (uNewEndIndex == uOldEndIndex)) ? uNewEndIndex : m_meshCurrent->getNoOfIndices();
+		return change;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// When the mesh next to this one has half the resolution its vertices on the shared face don't line up with the ones
+	/// in this mesh, which leaves cracks between them. This is fixed in the same way as by the Transvoxel algorithm. The
+	/// layer of cells next to a transition face is squashed to half its width, and the gap is filled by transition cells.
+	/// These are half a voxel deep and two voxels across, so one face of each matches four cells of this mesh and the
+	/// other matches one cell of the lower resolution mesh. Their triangles join the outline of the surface on one face
+	/// to the outline on the other, so the two meshes are stitched together without any holes or skirts.
+	///
+	/// Rather than using the Transvoxel tables, each transition cell takes the outlines from the marching cubes cases of
+	/// the cells on either side of it (including the cell of the lower resolution mesh). This means that they always
+	/// match the triangles which were actually generated, and the faces can be set independently. The transition cells
+	/// are added to the end of the mesh by execute(), executeInParallel() and update(), with vertices of their own.
+	///
+	/// The lower resolution mesh is expected to have been extracted from a volume holding every second voxel of this
+	/// one (as VolumeResampler does when going from 2n+1 voxels to n+1), on a grid which lines up with the lower corner
+	/// of this region. So the region must be an even number of cells across the face, and at least two cells deep.
+	/// \param eFace The face of the region.
+	/// \param bEnabled Whether the mesh on the other side of that face is at half of this one's resolution.
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::setTransitionFace(RegionFace eFace, bool bEnabled)
+	{
+		assert(eFace < RegionFaces::NoOfFaces);
+		m_bTransitionFaces[eFace] = bEnabled;
+	}
+
+	template<typename VolumeType, typename Controller>
+	bool MarchingCubesSurfaceExtractor<VolumeType, Controller>::calculateUniformBitmask(const Region& region, int16_t& iBitmask)
+	{
+		iBitmask = -1;
+
+		typename Controller::DensityType tMin;
+		typename Controller::DensityType tMax;
+		if(!DensityRangeCalculator<UsesDefaultDensities<Controller, typename VolumeType::VoxelType>::value>::calculate(m_volData, region, tMin, tMax))
+		{
+			return false;
+		}
+
+		//The bits are set for corners which are below the threshold.
+		if(tMax < m_tThreshold)
+		{
+			iBitmask = 255;
+		}
+		else if(!(tMin < m_tThreshold))
+		{
+			iBitmask = 0;
+		}
+		return true;
+	}
+
 	template<typename VolumeType, typename Controller>
 	template<bool isPrevZAvail>
 	uint32_t MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeBitmaskForSlice(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask)
@@ -138,6 +549,42 @@ namespace PolyVox
 
 		int32_t iZVolSpace = m_regSliceCurrent.getLowerCorner().getZ();
 
+		//Each cell reads the voxels one beyond it in each direction. If all the voxels which the slice reads are on
+		//the same side of the threshold then none of its cells can contain a triangle, and they all have the same
+		//bitmask (either no corners or all of them below the threshold). The previous slice's bitmasks are still
+		//correct, so this doesn't change the result.
+		const Region regSliceVoxels(m_regSliceCurrent.getLowerCorner(), m_regSliceCurrent.getUpperCorner() + Vector3DInt32(1, 1, 1));
+		int16_t iSliceBitmask;
+		const bool bHasDensityRanges = calculateUniformBitmask(regSliceVoxels, iSliceBitmask);
+		if(iSliceBitmask >= 0)
+		{
+			memset(pCurrentBitmask.getRawData(), iSliceBitmask, pCurrentBitmask.getNoOfElements());
+			return m_uNoOfOccupiedCells;
+		}
+
+		//Volumes which store their voxels in rows can give us a whole plane of them at once. Thresholding those with
+		//SIMD is faster than skipping tiles and sampling the voxels around each of the remaining cells.
+		if(IsContiguousVolume<VolumeType>::value)
+		{
+			computeBitmaskForSliceFromRows<isPrevZAvail>(pPreviousBitmask, pCurrentBitmask);
+			return m_uNoOfOccupiedCells;
+		}
+
+		//Otherwise do the same for each tile of the slice.
+		std::fill(m_vecTileBitmasks.begin(), m_vecTileBitmasks.end(), static_cast<int16_t>(-1));
+		if(bHasDensityRanges)
+		{
+			for(uint32_t uTileY = 0; uTileY < m_uNoOfTilesY; uTileY++)
+			{
+				for(uint32_t uTileX = 0; uTileX < m_uNoOfTilesX; uTileX++)
+				{
+					const Vector3DInt32 v3dLowerCorner(m_regSliceCurrent.getLowerCorner().getX() + uTileX * uTileSideLength, m_regSliceCurrent.getLowerCorner().getY() + uTileY * uTileSideLength, iZVolSpace);
+					const Vector3DInt32 v3dUpperCorner((std::min)(v3dLowerCorner.getX() + static_cast<int32_t>(uTileSideLength) - 1, iMaxXVolSpace) + 1, (std::min)(v3dLowerCorner.getY() + static_cast<int32_t>(uTileSideLength) - 1, iMaxYVolSpace) + 1, iZVolSpace + 1);
+					calculateUniformBitmask(Region(v3dLowerCorner, v3dUpperCorner), m_vecTileBitmasks[uTileY * m_uNoOfTilesX + uTileX]);
+				}
+			}
+		}
+
 		//Process the lower left corner
 		int32_t iYVolSpace = m_regSliceCurrent.getLowerCorner().getY();
 		int32_t iXVolSpace = m_regSliceCurrent.getLowerCorner().getX();
@@ -174,24 +621,183 @@ namespace PolyVox
 			computeBitmaskForCell<true, false, isPrevZAvail>(pPreviousBitmask, pCurrentBitmask, uXRegSpace, uYRegSpace);
 		}
 
-		//Process all remaining elemnents of the slice. In this case, previous x and y values are always available
+		//Process all remaining elemnents of the slice. In this case, previous x and y values are always available.
+		//The cells are processed a tile at a time, so that the tiles which can't contain any triangles can be skipped.
 		for(iYVolSpace = m_regSliceCurrent.getLowerCorner().getY() + 1; iYVolSpace <= iMaxYVolSpace; iYVolSpace++)
 		{
+			uYRegSpace = iYVolSpace - m_regSizeInVoxels.getLowerCorner().getY();
+			const int16_t* pTileBitmasks = &m_vecTileBitmasks[(uYRegSpace / uTileSideLength) * m_uNoOfTilesX];
+
 			m_sampVolume.setPosition(m_regSliceCurrent.getLowerCorner().getX(), iYVolSpace, iZVolSpace);
-			for(iXVolSpace = m_regSliceCurrent.getLowerCorner().getX() + 1; iXVolSpace <= iMaxXVolSpace; iXVolSpace++)
-			{	
+			iXVolSpace = m_regSliceCurrent.getLowerCorner().getX() + 1;
+			while(iXVolSpace <= iMaxXVolSpace)
+			{
 				uXRegSpace = iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX();
-				uYRegSpace = iYVolSpace - m_regSizeInVoxels.getLowerCorner().getY();
+				const int32_t iEndOfTile = (std::min)(iXVolSpace + static_cast<int32_t>(uTileSideLength - 1 - uXRegSpace % uTileSideLength), iMaxXVolSpace);
+				const int16_t iTileBitmask = pTileBitmasks[uXRegSpace / uTileSideLength];
 
-				m_sampVolume.movePositiveX();
+				if(iTileBitmask >= 0)
+				{
+					for(; iXVolSpace <= iEndOfTile; iXVolSpace++)
+					{
+						pCurrentBitmask[iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX()][uYRegSpace] = static_cast<uint8_t>(iTileBitmask);
+					}
 
-				computeBitmaskForCell<true, true, isPrevZAvail>(pPreviousBitmask, pCurrentBitmask, uXRegSpace, uYRegSpace);
+					//Leave the sampler where it would have been if we had processed the cells.
+					m_sampVolume.setPosition(iEndOfTile, iYVolSpace, iZVolSpace);
+				}
+				else
+				{
+					for(; iXVolSpace <= iEndOfTile; iXVolSpace++)
+					{
+						uXRegSpace = iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX();
+
+						m_sampVolume.movePositiveX();
+
+						computeBitmaskForCell<true, true, isPrevZAvail>(pPreviousBitmask, pCurrentBitmask, uXRegSpace, uYRegSpace);
+					}
+				}
 			}
 		}
 
 		return m_uNoOfOccupiedCells;
 	}
 
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeBitmasksForRegion(Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask, uint32_t& uNoOfVertices, uint32_t& uNoOfIndices)
+	{
+		const uint32_t uWidth = pCurrentBitmask.getDimension(0);
+		const uint32_t uHeight = pCurrentBitmask.getDimension(1);
+		const uint32_t uNoOfCellsInSlice = uWidth * uHeight;
+		const uint32_t uNoOfSlices = m_regSizeInVoxels.getDepthInVoxels();
+
+		m_vecRegionBitmasks.resize(uNoOfCellsInSlice * uNoOfSlices);
+		m_vecNoOfOccupiedCellsInSlices.resize(uNoOfSlices);
+
+		m_regSliceCurrent = m_regSizeInVoxels;
+		Vector3DInt32 v3dUpperCorner = m_regSliceCurrent.getUpperCorner();
+		v3dUpperCorner.setZ(m_regSliceCurrent.getLowerCorner().getZ());
+		m_regSliceCurrent.setUpperCorner(v3dUpperCorner);
+
+		uNoOfVertices = 0;
+		uNoOfIndices = 0;
+		for(uint32_t uSlice = 0; uSlice < uNoOfSlices; uSlice++)
+		{
+			if(uSlice == 0)
+			{
+				computeBitmaskForSlice<false>(pPreviousBitmask, pCurrentBitmask);
+			}
+			else
+			{
+				computeBitmaskForSlice<true>(pPreviousBitmask, pCurrentBitmask);
+			}
+
+			memcpy(&m_vecRegionBitmasks[uSlice * uNoOfCellsInSlice], pCurrentBitmask.getRawData(), uNoOfCellsInSlice);
+			m_vecNoOfOccupiedCellsInSlices[uSlice] = m_uNoOfOccupiedCells;
+
+			//Each occupied cell generates the vertices on the three edges which leave its lower corner (see generateVerticesForSlice()).
+			if(m_uNoOfOccupiedCells != 0)
+			{
+				const uint8_t* pBitmask = pCurrentBitmask.getRawData();
+				for(uint32_t uCell = 0; uCell < uNoOfCellsInSlice; uCell++)
+				{
+					const int iEdges = edgeTable[pBitmask[uCell]];
+					uNoOfVertices += ((iEdges & 1) ? 1 : 0) + ((iEdges & 8) ? 1 : 0) + ((iEdges & 256) ? 1 : 0);
+				}
+			}
+
+			//The triangles for the cells of the previous slice can be generated once this one's vertices are known, except for
+			//the cells on the upper x and y faces of the region (see generateIndicesForSlice()). A few of these triangles might be
+			//dropped when they are generated, so this is an upper limit on the number of indices.
+			if((uSlice > 0) && ((m_vecNoOfOccupiedCellsInSlices[uSlice - 1] != 0) || (m_uNoOfOccupiedCells != 0)))
+			{
+				const uint8_t* pBitmask = pPreviousBitmask.getRawData();
+				for(uint32_t uX = 0; uX + 1 < uWidth; uX++)
+				{
+					for(uint32_t uY = 0; uY + 1 < uHeight; uY++)
+					{
+						uNoOfIndices += triangleCountTable[pBitmask[uX * uHeight + uY]] * 3;
+					}
+				}
+			}
+
+			pPreviousBitmask.swap(pCurrentBitmask);
+			m_regSlicePrevious = m_regSliceCurrent;
+			m_regSliceCurrent.shift(Vector3DInt32(0,0,1));
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	template<bool isPrevZAvail>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::getBitmaskForSlice(uint32_t uSlice, const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask)
+	{
+		if(m_bTwoPassEnabled)
+		{
+			const uint32_t uNoOfCellsInSlice = pCurrentBitmask.getNoOfElements();
+			memcpy(pCurrentBitmask.getRawData(), &m_vecRegionBitmasks[uSlice * uNoOfCellsInSlice], uNoOfCellsInSlice);
+			m_uNoOfOccupiedCells = m_vecNoOfOccupiedCellsInSlices[uSlice];
+		}
+		else
+		{
+			computeBitmaskForSlice<isPrevZAvail>(pPreviousBitmask, pCurrentBitmask);
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	template<bool isPrevZAvail>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeBitmaskForSliceFromRows(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask)
+	{
+		const uint32_t uWidth = pCurrentBitmask.getDimension(0);
+		const uint32_t uHeight = pCurrentBitmask.getDimension(1);
+		const int32_t iZVolSpace = m_regSliceCurrent.getLowerCorner().getZ();
+
+		//The lower half of each bitmask is normally the upper half of the one below it, but for the first
+		//slice the plane of voxels at the bottom of the slice has to be processed as well.
+		const uint8_t* pLowerBits = pPreviousBitmask.getRawData();
+		if(!isPrevZAvail)
+		{
+			m_vecFirstSliceLowerBits.resize(uWidth * uHeight);
+			computeCornerBitsForPlane(iZVolSpace);
+			transposeCornerBits(&m_vecPlaneCornerBits[0], uWidth, uHeight, &m_vecFirstSliceLowerBits[0]);
+			pLowerBits = &m_vecFirstSliceLowerBits[0];
+		}
+
+		computeCornerBitsForPlane(iZVolSpace + 1);
+		transposeCornerBits(&m_vecPlaneCornerBits[0], uWidth, uHeight, pCurrentBitmask.getRawData());
+
+		m_uNoOfOccupiedCells = mergeSliceBitmasks(pLowerBits, pCurrentBitmask.getRawData(), uWidth * uHeight);
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeCornerBitsForPlane(int32_t iZVolSpace)
+	{
+		//Each cell reads the voxels one beyond it in x and y.
+		const uint32_t uWidth = m_regSizeInVoxels.getWidthInVoxels();
+		const uint32_t uHeight = m_regSizeInVoxels.getHeightInVoxels();
+		const uint32_t uPlaneWidth = uWidth + 1;
+		const uint32_t uNoOfVoxels = uPlaneWidth * (uHeight + 1);
+
+		const Vector3DInt32 v3dLowerCorner(m_regSizeInVoxels.getLowerCorner().getX(), m_regSizeInVoxels.getLowerCorner().getY(), iZVolSpace);
+		const Vector3DInt32 v3dUpperCorner(m_regSizeInVoxels.getUpperCorner().getX() + 1, m_regSizeInVoxels.getUpperCorner().getY() + 1, iZVolSpace);
+
+		m_vecPlaneVoxels.resize(uNoOfVoxels);
+		m_vecPlaneDensities.resize(uNoOfVoxels);
+		m_vecPlaneBelowThreshold.resize(uNoOfVoxels);
+		m_vecPlaneCornerBits.resize(uWidth * uHeight);
+
+		readVolumeRegion(m_volData, Region(v3dLowerCorner, v3dUpperCorner), &m_vecPlaneVoxels[0]);
+		for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+		{
+			m_vecPlaneDensities[ct] = m_controller.convertToDensity(m_vecPlaneVoxels[ct]);
+		}
+		findDensitiesBelowThreshold(&m_vecPlaneDensities[0], uNoOfVoxels, m_tThreshold, &m_vecPlaneBelowThreshold[0]);
+
+		for(uint32_t uY = 0; uY < uHeight; uY++)
+		{
+			combineCornerBits(&m_vecPlaneBelowThreshold[uY * uPlaneWidth], &m_vecPlaneBelowThreshold[(uY + 1) * uPlaneWidth], uWidth, &m_vecPlaneCornerBits[uY * uWidth]);
+		}
+	}
+
 	template<typename VolumeType, typename Controller>
 	template<bool isPrevXAvail, bool isPrevYAvail, bool isPrevZAvail>
 	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeBitmaskForCell(const Array2DUint8& pPreviousBitmask, Array2DUint8& pCurrentBitmask, uint32_t uXRegSpace, uint32_t uYRegSpace)
@@ -435,7 +1041,7 @@ namespace PolyVox
 
 					float fInterp = static_cast<float>(m_tThreshold - m_controller.convertToDensity(v000)) / static_cast<float>(m_controller.convertToDensity(v100) - m_controller.convertToDensity(v000));
 
-					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX()) + fInterp, static_cast<float>(iYVolSpace - m_regSizeInVoxels.getLowerCorner().getY()), static_cast<float>(iZVolSpace - m_regSizeInCells.getLowerCorner().getZ()));
+					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_v3dMeshOrigin.getX()) + fInterp, static_cast<float>(iYVolSpace - m_v3dMeshOrigin.getY()), static_cast<float>(iZVolSpace - m_v3dMeshOrigin.getZ()));
 
 					Vector3DFloat v3dNormal = (n100*fInterp) + (n000*(1-fInterp));
 					v3dNormal.normalise();
@@ -461,7 +1067,7 @@ namespace PolyVox
 
 					float fInterp = static_cast<float>(m_tThreshold - m_controller.convertToDensity(v000)) / static_cast<float>(m_controller.convertToDensity(v010) - m_controller.convertToDensity(v000));
 
-					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX()), static_cast<float>(iYVolSpace - m_regSizeInVoxels.getLowerCorner().getY()) + fInterp, static_cast<float>(iZVolSpace - m_regSizeInVoxels.getLowerCorner().getZ()));
+					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_v3dMeshOrigin.getX()), static_cast<float>(iYVolSpace - m_v3dMeshOrigin.getY()) + fInterp, static_cast<float>(iZVolSpace - m_v3dMeshOrigin.getZ()));
 
 					Vector3DFloat v3dNormal = (n010*fInterp) + (n000*(1-fInterp));
 					v3dNormal.normalise();
@@ -487,7 +1093,7 @@ namespace PolyVox
 
 					float fInterp = static_cast<float>(m_tThreshold - m_controller.convertToDensity(v000)) / static_cast<float>(m_controller.convertToDensity(v001) - m_controller.convertToDensity(v000));
 
-					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_regSizeInVoxels.getLowerCorner().getX()), static_cast<float>(iYVolSpace - m_regSizeInVoxels.getLowerCorner().getY()), static_cast<float>(iZVolSpace - m_regSizeInVoxels.getLowerCorner().getZ()) + fInterp);
+					const Vector3DFloat v3dPosition(static_cast<float>(iXVolSpace - m_v3dMeshOrigin.getX()), static_cast<float>(iYVolSpace - m_v3dMeshOrigin.getY()), static_cast<float>(iZVolSpace - m_v3dMeshOrigin.getZ()) + fInterp);
 
 					Vector3DFloat v3dNormal = (n001*fInterp) + (n000*(1-fInterp));
 					v3dNormal.normalise();
@@ -619,4 +1225,336 @@ namespace PolyVox
 			}//For each cell
 		}
 	}
+
+	template<typename VolumeType, typename Controller>
+	bool MarchingCubesSurfaceExtractor<VolumeType, Controller>::hasTransitionFaces(void) const
+	{
+		return std::find(m_bTransitionFaces, m_bTransitionFaces + RegionFaces::NoOfFaces, true) != m_bTransitionFaces + RegionFaces::NoOfFaces;
+	}
+
+	template<typename VolumeType, typename Controller>
+	Vector3DFloat MarchingCubesSurfaceExtractor<VolumeType, Controller>::shrinkForTransitionCells(Vector3DFloat v3dPosition) const
+	{
+		//The transition cells take up this much of the layer of cells next to the face.
+		const float fTransitionCellWidth = 0.5f;
+
+		for(uint32_t uAxis = 0; uAxis < 3; uAxis++)
+		{
+			const float fLower = static_cast<float>(m_regSizeInVoxels.getLowerCorner().getElement(uAxis) - m_v3dMeshOrigin.getElement(uAxis));
+			const float fUpper = static_cast<float>(m_regSizeInVoxels.getUpperCorner().getElement(uAxis) - m_v3dMeshOrigin.getElement(uAxis));
+			float fPos = v3dPosition.getElement(uAxis);
+			if(m_bTransitionFaces[uAxis * 2] && (fPos < fLower + 1.0f))
+			{
+				fPos = fLower + fTransitionCellWidth + (fPos - fLower) * (1.0f - fTransitionCellWidth);
+			}
+			if(m_bTransitionFaces[uAxis * 2 + 1] && (fPos > fUpper - 1.0f))
+			{
+				fPos = fUpper - fTransitionCellWidth - (fUpper - fPos) * (1.0f - fTransitionCellWidth);
+			}
+			v3dPosition.setElement(uAxis, fPos);
+		}
+		return v3dPosition;
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::shrinkVerticesForTransitionCells(uint32_t uBeginVertex, uint32_t uEndVertex)
+	{
+		std::vector<PositionMaterialNormal>& vecVertices = m_meshCurrent->m_vecVertices;
+		for(uint32_t uVertex = uBeginVertex; uVertex < uEndVertex; uVertex++)
+		{
+			vecVertices[uVertex].setPosition(shrinkForTransitionCells(vecVertices[uVertex].getPosition()));
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::generateTransitionCells(void)
+	{
+		const Vector3DInt32& v3dLowerCorner = m_regSizeInVoxels.getLowerCorner();
+		const Vector3DInt32& v3dUpperCorner = m_regSizeInVoxels.getUpperCorner();
+
+		for(uint32_t uFace = 0; uFace < RegionFaces::NoOfFaces; uFace++)
+		{
+			if(!m_bTransitionFaces[uFace])
+			{
+				continue;
+			}
+
+			const uint32_t uAxis = uFace / 2;
+			const uint32_t uAxisU = (uAxis + 1) % 3;
+			const uint32_t uAxisV = (uAxis + 2) % 3;
+			const bool bPositiveFace = (uFace % 2) == 1;
+			assert((m_regSizeInVoxels.getDimensionsInCells().getElement(uAxisU) % 2 == 0) && (m_regSizeInVoxels.getDimensionsInCells().getElement(uAxisV) % 2 == 0));
+
+			Vector3DInt32 v3dCorner;
+			v3dCorner.setElement(uAxis, bPositiveFace ? v3dUpperCorner.getElement(uAxis) : v3dLowerCorner.getElement(uAxis));
+			for(int32_t iV = v3dLowerCorner.getElement(uAxisV); iV + 2 <= v3dUpperCorner.getElement(uAxisV); iV += 2)
+			{
+				v3dCorner.setElement(uAxisV, iV);
+				for(int32_t iU = v3dLowerCorner.getElement(uAxisU); iU + 2 <= v3dUpperCorner.getElement(uAxisU); iU += 2)
+				{
+					v3dCorner.setElement(uAxisU, iU);
+					generateTransitionCell(uAxis, bPositiveFace, v3dCorner);
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::generateTransitionCell(uint32_t uAxis, bool bPositiveFace, const Vector3DInt32& v3dCorner)
+	{
+		Vector3DInt32 v3dNormal(0,0,0);
+		Vector3DInt32 v3dU(0,0,0);
+		Vector3DInt32 v3dV(0,0,0);
+		v3dNormal.setElement(uAxis, 1);
+		v3dU.setElement((uAxis + 1) % 3, 1);
+		v3dV.setElement((uAxis + 2) % 3, 1);
+		const int32_t iPlane = v3dCorner.getElement(uAxis);
+
+		std::vector<TransitionEdge> vecEdges;
+		std::vector<TransitionSegment> vecSegments;
+
+		//The outline on the face comes from the four cells of this mesh next to it, and from the cell of the lower resolution mesh on the other side.
+		const Vector3DInt32 v3dCellOffset = bPositiveFace ? v3dNormal : Vector3DInt32(0,0,0);
+		for(int32_t iV = 0; iV < 2; iV++)
+		{
+			for(int32_t iU = 0; iU < 2; iU++)
+			{
+				addTransitionFaceSegments(v3dCorner + v3dU * iU + v3dV * iV - v3dCellOffset, 1, uAxis, iPlane, vecEdges, vecSegments);
+			}
+		}
+		addTransitionFaceSegments(bPositiveFace ? v3dCorner : v3dCorner - v3dNormal * 2, 2, uAxis, iPlane, vecEdges, vecSegments);
+
+		addTransitionSideSegment(v3dCorner, v3dU, vecEdges, vecSegments);
+		addTransitionSideSegment(v3dCorner + v3dV * 2, v3dU, vecEdges, vecSegments);
+		addTransitionSideSegment(v3dCorner, v3dV, vecEdges, vecSegments);
+		addTransitionSideSegment(v3dCorner + v3dU * 2, v3dV, vecEdges, vecSegments);
+
+		//Join the segments up into loops, starting from the ones which have a direction, and fill each loop with a fan of triangles.
+		std::vector<bool> vecSegmentUsed(vecSegments.size(), false);
+		std::vector<int32_t> vecVertexIndices(vecEdges.size(), -1);
+		std::vector<uint32_t> vecLoop;
+		for(uint32_t uFirstSegment = 0; uFirstSegment < vecSegments.size(); uFirstSegment++)
+		{
+			if(vecSegmentUsed[uFirstSegment] || !vecSegments[uFirstSegment].bDirected)
+			{
+				continue;
+			}
+			vecSegmentUsed[uFirstSegment] = true;
+
+			vecLoop.clear();
+			vecLoop.push_back(vecSegments[uFirstSegment].uStartEdge);
+			uint32_t uCurrentEdge = vecSegments[uFirstSegment].uEndEdge;
+			while(uCurrentEdge != vecLoop[0])
+			{
+				vecLoop.push_back(uCurrentEdge);
+
+				bool bFoundNext = false;
+				for(uint32_t uSegment = 0; uSegment < vecSegments.size(); uSegment++)
+				{
+					const TransitionSegment& segment = vecSegments[uSegment];
+					if(vecSegmentUsed[uSegment])
+					{
+						continue;
+					}
+					if(segment.uStartEdge == uCurrentEdge)
+					{
+						uCurrentEdge = segment.uEndEdge;
+					}
+					else if(!segment.bDirected && (segment.uEndEdge == uCurrentEdge))
+					{
+						uCurrentEdge = segment.uStartEdge;
+					}
+					else
+					{
+						continue;
+					}
+					vecSegmentUsed[uSegment] = true;
+					bFoundNext = true;
+					break;
+				}
+
+				//This shouldn't happen, as every vertex is on exactly two segments.
+				if(!bFoundNext)
+				{
+					assert(false);
+					vecLoop.clear();
+					break;
+				}
+			}
+
+			for(uint32_t uLoopEdge = 0; uLoopEdge < vecLoop.size(); uLoopEdge++)
+			{
+				if(vecVertexIndices[vecLoop[uLoopEdge]] == -1)
+				{
+					vecVertexIndices[vecLoop[uLoopEdge]] = m_meshCurrent->addVertex(computeTransitionVertex(vecEdges[vecLoop[uLoopEdge]]));
+				}
+			}
+			for(uint32_t uLoopEdge = 1; uLoopEdge + 1 < vecLoop.size(); uLoopEdge++)
+			{
+				m_meshCurrent->addTriangle(vecVertexIndices[vecLoop[0]], vecVertexIndices[vecLoop[uLoopEdge]], vecVertexIndices[vecLoop[uLoopEdge + 1]]);
+			}
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::addTransitionFaceSegments(const Vector3DInt32& v3dCubeLowerCorner, int32_t iStep, uint32_t uAxis, int32_t iPlane,
+		std::vector<TransitionEdge>& vecEdges, std::vector<TransitionSegment>& vecSegments)
+	{
+		Vector3DInt32 v3dCorners[8];
+		uint8_t iCubeIndex = 0;
+		for(uint32_t uCorner = 0; uCorner < 8; uCorner++)
+		{
+			v3dCorners[uCorner] = v3dCubeLowerCorner + Vector3DInt32(static_cast<int32_t>(uCorner & 1), static_cast<int32_t>((uCorner >> 1) & 1), static_cast<int32_t>((uCorner >> 2) & 1)) * iStep;
+			if(getDensityAt(v3dCorners[uCorner]) < m_tThreshold)
+			{
+				iCubeIndex |= (1 << uCorner);
+			}
+		}
+
+		//The sides of the triangles which lie in the plane. Ones which are shared by two triangles are inside the outline, so are removed.
+		//The triangles of the transition cell are on the other side of the outline, so go around it in the opposite direction.
+		const size_t uFirstSegment = vecSegments.size();
+		for(int i = 0; triTable[iCubeIndex][i] != -1; i++)
+		{
+			const int iEdge = triTable[iCubeIndex][i];
+			const int iNextEdge = triTable[iCubeIndex][(i % 3 == 2) ? i - 2 : i + 1];
+			const Vector3DInt32& v3dEdgeStart = v3dCorners[edgeCornersTable[iEdge][0]];
+			const Vector3DInt32& v3dEdgeEnd = v3dCorners[edgeCornersTable[iEdge][1]];
+			const Vector3DInt32& v3dNextEdgeStart = v3dCorners[edgeCornersTable[iNextEdge][0]];
+			const Vector3DInt32& v3dNextEdgeEnd = v3dCorners[edgeCornersTable[iNextEdge][1]];
+			if((v3dEdgeStart.getElement(uAxis) != iPlane) || (v3dEdgeEnd.getElement(uAxis) != iPlane) ||
+				(v3dNextEdgeStart.getElement(uAxis) != iPlane) || (v3dNextEdgeEnd.getElement(uAxis) != iPlane))
+			{
+				continue;
+			}
+
+			TransitionSegment segment;
+			segment.uStartEdge = findTransitionEdge(v3dNextEdgeStart, v3dNextEdgeEnd, vecEdges);
+			segment.uEndEdge = findTransitionEdge(v3dEdgeStart, v3dEdgeEnd, vecEdges);
+			segment.bDirected = true;
+
+			bool bShared = false;
+			for(size_t uSegment = uFirstSegment; uSegment < vecSegments.size(); uSegment++)
+			{
+				if((vecSegments[uSegment].uStartEdge == segment.uEndEdge) && (vecSegments[uSegment].uEndEdge == segment.uStartEdge))
+				{
+					vecSegments.erase(vecSegments.begin() + uSegment);
+					bShared = true;
+					break;
+				}
+			}
+			if(!bShared)
+			{
+				vecSegments.push_back(segment);
+			}
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	void MarchingCubesSurfaceExtractor<VolumeType, Controller>::addTransitionSideSegment(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dStep,
+		std::vector<TransitionEdge>& vecEdges, std::vector<TransitionSegment>& vecSegments)
+	{
+		//The side has three voxels of this mesh along it, and the two at the ends are also the lower resolution mesh's.
+		//So the outline either joins the vertex on one half of the side to the vertex on the lower resolution mesh's edge,
+		//or (when the middle voxel is on the other side of the surface to the ends) joins the vertices on the two halves.
+		const Vector3DInt32 v3dMiddle = v3dStart + v3dStep;
+		const Vector3DInt32 v3dEnd = v3dStart + v3dStep * 2;
+		const bool bStartBelow = getDensityAt(v3dStart) < m_tThreshold;
+		const bool bMiddleBelow = getDensityAt(v3dMiddle) < m_tThreshold;
+		const bool bEndBelow = getDensityAt(v3dEnd) < m_tThreshold;
+
+		TransitionSegment segment;
+		segment.bDirected = false;
+		if(bStartBelow != bEndBelow)
+		{
+			segment.uStartEdge = (bStartBelow != bMiddleBelow) ? findTransitionEdge(v3dStart, v3dMiddle, vecEdges) : findTransitionEdge(v3dMiddle, v3dEnd, vecEdges);
+			segment.uEndEdge = findTransitionEdge(v3dStart, v3dEnd, vecEdges);
+			vecSegments.push_back(segment);
+		}
+		else if(bStartBelow != bMiddleBelow)
+		{
+			segment.uStartEdge = findTransitionEdge(v3dStart, v3dMiddle, vecEdges);
+			segment.uEndEdge = findTransitionEdge(v3dMiddle, v3dEnd, vecEdges);
+			vecSegments.push_back(segment);
+		}
+	}
+
+	template<typename VolumeType, typename Controller>
+	uint32_t MarchingCubesSurfaceExtractor<VolumeType, Controller>::findTransitionEdge(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dEnd, std::vector<TransitionEdge>& vecEdges)
+	{
+		for(uint32_t uEdge = 0; uEdge < vecEdges.size(); uEdge++)
+		{
+			if((vecEdges[uEdge].v3dStart == v3dStart) && (vecEdges[uEdge].v3dEnd == v3dEnd))
+			{
+				return uEdge;
+			}
+		}
+
+		TransitionEdge edge;
+		edge.v3dStart = v3dStart;
+		edge.v3dEnd = v3dEnd;
+		vecEdges.push_back(edge);
+		return static_cast<uint32_t>(vecEdges.size() - 1);
+	}
+
+	template<typename VolumeType, typename Controller>
+	typename Controller::DensityType MarchingCubesSurfaceExtractor<VolumeType, Controller>::getDensityAt(const Vector3DInt32& v3dPos)
+	{
+		m_sampVolume.setPosition(v3dPos);
+		return m_controller.convertToDensity(m_sampVolume.getVoxel());
+	}
+
+	template<typename VolumeType, typename Controller>
+	PositionMaterialNormal MarchingCubesSurfaceExtractor<VolumeType, Controller>::computeTransitionVertex(const TransitionEdge& edge)
+	{
+		//This works out the vertex in the same way as generateVerticesForSlice(), so that it is exactly the same as the one in the
+		//mesh on either side. The normals on the lower resolution mesh's edges come from its voxels, which are two apart.
+		const Vector3DInt32 v3dDirection = edge.v3dEnd - edge.v3dStart;
+		const int32_t iLength = v3dDirection.getX() + v3dDirection.getY() + v3dDirection.getZ();
+		const Vector3DInt32 v3dStepX(iLength, 0, 0);
+		const Vector3DInt32 v3dStepY(0, iLength, 0);
+		const Vector3DInt32 v3dStepZ(0, 0, iLength);
+
+		m_sampVolume.setPosition(edge.v3dStart);
+		const typename VolumeType::VoxelType tStart = m_sampVolume.getVoxel();
+		m_sampVolume.setPosition(edge.v3dEnd);
+		const typename VolumeType::VoxelType tEnd = m_sampVolume.getVoxel();
+
+		const Vector3DFloat v3dStartNormal
+		(
+			static_cast<float>(getDensityAt(edge.v3dStart - v3dStepX)) - static_cast<float>(getDensityAt(edge.v3dStart + v3dStepX)),
+			static_cast<float>(getDensityAt(edge.v3dStart - v3dStepY)) - static_cast<float>(getDensityAt(edge.v3dStart + v3dStepY)),
+			static_cast<float>(getDensityAt(edge.v3dStart - v3dStepZ)) - static_cast<float>(getDensityAt(edge.v3dStart + v3dStepZ))
+		);
+		const Vector3DFloat v3dEndNormal
+		(
+			static_cast<float>(getDensityAt(edge.v3dEnd - v3dStepX)) - static_cast<float>(getDensityAt(edge.v3dEnd + v3dStepX)),
+			static_cast<float>(getDensityAt(edge.v3dEnd - v3dStepY)) - static_cast<float>(getDensityAt(edge.v3dEnd + v3dStepY)),
+			static_cast<float>(getDensityAt(edge.v3dEnd - v3dStepZ)) - static_cast<float>(getDensityAt(edge.v3dEnd + v3dStepZ))
+		);
+
+		float fInterp = static_cast<float>(m_tThreshold - m_controller.convertToDensity(tStart)) / static_cast<float>(m_controller.convertToDensity(tEnd) - m_controller.convertToDensity(tStart));
+
+		Vector3DFloat v3dPosition
+		(
+			static_cast<float>(edge.v3dStart.getX() - m_v3dMeshOrigin.getX()),
+			static_cast<float>(edge.v3dStart.getY() - m_v3dMeshOrigin.getY()),
+			static_cast<float>(edge.v3dStart.getZ() - m_v3dMeshOrigin.getZ())
+		);
+		const uint32_t uAxis = (v3dDirection.getX() != 0) ? 0 : ((v3dDirection.getY() != 0) ? 1 : 2);
+		v3dPosition.setElement(uAxis, v3dPosition.getElement(uAxis) + fInterp * static_cast<float>(iLength));
+
+		//Only the vertices on the edges of this mesh are moved, the lower resolution mesh's are where it put them.
+		if(iLength == 1)
+		{
+			v3dPosition = shrinkForTransitionCells(v3dPosition);
+		}
+
+		Vector3DFloat v3dNormal = (v3dEndNormal*fInterp) + (v3dStartNormal*(1-fInterp));
+		v3dNormal.normalise();
+
+		typename Controller::MaterialType uMaterial = (std::max)(m_controller.convertToMaterial(tStart), m_controller.convertToMaterial(tEnd));
+
+		return PositionMaterialNormal(v3dPosition, v3dNormal, static_cast<float>(uMaterial));
+	}
 }
@@ -0,0 +1,55 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_MortonRLECompressor_H__
+#define __PolyVox_MortonRLECompressor_H__
+
+#include "PolyVoxCore/RLECompressor.h"
+#include "PolyVoxCore/Impl/BlockLayout.h"
+
+namespace PolyVox
+{
+	/// Compresses blocks by run length encoding the voxels in Morton (Z-order) order.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The RLECompressor visits the voxels a row at a time, so a run is broken every time it reaches
+	/// the edge of the block even if the next row continues with the same value. Following a Morton
+	/// curve instead visits small cubes of neighbouring voxels together, so 3D features such as caves
+	/// and overhangs give much longer runs. The runs are stored in the same way as by the RLECompressor.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class MortonRLECompressor : public RLECompressor<VoxelType>
+	{
+	public:
+		void compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		void decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const;
+		VoxelType getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, uint32_t uIndex) const;
+		const char* getName(void) const;
+
+	private:
+		static uint32_t mortonToLinearIndex(uint32_t uMortonIndex, uint16_t uSideLength);
+	};
+}
+
+#include "PolyVoxCore/MortonRLECompressor.inl"
+
+#endif //__PolyVox_MortonRLECompressor_H__
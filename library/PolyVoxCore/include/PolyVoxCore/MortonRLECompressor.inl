@@ -0,0 +1,80 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	void MortonRLECompressor<VoxelType>::compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+	{
+		const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+		//Gather the voxels into Morton order and then encode them as usual.
+		std::vector<VoxelType> vecMortonOrdered(uNoOfVoxels);
+		for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+		{
+			vecMortonOrdered[ct] = pVoxels[mortonToLinearIndex(ct, uSideLength)];
+		}
+
+		this->encodeRuns(&vecMortonOrdered[0], uNoOfVoxels, vecCompressedData);
+	}
+
+	template <typename VoxelType>
+	void MortonRLECompressor<VoxelType>::decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const
+	{
+		const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+		std::vector<VoxelType> vecMortonOrdered(uNoOfVoxels);
+		this->decodeRuns(vecCompressedData, &vecMortonOrdered[0], uNoOfVoxels);
+
+		for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+		{
+			pVoxels[mortonToLinearIndex(ct, uSideLength)] = vecMortonOrdered[ct];
+		}
+	}
+
+	template <typename VoxelType>
+	VoxelType MortonRLECompressor<VoxelType>::getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, uint32_t uIndex) const
+	{
+		//The runs are in Morton order, so find where the voxel ended up.
+		const uint32_t uX = uIndex % uSideLength;
+		const uint32_t uY = (uIndex / uSideLength) % uSideLength;
+		const uint32_t uZ = uIndex / (uSideLength * uSideLength);
+		return this->decodeVoxel(vecCompressedData, encodeMortonIndex(uX, uY, uZ));
+	}
+
+	template <typename VoxelType>
+	const char* MortonRLECompressor<VoxelType>::getName(void) const
+	{
+		return "MortonRLE";
+	}
+
+	template <typename VoxelType>
+	uint32_t MortonRLECompressor<VoxelType>::mortonToLinearIndex(uint32_t uMortonIndex, uint16_t uSideLength)
+	{
+		//The bits of the Morton index are interleaved as ...zyxzyx, and the side length is a power of two.
+		const uint32_t uX = compactBits(uMortonIndex);
+		const uint32_t uY = compactBits(uMortonIndex >> 1);
+		const uint32_t uZ = compactBits(uMortonIndex >> 2);
+		return uX + uY * uSideLength + uZ * uSideLength * uSideLength;
+	}
+}
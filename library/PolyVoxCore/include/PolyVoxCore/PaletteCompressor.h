@@ -0,0 +1,66 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_PaletteCompressor_H__
+#define __PolyVox_PaletteCompressor_H__
+
+#include "PolyVoxCore/BlockCompressor.h"
+
+namespace PolyVox
+{
+	/// Compresses blocks by storing each distinct value once, followed by a bit-packed index per voxel.
+	////////////////////////////////////////////////////////////////////////////////
+	/// The indices use the smallest of 0, 1, 2, 4, 8 or 16 bits which can address the palette (or 32 for huge blocks), so a
+	/// block containing at most sixteen distinct values takes half a byte per voxel however they are
+	/// arranged, and a uniform block needs no indices at all. Unlike run length encoding the size
+	/// doesn't depend on how the values are arranged, which makes it a good fit for noisy data.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class PaletteCompressor : public BlockCompressor<VoxelType>
+	{
+	public:
+		void compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		void decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const;
+		void compressUniform(VoxelType tValue, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		VoxelType getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, uint32_t uIndex) const;
+		void visitRuns(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const;
+		const char* getName(void) const;
+
+		/// Gets the number of bits needed for each index into a palette of the given size.
+		static uint8_t getBitsPerIndex(uint32_t uPaletteSize);
+
+	private:
+		//The data starts with this header, followed by the palette values and then the indices.
+		struct Header
+		{
+			uint32_t uPaletteSize;
+			uint8_t uBitsPerIndex;
+		};
+
+		static uint32_t readIndex(const uint8_t* pIndices, uint32_t uVoxel, uint8_t uBitsPerIndex);
+	};
+}
+
+#include "PolyVoxCore/PaletteCompressor.inl"
+
+#endif //__PolyVox_PaletteCompressor_H__
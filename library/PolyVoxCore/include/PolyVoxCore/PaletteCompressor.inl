@@ -0,0 +1,200 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "PolyVoxCore/Impl/VoxelPalette.h"
+
+#include <cassert>
+#include <cstring> //For memcpy
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	void PaletteCompressor<VoxelType>::compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+	{
+		const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+		//Build the palette and find the index of every voxel.
+		VoxelPalette<VoxelType> palette;
+		std::vector<uint32_t> vecIndices(uNoOfVoxels);
+		for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+		{
+			vecIndices[ct] = palette.findOrAdd(pVoxels[ct]);
+		}
+
+		Header header;
+		header.uPaletteSize = palette.size();
+		header.uBitsPerIndex = getBitsPerIndex(header.uPaletteSize);
+
+		const uint32_t uPaletteOffset = sizeof(Header);
+		const uint32_t uIndicesOffset = uPaletteOffset + header.uPaletteSize * sizeof(VoxelType);
+		const uint32_t uIndicesSize = (uNoOfVoxels * header.uBitsPerIndex + 7) / 8;
+		vecCompressedData.assign(uIndicesOffset + uIndicesSize, 0);
+
+		memcpy(&vecCompressedData[0], &header, sizeof(Header));
+		for(uint32_t ct = 0; ct < header.uPaletteSize; ct++)
+		{
+			memcpy(&vecCompressedData[uPaletteOffset + ct * sizeof(VoxelType)], &palette.getValue(ct), sizeof(VoxelType));
+		}
+
+		//The bits per index always divide a byte evenly (or are a whole number of bytes) so an index never
+		//straddles two bytes in an awkward way. Indices are stored least significant bits first.
+		if(header.uBitsPerIndex > 0)
+		{
+			uint8_t* pIndices = &vecCompressedData[uIndicesOffset];
+			for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+			{
+				const uint32_t uBitOffset = ct * header.uBitsPerIndex;
+				if(header.uBitsPerIndex >= 8)
+				{
+					for(uint32_t uByte = 0; uByte < header.uBitsPerIndex / 8u; uByte++)
+					{
+						pIndices[uBitOffset / 8 + uByte] = static_cast<uint8_t>(vecIndices[ct] >> (uByte * 8));
+					}
+				}
+				else
+				{
+					pIndices[uBitOffset / 8] |= static_cast<uint8_t>(vecIndices[ct] << (uBitOffset % 8));
+				}
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	void PaletteCompressor<VoxelType>::decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const
+	{
+		const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+		Header header;
+		memcpy(&header, &vecCompressedData[0], sizeof(Header));
+
+		std::vector<VoxelType> vecPalette(header.uPaletteSize);
+		memcpy(&vecPalette[0], &vecCompressedData[sizeof(Header)], header.uPaletteSize * sizeof(VoxelType));
+
+		if(header.uBitsPerIndex == 0)
+		{
+			std::fill(pVoxels, pVoxels + uNoOfVoxels, vecPalette[0]);
+			return;
+		}
+
+		const uint8_t* pIndices = &vecCompressedData[sizeof(Header) + header.uPaletteSize * sizeof(VoxelType)];
+		for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+		{
+			const uint32_t uIndex = readIndex(pIndices, ct, header.uBitsPerIndex);
+			assert(uIndex < header.uPaletteSize);
+			pVoxels[ct] = vecPalette[uIndex];
+		}
+	}
+
+	template <typename VoxelType>
+	VoxelType PaletteCompressor<VoxelType>::getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t /*uSideLength*/, uint32_t uIndex) const
+	{
+		//The indices are all the same size, so the voxel's can be found directly.
+		Header header;
+		memcpy(&header, &vecCompressedData[0], sizeof(Header));
+
+		const uint8_t* pIndices = &vecCompressedData[sizeof(Header) + header.uPaletteSize * sizeof(VoxelType)];
+		const uint32_t uPaletteIndex = (header.uBitsPerIndex > 0) ? readIndex(pIndices, uIndex, header.uBitsPerIndex) : 0;
+		assert(uPaletteIndex < header.uPaletteSize);
+
+		VoxelType tValue;
+		memcpy(&tValue, &vecCompressedData[sizeof(Header) + uPaletteIndex * sizeof(VoxelType)], sizeof(VoxelType));
+		return tValue;
+	}
+
+	template <typename VoxelType>
+	void PaletteCompressor<VoxelType>::visitRuns(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const
+	{
+		const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+		Header header;
+		memcpy(&header, &vecCompressedData[0], sizeof(Header));
+
+		//Each palette entry is visited once, as a 'run' of all the voxels which use it.
+		std::vector<uint32_t> vecCounts(header.uPaletteSize, 0);
+		if(header.uBitsPerIndex == 0)
+		{
+			vecCounts[0] = uNoOfVoxels;
+		}
+		else
+		{
+			const uint8_t* pIndices = &vecCompressedData[sizeof(Header) + header.uPaletteSize * sizeof(VoxelType)];
+			for(uint32_t ct = 0; ct < uNoOfVoxels; ct++)
+			{
+				vecCounts[readIndex(pIndices, ct, header.uBitsPerIndex)]++;
+			}
+		}
+
+		for(uint32_t ct = 0; ct < header.uPaletteSize; ct++)
+		{
+			if(vecCounts[ct] > 0)
+			{
+				VoxelType tValue;
+				memcpy(&tValue, &vecCompressedData[sizeof(Header) + ct * sizeof(VoxelType)], sizeof(VoxelType));
+				funcVisitor(tValue, vecCounts[ct]);
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	void PaletteCompressor<VoxelType>::compressUniform(VoxelType tValue, uint16_t /*uSideLength*/, std::vector<uint8_t>& vecCompressedData) const
+	{
+		//A single palette entry and no indices.
+		Header header;
+		header.uPaletteSize = 1;
+		header.uBitsPerIndex = 0;
+
+		vecCompressedData.resize(sizeof(Header) + sizeof(VoxelType));
+		memcpy(&vecCompressedData[0], &header, sizeof(Header));
+		memcpy(&vecCompressedData[sizeof(Header)], &tValue, sizeof(VoxelType));
+	}
+
+	template <typename VoxelType>
+	const char* PaletteCompressor<VoxelType>::getName(void) const
+	{
+		return "Palette";
+	}
+
+	template <typename VoxelType>
+	uint8_t PaletteCompressor<VoxelType>::getBitsPerIndex(uint32_t uPaletteSize)
+	{
+		return VoxelPalette<VoxelType>::getBitsPerIndex(uPaletteSize);
+	}
+
+	template <typename VoxelType>
+	uint32_t PaletteCompressor<VoxelType>::readIndex(const uint8_t* pIndices, uint32_t uVoxel, uint8_t uBitsPerIndex)
+	{
+		const uint32_t uBitOffset = uVoxel * uBitsPerIndex;
+		if(uBitsPerIndex >= 8)
+		{
+			uint32_t uIndex = 0;
+			for(uint32_t uByte = 0; uByte < uBitsPerIndex / 8u; uByte++)
+			{
+				uIndex |= static_cast<uint32_t>(pIndices[uBitOffset / 8 + uByte]) << (uByte * 8);
+			}
+			return uIndex;
+		}
+
+		const uint32_t uIndexMask = (1u << uBitsPerIndex) - 1;
+		return (pIndices[uBitOffset / 8] >> (uBitOffset % 8)) & uIndexMask;
+	}
+}
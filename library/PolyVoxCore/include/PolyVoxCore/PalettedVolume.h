@@ -0,0 +1,209 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_PalettedVolume_H__
+#define __PolyVox_PalettedVolume_H__
+
+#include "Impl/PalettedBlock.h"
+#include "Impl/RegionCopy.h"
+#include "Impl/Utility.h"
+
+#include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/Log.h"
+#include "PolyVoxCore/Region.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <cassert>
+#include <cstdlib> //For abort()
+#include <limits>
+#include <memory>
+#include <stdexcept> //For invalid_argument
+
+namespace PolyVox
+{
+	/// A fixed size volume which stores each block as a palette and a small index per voxel.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The PalettedVolume is used in the same way as the SimpleVolume, but it takes advantage of the fact that most blocks only contain
+	/// a handful of distinct values. Each block keeps a list (the <i>palette</i>) of the values which occur in it, and then for each voxel
+	/// stores the position of its value in that list using as few bits as possible. A block containing a single value needs no per-voxel
+	/// storage at all, one with two values needs one bit per voxel, and one with up to sixteen values (for example most terrain stored as
+	/// MaterialDensityPair44) needs four. When a write introduces a value which doesn't fit, the block is widened to the next size up.
+	///
+	/// Unlike the compression used by the LargeVolume the data is never unpacked. Voxels are read and written in place, so memory use stays
+	/// low no matter how the volume is accessed. The cost is a few shifts and a palette lookup per access, and writes of a new value are
+	/// slower as they need to search the palette. The palette of a block only shrinks when the whole block is overwritten, so a block which
+	/// once held many values will stay wide even if most of them are later removed.
+	///
+	/// The Sampler keeps track of its block and its position within it, so moving and peeking within a block never needs to find the block
+	/// again. The border value is stored as a single value rather than as a block of data.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class PalettedVolume : public BaseVolume<VoxelType>
+	{
+	public:
+		#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< PalettedVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< PalettedVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			/// Construct a new Sampler
+			Sampler(PalettedVolume<VoxelType>* volume);
+			~Sampler();
+
+			Sampler& operator=(const Sampler& rhs);
+
+			VoxelType getSubSampledVoxel(uint8_t uLevel) const;
+			/// Get the value of the current voxel
+			inline VoxelType getVoxel(void) const;
+			
+			/// Set the current voxel position
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			/// Set the current voxel position
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			/// Set the value of the current voxel
+			inline bool setVoxel(VoxelType tValue);
+
+			/// Increase the \a x position by \a 1
+			void movePositiveX(void);
+			/// Increase the \a y position by \a 1
+			void movePositiveY(void);
+			/// Increase the \a z position by \a 1
+			void movePositiveZ(void);
+
+			/// Decrease the \a x position by \a 1
+			void moveNegativeX(void);
+			/// Decrease the \a y position by \a 1
+			void moveNegativeY(void);
+			/// Decrease the \a z position by \a 1
+			void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			inline VoxelType getVoxelInCurrentBlock(int32_t iOffset) const;
+
+			//The block containing the current position, or null if it is outside the volume.
+			PalettedBlock<VoxelType>* mCurrentBlock;
+			//The index of the current voxel within that block.
+			uint32_t mCurrentVoxelIndex;
+		};
+		#endif
+
+	public:
+		/// Constructor for creating a fixed size volume.
+		PalettedVolume(const Region& regValid, uint16_t uBlockSideLength = 32);
+
+		/// Destructor
+		~PalettedVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		VoxelType getBorderValue(void) const;
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(const VoxelType& tBorder);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		PalettedVolume(const PalettedVolume& rhs);
+
+		/// Assignment operator
+		PalettedVolume& operator=(const PalettedVolume& rhs);
+
+	private:	
+		void initialise(const Region& regValidRegion, uint16_t uBlockSideLength);
+
+		PalettedBlock<VoxelType>* getBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const;
+
+		//The block data
+		PalettedBlock<VoxelType>* m_pBlocks;
+
+		VoxelType m_tBorderValue;
+
+		//The size of the volume in vlocks
+		Region m_regValidRegionInBlocks;
+
+		//Volume size measured in blocks.
+		uint32_t m_uNoOfBlocksInVolume;
+		uint16_t m_uWidthInBlocks;
+		uint16_t m_uHeightInBlocks;
+		uint16_t m_uDepthInBlocks;
+
+		//The size of the blocks
+		uint32_t m_uNoOfVoxelsPerBlock;
+		uint16_t m_uBlockSideLength;
+		uint8_t m_uBlockSideLengthPower;
+	};
+}
+
+#include "PolyVoxCore/PalettedVolume.inl"
+#include "PolyVoxCore/PalettedVolumeSampler.inl"
+
+#endif //__PolyVox_PalettedVolume_H__
@@ -0,0 +1,405 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a volume with a fixed size which is specified as a parameter.
+	/// \param regValid Specifies the minimum and maximum valid voxel positions.
+	/// \param uBlockSideLength The size of the block to use within the volume. Larger blocks have less overhead but are more likely to need wide indices.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	PalettedVolume<VoxelType>::PalettedVolume(const Region& regValid, uint16_t uBlockSideLength)
+		:BaseVolume<VoxelType>(regValid)
+	{
+		//Create a volume of the right size.
+		initialise(regValid,uBlockSideLength);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	PalettedVolume<VoxelType>::PalettedVolume(const PalettedVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	PalettedVolume<VoxelType>::~PalettedVolume()
+	{
+		delete[] m_pBlocks;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	PalettedVolume<VoxelType>& PalettedVolume<VoxelType>::operator=(const PalettedVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType PalettedVolume<VoxelType>::getBorderValue(void) const
+	{
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType PalettedVolume<VoxelType>::getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)))
+		{
+			const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+			const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+			const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+			const uint16_t xOffset = static_cast<uint16_t>(uXPos - (blockX << m_uBlockSideLengthPower));
+			const uint16_t yOffset = static_cast<uint16_t>(uYPos - (blockY << m_uBlockSideLengthPower));
+			const uint16_t zOffset = static_cast<uint16_t>(uZPos - (blockZ << m_uBlockSideLengthPower));
+
+			return getBlock(blockX, blockY, blockZ)->getVoxelAt(xOffset,yOffset,zOffset);
+		}
+		else
+		{
+			return getBorderValue();
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType PalettedVolume<VoxelType>::getVoxelAt(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The indices of the voxels are packed, so unlike the other volumes this has to go voxel by voxel. It still
+	/// saves finding the block for each voxel.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PalettedVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value.
+			fillRegionPart(pDestination, regRead, regRead, getBorderValue());
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					const PalettedBlock<VoxelType>* pBlock = getBlock(x, y, z);
+					const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+					for(int32_t iZPos = regPart.getLowerCorner().getZ(); iZPos <= regPart.getUpperCorner().getZ(); iZPos++)
+					{
+						for(int32_t iYPos = regPart.getLowerCorner().getY(); iYPos <= regPart.getUpperCorner().getY(); iYPos++)
+						{
+							for(int32_t iXPos = regPart.getLowerCorner().getX(); iXPos <= regPart.getUpperCorner().getX(); iXPos++)
+							{
+								pDestination[getVoxelIndexInRegion(iXPos, iYPos, iZPos, regRead)] = pBlock->getVoxelAt(iXPos - v3dBlockLowerCorner.getX(), iYPos - v3dBlockLowerCorner.getY(), iZPos - v3dBlockLowerCorner.getZ());
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PalettedVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
+	{
+		m_tBorderValue = tBorder;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool PalettedVolume<VoxelType>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		assert(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
+
+		const int32_t blockX = uXPos >> m_uBlockSideLengthPower;
+		const int32_t blockY = uYPos >> m_uBlockSideLengthPower;
+		const int32_t blockZ = uZPos >> m_uBlockSideLengthPower;
+
+		const uint16_t xOffset = uXPos - (blockX << m_uBlockSideLengthPower);
+		const uint16_t yOffset = uYPos - (blockY << m_uBlockSideLengthPower);
+		const uint16_t zOffset = uZPos - (blockZ << m_uBlockSideLengthPower);
+
+		getBlock(blockX, blockY, blockZ)->setVoxelAt(xOffset,yOffset,zOffset, tValue);
+
+		//Return true to indicate that we modified a voxel.
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool PalettedVolume<VoxelType>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PalettedVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					PalettedBlock<VoxelType>* pBlock = getBlock(x, y, z);
+					const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+					for(int32_t iZPos = regPart.getLowerCorner().getZ(); iZPos <= regPart.getUpperCorner().getZ(); iZPos++)
+					{
+						for(int32_t iYPos = regPart.getLowerCorner().getY(); iYPos <= regPart.getUpperCorner().getY(); iYPos++)
+						{
+							for(int32_t iXPos = regPart.getLowerCorner().getX(); iXPos <= regPart.getUpperCorner().getX(); iXPos++)
+							{
+								pBlock->setVoxelAt(iXPos - v3dBlockLowerCorner.getX(), iYPos - v3dBlockLowerCorner.getY(), iZPos - v3dBlockLowerCorner.getZ(), pSource[getVoxelIndexInRegion(iXPos, iYPos, iZPos, regWrite)]);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. Blocks which are completely covered by
+	/// the region are reset to a palette holding just the new value.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PalettedVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					PalettedBlock<VoxelType>* pBlock = getBlock(x, y, z);
+					if(regPart == regBlock)
+					{
+						pBlock->fill(tValue);
+						continue;
+					}
+
+					const Vector3DInt32& v3dBlockLowerCorner = regBlock.getLowerCorner();
+					for(int32_t iZPos = regPart.getLowerCorner().getZ(); iZPos <= regPart.getUpperCorner().getZ(); iZPos++)
+					{
+						for(int32_t iYPos = regPart.getLowerCorner().getY(); iYPos <= regPart.getUpperCorner().getY(); iYPos++)
+						{
+							for(int32_t iXPos = regPart.getLowerCorner().getX(); iXPos <= regPart.getUpperCorner().getX(); iXPos++)
+							{
+								pBlock->setVoxelAt(iXPos - v3dBlockLowerCorner.getX(), iYPos - v3dBlockLowerCorner.getY(), iZPos - v3dBlockLowerCorner.getZ(), tValue);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should probably be made internal...
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PalettedVolume<VoxelType>::initialise(const Region& regValidRegion, uint16_t uBlockSideLength)
+	{
+		//Debug mode validation
+		assert(uBlockSideLength >= 8);
+		assert(uBlockSideLength <= 256);
+		assert(isPowerOf2(uBlockSideLength));
+		
+		//Release mode validation
+		if(uBlockSideLength < 8)
+		{
+			throw std::invalid_argument("Block side length should be at least 8");
+		}
+		if(uBlockSideLength > 256)
+		{
+			throw std::invalid_argument("Block side length should not be more than 256");
+		}
+		if(!isPowerOf2(uBlockSideLength))
+		{
+			throw std::invalid_argument("Block side length must be a power of two.");
+		}
+
+		this->m_regValidRegion = regValidRegion;
+		m_tBorderValue = VoxelType();
+
+		//Compute the block side length
+		m_uBlockSideLength = uBlockSideLength;
+		m_uBlockSideLengthPower = logBase2(m_uBlockSideLength);
+		m_uNoOfVoxelsPerBlock = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
+
+		m_regValidRegionInBlocks.setLowerCorner(Vector3DInt32(this->m_regValidRegion.getLowerCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getLowerCorner().getZ() >> m_uBlockSideLengthPower));
+		m_regValidRegionInBlocks.setUpperCorner(Vector3DInt32(this->m_regValidRegion.getUpperCorner().getX() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getY() >> m_uBlockSideLengthPower, this->m_regValidRegion.getUpperCorner().getZ() >> m_uBlockSideLengthPower));
+
+		//Compute the size of the volume in blocks (and note +1 at the end)
+		m_uWidthInBlocks = m_regValidRegionInBlocks.getUpperCorner().getX() - m_regValidRegionInBlocks.getLowerCorner().getX() + 1;
+		m_uHeightInBlocks = m_regValidRegionInBlocks.getUpperCorner().getY() - m_regValidRegionInBlocks.getLowerCorner().getY() + 1;
+		m_uDepthInBlocks = m_regValidRegionInBlocks.getUpperCorner().getZ() - m_regValidRegionInBlocks.getLowerCorner().getZ() + 1;
+		m_uNoOfBlocksInVolume = m_uWidthInBlocks * m_uHeightInBlocks * m_uDepthInBlocks;
+
+		//Allocate the data. Each block starts out uniform, so this doesn't need any per-voxel storage yet.
+		m_pBlocks = new PalettedBlock<VoxelType>[m_uNoOfBlocksInVolume];
+		for(uint32_t i = 0; i < m_uNoOfBlocksInVolume; ++i)
+		{
+			m_pBlocks[i].initialise(m_uBlockSideLength);
+		}
+
+		//Other properties we might find useful later
+		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_fDiagonalLength = sqrtf(static_cast<float>(this->getWidth() * this->getWidth() + this->getHeight() * this->getHeight() + this->getDepth() * this->getDepth()));
+	}
+
+	template <typename VoxelType>
+	PalettedBlock<VoxelType>* PalettedVolume<VoxelType>::getBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const
+	{
+		//The lower left corner of the volume could be
+		//anywhere, but array indices need to start at zero.
+		uBlockX -= m_regValidRegionInBlocks.getLowerCorner().getX();
+		uBlockY -= m_regValidRegionInBlocks.getLowerCorner().getY();
+		uBlockZ -= m_regValidRegionInBlocks.getLowerCorner().getZ();
+
+		//Compute the block index
+		uint32_t uBlockIndex =
+				uBlockX + 
+				uBlockY * m_uWidthInBlocks + 
+				uBlockZ * m_uWidthInBlocks * m_uHeightInBlocks;
+
+		//Return the block
+		return &(m_pBlocks[uBlockIndex]);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Unlike the SimpleVolume this depends on the data, as each block only uses as many bits per voxel as its palette requires.
+	///
+	/// \return The number of bytes used
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t PalettedVolume<VoxelType>::calculateSizeInBytes(void)
+	{
+		uint32_t uSizeInBytes = sizeof(PalettedVolume);
+
+		for(uint32_t i = 0; i < m_uNoOfBlocksInVolume; ++i)
+		{
+			uSizeInBytes += m_pBlocks[i].calculateSizeInBytes();
+		}
+
+		return uSizeInBytes;
+	}
+}
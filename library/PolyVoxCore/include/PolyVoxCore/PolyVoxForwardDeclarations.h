@@ -80,11 +80,21 @@ namespace PolyVox
 	typedef DensityU8 Density8; //Backwards compatibility
 	typedef DensityU16 Density16; //Backwards compatibility
 
+	////////////////////////////////////////////////////////////////////////////////
+	// FixedRawVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint32_t Width, uint32_t Height, uint32_t Depth> class FixedRawVolume;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// LargeVolume
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType> class LargeVolume;
 
+	////////////////////////////////////////////////////////////////////////////////
+	// MappedVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType> class MappedVolume;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// Material
 	////////////////////////////////////////////////////////////////////////////////
@@ -106,6 +116,11 @@ namespace PolyVox
 	typedef MaterialDensityPair<uint8_t, 4, 4> MaterialDensityPair44;
 	typedef MaterialDensityPair<uint16_t, 8, 8> MaterialDensityPair88;
 
+	////////////////////////////////////////////////////////////////////////////////
+	// PalettedVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType> class PalettedVolume;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// PositionMaterial
 	////////////////////////////////////////////////////////////////////////////////
@@ -131,6 +146,16 @@ namespace PolyVox
 	////////////////////////////////////////////////////////////////////////////////
 	template<typename VolumeType, typename Controller> class MarchingCubesSurfaceExtractor;
 
+	////////////////////////////////////////////////////////////////////////////////
+	// SimpleVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType> class SimpleVolume;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// SparseVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType> class SparseVolume;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// SurfaceMesh
 	////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_RLECompressor_H__
+#define __PolyVox_RLECompressor_H__
+
+#include "PolyVoxCore/BlockCompressor.h"
+#include "PolyVoxCore/Impl/VoxelRuns.h"
+
+namespace PolyVox
+{
+	/// Compresses blocks by run length encoding the voxels in the order they are stored (x, then y, then z).
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is the scheme which the LargeVolume has always used, and it remains the default. Each run
+	/// is stored as a 16-bit length followed by the value. See BlockCompressor for the alternatives.
+	///
+	/// The runs are followed by a small index giving the position of the first voxel in every 32nd run, so
+	/// that getVoxelAt() can binary search for the right part of the data rather than adding up the lengths
+	/// of all the runs before the voxel it wants.
+	///
+	/// For voxels of one, two or four bytes the runs are found and expanded with SSE2 (or AVX2, if the compiler
+	/// is targeting it) sixteen or thirty-two bytes at a time, which matters a lot when the block cache is thrashing.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class RLECompressor : public BlockCompressor<VoxelType>
+	{
+	public:
+		void compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		void decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const;
+		void compressUniform(VoxelType tValue, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const;
+		VoxelType getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, uint32_t uIndex) const;
+		void visitRuns(const std::vector<uint8_t>& vecCompressedData, uint16_t uSideLength, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const;
+		const char* getName(void) const;
+
+	protected:
+		struct RunlengthEntry
+		{
+			uint16_t length;
+			VoxelType value;
+		};
+
+		//The encoding itself, shared with the MortonRLECompressor which just visits the voxels in a different order.
+		static void encodeRuns(const VoxelType* pVoxels, uint32_t uNoOfVoxels, std::vector<uint8_t>& vecCompressedData);
+		static void decodeRuns(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint32_t uNoOfVoxels);
+		static VoxelType decodeVoxel(const std::vector<uint8_t>& vecCompressedData, uint32_t uIndex);
+		static void appendRun(const RunlengthEntry& entry, std::vector<uint8_t>& vecCompressedData);
+
+	private:
+		//The index is stored after the runs, followed by the number of runs.
+		static const uint32_t uRunsPerIndexEntry = 32;
+		static void appendRunIndex(uint32_t uNoOfRuns, std::vector<uint8_t>& vecCompressedData);
+		static uint32_t getNoOfRuns(const std::vector<uint8_t>& vecCompressedData);
+		static uint32_t getIndexEntry(const std::vector<uint8_t>& vecCompressedData, uint32_t uNoOfRuns, uint32_t uIndexEntry);
+		static RunlengthEntry getRun(const std::vector<uint8_t>& vecCompressedData, uint32_t uRun);
+	};
+}
+
+#include "PolyVoxCore/RLECompressor.inl"
+
+#endif //__PolyVox_RLECompressor_H__
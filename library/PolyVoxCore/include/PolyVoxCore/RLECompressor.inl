@@ -0,0 +1,222 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstring> //For memcpy
+#include <limits>
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::compress(const VoxelType* pVoxels, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+	{
+		encodeRuns(pVoxels, uSideLength * uSideLength * uSideLength, vecCompressedData);
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::decompress(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint16_t uSideLength) const
+	{
+		decodeRuns(vecCompressedData, pVoxels, uSideLength * uSideLength * uSideLength);
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::compressUniform(VoxelType tValue, uint16_t uSideLength, std::vector<uint8_t>& vecCompressedData) const
+	{
+		vecCompressedData.clear();
+
+		uint32_t uNoOfRuns = 0;
+		uint32_t uNoOfVoxelsRemaining = uSideLength * uSideLength * uSideLength;
+		while(uNoOfVoxelsRemaining > 0)
+		{
+			RunlengthEntry entry;
+			entry.length = static_cast<uint16_t>((std::min)(uNoOfVoxelsRemaining, static_cast<uint32_t>((std::numeric_limits<uint16_t>::max)())));
+			entry.value = tValue;
+			appendRun(entry, vecCompressedData);
+			uNoOfVoxelsRemaining -= entry.length;
+			uNoOfRuns++;
+		}
+
+		appendRunIndex(uNoOfRuns, vecCompressedData);
+	}
+
+	template <typename VoxelType>
+	VoxelType RLECompressor<VoxelType>::getVoxelAt(const std::vector<uint8_t>& vecCompressedData, uint16_t /*uSideLength*/, uint32_t uIndex) const
+	{
+		return decodeVoxel(vecCompressedData, uIndex);
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::visitRuns(const std::vector<uint8_t>& vecCompressedData, uint16_t /*uSideLength*/, polyvox_function<void(const VoxelType&, uint32_t)> funcVisitor) const
+	{
+		const uint32_t uNoOfRuns = getNoOfRuns(vecCompressedData);
+		for(uint32_t uRun = 0; uRun < uNoOfRuns; uRun++)
+		{
+			const RunlengthEntry entry = getRun(vecCompressedData, uRun);
+			funcVisitor(entry.value, entry.length);
+		}
+	}
+
+	template <typename VoxelType>
+	const char* RLECompressor<VoxelType>::getName(void) const
+	{
+		return "RLE";
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::encodeRuns(const VoxelType* pVoxels, uint32_t uNoOfVoxels, std::vector<uint8_t>& vecCompressedData)
+	{
+		vecCompressedData.clear();
+
+		uint32_t uNoOfRuns = 0;
+		uint32_t ct = 0;
+		while(ct < uNoOfVoxels)
+		{
+			//Runs which are too long for the 16-bit length are split.
+			const uint32_t uMaxLength = (std::min)(uNoOfVoxels - ct, static_cast<uint32_t>((std::numeric_limits<uint16_t>::max)()));
+
+			RunlengthEntry entry;
+			entry.value = pVoxels[ct];
+			entry.length = static_cast<uint16_t>(findRunLength(pVoxels + ct, uMaxLength));
+			appendRun(entry, vecCompressedData);
+			ct += entry.length;
+			uNoOfRuns++;
+		}
+
+		appendRunIndex(uNoOfRuns, vecCompressedData);
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::decodeRuns(const std::vector<uint8_t>& vecCompressedData, VoxelType* pVoxels, uint32_t uNoOfVoxels)
+	{
+		const uint32_t uNoOfRuns = getNoOfRuns(vecCompressedData);
+
+		VoxelType* pVoxel = pVoxels;
+		for(uint32_t uRun = 0; uRun < uNoOfRuns; uRun++)
+		{
+			const RunlengthEntry entry = getRun(vecCompressedData, uRun);
+			fillRun(pVoxel, entry.length, entry.value);
+			pVoxel += entry.length;
+		}
+
+		assert(pVoxel == pVoxels + uNoOfVoxels);
+	}
+
+	template <typename VoxelType>
+	VoxelType RLECompressor<VoxelType>::decodeVoxel(const std::vector<uint8_t>& vecCompressedData, uint32_t uIndex)
+	{
+		const uint32_t uNoOfRuns = getNoOfRuns(vecCompressedData);
+		const uint32_t uNoOfIndexEntries = (uNoOfRuns + uRunsPerIndexEntry - 1) / uRunsPerIndexEntry;
+
+		//Find the last index entry which starts at or before the voxel. The first one always starts at zero.
+		uint32_t uLower = 0;
+		uint32_t uUpper = uNoOfIndexEntries;
+		while(uUpper - uLower > 1)
+		{
+			const uint32_t uMiddle = (uLower + uUpper) / 2;
+			if(getIndexEntry(vecCompressedData, uNoOfRuns, uMiddle) <= uIndex)
+			{
+				uLower = uMiddle;
+			}
+			else
+			{
+				uUpper = uMiddle;
+			}
+		}
+
+		//Then walk along the runs which it covers.
+		uint32_t uEndOfRun = getIndexEntry(vecCompressedData, uNoOfRuns, uLower);
+		for(uint32_t uRun = uLower * uRunsPerIndexEntry; uRun < uNoOfRuns; uRun++)
+		{
+			const RunlengthEntry entry = getRun(vecCompressedData, uRun);
+			uEndOfRun += entry.length;
+			if(uIndex < uEndOfRun)
+			{
+				return entry.value;
+			}
+		}
+
+		assert(false); //The index is past the end of the block.
+		return VoxelType();
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::appendRun(const RunlengthEntry& entry, std::vector<uint8_t>& vecCompressedData)
+	{
+		//The entries are copied in as raw bytes, so the data has no alignment requirements.
+		const size_t uOffset = vecCompressedData.size();
+		vecCompressedData.resize(uOffset + sizeof(RunlengthEntry));
+		memcpy(&vecCompressedData[uOffset], &entry, sizeof(RunlengthEntry));
+	}
+
+	template <typename VoxelType>
+	void RLECompressor<VoxelType>::appendRunIndex(uint32_t uNoOfRuns, std::vector<uint8_t>& vecCompressedData)
+	{
+		assert(vecCompressedData.size() == uNoOfRuns * sizeof(RunlengthEntry));
+
+		const uint32_t uNoOfIndexEntries = (uNoOfRuns + uRunsPerIndexEntry - 1) / uRunsPerIndexEntry;
+		const size_t uIndexOffset = vecCompressedData.size();
+		//Reserve the exact size, so that adding the index doesn't double the capacity of a vector which was nearly full.
+		vecCompressedData.reserve(uIndexOffset + (uNoOfIndexEntries + 1) * sizeof(uint32_t));
+		vecCompressedData.resize(uIndexOffset + (uNoOfIndexEntries + 1) * sizeof(uint32_t));
+
+		uint32_t uStartOfRun = 0;
+		for(uint32_t uRun = 0; uRun < uNoOfRuns; uRun++)
+		{
+			if(uRun % uRunsPerIndexEntry == 0)
+			{
+				memcpy(&vecCompressedData[uIndexOffset + (uRun / uRunsPerIndexEntry) * sizeof(uint32_t)], &uStartOfRun, sizeof(uint32_t));
+			}
+			uStartOfRun += getRun(vecCompressedData, uRun).length;
+		}
+
+		memcpy(&vecCompressedData[vecCompressedData.size() - sizeof(uint32_t)], &uNoOfRuns, sizeof(uint32_t));
+	}
+
+	template <typename VoxelType>
+	uint32_t RLECompressor<VoxelType>::getNoOfRuns(const std::vector<uint8_t>& vecCompressedData)
+	{
+		assert(vecCompressedData.size() >= sizeof(uint32_t));
+
+		uint32_t uNoOfRuns;
+		memcpy(&uNoOfRuns, &vecCompressedData[vecCompressedData.size() - sizeof(uint32_t)], sizeof(uint32_t));
+		assert(vecCompressedData.size() == uNoOfRuns * sizeof(RunlengthEntry) + ((uNoOfRuns + uRunsPerIndexEntry - 1) / uRunsPerIndexEntry + 1) * sizeof(uint32_t));
+		return uNoOfRuns;
+	}
+
+	template <typename VoxelType>
+	uint32_t RLECompressor<VoxelType>::getIndexEntry(const std::vector<uint8_t>& vecCompressedData, uint32_t uNoOfRuns, uint32_t uIndexEntry)
+	{
+		uint32_t uStartOfRun;
+		memcpy(&uStartOfRun, &vecCompressedData[uNoOfRuns * sizeof(RunlengthEntry) + uIndexEntry * sizeof(uint32_t)], sizeof(uint32_t));
+		return uStartOfRun;
+	}
+
+	template <typename VoxelType>
+	typename RLECompressor<VoxelType>::RunlengthEntry RLECompressor<VoxelType>::getRun(const std::vector<uint8_t>& vecCompressedData, uint32_t uRun)
+	{
+		RunlengthEntry entry;
+		memcpy(&entry, &vecCompressedData[uRun * sizeof(RunlengthEntry)], sizeof(RunlengthEntry));
+		return entry;
+	}
+}
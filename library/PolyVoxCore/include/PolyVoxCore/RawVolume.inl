@@ -123,6 +123,31 @@ namespace PolyVox
 		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Each row of voxels is copied with a single std::copy().
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void RawVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value.
+			fillRegionPart(pDestination, regRead, regRead, this->getBorderValue());
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		copyRegionPart(m_pData, this->m_regValidRegion, pDestination, regRead, regCropped);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// \param tBorder The value to use for voxels outside the volume.
 	////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +201,44 @@ namespace PolyVox
 		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void RawVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		copyRegionPart(pSource, regWrite, m_pData, this->m_regValidRegion, regCropped);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void RawVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		fillRegionPart(m_pData, this->m_regValidRegion, regCropped, tValue);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// This function should probably be made internal...
 	////////////////////////////////////////////////////////////////////////////////
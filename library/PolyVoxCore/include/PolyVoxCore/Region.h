@@ -98,6 +98,8 @@ namespace PolyVox
 		bool containsPointInZ(float pos, float boundary = 0.0f) const;
 		bool containsPointInZ(int32_t pos, uint8_t boundary = 0) const;
 		void cropTo(const Region& other);
+		/// Tests whether the region contains any voxels, which it doesn't if (for example) it was cropped to a region it didn't intersect.
+		bool isValid(void) const;
 		/// Deprecated and misleading
 		POLYVOX_DEPRECATED int32_t depth(void) const;
 		/// Deprecated and misleading
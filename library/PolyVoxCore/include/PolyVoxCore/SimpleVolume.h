@@ -24,7 +24,12 @@ freely, subject to the following restrictions:
 #ifndef __PolyVox_SimpleVolume_H__
 #define __PolyVox_SimpleVolume_H__
 
+#include "Impl/BlockLayout.h"
+#include "Impl/BorderMode.h"
+#include "Impl/DensityRange.h"
+#include "Impl/RegionCopy.h"
 #include "Impl/Utility.h"
+#include "Impl/VoxelRuns.h"
 
 #include "PolyVoxCore/BaseVolume.h"
 #include "PolyVoxCore/Log.h"
@@ -37,6 +42,7 @@ freely, subject to the following restrictions:
 #include <limits>
 #include <memory>
 #include <stdexcept> //For invalid_argument
+#include <vector>
 
 namespace PolyVox
 {
@@ -61,12 +67,33 @@ namespace PolyVox
 
 			void fill(VoxelType tValue);
 			void initialise(uint16_t uSideLength);
+			void shareData(Block& rhs);
 			uint32_t calculateSizeInBytes(void);
 
+			bool isUniform(void) const;
+			DensityRange<VoxelType> calculateDensityRange(void) const;
+
+			void setLayout(BlockLayout eLayout);
+
+			//Gives the block voxels which it can write to, allocating them if it is uniform.
+			void makeDataWritable(void);
+			//Gives the block its own copy of its voxels if they are shared with a snapshot.
+			void makeDataUnique(void);
+			void releaseData(void);
+
 		public:
+			//Null while every voxel in the block has the same value (m_tUniformValue). The voxels are
+			//only allocated when one of them is set to something else, and freed again by fill().
 			VoxelType* m_tUncompressedData;
+			//Null unless the voxels have been shared with a snapshot, in which case it counts the blocks
+			//using them. The last of those blocks to let go of the voxels frees them (and the count).
+			polyvox_atomic<uint32_t>* m_pDataRefCount;
+			VoxelType m_tUniformValue;
+			//Calculated when it is first needed, and invalidated whenever the voxels may have been modified.
+			mutable DensityRange<VoxelType> m_rangeDensities;
 			uint16_t m_uSideLength;
 			uint8_t m_uSideLengthPower;	
+			BlockLayout m_eLayout;
 		};
 
 		//There seems to be some descrepency between Visual Studio and GCC about how the following class should be declared.
@@ -145,8 +172,32 @@ namespace PolyVox
 			inline VoxelType peekVoxel1px1py1pz(void) const;
 
 		private:			
+			//Reads a neighbouring voxel which the Linear fast path in the peek functions couldn't, from within the
+			//current block if it uses the Morton layout and from the volume otherwise.
+			template <int iXOffset, int iYOffset, int iZOffset>
+			inline VoxelType peekNeighbourVoxel(void) const;
+
 			//Other current position information
 			VoxelType* mCurrentVoxel;
+
+			//The voxels of the current block (which may be shared, as described below), and the index of the current
+			//voxel within them. The index is only kept up to date with the Morton layout.
+			VoxelType* mCurrentBlockVoxels;
+			uint32_t mCurrentVoxelIndex;
+
+			//The block containing the current voxel, or null when the Sampler is outside the volume and reading
+			//the border data. If the block is uniform then mCurrentVoxel points at some shared data instead.
+			Block* mCurrentBlock;
+
+			//The size of the block which the Sampler can move around in using pointer arithmetic. Outside a volume
+			//which is clamped or wrapped, or in a uniform block when the volume has no uniform block data for its
+			//value, this is a single voxel, so that every move and peek goes to the volume.
+			uint16_t mBlockSideLength;
+			uint8_t mBlockSideLengthPower;
+
+			//The size of the current block if it uses the Morton layout, otherwise zero. The block side length
+			//above is then a single voxel, so that the moves and peeks always take their slow paths.
+			uint16_t mMortonBlockSideLength;
 		};
 		#endif
 
@@ -159,17 +210,42 @@ namespace PolyVox
 
 		/// Gets the value used for voxels which are outside the volume
 		VoxelType getBorderValue(void) const;
+		/// Gets what is read from the voxels which are outside the volume
+		BorderMode getBorderMode(void) const;
 		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
 		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
 		/// Gets a voxel at the position given by a 3D vector
 		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
 
 		/// Sets the value used for voxels which are outside the volume
 		void setBorderValue(const VoxelType& tBorder);
+		/// Sets what is read from the voxels which are outside the volume
+		void setBorderMode(BorderMode eMode);
 		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
 		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
 		/// Sets the voxel at the position given by a 3D vector
 		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+		/// Sets the order in which the voxels of each block are stored in memory
+		void setBlockLayout(BlockLayout eLayout);
+
+		/// Gets the length of the sides of the blocks making up the volume
+		uint16_t getBlockSideLength(void) const;
+		/// Gets the order in which the voxels of each block are stored in memory
+		BlockLayout getBlockLayout(void) const;
+		/// Gets whether every voxel in the given block has the same value
+		bool isBlockUniform(const Vector3DInt32& v3dBlockPos) const;
+		/// Finds the smallest and largest densities in a region, using the summary kept for each block
+		template <typename DensityType>
+		bool calculateDensityRange(const Region& region, DensityType& tMin, DensityType& tMax) const;
+
+		/// Creates a copy of the volume which shares its voxels with this one until either is modified
+		polyvox_shared_ptr< SimpleVolume<VoxelType> > snapshot(void);
 
 		/// Calculates approximatly how many bytes of memory the volume is currently using.
 		uint32_t calculateSizeInBytes(void);
@@ -182,18 +258,34 @@ namespace PolyVox
 		SimpleVolume& operator=(const SimpleVolume& rhs);
 
 	private:	
+		//The number of distinct values for which uniform block data is kept (see getUniformBlockData()).
+		static const uint32_t uMaxNoOfUniformBlockData = 16;
+
 		void initialise(const Region& regValidRegion, uint16_t uBlockSideLength);
 
 		Block* getUncompressedBlock(int32_t uBlockX, int32_t uBlockY, int32_t uBlockZ) const;
+		VoxelType getBorderVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		VoxelType* getUniformBlockData(const VoxelType& tValue) const;
 
 		//The block data
 		Block* m_pBlocks;
 
-		//We don't store an actual Block for the border, just the uncompressed data. This is partly because the border
-		//block does not have a position (so can't be passed to getUncompressedBlock()) and partly because there's a
-		//good chance we'll often hit it anyway. It's a chunk of homogenous data (rather than a single value) so that
-		//the VolumeIterator can do it's usual pointer arithmetic without needing to know it's gone outside the volume.
-		VoxelType* m_pUncompressedBorderData;
+		//We don't store any voxels for the border. With the Constant mode a Sampler outside the volume uses the
+		//same (read only) data as a uniform block with the border value, so it can still do its usual pointer
+		//arithmetic. With the other modes it reads the voxels inside the volume which the border maps on to.
+		VoxelType m_tBorderValue;
+		BorderMode m_eBorderMode;
+
+		//Uniform blocks don't have any voxels of their own, so for the Samplers' pointer arithmetic we keep an
+		//array filled with the value for each value they have needed, up to uMaxNoOfUniformBlockData of them.
+		//These are only freed with the volume. Entries are never changed once the count includes them, so they
+		//can be read without a lock. The mutex is only taken to add a new one.
+		mutable VoxelType* m_pUniformBlockData[uMaxNoOfUniformBlockData];
+		mutable polyvox_atomic<uint32_t> m_uNoOfUniformBlockData;
+		mutable polyvox_mutex m_mutexUniformBlockData;
+
+		//The blocks' density ranges are calculated on demand, possibly by several extractors at once.
+		mutable polyvox_mutex m_mutexDensityRanges;
 
 		//The size of the volume in vlocks
 		Region m_regValidRegionInBlocks;
@@ -208,6 +300,7 @@ namespace PolyVox
 		uint32_t m_uNoOfVoxelsPerBlock;
 		uint16_t m_uBlockSideLength;
 		uint8_t m_uBlockSideLengthPower;
+		BlockLayout m_eBlockLayout;
 	};
 }
 
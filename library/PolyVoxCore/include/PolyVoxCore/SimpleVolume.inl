@@ -56,7 +56,11 @@ namespace PolyVox
 	SimpleVolume<VoxelType>::~SimpleVolume()
 	{
 		delete[] m_pBlocks;
-		delete[] m_pUncompressedBorderData;
+
+		for(uint32_t ct = 0; ct < m_uNoOfUniformBlockData; ct++)
+		{
+			delete[] m_pUniformBlockData[ct];
+		}
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -80,7 +84,16 @@ namespace PolyVox
 	template <typename VoxelType>
 	VoxelType SimpleVolume<VoxelType>::getBorderValue(void) const
 	{
-		return *m_pUncompressedBorderData;
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return What is read from the voxels which are outside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	BorderMode SimpleVolume<VoxelType>::getBorderMode(void) const
+	{
+		return m_eBorderMode;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -108,7 +121,7 @@ namespace PolyVox
 		}
 		else
 		{
-			return getBorderValue();
+			return getBorderVoxelAt(uXPos, uYPos, uZPos);
 		}
 	}
 
@@ -123,14 +136,84 @@ namespace PolyVox
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels are copied block by block, a row at a time. Uniform blocks are just filled in with their value.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value, or read from where they map on to.
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				fillRegionPart(pDestination, regRead, regRead, getBorderValue());
+			}
+			else
+			{
+				readRegionOutside(this, pDestination, regRead, regCropped);
+			}
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					const Block* pBlock = getUncompressedBlock(x, y, z);
+					if(pBlock->m_tUncompressedData)
+					{
+						copyBlockToRegion(pBlock->m_tUncompressedData, regBlock, pBlock->m_eLayout, pDestination, regRead, regPart);
+					}
+					else
+					{
+						fillRegionPart(pDestination, regRead, regPart, pBlock->m_tUniformValue);
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is only read while the border mode is BorderModes::Constant, which is the default. It is
+	/// kept when the mode is changed, and carried over to any snapshot() of the volume.
 	/// \param tBorder The value to use for voxels outside the volume.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	void SimpleVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
 	{
-		/*Block<VoxelType>* pUncompressedBorderBlock = getUncompressedBlock(&m_pBorderBlock);
-		return pUncompressedBorderBlock->fill(tBorder);*/
-		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uNoOfVoxelsPerBlock, tBorder);
+		m_tBorderValue = tBorder;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// By default every voxel outside the volume has the border value. The volume can instead be clamped, so that
+	/// they have the value of the nearest voxel on its edge, or wrapped, so that it repeats in every direction.
+	/// Either way the voxels outside the volume can't be written to.
+	///
+	/// Only reads which are outside the volume have to check the mode, so it doesn't slow down those inside it.
+	/// Note that a Sampler reads the voxels in the blocks along the edge of the volume directly, so if the sides of the
+	/// volume aren't a multiple of the block side length it will see the voxels of those blocks which are outside it.
+	/// \param eMode What to read from the voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::setBorderMode(BorderMode eMode)
+	{
+		m_eBorderMode = eMode;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -172,6 +255,100 @@ namespace PolyVox
 		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					Block* pBlock = getUncompressedBlock(x, y, z);
+					pBlock->makeDataWritable();
+					copyRegionToBlock(pSource, regWrite, pBlock->m_tUncompressedData, regBlock, pBlock->m_eLayout, regPart);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. Blocks which are completely
+	/// covered by the region become uniform and so their voxels are freed, which means that any Samplers should
+	/// be repositioned (with setPosition()) before being used again.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regBlock = getRegionOfBlock(x, y, z, m_uBlockSideLengthPower);
+					Region regPart(regBlock);
+					regPart.cropTo(regCropped);
+
+					Block* pBlock = getUncompressedBlock(x, y, z);
+					if(regPart == regBlock)
+					{
+						pBlock->fill(tValue);
+					}
+					else if((pBlock->m_tUncompressedData != 0) || (pBlock->m_tUniformValue != tValue))
+					{
+						pBlock->makeDataWritable();
+						fillBlockPart(pBlock->m_tUncompressedData, regBlock, pBlock->m_eLayout, regPart, tValue);
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// See LargeVolume::setBlockLayout() for a description of the layouts. The existing blocks are
+	/// rearranged straight away, so this must not be called while any Samplers exist.
+	/// \param eLayout The order in which to store the voxels of each block.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::setBlockLayout(BlockLayout eLayout)
+	{
+		m_eBlockLayout = eLayout;
+		for(uint32_t i = 0; i < m_uNoOfBlocksInVolume; ++i)
+		{
+			m_pBlocks[i].setLayout(m_eBlockLayout);
+		}
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// This function should probably be made internal...
 	////////////////////////////////////////////////////////////////////////////////
@@ -199,7 +376,8 @@ namespace PolyVox
 
 		//m_uBlockSideLength = uBlockSideLength;
 		//m_uNoOfVoxelsPerBlock = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
-		m_pUncompressedBorderData = 0;
+		m_tBorderValue = VoxelType();
+		m_eBorderMode = BorderModes::Constant;
 
 		this->m_regValidRegion = regValidRegion;
 
@@ -210,6 +388,8 @@ namespace PolyVox
 		m_uBlockSideLength = uBlockSideLength;
 		m_uBlockSideLengthPower = logBase2(m_uBlockSideLength);
 		m_uNoOfVoxelsPerBlock = m_uBlockSideLength * m_uBlockSideLength * m_uBlockSideLength;
+		m_eBlockLayout = BlockLayouts::Linear;
+		m_uNoOfUniformBlockData = 0;
 
 		//m_regValidRegionInBlocks.setLowerX(this->m_regValidRegion.getLowerX() >> m_uBlockSideLengthPower);
 		//m_regValidRegionInBlocks.setLowerY(this->m_regValidRegion.getLowerY() >> m_uBlockSideLengthPower);
@@ -233,10 +413,6 @@ namespace PolyVox
 			m_pBlocks[i].initialise(m_uBlockSideLength);
 		}
 
-		//Create the border block
-		m_pUncompressedBorderData = new VoxelType[m_uNoOfVoxelsPerBlock];
-		std::fill(m_pUncompressedBorderData, m_pUncompressedBorderData + m_uNoOfVoxelsPerBlock, VoxelType());
-
 		//Other properties we might find useful later
 		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
 		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
@@ -262,6 +438,192 @@ namespace PolyVox
 		return &(m_pBlocks[uBlockIndex]);
 	}
 
+	template <typename VoxelType>
+	VoxelType SimpleVolume<VoxelType>::getBorderVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(m_eBorderMode == BorderModes::Constant)
+		{
+			return m_tBorderValue;
+		}
+
+		return getVoxelAt(mapIntoRegion(uXPos, uYPos, uZPos, this->m_regValidRegion, m_eBorderMode));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Samplers may call this from several threads at once. Values which already have
+	/// data are found without taking a lock, so only adding a new one is serialised.
+	/// \return A block's worth of voxels with the given value, or null if data is
+	/// already being kept for too many other values.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType* SimpleVolume<VoxelType>::getUniformBlockData(const VoxelType& tValue) const
+	{
+		const uint32_t uNoOfEntries = m_uNoOfUniformBlockData;
+		for(uint32_t ct = 0; ct < uNoOfEntries; ct++)
+		{
+			if(m_pUniformBlockData[ct][0] == tValue)
+			{
+				return m_pUniformBlockData[ct];
+			}
+		}
+
+		polyvox_lock_guard<polyvox_mutex> lockUniformBlockData(m_mutexUniformBlockData);
+
+		//Another thread may have added some entries (possibly for this value) since we looked.
+		for(uint32_t ct = uNoOfEntries; ct < m_uNoOfUniformBlockData; ct++)
+		{
+			if(m_pUniformBlockData[ct][0] == tValue)
+			{
+				return m_pUniformBlockData[ct];
+			}
+		}
+
+		if(m_uNoOfUniformBlockData >= uMaxNoOfUniformBlockData)
+		{
+			return 0;
+		}
+
+		VoxelType* pVoxels = new VoxelType[m_uNoOfVoxelsPerBlock];
+		std::fill(pVoxels, pVoxels + m_uNoOfVoxelsPerBlock, tValue);
+
+		//The entry has to be complete before the count makes it visible to the other threads.
+		m_pUniformBlockData[m_uNoOfUniformBlockData] = pVoxels;
+		++m_uNoOfUniformBlockData;
+		return pVoxels;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The length of the sides of the blocks, in voxels.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint16_t SimpleVolume<VoxelType>::getBlockSideLength(void) const
+	{
+		return m_uBlockSideLength;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The order in which the voxels of each block are stored in memory.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	BlockLayout SimpleVolume<VoxelType>::getBlockLayout(void) const
+	{
+		return m_eBlockLayout;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This lets algorithms such as surface extractors skip over large areas of empty space. Blocks which have
+	/// never been written to are uniform and don't use any memory for their voxels, but blocks which have been
+	/// modified have to be scanned. Block positions are voxel positions divided by getBlockSideLength() (rounding
+	/// down). Blocks outside the volume are read according to the border mode, so they are uniform unless it is
+	/// clamped or wrapped (see setBorderMode()).
+	/// \param v3dBlockPos The position of the block.
+	/// \return Whether every voxel in the block has the same value.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool SimpleVolume<VoxelType>::isBlockUniform(const Vector3DInt32& v3dBlockPos) const
+	{
+		if(!m_regValidRegionInBlocks.containsPoint(v3dBlockPos))
+		{
+			if(m_eBorderMode == BorderModes::Constant)
+			{
+				return true;
+			}
+
+			//The block is made up of whichever voxels it maps on to.
+			std::vector<VoxelType> vecVoxels(m_uNoOfVoxelsPerBlock);
+			readRegion(getRegionOfBlock(v3dBlockPos.getX(), v3dBlockPos.getY(), v3dBlockPos.getZ(), m_uBlockSideLengthPower), &vecVoxels[0]);
+			return findRunLength(&vecVoxels[0], m_uNoOfVoxelsPerBlock) == m_uNoOfVoxelsPerBlock;
+		}
+
+		return getUncompressedBlock(v3dBlockPos.getX(), v3dBlockPos.getY(), v3dBlockPos.getZ())->isUniform();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// See BaseVolume::calculateDensityRange(). Uniform blocks just use their value, and the range of any other block
+	/// is calculated when it is first needed and then kept until the block is modified. The range covers every voxel
+	/// in the blocks which the region touches, so it may be a little wider than the range of the region itself.
+	/// \param region The region to look at, which may extend outside the volume
+	/// \param tMin Set to the smallest density in the region
+	/// \param tMax Set to the largest density in the region
+	/// \return False if the region extends outside a volume which is clamped or wrapped, otherwise true
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	template <typename DensityType>
+	bool SimpleVolume<VoxelType>::calculateDensityRange(const Region& region, DensityType& tMin, DensityType& tMax) const
+	{
+		assert(region.isValid());
+
+		DensityRange<VoxelType> range;
+
+		Region regCropped(region);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != region)
+		{
+			//The voxels which the border maps on to could be anywhere in the volume.
+			if(m_eBorderMode != BorderModes::Constant)
+			{
+				return false;
+			}
+			addToDensityRange(getBorderValue(), range);
+		}
+
+		if(regCropped.isValid())
+		{
+			polyvox_lock_guard<polyvox_mutex> lockDensityRanges(m_mutexDensityRanges);
+
+			const Region regBlocks = getBlocksInRegion(regCropped, m_uBlockSideLengthPower);
+			for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+			{
+				for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+				{
+					for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+					{
+						addToDensityRange(getUncompressedBlock(x, y, z)->calculateDensityRange(), range);
+					}
+				}
+			}
+		}
+
+		DefaultMarchingCubesController<VoxelType> controller;
+		tMin = controller.convertToDensity(range.minVoxel);
+		tMax = controller.convertToDensity(range.maxVoxel);
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The snapshot is a SimpleVolume in its own right, so it can be passed to the surface extractors, pathfinder,
+	/// etc. It is cheap to create as the voxels of each block are shared rather than copied. A block only gets its
+	/// own copy of its voxels when it is next modified, in this volume or in the snapshot, so you can carry on
+	/// modifying this volume while other threads read from the snapshot, and they will see it exactly as it was
+	/// when it was taken. Blocks which are never modified after the snapshot are never copied.
+	///
+	/// This function has to be called from the thread which modifies the volume (as it marks the voxels as shared),
+	/// and the snapshot should only be read by the other threads. It can be destroyed by whichever thread finishes
+	/// with it last.
+	///
+	/// Note that a Sampler which is inside a block of this volume when that block gets its own copy of its voxels
+	/// will not see changes made to the copy (other than through the Sampler itself) until it moves into a
+	/// different block.
+	///
+	/// \return A copy of the volume as it is now.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	polyvox_shared_ptr< SimpleVolume<VoxelType> > SimpleVolume<VoxelType>::snapshot(void)
+	{
+		//Every block of the new volume starts out uniform, so it doesn't allocate any voxels.
+		polyvox_shared_ptr< SimpleVolume<VoxelType> > pSnapshot(new SimpleVolume<VoxelType>(this->m_regValidRegion, m_uBlockSideLength));
+		pSnapshot->setBorderValue(getBorderValue());
+		pSnapshot->setBorderMode(m_eBorderMode);
+		pSnapshot->m_eBlockLayout = m_eBlockLayout;
+
+		for(uint32_t ct = 0; ct < m_uNoOfBlocksInVolume; ct++)
+		{
+			pSnapshot->m_pBlocks[ct].shareData(m_pBlocks[ct]);
+		}
+
+		return pSnapshot;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// \todo This function needs reviewing for accuracy...
 	///
@@ -274,8 +636,14 @@ namespace PolyVox
 		
 		uint32_t uSizeOfBlockInBytes = m_uNoOfVoxelsPerBlock * sizeof(VoxelType);
 
-		//Memory used by the blocks ( + 1 is for border)
-		uSizeInBytes += uSizeOfBlockInBytes * (m_uNoOfBlocksInVolume + 1);
+		//Memory used by the blocks (uniform ones don't have any voxels)
+		for(uint32_t ct = 0; ct < m_uNoOfBlocksInVolume; ct++)
+		{
+			uSizeInBytes += m_pBlocks[ct].calculateSizeInBytes();
+		}
+
+		//Memory used by the border, and the data which Samplers use for uniform blocks.
+		uSizeInBytes += uSizeOfBlockInBytes * (m_uNoOfUniformBlockData + 1);
 
 		return uSizeInBytes;
 	}
@@ -26,8 +26,11 @@ namespace PolyVox
 	template <typename VoxelType>
 	SimpleVolume<VoxelType>::Block::Block(uint16_t uSideLength)
 		:m_tUncompressedData(0)
+		,m_pDataRefCount(0)
+		,m_tUniformValue()
 		,m_uSideLength(0)
 		,m_uSideLengthPower(0)
+		,m_eLayout(BlockLayouts::Linear)
 	{
 		if(uSideLength != 0)
 		{
@@ -38,7 +41,7 @@ namespace PolyVox
 	template <typename VoxelType>
 	SimpleVolume<VoxelType>::Block::~Block()
 	{
-		delete[] m_tUncompressedData;
+		releaseData();
 	}
 
 	template <typename VoxelType>
@@ -54,14 +57,12 @@ namespace PolyVox
 		assert(uYPos < m_uSideLength);
 		assert(uZPos < m_uSideLength);
 
-		assert(m_tUncompressedData);
+		if(m_tUncompressedData == 0)
+		{
+			return m_tUniformValue;
+		}
 
-		return m_tUncompressedData
-			[
-				uXPos + 
-				uYPos * m_uSideLength + 
-				uZPos * m_uSideLength * m_uSideLength
-			];
+		return m_tUncompressedData[getVoxelIndexInBlock(uXPos, uYPos, uZPos, m_uSideLengthPower, m_eLayout)];
 	}
 
 	template <typename VoxelType>
@@ -77,14 +78,13 @@ namespace PolyVox
 		assert(uYPos < m_uSideLength);
 		assert(uZPos < m_uSideLength);
 
-		assert(m_tUncompressedData);
+		if((m_tUncompressedData == 0) && (tValue == m_tUniformValue))
+		{
+			return;
+		}
 
-		m_tUncompressedData
-		[
-			uXPos + 
-			uYPos * m_uSideLength + 
-			uZPos * m_uSideLength * m_uSideLength
-		] = tValue;
+		makeDataWritable();
+		m_tUncompressedData[getVoxelIndexInBlock(uXPos, uYPos, uZPos, m_uSideLengthPower, m_eLayout)] = tValue;
 	}
 
 	template <typename VoxelType>
@@ -96,8 +96,9 @@ namespace PolyVox
 	template <typename VoxelType>
 	void SimpleVolume<VoxelType>::Block::fill(VoxelType tValue)
 	{
-		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
-		std::fill(m_tUncompressedData, m_tUncompressedData + uNoOfVoxels, tValue);
+		//A filled block is uniform, so it doesn't need its voxels any more.
+		releaseData();
+		m_tUniformValue = tValue;
 	}
 
 	template <typename VoxelType>
@@ -116,16 +117,167 @@ namespace PolyVox
 		m_uSideLength = uSideLength;
 		m_uSideLengthPower = logBase2(uSideLength);
 
-		m_tUncompressedData = new VoxelType[m_uSideLength * m_uSideLength * m_uSideLength];
-
 		SimpleVolume<VoxelType>::Block::fill(VoxelType());
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Makes this block a copy of the given one without copying the voxels. Both blocks will give themselves
+	/// their own copy of the voxels when they are next modified (unless the other has let go of them by then).
+	/// The given block is modified, so this must be called from the thread which owns it.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::Block::shareData(Block& rhs)
+	{
+		releaseData();
+
+		m_tUniformValue = rhs.m_tUniformValue;
+		m_rangeDensities = rhs.m_rangeDensities;
+		m_uSideLength = rhs.m_uSideLength;
+		m_uSideLengthPower = rhs.m_uSideLengthPower;
+		m_eLayout = rhs.m_eLayout;
+
+		if(rhs.m_tUncompressedData)
+		{
+			if(rhs.m_pDataRefCount == 0)
+			{
+				rhs.m_pDataRefCount = new polyvox_atomic<uint32_t>(1);
+			}
+			rhs.m_pDataRefCount->fetch_add(1);
+
+			m_tUncompressedData = rhs.m_tUncompressedData;
+			m_pDataRefCount = rhs.m_pDataRefCount;
+		}
+	}
+
 	template <typename VoxelType>
 	uint32_t SimpleVolume<VoxelType>::Block::calculateSizeInBytes(void)
 	{
 		uint32_t uSizeInBytes = sizeof(Block);
-		uSizeInBytes += sizeof(VoxelType) * m_uSideLength * m_uSideLength * m_uSideLength;
+		if(m_tUncompressedData)
+		{
+			uSizeInBytes += sizeof(VoxelType) * m_uSideLength * m_uSideLength * m_uSideLength;
+		}
 		return  uSizeInBytes;
 	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Blocks only become uniform when they are filled, so a block which has been modified
+	/// has to be scanned (in case its voxels have all been set to the same value).
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool SimpleVolume<VoxelType>::Block::isUniform(void) const
+	{
+		if(m_tUncompressedData == 0)
+		{
+			return true;
+		}
+
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+		for(uint32_t ct = 1; ct < uNoOfVoxels; ct++)
+		{
+			if(!(m_tUncompressedData[ct] == m_tUncompressedData[0]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The range of a block which has been modified is kept until it is modified
+	/// again, so it only has to be calculated once while the block isn't changing.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	DensityRange<VoxelType> SimpleVolume<VoxelType>::Block::calculateDensityRange(void) const
+	{
+		if(m_tUncompressedData == 0)
+		{
+			DensityRange<VoxelType> range;
+			addToDensityRange(m_tUniformValue, range);
+			return range;
+		}
+
+		if(!m_rangeDensities.isValid)
+		{
+			addVoxelsToDensityRange(m_tUncompressedData, m_uSideLength * m_uSideLength * m_uSideLength, m_rangeDensities);
+		}
+		return m_rangeDensities;
+	}
+
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::Block::setLayout(BlockLayout eLayout)
+	{
+		//A uniform block looks the same in any layout.
+		if((eLayout != m_eLayout) && (m_tUncompressedData != 0))
+		{
+			const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+			VoxelType* pNewData = new VoxelType[uNoOfVoxels];
+			changeBlockLayout(m_tUncompressedData, m_eLayout, pNewData, eLayout, m_uSideLengthPower);
+			releaseData();
+			m_tUncompressedData = pNewData;
+		}
+		m_eLayout = eLayout;
+	}
+
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::Block::makeDataWritable(void)
+	{
+		//The caller is about to modify the voxels.
+		m_rangeDensities.isValid = false;
+
+		if(m_tUncompressedData == 0)
+		{
+			//The block is about to stop being uniform, so it needs some voxels of its own.
+			const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+			m_tUncompressedData = new VoxelType[uNoOfVoxels];
+			std::fill(m_tUncompressedData, m_tUncompressedData + uNoOfVoxels, m_tUniformValue);
+		}
+		else
+		{
+			makeDataUnique();
+		}
+	}
+
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::Block::makeDataUnique(void)
+	{
+		if(m_pDataRefCount == 0)
+		{
+			return;
+		}
+
+		//If the other blocks have all let go of the voxels then we can just keep them.
+		if(m_pDataRefCount->load() == 1)
+		{
+			delete m_pDataRefCount;
+			m_pDataRefCount = 0;
+			return;
+		}
+
+		const uint32_t uNoOfVoxels = m_uSideLength * m_uSideLength * m_uSideLength;
+		VoxelType* pNewData = new VoxelType[uNoOfVoxels];
+		std::copy(m_tUncompressedData, m_tUncompressedData + uNoOfVoxels, pNewData);
+		releaseData();
+		m_tUncompressedData = pNewData;
+	}
+
+	template <typename VoxelType>
+	void SimpleVolume<VoxelType>::Block::releaseData(void)
+	{
+		if(m_pDataRefCount)
+		{
+			//The voxels might be in use by another block, in which case it frees them.
+			if(m_pDataRefCount->fetch_sub(1) == 1)
+			{
+				delete[] m_tUncompressedData;
+				delete m_pDataRefCount;
+			}
+			m_pDataRefCount = 0;
+		}
+		else
+		{
+			delete[] m_tUncompressedData;
+		}
+		m_tUncompressedData = 0;
+	}
 }
@@ -21,8 +21,8 @@ freely, subject to the following restrictions:
     distribution. 	
 *******************************************************************************/
 
-#define BORDER_LOW(x) ((( x >> this->mVolume->m_uBlockSideLengthPower) << this->mVolume->m_uBlockSideLengthPower) != x)
-#define BORDER_HIGH(x) ((( (x+1) >> this->mVolume->m_uBlockSideLengthPower) << this->mVolume->m_uBlockSideLengthPower) != (x+1))
+#define BORDER_LOW(x) ((( x >> this->mBlockSideLengthPower) << this->mBlockSideLengthPower) != x)
+#define BORDER_HIGH(x) ((( (x+1) >> this->mBlockSideLengthPower) << this->mBlockSideLengthPower) != (x+1))
 //#define BORDER_LOW(x) (( x % this->mVolume->m_uBlockSideLength) != 0)
 //#define BORDER_HIGH(x) (( x % this->mVolume->m_uBlockSideLength) != this->mVolume->m_uBlockSideLength - 1)
 
@@ -34,6 +34,13 @@ namespace PolyVox
 	template <typename VoxelType>
 	SimpleVolume<VoxelType>::Sampler::Sampler(SimpleVolume<VoxelType>* volume)
 		:BaseVolume<VoxelType>::template Sampler< SimpleVolume<VoxelType> >(volume)
+		,mCurrentVoxel(0)
+		,mCurrentBlockVoxels(0)
+		,mCurrentVoxelIndex(0)
+		,mCurrentBlock(0)
+		,mBlockSideLength(volume->m_uBlockSideLength)
+		,mBlockSideLengthPower(volume->m_uBlockSideLengthPower)
+		,mMortonBlockSideLength(0)
 	{
 	}
 
@@ -54,6 +61,12 @@ namespace PolyVox
 		this->mYPosInVolume = rhs.mYPosInVolume;
 		this->mZPosInVolume = rhs.mZPosInVolume;
 		mCurrentVoxel = rhs.mCurrentVoxel;
+		mCurrentBlockVoxels = rhs.mCurrentBlockVoxels;
+		mCurrentVoxelIndex = rhs.mCurrentVoxelIndex;
+		mCurrentBlock = rhs.mCurrentBlock;
+		mBlockSideLength = rhs.mBlockSideLength;
+		mBlockSideLengthPower = rhs.mBlockSideLengthPower;
+		mMortonBlockSideLength = rhs.mMortonBlockSideLength;
         return *this;
 	}
 
@@ -125,27 +138,94 @@ namespace PolyVox
 		this->mYPosInVolume = yPos;
 		this->mZPosInVolume = zPos;
 
-		const int32_t uXBlock = this->mXPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
-		const int32_t uYBlock = this->mYPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
-		const int32_t uZBlock = this->mZPosInVolume >> this->mVolume->m_uBlockSideLengthPower;
+		mBlockSideLength = this->mVolume->m_uBlockSideLength;
+		mBlockSideLengthPower = this->mVolume->m_uBlockSideLengthPower;
 
-		const uint16_t uXPosInBlock = static_cast<uint16_t>(this->mXPosInVolume - (uXBlock << this->mVolume->m_uBlockSideLengthPower));
-		const uint16_t uYPosInBlock = static_cast<uint16_t>(this->mYPosInVolume - (uYBlock << this->mVolume->m_uBlockSideLengthPower));
-		const uint16_t uZPosInBlock = static_cast<uint16_t>(this->mZPosInVolume - (uZBlock << this->mVolume->m_uBlockSideLengthPower));
+		int32_t uXBlock = xPos >> this->mVolume->m_uBlockSideLengthPower;
+		int32_t uYBlock = yPos >> this->mVolume->m_uBlockSideLengthPower;
+		int32_t uZBlock = zPos >> this->mVolume->m_uBlockSideLengthPower;
 
-		const uint32_t uVoxelIndexInBlock = uXPosInBlock + 
-				uYPosInBlock * this->mVolume->m_uBlockSideLength + 
-				uZPosInBlock * this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
+		const bool bIsInsideVolume = this->mVolume->m_regValidRegionInBlocks.containsPoint(Vector3DInt32(uXBlock, uYBlock, uZBlock));
+		if((!bIsInsideVolume) && (this->mVolume->m_eBorderMode != BorderModes::Constant))
+		{
+			//Point at the voxel which this position maps on to. The voxels next to it needn't be the ones which
+			//the neighbouring positions map on to, so we pretend the block is a single voxel. That way every move
+			//and peek goes through the volume, without the Sampler needing any extra checks inside the volume.
+			const Vector3DInt32 v3dMappedPos = mapIntoRegion(xPos, yPos, zPos, this->mVolume->m_regValidRegion, this->mVolume->m_eBorderMode);
+			xPos = v3dMappedPos.getX();
+			yPos = v3dMappedPos.getY();
+			zPos = v3dMappedPos.getZ();
+
+			uXBlock = xPos >> this->mVolume->m_uBlockSideLengthPower;
+			uYBlock = yPos >> this->mVolume->m_uBlockSideLengthPower;
+			uZBlock = zPos >> this->mVolume->m_uBlockSideLengthPower;
+
+			mBlockSideLength = 1;
+			mBlockSideLengthPower = 0;
+		}
+
+		const uint16_t uXPosInBlock = static_cast<uint16_t>(xPos - (uXBlock << this->mVolume->m_uBlockSideLengthPower));
+		const uint16_t uYPosInBlock = static_cast<uint16_t>(yPos - (uYBlock << this->mVolume->m_uBlockSideLengthPower));
+		const uint16_t uZPosInBlock = static_cast<uint16_t>(zPos - (uZBlock << this->mVolume->m_uBlockSideLengthPower));
+
+		mCurrentVoxelIndex = getVoxelIndexInBlock(uXPosInBlock, uYPosInBlock, uZPosInBlock, this->mVolume->m_uBlockSideLengthPower, this->mVolume->m_eBlockLayout);
 
 		if(this->mVolume->m_regValidRegionInBlocks.containsPoint(Vector3DInt32(uXBlock, uYBlock, uZBlock)))
 		{
-			Block* pUncompressedCurrentBlock = this->mVolume->getUncompressedBlock(uXBlock, uYBlock, uZBlock);
+			Block* pBlock = this->mVolume->getUncompressedBlock(uXBlock, uYBlock, uZBlock);
 
-			mCurrentVoxel = pUncompressedCurrentBlock->m_tUncompressedData + uVoxelIndexInBlock;
+			//Uniform blocks don't have any voxels of their own.
+			mCurrentBlockVoxels = pBlock->m_tUncompressedData;
+			if(mCurrentBlockVoxels == 0)
+			{
+				mCurrentBlockVoxels = this->mVolume->getUniformBlockData(pBlock->m_tUniformValue);
+			}
+
+			if(mCurrentBlockVoxels)
+			{
+				mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+			}
+			else
+			{
+				//There are already too many distinct uniform values, so go through the volume instead. As
+				//mCurrentBlockVoxels isn't the block's own data, setVoxel() also goes through the volume.
+				mCurrentVoxel = &(pBlock->m_tUniformValue);
+				mCurrentBlockVoxels = mCurrentVoxel;
+				mBlockSideLength = 1;
+				mBlockSideLengthPower = 0;
+			}
+
+			//The border can't be written to, even where it maps on to a voxel inside the volume.
+			mCurrentBlock = bIsInsideVolume ? pBlock : 0;
 		}
 		else
 		{
-			mCurrentVoxel = this->mVolume->m_pUncompressedBorderData + uVoxelIndexInBlock;
+			//The border is read from the same (read only) data as a uniform block with the border value.
+			//Every voxel of it has the same value, so the layout doesn't matter here.
+			mCurrentBlock = 0;
+			mCurrentBlockVoxels = this->mVolume->getUniformBlockData(this->mVolume->m_tBorderValue);
+			if(mCurrentBlockVoxels)
+			{
+				mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+			}
+			else
+			{
+				//There are already too many distinct uniform values, so go through the volume instead.
+				mCurrentVoxel = &(this->mVolume->m_tBorderValue);
+				mBlockSideLength = 1;
+				mBlockSideLengthPower = 0;
+			}
+		}
+
+		//The layout is chosen here rather than in every move and peek. The fast paths in those assume the Linear layout,
+		//so for the Morton layout we make sure they are never taken (as for a single voxel above) and let the slow paths
+		//step through the block instead.
+		mMortonBlockSideLength = 0;
+		if((this->mVolume->m_eBlockLayout == BlockLayouts::Morton) && (mBlockSideLength > 1))
+		{
+			mMortonBlockSideLength = mBlockSideLength;
+			mBlockSideLength = 1;
+			mBlockSideLengthPower = 0;
 		}
 	}
 	
@@ -156,33 +236,50 @@ namespace PolyVox
 	 * to set is not outside the volume. If it is, this function returns
 	 * \a false, otherwise it will return \a true.
 	 * 
+	 * Setting a voxel in a uniform block to a different value gives the block
+	 * its own voxels, but other Samplers which are already in that block will
+	 * not see the change until they move into a different block. The same
+	 * applies to a block whose voxels are shared with a snapshot.
+	 * 
 	 * \param tValue The value to set to voxel to
 	 */
 	template <typename VoxelType>
 	bool SimpleVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
 	{
-		VoxelType* pBorderDataEndPlusOne = this->mVolume->m_pUncompressedBorderData + this->mVolume->m_uNoOfVoxelsPerBlock;
-
 		//Make sure we're not trying to write to the border data
-		if((mCurrentVoxel < this->mVolume->m_pUncompressedBorderData) || (mCurrentVoxel >= pBorderDataEndPlusOne))
+		if(mCurrentBlock == 0)
 		{
-			*mCurrentVoxel = tValue;
-			return true;
+			return false;
 		}
-		else
+
+		//We're pointing at shared data (or at voxels which the block has since replaced with its
+		//own copy), so write through the block and then find the voxel again.
+		if((mCurrentBlockVoxels != mCurrentBlock->m_tUncompressedData) || (mCurrentBlock->m_pDataRefCount != 0))
 		{
-			return false;
+			this->mVolume->setVoxelAt(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume, tValue);
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+			return true;
 		}
+
+		mCurrentBlock->m_rangeDensities.isValid = false;
+		*mCurrentVoxel = tValue;
+		return true;
 	}
 
 	template <typename VoxelType>
 	void SimpleVolume<VoxelType>::Sampler::movePositiveX(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mXPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mXPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
-			++mCurrentVoxel;			
+			++mCurrentVoxel;
+		}
+		else if((mMortonBlockSideLength != 0) && ((this->mXPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonXMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
 		}
 		else
 		{
@@ -195,11 +292,17 @@ namespace PolyVox
 	void SimpleVolume<VoxelType>::Sampler::movePositiveY(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mYPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mYPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel += this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && ((this->mYPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonYMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -211,11 +314,17 @@ namespace PolyVox
 	void SimpleVolume<VoxelType>::Sampler::movePositiveZ(void)
 	{
 		//Note the *pre* increament here
-		if((++this->mZPosInVolume) % this->mVolume->m_uBlockSideLength != 0)
+		if((++this->mZPosInVolume) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel += this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && ((this->mZPosInVolume & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = incrementMortonIndex(mCurrentVoxelIndex, uMortonZMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -227,10 +336,16 @@ namespace PolyVox
 	void SimpleVolume<VoxelType>::Sampler::moveNegativeX(void)
 	{
 		//Note the *post* decreament here
-		if((this->mXPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mXPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
-			--mCurrentVoxel;			
+			--mCurrentVoxel;
+		}
+		else if((mMortonBlockSideLength != 0) && (((this->mXPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonXMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
 		}
 		else
 		{
@@ -243,11 +358,17 @@ namespace PolyVox
 	void SimpleVolume<VoxelType>::Sampler::moveNegativeY(void)
 	{
 		//Note the *post* decreament here
-		if((this->mYPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mYPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel -= this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && (((this->mYPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonYMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -259,11 +380,17 @@ namespace PolyVox
 	void SimpleVolume<VoxelType>::Sampler::moveNegativeZ(void)
 	{
 		//Note the *post* decreament here
-		if((this->mZPosInVolume--) % this->mVolume->m_uBlockSideLength != 0)
+		if((this->mZPosInVolume--) % mBlockSideLength != 0)
 		{
 			//No need to compute new block.
 			mCurrentVoxel -= this->mVolume->m_uBlockSideLength * this->mVolume->m_uBlockSideLength;
 		}
+		else if((mMortonBlockSideLength != 0) && (((this->mZPosInVolume + 1) & (mMortonBlockSideLength - 1)) != 0))
+		{
+			//Still within the block, which uses the Morton layout (see setPosition()).
+			mCurrentVoxelIndex = decrementMortonIndex(mCurrentVoxelIndex, uMortonZMask);
+			mCurrentVoxel = mCurrentBlockVoxels + mCurrentVoxelIndex;
+		}
 		else
 		{
 			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -278,7 +405,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -288,7 +415,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -298,7 +425,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -308,7 +435,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -318,7 +445,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,0,0>();
 	}
 
 	template <typename VoxelType>
@@ -328,7 +455,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -338,7 +465,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<-1,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -348,7 +475,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<-1,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -358,7 +485,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - 1 + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<-1,1,1>();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -370,7 +497,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -380,7 +507,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<0,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -390,7 +517,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -400,7 +527,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -416,7 +543,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -426,7 +553,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<0,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -436,7 +563,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<0,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -446,7 +573,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<0,1,1>();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -458,7 +585,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,-1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -468,7 +595,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,-1,0>();
 	}
 
 	template <typename VoxelType>
@@ -478,7 +605,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,-1,1>();
 	}
 
 	template <typename VoxelType>
@@ -488,7 +615,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,0,-1>();
 	}
 
 	template <typename VoxelType>
@@ -498,7 +625,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,0,0>();
 	}
 
 	template <typename VoxelType>
@@ -508,7 +635,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,0,1>();
 	}
 
 	template <typename VoxelType>
@@ -518,7 +645,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength - this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+		return peekNeighbourVoxel<1,1,-1>();
 	}
 
 	template <typename VoxelType>
@@ -528,7 +655,7 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume);
+		return peekNeighbourVoxel<1,1,0>();
 	}
 
 	template <typename VoxelType>
@@ -538,7 +665,32 @@ namespace PolyVox
 		{
 			return *(mCurrentVoxel + 1 + this->mVolume->m_uBlockSideLength + this->mVolume->m_uBlockSideLength*this->mVolume->m_uBlockSideLength);
 		}
-		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+		return peekNeighbourVoxel<1,1,1>();
+	}
+
+	template <typename VoxelType>
+	template <int iXOffset, int iYOffset, int iZOffset>
+	VoxelType SimpleVolume<VoxelType>::Sampler::peekNeighbourVoxel(void) const
+	{
+		//The offsets are known at compile time, so only the required checks and steps are left in.
+		const int32_t iMask = mMortonBlockSideLength - 1;
+		if((mMortonBlockSideLength == 0) ||
+			((iXOffset > 0) && (((this->mXPosInVolume + 1) & iMask) == 0)) || ((iXOffset < 0) && ((this->mXPosInVolume & iMask) == 0)) ||
+			((iYOffset > 0) && (((this->mYPosInVolume + 1) & iMask) == 0)) || ((iYOffset < 0) && ((this->mYPosInVolume & iMask) == 0)) ||
+			((iZOffset > 0) && (((this->mZPosInVolume + 1) & iMask) == 0)) || ((iZOffset < 0) && ((this->mZPosInVolume & iMask) == 0)))
+		{
+			return this->mVolume->getVoxelAt(this->mXPosInVolume + iXOffset, this->mYPosInVolume + iYOffset, this->mZPosInVolume + iZOffset);
+		}
+
+		//The neighbour is in the same block, which uses the Morton layout.
+		uint32_t uIndex = mCurrentVoxelIndex;
+		if(iXOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonXMask);
+		if(iXOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonXMask);
+		if(iYOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonYMask);
+		if(iYOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonYMask);
+		if(iZOffset > 0) uIndex = incrementMortonIndex(uIndex, uMortonZMask);
+		if(iZOffset < 0) uIndex = decrementMortonIndex(uIndex, uMortonZMask);
+		return mCurrentBlockVoxels[uIndex];
 	}
 }
 
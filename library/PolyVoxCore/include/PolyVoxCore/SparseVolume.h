@@ -0,0 +1,254 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#ifndef __PolyVox_SparseVolume_H__
+#define __PolyVox_SparseVolume_H__
+
+#include "Impl/RegionCopy.h"
+#include "Impl/Utility.h"
+
+#include "PolyVoxCore/BaseVolume.h"
+#include "PolyVoxCore/Log.h"
+#include "PolyVoxCore/Region.h"
+#include "PolyVoxCore/Vector.h"
+
+#include <cassert>
+#include <cstdlib> //For abort()
+#include <limits>
+#include <memory>
+#include <stdexcept> //For invalid_argument
+#include <vector>
+
+namespace PolyVox
+{
+	/// A fixed size volume which only allocates memory for the parts which are not uniform.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The SparseVolume is used in the same way as the SimpleVolume, but it is intended for volumes which are mostly empty (or mostly
+	/// solid). Rather than allocating every block up front it stores the voxels in a shallow tree, in the same spirit as a sparse voxel
+	/// octree but with a much larger branching factor so that any voxel can be found in a fixed number of steps:
+	///
+	/// - The volume is divided into <i>nodes</i>, each of which covers 16x16x16 leaves. The volume keeps an array with an entry for every node.
+	/// - Each node is divided into <i>leaves</i>. A leaf is a block of voxels with the side length passed to the constructor (8 by default).
+	///
+	/// Both nodes and leaves can be <i>collapsed</i>, in which case they are stored as a single value which applies to all of the voxels they
+	/// cover. A new volume consists only of collapsed nodes, so it uses hardly any memory however large it is. Setting a voxel to a value other
+	/// than the one its node or leaf was collapsed to allocates that node and leaf (but no others). Setting a voxel to the value it already has
+	/// never allocates anything, so writing 'air' over an empty part of the volume is free.
+	///
+	/// Leaves and nodes are not collapsed again automatically as this would mean checking the whole leaf after every write. Instead you should
+	/// call prune() when you have finished modifying the volume (or some large part of it) to free any leaves and nodes which have become uniform.
+	///
+	/// The Sampler keeps a pointer to the voxels of the current leaf, so moving and peeking within a leaf is as fast as for the SimpleVolume.
+	/// Moving into a neighbouring leaf costs two array lookups. When the Sampler is in a collapsed part of the volume it uses a private copy of
+	/// the collapsed value, and will not see changes made to that part of the volume (other than through the Sampler itself) until it moves
+	/// into a different leaf. Note that prune() may free the leaf a Sampler is pointing at, so Samplers should not be used across calls to it.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class SparseVolume : public BaseVolume<VoxelType>
+	{
+	public:
+		#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< SparseVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			/// Construct a new Sampler
+			Sampler(SparseVolume<VoxelType>* volume);
+			/// Copy constructor
+			Sampler(const Sampler& rhs);
+			~Sampler();
+
+			Sampler& operator=(const Sampler& rhs);
+
+			VoxelType getSubSampledVoxel(uint8_t uLevel) const;
+			/// Get the value of the current voxel
+			inline VoxelType getVoxel(void) const;
+			
+			/// Set the current voxel position
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			/// Set the current voxel position
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			/// Set the value of the current voxel
+			inline bool setVoxel(VoxelType tValue);
+
+			/// Increase the \a x position by \a 1
+			void movePositiveX(void);
+			/// Increase the \a y position by \a 1
+			void movePositiveY(void);
+			/// Increase the \a z position by \a 1
+			void movePositiveZ(void);
+
+			/// Decrease the \a x position by \a 1
+			void moveNegativeX(void);
+			/// Decrease the \a y position by \a 1
+			void moveNegativeY(void);
+			/// Decrease the \a z position by \a 1
+			void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			//Points into the current leaf or, if the current leaf is collapsed or outside the volume, into mCollapsedLeafData.
+			VoxelType* mCurrentVoxel;
+			bool mIsInLeaf;
+
+			//A whole leaf filled with the collapsed value, so that the pointer arithmetic works as usual.
+			std::vector<VoxelType> mCollapsedLeafData;
+		};
+		#endif
+
+	public:
+		/// Constructor for creating a fixed size volume.
+		SparseVolume(const Region& regValid, uint16_t uLeafSideLength = 8);
+		/// Destructor
+		~SparseVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		VoxelType getBorderValue(void) const;
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxelAt(const Vector3DInt32& v3dPos) const;
+		/// Copies the voxels in a region into a buffer
+		void readRegion(const Region& regRead, VoxelType* pDestination) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(const VoxelType& tBorder);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		bool setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		bool setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue);
+		/// Copies the voxels in a region from a buffer
+		void writeRegion(const Region& regWrite, const VoxelType* pSource);
+		/// Sets every voxel in a region to the same value
+		void fillRegion(const Region& regFill, VoxelType tValue);
+
+		/// Collapses any leaves and nodes whose voxels all have the same value
+		void prune(void);
+
+		/// Gets the length of the sides of the leaves
+		uint16_t getLeafSideLength(void) const;
+		/// Gets the number of leaves which have been allocated
+		uint32_t getNoOfLeaves(void) const;
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		SparseVolume(const SparseVolume& rhs);
+
+		/// Assignment operator
+		SparseVolume& operator=(const SparseVolume& rhs);
+
+	private:
+		//A node covers uNodeSideLengthInLeaves leaves in each direction. Each of them is either allocated (in which
+		//case m_vecLeaves holds its voxels) or collapsed (in which case m_vecLeaves holds null and m_vecLeafValues
+		//holds the value of all its voxels).
+		class Node
+		{
+		public:
+			Node(const VoxelType& tValue);
+			~Node();
+
+			std::vector<VoxelType*> m_vecLeaves;
+			std::vector<VoxelType> m_vecLeafValues;
+			uint32_t m_uNoOfLeaves;
+
+		private:
+			Node(const Node& rhs);
+			Node& operator=(const Node& rhs);
+		};
+
+		static const uint8_t uNodeSideLengthInLeavesPower = 4;
+		static const uint16_t uNodeSideLengthInLeaves = 1 << uNodeSideLengthInLeavesPower;
+		static const uint32_t uNoOfLeavesPerNode = uNodeSideLengthInLeaves * uNodeSideLengthInLeaves * uNodeSideLengthInLeaves;
+
+		void initialise(const Region& regValidRegion, uint16_t uLeafSideLength);
+
+		//Finds the leaf at the given position. If it is collapsed then this returns null and sets tCollapsedValue instead.
+		VoxelType* getLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ, VoxelType& tCollapsedValue) const;
+		//Finds the leaf at the given position, allocating it (and its node) if it is collapsed.
+		VoxelType* getAllocatedLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ);
+		void collapseLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ, const VoxelType& tValue);
+
+		uint32_t getNodeIndex(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ) const;
+		static uint32_t getLeafIndexInNode(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ);
+		uint32_t getVoxelIndexInLeaf(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+
+		//The nodes covering the volume. As with the leaves, a null entry means the node is collapsed
+		//and m_vecNodeValues holds the value of all its voxels.
+		std::vector<Node*> m_vecNodes;
+		std::vector<VoxelType> m_vecNodeValues;
+
+		VoxelType m_tBorderValue;
+
+		//The valid region measured in leaves and in nodes
+		Region m_regValidRegionInLeaves;
+		Region m_regValidRegionInNodes;
+		uint16_t m_uWidthInNodes;
+		uint16_t m_uHeightInNodes;
+		uint16_t m_uDepthInNodes;
+
+		//The size of the leaves
+		uint32_t m_uNoOfVoxelsPerLeaf;
+		uint16_t m_uLeafSideLength;
+		uint8_t m_uLeafSideLengthPower;
+	};
+}
+
+#include "PolyVoxCore/SparseVolume.inl"
+#include "PolyVoxCore/SparseVolumeSampler.inl"
+
+#endif //__PolyVox_SparseVolume_H__
@@ -0,0 +1,589 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include <algorithm>
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Node::Node(const VoxelType& tValue)
+		:m_vecLeaves(uNoOfLeavesPerNode, static_cast<VoxelType*>(0))
+		,m_vecLeafValues(uNoOfLeavesPerNode, tValue)
+		,m_uNoOfLeaves(0)
+	{
+	}
+
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Node::~Node()
+	{
+		for(uint32_t ct = 0; ct < m_vecLeaves.size(); ct++)
+		{
+			delete[] m_vecLeaves[ct];
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a volume with a fixed size which is specified as a parameter. All the voxels are
+	/// initially set to their default value, and no memory is allocated for them until they are set to something else.
+	/// \param regValid Specifies the minimum and maximum valid voxel positions.
+	/// \param uLeafSideLength The side length of the leaves. Smaller leaves waste less memory on partly uniform regions, but
+	/// mean that the Sampler has to move between leaves more often.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::SparseVolume(const Region& regValid, uint16_t uLeafSideLength)
+		:BaseVolume<VoxelType>(regValid)
+	{
+		//Create a volume of the right size.
+		initialise(regValid,uLeafSideLength);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::SparseVolume(const SparseVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::~SparseVolume()
+	{
+		for(uint32_t ct = 0; ct < m_vecNodes.size(); ct++)
+		{
+			delete m_vecNodes[ct];
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the Volumeresampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>& SparseVolume<VoxelType>::operator=(const SparseVolume<VoxelType>& /*rhs*/)
+	{
+		assert(false); // See function comment above.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getBorderValue(void) const
+	{
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)))
+		{
+			VoxelType tCollapsedValue;
+			const VoxelType* pLeaf = getLeaf(uXPos >> m_uLeafSideLengthPower, uYPos >> m_uLeafSideLengthPower, uZPos >> m_uLeafSideLengthPower, tCollapsedValue);
+			if(pLeaf)
+			{
+				return pLeaf[getVoxelIndexInLeaf(uXPos, uYPos, uZPos)];
+			}
+			return tCollapsedValue;
+		}
+		else
+		{
+			return getBorderValue();
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getVoxelAt(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The voxels are copied leaf by leaf, a row at a time. Collapsed leaves are just filled in with their value.
+	/// \param regRead The region to read
+	/// \param pDestination The buffer which receives the voxels, with \c x varying fastest, then \c y, then \c z
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::readRegion(const Region& regRead, VoxelType* pDestination) const
+	{
+		assert(regRead.isValid());
+
+		Region regCropped(regRead);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(regCropped != regRead)
+		{
+			//Any voxels outside the volume are given the border value.
+			fillRegionPart(pDestination, regRead, regRead, getBorderValue());
+			if(!regCropped.isValid())
+			{
+				return;
+			}
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uLeafSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regLeaf = getRegionOfBlock(x, y, z, m_uLeafSideLengthPower);
+					Region regPart(regLeaf);
+					regPart.cropTo(regCropped);
+
+					VoxelType tCollapsedValue;
+					const VoxelType* pLeaf = getLeaf(x, y, z, tCollapsedValue);
+					if(pLeaf)
+					{
+						copyRegionPart(pLeaf, regLeaf, pDestination, regRead, regPart);
+					}
+					else
+					{
+						fillRegionPart(pDestination, regRead, regPart, tCollapsedValue);
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::setBorderValue(const VoxelType& tBorder) 
+	{
+		m_tBorderValue = tBorder;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Setting a voxel to the value it already has does not allocate any memory, even if it is in a collapsed leaf.
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool SparseVolume<VoxelType>::setVoxelAt(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		assert(this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)));
+
+		const int32_t uLeafX = uXPos >> m_uLeafSideLengthPower;
+		const int32_t uLeafY = uYPos >> m_uLeafSideLengthPower;
+		const int32_t uLeafZ = uZPos >> m_uLeafSideLengthPower;
+
+		VoxelType tCollapsedValue;
+		VoxelType* pLeaf = getLeaf(uLeafX, uLeafY, uLeafZ, tCollapsedValue);
+		if(!pLeaf)
+		{
+			if(tCollapsedValue == tValue)
+			{
+				//The voxel already has this value.
+				return true;
+			}
+			pLeaf = getAllocatedLeaf(uLeafX, uLeafY, uLeafZ);
+		}
+
+		pLeaf[getVoxelIndexInLeaf(uXPos, uYPos, uZPos)] = tValue;
+
+		//Return true to indicate that we modified a voxel.
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	/// \return whether the requested position is inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	bool SparseVolume<VoxelType>::setVoxelAt(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		return setVoxelAt(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. Note that every leaf touched by the region
+	/// is allocated, so prune() may be worth calling afterwards if much of the data was uniform.
+	/// \param regWrite The region to write
+	/// \param pSource The buffer holding the new values of the voxels, laid out as for readRegion()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::writeRegion(const Region& regWrite, const VoxelType* pSource)
+	{
+		assert(regWrite.isValid());
+
+		Region regCropped(regWrite);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uLeafSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regLeaf = getRegionOfBlock(x, y, z, m_uLeafSideLengthPower);
+					Region regPart(regLeaf);
+					regPart.cropTo(regCropped);
+
+					copyRegionPart(pSource, regWrite, getAllocatedLeaf(x, y, z), regLeaf, regPart);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any part of the region which is outside the volume is skipped. Leaves which are completely covered
+	/// by the region are collapsed, which (as with prune()) means that Samplers should not be used across calls to it.
+	/// \param regFill The region to fill
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::fillRegion(const Region& regFill, VoxelType tValue)
+	{
+		Region regCropped(regFill);
+		regCropped.cropTo(this->m_regValidRegion);
+		if(!regCropped.isValid())
+		{
+			return;
+		}
+
+		const Region regBlocks = getBlocksInRegion(regCropped, m_uLeafSideLengthPower);
+		for(int32_t z = regBlocks.getLowerCorner().getZ(); z <= regBlocks.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = regBlocks.getLowerCorner().getY(); y <= regBlocks.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = regBlocks.getLowerCorner().getX(); x <= regBlocks.getUpperCorner().getX(); x++)
+				{
+					const Region regLeaf = getRegionOfBlock(x, y, z, m_uLeafSideLengthPower);
+					Region regPart(regLeaf);
+					regPart.cropTo(regCropped);
+
+					if(regPart == regLeaf)
+					{
+						collapseLeaf(x, y, z, tValue);
+						continue;
+					}
+
+					VoxelType tCollapsedValue;
+					VoxelType* pLeaf = getLeaf(x, y, z, tCollapsedValue);
+					if(!pLeaf)
+					{
+						if(tCollapsedValue == tValue)
+						{
+							//The leaf already has this value.
+							continue;
+						}
+						pLeaf = getAllocatedLeaf(x, y, z);
+					}
+					fillRegionPart(pLeaf, regLeaf, regPart, tValue);
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any leaf whose voxels all have the same value is freed and replaced by that value, and then any node whose
+	/// leaves are all collapsed to the same value is freed in the same way. This has to look at every voxel in every
+	/// allocated leaf, so it is best called after a batch of changes rather than after each one.
+	///
+	/// Samplers may be left pointing at freed leaves, so they should not be used across a call to this function.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::prune(void)
+	{
+		for(uint32_t uNodeIndex = 0; uNodeIndex < m_vecNodes.size(); uNodeIndex++)
+		{
+			Node* pNode = m_vecNodes[uNodeIndex];
+			if(!pNode)
+			{
+				continue;
+			}
+
+			for(uint32_t uLeafIndex = 0; uLeafIndex < uNoOfLeavesPerNode; uLeafIndex++)
+			{
+				VoxelType* pLeaf = pNode->m_vecLeaves[uLeafIndex];
+				if(!pLeaf)
+				{
+					continue;
+				}
+
+				const VoxelType tFirstValue = pLeaf[0];
+				uint32_t uVoxelIndex = 1;
+				while((uVoxelIndex < m_uNoOfVoxelsPerLeaf) && (pLeaf[uVoxelIndex] == tFirstValue))
+				{
+					uVoxelIndex++;
+				}
+
+				if(uVoxelIndex == m_uNoOfVoxelsPerLeaf)
+				{
+					delete[] pLeaf;
+					pNode->m_vecLeaves[uLeafIndex] = 0;
+					pNode->m_vecLeafValues[uLeafIndex] = tFirstValue;
+					pNode->m_uNoOfLeaves--;
+				}
+			}
+
+			if(pNode->m_uNoOfLeaves == 0)
+			{
+				const VoxelType tFirstValue = pNode->m_vecLeafValues[0];
+				uint32_t uLeafIndex = 1;
+				while((uLeafIndex < uNoOfLeavesPerNode) && (pNode->m_vecLeafValues[uLeafIndex] == tFirstValue))
+				{
+					uLeafIndex++;
+				}
+
+				if(uLeafIndex == uNoOfLeavesPerNode)
+				{
+					delete pNode;
+					m_vecNodes[uNodeIndex] = 0;
+					m_vecNodeValues[uNodeIndex] = tFirstValue;
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The length of the sides of the leaves, in voxels.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint16_t SparseVolume<VoxelType>::getLeafSideLength(void) const
+	{
+		return m_uLeafSideLength;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The number of leaves which have their own voxels, rather than being collapsed.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::getNoOfLeaves(void) const
+	{
+		uint32_t uNoOfLeaves = 0;
+		for(uint32_t ct = 0; ct < m_vecNodes.size(); ct++)
+		{
+			if(m_vecNodes[ct])
+			{
+				uNoOfLeaves += m_vecNodes[ct]->m_uNoOfLeaves;
+			}
+		}
+		return uNoOfLeaves;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should probably be made internal...
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::initialise(const Region& regValidRegion, uint16_t uLeafSideLength)
+	{
+		//Debug mode validation
+		assert(uLeafSideLength > 0);
+		assert(isPowerOf2(uLeafSideLength));
+		
+		//Release mode validation
+		if(uLeafSideLength == 0)
+		{
+			throw std::invalid_argument("Leaf side length cannot be zero.");
+		}
+		if(!isPowerOf2(uLeafSideLength))
+		{
+			throw std::invalid_argument("Leaf side length must be a power of two.");
+		}
+
+		this->m_regValidRegion = regValidRegion;
+		m_tBorderValue = VoxelType();
+
+		//Compute the leaf side length
+		m_uLeafSideLength = uLeafSideLength;
+		m_uLeafSideLengthPower = logBase2(m_uLeafSideLength);
+		m_uNoOfVoxelsPerLeaf = m_uLeafSideLength * m_uLeafSideLength * m_uLeafSideLength;
+
+		m_regValidRegionInLeaves.setLowerCorner(Vector3DInt32(this->m_regValidRegion.getLowerCorner().getX() >> m_uLeafSideLengthPower, this->m_regValidRegion.getLowerCorner().getY() >> m_uLeafSideLengthPower, this->m_regValidRegion.getLowerCorner().getZ() >> m_uLeafSideLengthPower));
+		m_regValidRegionInLeaves.setUpperCorner(Vector3DInt32(this->m_regValidRegion.getUpperCorner().getX() >> m_uLeafSideLengthPower, this->m_regValidRegion.getUpperCorner().getY() >> m_uLeafSideLengthPower, this->m_regValidRegion.getUpperCorner().getZ() >> m_uLeafSideLengthPower));
+
+		m_regValidRegionInNodes.setLowerCorner(Vector3DInt32(m_regValidRegionInLeaves.getLowerCorner().getX() >> uNodeSideLengthInLeavesPower, m_regValidRegionInLeaves.getLowerCorner().getY() >> uNodeSideLengthInLeavesPower, m_regValidRegionInLeaves.getLowerCorner().getZ() >> uNodeSideLengthInLeavesPower));
+		m_regValidRegionInNodes.setUpperCorner(Vector3DInt32(m_regValidRegionInLeaves.getUpperCorner().getX() >> uNodeSideLengthInLeavesPower, m_regValidRegionInLeaves.getUpperCorner().getY() >> uNodeSideLengthInLeavesPower, m_regValidRegionInLeaves.getUpperCorner().getZ() >> uNodeSideLengthInLeavesPower));
+
+		//Compute the size of the volume in nodes (and note +1 at the end)
+		m_uWidthInNodes = m_regValidRegionInNodes.getUpperCorner().getX() - m_regValidRegionInNodes.getLowerCorner().getX() + 1;
+		m_uHeightInNodes = m_regValidRegionInNodes.getUpperCorner().getY() - m_regValidRegionInNodes.getLowerCorner().getY() + 1;
+		m_uDepthInNodes = m_regValidRegionInNodes.getUpperCorner().getZ() - m_regValidRegionInNodes.getLowerCorner().getZ() + 1;
+
+		//All the nodes start out collapsed.
+		const uint32_t uNoOfNodes = m_uWidthInNodes * m_uHeightInNodes * m_uDepthInNodes;
+		m_vecNodes.assign(uNoOfNodes, static_cast<Node*>(0));
+		m_vecNodeValues.assign(uNoOfNodes, VoxelType());
+
+		//Other properties we might find useful later
+		this->m_uLongestSideLength = (std::max)((std::max)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_uShortestSideLength = (std::min)((std::min)(this->getWidth(),this->getHeight()),this->getDepth());
+		this->m_fDiagonalLength = sqrtf(static_cast<float>(this->getWidth() * this->getWidth() + this->getHeight() * this->getHeight() + this->getDepth() * this->getDepth()));
+	}
+
+	template <typename VoxelType>
+	VoxelType* SparseVolume<VoxelType>::getLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ, VoxelType& tCollapsedValue) const
+	{
+		const uint32_t uNodeIndex = getNodeIndex(uLeafX, uLeafY, uLeafZ);
+		const Node* pNode = m_vecNodes[uNodeIndex];
+		if(!pNode)
+		{
+			tCollapsedValue = m_vecNodeValues[uNodeIndex];
+			return 0;
+		}
+
+		const uint32_t uLeafIndex = getLeafIndexInNode(uLeafX, uLeafY, uLeafZ);
+		VoxelType* pLeaf = pNode->m_vecLeaves[uLeafIndex];
+		if(!pLeaf)
+		{
+			tCollapsedValue = pNode->m_vecLeafValues[uLeafIndex];
+		}
+		return pLeaf;
+	}
+
+	template <typename VoxelType>
+	VoxelType* SparseVolume<VoxelType>::getAllocatedLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ)
+	{
+		const uint32_t uNodeIndex = getNodeIndex(uLeafX, uLeafY, uLeafZ);
+		Node* pNode = m_vecNodes[uNodeIndex];
+		if(!pNode)
+		{
+			pNode = new Node(m_vecNodeValues[uNodeIndex]);
+			m_vecNodes[uNodeIndex] = pNode;
+		}
+
+		const uint32_t uLeafIndex = getLeafIndexInNode(uLeafX, uLeafY, uLeafZ);
+		VoxelType* pLeaf = pNode->m_vecLeaves[uLeafIndex];
+		if(!pLeaf)
+		{
+			pLeaf = new VoxelType[m_uNoOfVoxelsPerLeaf];
+			std::fill(pLeaf, pLeaf + m_uNoOfVoxelsPerLeaf, pNode->m_vecLeafValues[uLeafIndex]);
+			pNode->m_vecLeaves[uLeafIndex] = pLeaf;
+			pNode->m_uNoOfLeaves++;
+		}
+		return pLeaf;
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::collapseLeaf(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ, const VoxelType& tValue)
+	{
+		const uint32_t uNodeIndex = getNodeIndex(uLeafX, uLeafY, uLeafZ);
+		Node* pNode = m_vecNodes[uNodeIndex];
+		if(!pNode)
+		{
+			if(m_vecNodeValues[uNodeIndex] == tValue)
+			{
+				return;
+			}
+			pNode = new Node(m_vecNodeValues[uNodeIndex]);
+			m_vecNodes[uNodeIndex] = pNode;
+		}
+
+		const uint32_t uLeafIndex = getLeafIndexInNode(uLeafX, uLeafY, uLeafZ);
+		if(pNode->m_vecLeaves[uLeafIndex])
+		{
+			delete[] pNode->m_vecLeaves[uLeafIndex];
+			pNode->m_vecLeaves[uLeafIndex] = 0;
+			pNode->m_uNoOfLeaves--;
+		}
+		pNode->m_vecLeafValues[uLeafIndex] = tValue;
+	}
+
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::getNodeIndex(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ) const
+	{
+		//The lower left corner of the volume could be
+		//anywhere, but array indices need to start at zero.
+		const int32_t uNodeX = (uLeafX >> uNodeSideLengthInLeavesPower) - m_regValidRegionInNodes.getLowerCorner().getX();
+		const int32_t uNodeY = (uLeafY >> uNodeSideLengthInLeavesPower) - m_regValidRegionInNodes.getLowerCorner().getY();
+		const int32_t uNodeZ = (uLeafZ >> uNodeSideLengthInLeavesPower) - m_regValidRegionInNodes.getLowerCorner().getZ();
+
+		return uNodeX + uNodeY * m_uWidthInNodes + uNodeZ * m_uWidthInNodes * m_uHeightInNodes;
+	}
+
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::getLeafIndexInNode(int32_t uLeafX, int32_t uLeafY, int32_t uLeafZ)
+	{
+		const int32_t uMask = uNodeSideLengthInLeaves - 1;
+		return (uLeafX & uMask) | ((uLeafY & uMask) << uNodeSideLengthInLeavesPower) | ((uLeafZ & uMask) << (uNodeSideLengthInLeavesPower * 2));
+	}
+
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::getVoxelIndexInLeaf(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		const int32_t uMask = m_uLeafSideLength - 1;
+		return (uXPos & uMask) + (uYPos & uMask) * m_uLeafSideLength + (uZPos & uMask) * m_uLeafSideLength * m_uLeafSideLength;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Collapsed nodes and leaves only count as the single value which represents them.
+	/// \return The number of bytes used
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::calculateSizeInBytes(void)
+	{
+		uint32_t uSizeInBytes = sizeof(SparseVolume);
+
+		uSizeInBytes += m_vecNodes.capacity() * sizeof(Node*);
+		uSizeInBytes += m_vecNodeValues.capacity() * sizeof(VoxelType);
+
+		for(uint32_t ct = 0; ct < m_vecNodes.size(); ct++)
+		{
+			const Node* pNode = m_vecNodes[ct];
+			if(pNode)
+			{
+				uSizeInBytes += sizeof(Node);
+				uSizeInBytes += pNode->m_vecLeaves.capacity() * sizeof(VoxelType*);
+				uSizeInBytes += pNode->m_vecLeafValues.capacity() * sizeof(VoxelType);
+				uSizeInBytes += pNode->m_uNoOfLeaves * m_uNoOfVoxelsPerLeaf * sizeof(VoxelType);
+			}
+		}
+
+		return uSizeInBytes;
+	}
+}
@@ -0,0 +1,585 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#define BORDER_LOW(x) ((( x >> this->mVolume->m_uLeafSideLengthPower) << this->mVolume->m_uLeafSideLengthPower) != x)
+#define BORDER_HIGH(x) ((( (x+1) >> this->mVolume->m_uLeafSideLengthPower) << this->mVolume->m_uLeafSideLengthPower) != (x+1))
+//#define BORDER_LOW(x) (( x % this->mVolume->m_uLeafSideLength) != 0)
+//#define BORDER_HIGH(x) (( x % this->mVolume->m_uLeafSideLength) != this->mVolume->m_uLeafSideLength - 1)
+
+namespace PolyVox
+{
+	/**
+	 * \param volume The SparseVolume you want to sample
+	 */
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Sampler::Sampler(SparseVolume<VoxelType>* volume)
+		:BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >(volume)
+		,mCurrentVoxel(0)
+		,mIsInLeaf(false)
+	{
+	}
+
+	/**
+	 * \param rhs The Sampler to copy. The new Sampler has its own copy of any collapsed leaf.
+	 */
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Sampler::Sampler(const typename SparseVolume<VoxelType>::Sampler& rhs)
+		:BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >(rhs.mVolume)
+		,mCurrentVoxel(0)
+		,mIsInLeaf(false)
+	{
+		if(rhs.mCurrentVoxel)
+		{
+			setPosition(rhs.mXPosInVolume, rhs.mYPosInVolume, rhs.mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Sampler::~Sampler()
+	{
+	}
+
+	template <typename VoxelType>
+	typename SparseVolume<VoxelType>::Sampler& SparseVolume<VoxelType>::Sampler::operator=(const typename SparseVolume<VoxelType>::Sampler& rhs)
+	{
+		if(this == &rhs)
+		{
+			return *this;
+		}
+		this->mVolume = rhs.mVolume;
+		//mCurrentVoxel might point into the other Sampler's copy of a collapsed leaf, so look it up again.
+		if(rhs.mCurrentVoxel)
+		{
+			setPosition(rhs.mXPosInVolume, rhs.mYPosInVolume, rhs.mZPosInVolume);
+		}
+		else
+		{
+			this->mXPosInVolume = rhs.mXPosInVolume;
+			this->mYPosInVolume = rhs.mYPosInVolume;
+			this->mZPosInVolume = rhs.mZPosInVolume;
+			mCurrentVoxel = 0;
+			mIsInLeaf = false;
+		}
+		return *this;
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::getSubSampledVoxel(uint8_t uLevel) const
+	{		
+		if(uLevel == 0)
+		{
+			return getVoxel();
+		}
+		else if(uLevel == 1)
+		{
+			VoxelType tValue = getVoxel();
+			tValue = (std::min)(tValue, peekVoxel1px0py0pz());
+			tValue = (std::min)(tValue, peekVoxel0px1py0pz());
+			tValue = (std::min)(tValue, peekVoxel1px1py0pz());
+			tValue = (std::min)(tValue, peekVoxel0px0py1pz());
+			tValue = (std::min)(tValue, peekVoxel1px0py1pz());
+			tValue = (std::min)(tValue, peekVoxel0px1py1pz());
+			tValue = (std::min)(tValue, peekVoxel1px1py1pz());
+			return tValue;
+		}
+		else
+		{
+			const uint8_t uSize = 1 << uLevel;
+
+			VoxelType tValue = (std::numeric_limits<VoxelType>::max)();
+			for(uint8_t z = 0; z < uSize; ++z)
+			{
+				for(uint8_t y = 0; y < uSize; ++y)
+				{
+					for(uint8_t x = 0; x < uSize; ++x)
+					{
+						tValue = (std::min)(tValue, this->mVolume->getVoxelAt(this->mXPosInVolume + x, this->mYPosInVolume + y, this->mZPosInVolume + z));
+					}
+				}
+			}
+			return tValue;
+		}
+	}
+	
+	/**
+	 * \return The current voxel
+	 */
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::getVoxel(void) const
+	{
+		return *mCurrentVoxel;
+	}
+	
+	/**
+	 * \param v3dNewPos The position to set to
+	 */
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	{
+		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
+	}
+	
+	/**
+	 * \param xPos The \a x position to set to
+	 * \param yPos The \a y position to set to
+	 * \param zPos The \a z position to set to
+	 */
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	{
+		this->mXPosInVolume = xPos;
+		this->mYPosInVolume = yPos;
+		this->mZPosInVolume = zPos;
+
+		const int32_t uXLeaf = this->mXPosInVolume >> this->mVolume->m_uLeafSideLengthPower;
+		const int32_t uYLeaf = this->mYPosInVolume >> this->mVolume->m_uLeafSideLengthPower;
+		const int32_t uZLeaf = this->mZPosInVolume >> this->mVolume->m_uLeafSideLengthPower;
+
+		const uint32_t uVoxelIndexInLeaf = this->mVolume->getVoxelIndexInLeaf(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+
+		VoxelType tCollapsedValue;
+		VoxelType* pLeaf = 0;
+		if(this->mVolume->m_regValidRegionInLeaves.containsPoint(Vector3DInt32(uXLeaf, uYLeaf, uZLeaf)))
+		{
+			pLeaf = this->mVolume->getLeaf(uXLeaf, uYLeaf, uZLeaf, tCollapsedValue);
+		}
+		else
+		{
+			tCollapsedValue = this->mVolume->getBorderValue();
+		}
+
+		mIsInLeaf = (pLeaf != 0);
+		if(mIsInLeaf)
+		{
+			mCurrentVoxel = pLeaf + uVoxelIndexInLeaf;
+		}
+		else
+		{
+			//Only refill our copy of the collapsed leaf if the value has changed.
+			if(mCollapsedLeafData.empty() || !(mCollapsedLeafData[0] == tCollapsedValue))
+			{
+				mCollapsedLeafData.assign(this->mVolume->m_uNoOfVoxelsPerLeaf, tCollapsedValue);
+			}
+			mCurrentVoxel = &mCollapsedLeafData[0] + uVoxelIndexInLeaf;
+		}
+	}
+
+	/**
+	 * \details
+	 * 
+	 * This function checks that the current voxel position that you're trying
+	 * to set is not outside the volume. If it is, this function returns
+	 * \a false, otherwise it will return \a true.
+	 * 
+	 * \param tValue The value to set to voxel to
+	 */
+	template <typename VoxelType>
+	bool SparseVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
+	{
+		if(mIsInLeaf)
+		{
+			*mCurrentVoxel = tValue;
+			return true;
+		}
+
+		//Make sure we're not trying to write to the border
+		if(!this->mVolume->getEnclosingRegion().containsPoint(Vector3DInt32(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume)))
+		{
+			return false;
+		}
+
+		//The leaf is collapsed, so let the volume allocate it (if the value is different) and then find it again.
+		this->mVolume->setVoxelAt(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume, tValue);
+		setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		return true;
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveX(void)
+	{
+		//Note the *pre* increament here
+		if((++this->mXPosInVolume) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			++mCurrentVoxel;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveY(void)
+	{
+		//Note the *pre* increament here
+		if((++this->mYPosInVolume) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			mCurrentVoxel += this->mVolume->m_uLeafSideLength;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveZ(void)
+	{
+		//Note the *pre* increament here
+		if((++this->mZPosInVolume) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			mCurrentVoxel += this->mVolume->m_uLeafSideLength * this->mVolume->m_uLeafSideLength;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeX(void)
+	{
+		//Note the *post* decreament here
+		if((this->mXPosInVolume--) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			--mCurrentVoxel;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeY(void)
+	{
+		//Note the *post* decreament here
+		if((this->mYPosInVolume--) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			mCurrentVoxel -= this->mVolume->m_uLeafSideLength;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeZ(void)
+	{
+		//Note the *post* decreament here
+		if((this->mZPosInVolume--) % this->mVolume->m_uLeafSideLength != 0)
+		{
+			//No need to compute new block.
+			mCurrentVoxel -= this->mVolume->m_uLeafSideLength * this->mVolume->m_uLeafSideLength;
+		}
+		else
+		{
+			//We've hit the block boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny1nz(void) const
+	{
+		if(	BORDER_LOW(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 - this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny0pz(void) const
+	{
+		if(	BORDER_LOW(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 - this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny1pz(void) const
+	{
+		if(	BORDER_LOW(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 - this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py1nz(void) const
+	{
+		if(	BORDER_LOW(this->mXPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py0pz(void) const
+	{
+		if( BORDER_LOW(this->mXPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py1pz(void) const
+	{
+		if( BORDER_LOW(this->mXPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py1nz(void) const
+	{
+		if( BORDER_LOW(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 + this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py0pz(void) const
+	{
+		if( BORDER_LOW(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 + this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py1pz(void) const
+	{
+		if( BORDER_LOW(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - 1 + this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume-1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny1nz(void) const
+	{
+		if( BORDER_LOW(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny0pz(void) const
+	{
+		if( BORDER_LOW(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel - this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny1pz(void) const
+	{
+		if( BORDER_LOW(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume-1,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py1nz(void) const
+	{
+		if( BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py0pz(void) const
+	{
+			return *mCurrentVoxel;
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py1pz(void) const
+	{
+		if( BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py1nz(void) const
+	{
+		if( BORDER_HIGH(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py0pz(void) const
+	{
+		if( BORDER_HIGH(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel + this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py1pz(void) const
+	{
+		if( BORDER_HIGH(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume,this->mYPosInVolume+1,this->mZPosInVolume+1);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny1nz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 - this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny0pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 - this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny1pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_LOW(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 - this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume-1,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py1nz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py0pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py1pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume,this->mZPosInVolume+1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py1nz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) && BORDER_LOW(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 + this->mVolume->m_uLeafSideLength - this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume-1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py0pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 + this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py1pz(void) const
+	{
+		if( BORDER_HIGH(this->mXPosInVolume) && BORDER_HIGH(this->mYPosInVolume) && BORDER_HIGH(this->mZPosInVolume) )
+		{
+			return *(mCurrentVoxel + 1 + this->mVolume->m_uLeafSideLength + this->mVolume->m_uLeafSideLength*this->mVolume->m_uLeafSideLength);
+		}
+		return this->mVolume->getVoxelAt(this->mXPosInVolume+1,this->mYPosInVolume+1,this->mZPosInVolume+1);
+	}
+}
+
+#undef BORDER_LOW
+#undef BORDER_HIGH
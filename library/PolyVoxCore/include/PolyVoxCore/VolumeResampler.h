@@ -25,6 +25,7 @@ freely, subject to the following restrictions:
 #define __PolyVox_VolumeResampler_H__
 
 #include <cmath>
+#include <vector>
 
 namespace PolyVox
 {
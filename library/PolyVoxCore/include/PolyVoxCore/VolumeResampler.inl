@@ -22,6 +22,7 @@ freely, subject to the following restrictions:
 *******************************************************************************/
 
 #include "PolyVoxCore/Interpolation.h"
+#include "PolyVoxCore/Impl/VolumeRegionAccess.h"
 
 namespace PolyVox
 {
@@ -64,17 +65,24 @@ namespace PolyVox
 	template< typename SrcVolumeType, typename DstVolumeType>
 	void VolumeResampler<SrcVolumeType, DstVolumeType>::resampleSameSize()
 	{
+		//The copy goes a slice at a time through a buffer, so that the volumes can copy whole rows of voxels
+		//rather than looking up each one. Only the conversion between the voxel types is done per voxel.
+		const int32_t iWidth = m_regDst.getWidthInVoxels();
+		const int32_t iHeight = m_regDst.getHeightInVoxels();
+		std::vector<typename SrcVolumeType::VoxelType> vecSrcSlice(iWidth * iHeight);
+		std::vector<typename DstVolumeType::VoxelType> vecDstSlice(iWidth * iHeight);
+
 		for(int32_t sz = m_regSrc.getLowerCorner().getZ(), dz = m_regDst.getLowerCorner().getZ(); dz <= m_regDst.getUpperCorner().getZ(); sz++, dz++)
 		{
-			for(int32_t sy = m_regSrc.getLowerCorner().getY(), dy = m_regDst.getLowerCorner().getY(); dy <= m_regDst.getUpperCorner().getY(); sy++, dy++)
+			const Region regSrcSlice(m_regSrc.getLowerCorner().getX(), m_regSrc.getLowerCorner().getY(), sz, m_regSrc.getUpperCorner().getX(), m_regSrc.getUpperCorner().getY(), sz);
+			const Region regDstSlice(m_regDst.getLowerCorner().getX(), m_regDst.getLowerCorner().getY(), dz, m_regDst.getUpperCorner().getX(), m_regDst.getUpperCorner().getY(), dz);
+
+			readVolumeRegion(m_pVolSrc, regSrcSlice, &vecSrcSlice[0]);
+			for(uint32_t uIndex = 0; uIndex < vecSrcSlice.size(); uIndex++)
 			{
-				for(int32_t sx = m_regSrc.getLowerCorner().getX(), dx = m_regDst.getLowerCorner().getX(); dx <= m_regDst.getUpperCorner().getX(); sx++,dx++)
-				{
-					const typename SrcVolumeType::VoxelType& tSrcVoxel = m_pVolSrc->getVoxelAt(sx,sy,sz);
-					const typename DstVolumeType::VoxelType& tDstVoxel = static_cast<typename DstVolumeType::VoxelType>(tSrcVoxel);
-					m_pVolDst->setVoxelAt(dx,dy,dz,tDstVoxel);
-				}
+				vecDstSlice[uIndex] = static_cast<typename DstVolumeType::VoxelType>(vecSrcSlice[uIndex]);
 			}
+			writeVolumeRegion(m_pVolDst, regDstSlice, &vecDstSlice[0]);
 		}
 	}
 
@@ -0,0 +1,244 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "PolyVoxCore/Impl/MappedFile.h"
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+#if defined _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any existing file with this name is replaced. On most file systems the new
+	/// file is sparse, so no disk space is used until the data is written to.
+	/// \param strFilename The name of the file to create.
+	/// \param uSizeInBytes The size of the file. The data starts out as zeros.
+	////////////////////////////////////////////////////////////////////////////////
+	MappedFile::MappedFile(const std::string& strFilename, uint64_t uSizeInBytes)
+	{
+		open(strFilename, true, uSizeInBytes);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param strFilename The name of the file to open, which must already exist.
+	////////////////////////////////////////////////////////////////////////////////
+	MappedFile::MappedFile(const std::string& strFilename)
+	{
+		open(strFilename, false, 0);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	uint8_t* MappedFile::getData(void) const
+	{
+		return m_pData;
+	}
+
+	uint64_t MappedFile::getSizeInBytes(void) const
+	{
+		return m_uSizeInBytes;
+	}
+
+#if defined _WIN32
+	void MappedFile::open(const std::string& strFilename, bool bCreate, uint64_t uSizeInBytes)
+	{
+		m_pData = 0;
+		m_uSizeInBytes = 0;
+		m_hMapping = 0;
+
+		m_hFile = CreateFileA(strFilename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0, bCreate ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if(m_hFile == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error("Failed to open the file '" + strFilename + "'.");
+		}
+
+		if(bCreate)
+		{
+			//Mark the file as sparse so that setting its size doesn't write out all the zeros.
+			DWORD uBytesReturned = 0;
+			DeviceIoControl(m_hFile, FSCTL_SET_SPARSE, 0, 0, 0, 0, &uBytesReturned, 0);
+
+			LARGE_INTEGER iSize;
+			iSize.QuadPart = static_cast<LONGLONG>(uSizeInBytes);
+			if(!SetFilePointerEx(m_hFile, iSize, 0, FILE_BEGIN) || !SetEndOfFile(m_hFile))
+			{
+				close();
+				throw std::runtime_error("Failed to set the size of the file '" + strFilename + "'.");
+			}
+			m_uSizeInBytes = uSizeInBytes;
+		}
+		else
+		{
+			LARGE_INTEGER iSize;
+			if(!GetFileSizeEx(m_hFile, &iSize))
+			{
+				close();
+				throw std::runtime_error("Failed to get the size of the file '" + strFilename + "'.");
+			}
+			m_uSizeInBytes = static_cast<uint64_t>(iSize.QuadPart);
+		}
+
+		//An empty file can't be mapped, but there's nothing in it to access anyway.
+		if(m_uSizeInBytes == 0)
+		{
+			return;
+		}
+
+		if(m_uSizeInBytes > (std::numeric_limits<size_t>::max)())
+		{
+			close();
+			throw std::runtime_error("The file '" + strFilename + "' is too large to be mapped into memory.");
+		}
+
+		m_hMapping = CreateFileMappingA(m_hFile, 0, PAGE_READWRITE, 0, 0, 0);
+		if(m_hMapping)
+		{
+			m_pData = static_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+		}
+		if(m_pData == 0)
+		{
+			close();
+			throw std::runtime_error("Failed to map the file '" + strFilename + "' into memory.");
+		}
+	}
+
+	void MappedFile::close(void)
+	{
+		if(m_pData)
+		{
+			UnmapViewOfFile(m_pData);
+			m_pData = 0;
+		}
+		if(m_hMapping)
+		{
+			CloseHandle(m_hMapping);
+			m_hMapping = 0;
+		}
+		if(m_hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_hFile);
+			m_hFile = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	void MappedFile::flush(void)
+	{
+		if(m_pData)
+		{
+			FlushViewOfFile(m_pData, 0);
+			FlushFileBuffers(m_hFile);
+		}
+	}
+#else
+	void MappedFile::open(const std::string& strFilename, bool bCreate, uint64_t uSizeInBytes)
+	{
+		m_pData = 0;
+		m_uSizeInBytes = 0;
+
+		m_iFile = ::open(strFilename.c_str(), bCreate ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+		if(m_iFile == -1)
+		{
+			throw std::runtime_error("Failed to open the file '" + strFilename + "'.");
+		}
+
+		if(bCreate)
+		{
+			//Extending the file like this leaves a hole, so it doesn't use any disk space until it's written to.
+			if(ftruncate(m_iFile, static_cast<off_t>(uSizeInBytes)) != 0)
+			{
+				close();
+				throw std::runtime_error("Failed to set the size of the file '" + strFilename + "'.");
+			}
+			m_uSizeInBytes = uSizeInBytes;
+		}
+		else
+		{
+			struct stat fileStatus;
+			if(fstat(m_iFile, &fileStatus) != 0)
+			{
+				close();
+				throw std::runtime_error("Failed to get the size of the file '" + strFilename + "'.");
+			}
+			m_uSizeInBytes = static_cast<uint64_t>(fileStatus.st_size);
+		}
+
+		//An empty file can't be mapped, but there's nothing in it to access anyway.
+		if(m_uSizeInBytes == 0)
+		{
+			return;
+		}
+
+		if(m_uSizeInBytes > (std::numeric_limits<size_t>::max)())
+		{
+			close();
+			throw std::runtime_error("The file '" + strFilename + "' is too large to be mapped into memory.");
+		}
+
+		void* pData = mmap(0, static_cast<size_t>(m_uSizeInBytes), PROT_READ | PROT_WRITE, MAP_SHARED, m_iFile, 0);
+		if(pData == MAP_FAILED)
+		{
+			close();
+			throw std::runtime_error("Failed to map the file '" + strFilename + "' into memory.");
+		}
+		m_pData = static_cast<uint8_t*>(pData);
+	}
+
+	void MappedFile::close(void)
+	{
+		if(m_pData)
+		{
+			munmap(m_pData, static_cast<size_t>(m_uSizeInBytes));
+			m_pData = 0;
+		}
+		if(m_iFile != -1)
+		{
+			::close(m_iFile);
+			m_iFile = -1;
+		}
+	}
+
+	void MappedFile::flush(void)
+	{
+		if(m_pData)
+		{
+			msync(m_pData, static_cast<size_t>(m_uSizeInBytes), MS_SYNC);
+		}
+	}
+#endif
+}
@@ -0,0 +1,119 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "PolyVoxCore/Impl/ThreadPool.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace PolyVox
+{
+	ThreadPool::ThreadPool(uint32_t uNoOfThreads)
+		:m_uNoOfRunningTasks(0)
+		,m_bStopping(false)
+	{
+		//Debug mode validation
+		assert(uNoOfThreads > 0);
+
+		//Release mode validation
+		if(uNoOfThreads == 0)
+		{
+			throw std::invalid_argument("A thread pool needs at least one thread.");
+		}
+
+		for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+		{
+			m_vecThreads.push_back(new polyvox_thread(polyvox_bind(&ThreadPool::runWorker, this)));
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			polyvox_lock_guard<polyvox_mutex> lock(m_mutexTasks);
+			m_bStopping = true;
+		}
+		m_condTaskAvailable.notify_all();
+
+		for(uint32_t ct = 0; ct < m_vecThreads.size(); ct++)
+		{
+			m_vecThreads[ct]->join();
+			delete m_vecThreads[ct];
+		}
+	}
+
+	void ThreadPool::enqueue(polyvox_function<void()> funcTask)
+	{
+		{
+			polyvox_lock_guard<polyvox_mutex> lock(m_mutexTasks);
+			m_queueTasks.push_back(funcTask);
+		}
+		m_condTaskAvailable.notify_one();
+	}
+
+	void ThreadPool::waitForAll(void)
+	{
+		polyvox_unique_lock<polyvox_mutex> lock(m_mutexTasks);
+		while(!m_queueTasks.empty() || (m_uNoOfRunningTasks > 0))
+		{
+			m_condAllTasksDone.wait(lock);
+		}
+	}
+
+	uint32_t ThreadPool::getNoOfThreads(void) const
+	{
+		return static_cast<uint32_t>(m_vecThreads.size());
+	}
+
+	void ThreadPool::runWorker(void)
+	{
+		polyvox_unique_lock<polyvox_mutex> lock(m_mutexTasks);
+		for(;;)
+		{
+			while(m_queueTasks.empty() && !m_bStopping)
+			{
+				m_condTaskAvailable.wait(lock);
+			}
+
+			//We only stop once the queue is empty, so that no work is lost.
+			if(m_queueTasks.empty())
+			{
+				return;
+			}
+
+			polyvox_function<void()> funcTask = m_queueTasks.front();
+			m_queueTasks.pop_front();
+			m_uNoOfRunningTasks++;
+
+			lock.unlock();
+			funcTask();
+			lock.lock();
+
+			m_uNoOfRunningTasks--;
+			if(m_queueTasks.empty() && (m_uNoOfRunningTasks == 0))
+			{
+				m_condAllTasksDone.notify_all();
+			}
+		}
+	}
+}
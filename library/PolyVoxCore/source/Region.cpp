@@ -208,6 +208,13 @@ namespace PolyVox
 		m_v3dUpperCorner.setZ((std::min)(m_v3dUpperCorner.getZ(), other.m_v3dUpperCorner.getZ()));
 	}
 
+	bool Region::isValid(void) const
+	{
+		return (m_v3dLowerCorner.getX() <= m_v3dUpperCorner.getX())
+			&& (m_v3dLowerCorner.getY() <= m_v3dUpperCorner.getY())
+			&& (m_v3dLowerCorner.getZ() <= m_v3dUpperCorner.getZ());
+	}
+
 	/// \deprecated Use getDepthInVoxels() or getDepthInCells() instead
 	int32_t Region::depth(void) const
 	{
@@ -0,0 +1,446 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "TestBlockCompressor.h"
+
+#include "PolyVoxCore/Density.h"
+#include "PolyVoxCore/LargeVolume.h"
+#include "PolyVoxCore/LZCompressor.h"
+#include "PolyVoxCore/MaterialDensityPair.h"
+#include "PolyVoxCore/MortonRLECompressor.h"
+#include "PolyVoxCore/PaletteCompressor.h"
+#include "PolyVoxCore/RLECompressor.h"
+
+#include <QtTest>
+
+#include <algorithm>
+
+using namespace PolyVox;
+
+const uint16_t g_uSideLength = 32;
+const uint32_t g_uNoOfVoxels = g_uSideLength * g_uSideLength * g_uSideLength;
+
+//A simple linear congruential generator, so the 'random' data is the same on every platform.
+uint32_t nextRandom(uint32_t& uSeed)
+{
+	uSeed = uSeed * 1664525u + 1013904223u;
+	return uSeed >> 16;
+}
+
+//Rock made of 8x8x8 chunks of three materials, with a spherical cave in the middle.
+uint8_t caveValue(int32_t x, int32_t y, int32_t z)
+{
+	const int32_t iDistSquared = (x - 16) * (x - 16) + (y - 16) * (y - 16) + (z - 16) * (z - 16);
+	if(iDistSquared < 100)
+	{
+		return 0;
+	}
+	return static_cast<uint8_t>(1 + (x / 8 + y / 8 + z / 8) % 3);
+}
+
+template <typename VoxelType>
+bool compressAndCompare(const BlockCompressor<VoxelType>& compressor, const std::vector<VoxelType>& vecVoxels)
+{
+	std::vector<uint8_t> vecCompressedData;
+	compressor.compress(&vecVoxels[0], g_uSideLength, vecCompressedData);
+
+	std::vector<VoxelType> vecResult(g_uNoOfVoxels);
+	compressor.decompress(vecCompressedData, &vecResult[0], g_uSideLength);
+
+	return vecResult == vecVoxels;
+}
+
+template <typename VoxelType>
+void testRoundTripForAllCompressors(const std::vector<VoxelType>& vecVoxels)
+{
+	QCOMPARE(compressAndCompare(RLECompressor<VoxelType>(), vecVoxels), true);
+	QCOMPARE(compressAndCompare(MortonRLECompressor<VoxelType>(), vecVoxels), true);
+	QCOMPARE(compressAndCompare(PaletteCompressor<VoxelType>(), vecVoxels), true);
+	QCOMPARE(compressAndCompare(LZCompressor<VoxelType>(), vecVoxels), true);
+}
+
+void TestBlockCompressor::testRoundTrip()
+{
+	std::vector<uint8_t> vecUniform(g_uNoOfVoxels, 7);
+	testRoundTripForAllCompressors(vecUniform);
+
+	//Noise with only a few materials, and then with every possible value.
+	uint32_t uSeed = 0;
+	std::vector<uint8_t> vecFewMaterials(g_uNoOfVoxels);
+	std::vector<uint8_t> vecNoise(g_uNoOfVoxels);
+	for(uint32_t ct = 0; ct < g_uNoOfVoxels; ct++)
+	{
+		vecFewMaterials[ct] = static_cast<uint8_t>(nextRandom(uSeed) % 5);
+		vecNoise[ct] = static_cast<uint8_t>(nextRandom(uSeed));
+	}
+	testRoundTripForAllCompressors(vecFewMaterials);
+	testRoundTripForAllCompressors(vecNoise);
+
+	std::vector<uint8_t> vecCave(g_uNoOfVoxels);
+	std::vector<MaterialDensityPair44> vecCavePairs(g_uNoOfVoxels);
+	for(int32_t z = 0; z < g_uSideLength; z++)
+	{
+		for(int32_t y = 0; y < g_uSideLength; y++)
+		{
+			for(int32_t x = 0; x < g_uSideLength; x++)
+			{
+				const uint32_t uIndex = x + y * g_uSideLength + z * g_uSideLength * g_uSideLength;
+				vecCave[uIndex] = caveValue(x, y, z);
+				vecCavePairs[uIndex] = MaterialDensityPair44(vecCave[uIndex], (vecCave[uIndex] > 0) ? 15 : 0);
+			}
+		}
+	}
+	testRoundTripForAllCompressors(vecCave);
+	testRoundTripForAllCompressors(vecCavePairs);
+}
+
+void TestBlockCompressor::testUniformBlocks()
+{
+	//Each compressor's shortcut for uniform blocks must decompress to the same thing as the full block.
+	RLECompressor<uint8_t> rleCompressor;
+	MortonRLECompressor<uint8_t> mortonCompressor;
+	PaletteCompressor<uint8_t> paletteCompressor;
+	LZCompressor<uint8_t> lzCompressor;
+	const BlockCompressor<uint8_t>* compressors[] = {&rleCompressor, &mortonCompressor, &paletteCompressor, &lzCompressor};
+
+	for(uint32_t ct = 0; ct < 4; ct++)
+	{
+		std::vector<uint8_t> vecCompressedData;
+		compressors[ct]->compressUniform(42, g_uSideLength, vecCompressedData);
+
+		//Should be tiny, whatever the scheme.
+		QCOMPARE(vecCompressedData.size() < g_uNoOfVoxels / 100, true);
+
+		std::vector<uint8_t> vecResult(g_uNoOfVoxels);
+		compressors[ct]->decompress(vecCompressedData, &vecResult[0], g_uSideLength);
+		QCOMPARE(vecResult == std::vector<uint8_t>(g_uNoOfVoxels, 42), true);
+	}
+}
+
+void TestBlockCompressor::testLargeVolume()
+{
+	LargeVolume<uint8_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(63,63,63)));
+	//Keep the cache small so that most of the blocks are held compressed.
+	volData.setMaxNumberOfUncompressedBlocks(2);
+
+	for(int32_t z = 0; z < 64; z++)
+	{
+		for(int32_t y = 0; y < 64; y++)
+		{
+			for(int32_t x = 0; x < 64; x++)
+			{
+				volData.setVoxelAt(x, y, z, caveValue(x % 32, y % 32, z % 32));
+			}
+		}
+	}
+
+	QCOMPARE(volData.getCompressor()->getName(), "RLE");
+
+	MortonRLECompressor<uint8_t> mortonCompressor;
+	PaletteCompressor<uint8_t> paletteCompressor;
+	LZCompressor<uint8_t> lzCompressor;
+	BlockCompressor<uint8_t>* compressors[] = {&mortonCompressor, &paletteCompressor, &lzCompressor, 0};
+
+	for(uint32_t ct = 0; ct < 4; ct++)
+	{
+		//Switching recompresses the existing blocks, so the data must survive it.
+		volData.setCompressor(compressors[ct]);
+
+		uint32_t uNoOfMismatches = 0;
+		for(int32_t z = 0; z < 64; z++)
+		{
+			for(int32_t y = 0; y < 64; y++)
+			{
+				for(int32_t x = 0; x < 64; x++)
+				{
+					if(volData.getVoxelAt(x, y, z) != caveValue(x % 32, y % 32, z % 32))
+					{
+						uNoOfMismatches++;
+					}
+				}
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+	}
+
+	//Null restores the default.
+	QCOMPARE(volData.getCompressor()->getName(), "RLE");
+
+	//There are four materials, so the palette needs two bits per voxel.
+	QCOMPARE(volData.calculateCompressionRatio(&mortonCompressor) < 0.2f, true);
+	QCOMPARE(volData.calculateCompressionRatio(&lzCompressor) < 0.2f, true);
+	QCOMPARE(volData.calculateCompressionRatio(&paletteCompressor) < 0.26f, true);
+
+	//Runs along the Morton curve aren't broken at the end of each row.
+	QCOMPARE(volData.calculateCompressionRatio(&mortonCompressor) < volData.calculateCompressionRatio(volData.getCompressor()), true);
+}
+
+//Runs of every length from one up to a little over two AVX2 vectors, so that the ends of the runs fall at
+//every position within the vectors. The values alternate so that neighbouring runs are always different.
+template <typename VoxelType>
+std::vector<VoxelType> createRunsOfEveryLength(VoxelType tFirstValue, VoxelType tSecondValue)
+{
+	std::vector<VoxelType> vecVoxels;
+	vecVoxels.reserve(g_uNoOfVoxels);
+	uint32_t uLength = 1;
+	while(vecVoxels.size() < g_uNoOfVoxels)
+	{
+		const VoxelType tValue = (uLength % 2 == 0) ? tFirstValue : tSecondValue;
+		for(uint32_t ct = 0; (ct < uLength) && (vecVoxels.size() < g_uNoOfVoxels); ct++)
+		{
+			vecVoxels.push_back(tValue);
+		}
+		uLength = (uLength % 70) + 1;
+	}
+	return vecVoxels;
+}
+
+template <typename VoxelType>
+uint32_t countRuns(const std::vector<VoxelType>& vecVoxels)
+{
+	uint32_t uNoOfRuns = 1;
+	for(uint32_t ct = 1; ct < vecVoxels.size(); ct++)
+	{
+		if(!(vecVoxels[ct] == vecVoxels[ct - 1]))
+		{
+			uNoOfRuns++;
+		}
+	}
+	return uNoOfRuns;
+}
+
+//Used with visitRuns() to count the runs which a compressor has stored.
+template <typename VoxelType>
+void addRunToTotals(const VoxelType& /*tValue*/, uint32_t uLength, uint32_t* pNoOfRuns, uint32_t* pNoOfVoxels)
+{
+	(*pNoOfRuns)++;
+	*pNoOfVoxels += uLength;
+}
+
+template <typename VoxelType>
+void testRunLengthsForType(VoxelType tFirstValue, VoxelType tSecondValue)
+{
+	const std::vector<VoxelType> vecVoxels = createRunsOfEveryLength(tFirstValue, tSecondValue);
+	QCOMPARE(compressAndCompare(RLECompressor<VoxelType>(), vecVoxels), true);
+	QCOMPARE(compressAndCompare(MortonRLECompressor<VoxelType>(), vecVoxels), true);
+
+	//Each run should have been found exactly, whether or not the vectorised code was used.
+	RLECompressor<VoxelType> compressor;
+	std::vector<uint8_t> vecCompressedData;
+	compressor.compress(&vecVoxels[0], g_uSideLength, vecCompressedData);
+	uint32_t uNoOfRuns = 0;
+	uint32_t uNoOfVoxels = 0;
+	compressor.visitRuns(vecCompressedData, g_uSideLength, polyvox_bind(&addRunToTotals<VoxelType>, polyvox_placeholder_1, polyvox_placeholder_2, &uNoOfRuns, &uNoOfVoxels));
+	QCOMPARE(uNoOfRuns, countRuns(vecVoxels));
+	QCOMPARE(uNoOfVoxels, g_uNoOfVoxels);
+}
+
+void TestBlockCompressor::testRunLengths()
+{
+	testRunLengthsForType<uint8_t>(3, 200);
+	testRunLengthsForType<Density8>(Density8(0), Density8(255));
+	testRunLengthsForType<MaterialDensityPair44>(MaterialDensityPair44(1, 15), MaterialDensityPair44(1, 14));
+	testRunLengthsForType<uint16_t>(1000, 1001);
+	testRunLengthsForType<float>(0.5f, -0.5f);
+
+	//A run longer than the 16-bit length has to be split.
+	std::vector<uint8_t> vecLongRun(g_uSideLength * g_uSideLength * g_uSideLength * 8, 9);
+	vecLongRun.back() = 10;
+	std::vector<uint8_t> vecCompressedData;
+	RLECompressor<uint8_t>().compress(&vecLongRun[0], g_uSideLength * 2, vecCompressedData);
+	std::vector<uint8_t> vecResult(vecLongRun.size());
+	RLECompressor<uint8_t>().decompress(vecCompressedData, &vecResult[0], g_uSideLength * 2);
+	QCOMPARE(vecResult == vecLongRun, true);
+}
+
+template <typename VoxelType>
+void compressAndDecompressRepeatedly(const std::vector<VoxelType>& vecVoxels, std::vector<uint8_t>& vecCompressedData, std::vector<VoxelType>& vecResult)
+{
+	RLECompressor<VoxelType> compressor;
+	for(uint32_t ct = 0; ct < 100; ct++)
+	{
+		compressor.compress(&vecVoxels[0], g_uSideLength, vecCompressedData);
+		compressor.decompress(vecCompressedData, &vecResult[0], g_uSideLength);
+	}
+}
+
+void TestBlockCompressor::testRLEPerformance()
+{
+	//Terrain-like blocks in the three most common voxel types.
+	std::vector<uint8_t> vecCave(g_uNoOfVoxels);
+	std::vector<Density8> vecCaveDensities(g_uNoOfVoxels);
+	std::vector<MaterialDensityPair44> vecCavePairs(g_uNoOfVoxels);
+	for(int32_t z = 0; z < g_uSideLength; z++)
+	{
+		for(int32_t y = 0; y < g_uSideLength; y++)
+		{
+			for(int32_t x = 0; x < g_uSideLength; x++)
+			{
+				const uint32_t uIndex = x + y * g_uSideLength + z * g_uSideLength * g_uSideLength;
+				vecCave[uIndex] = caveValue(x, y, z);
+				vecCaveDensities[uIndex] = Density8((vecCave[uIndex] > 0) ? 255 : 0);
+				vecCavePairs[uIndex] = MaterialDensityPair44(vecCave[uIndex], (vecCave[uIndex] > 0) ? 15 : 0);
+			}
+		}
+	}
+
+	std::vector<uint8_t> vecCompressedData;
+	std::vector<uint8_t> vecResult(g_uNoOfVoxels);
+	std::vector<Density8> vecResultDensities(g_uNoOfVoxels);
+	std::vector<MaterialDensityPair44> vecResultPairs(g_uNoOfVoxels);
+	QBENCHMARK {
+		compressAndDecompressRepeatedly(vecCave, vecCompressedData, vecResult);
+		compressAndDecompressRepeatedly(vecCaveDensities, vecCompressedData, vecResultDensities);
+		compressAndDecompressRepeatedly(vecCavePairs, vecCompressedData, vecResultPairs);
+	}
+
+	QCOMPARE(vecResult == vecCave, true);
+	QCOMPARE(vecResultDensities == vecCaveDensities, true);
+	QCOMPARE(vecResultPairs == vecCavePairs, true);
+}
+
+//Used with visitRuns() to count how often each value occurs.
+void addRunToHistogram(const uint8_t& tValue, uint32_t uLength, std::vector<uint32_t>* pHistogram)
+{
+	(*pHistogram)[tValue] += uLength;
+}
+
+void TestBlockCompressor::testQueries()
+{
+	uint32_t uSeed = 0;
+	std::vector<uint8_t> vecCave(g_uNoOfVoxels);
+	std::vector<uint8_t> vecFewMaterials(g_uNoOfVoxels);
+	for(int32_t z = 0; z < g_uSideLength; z++)
+	{
+		for(int32_t y = 0; y < g_uSideLength; y++)
+		{
+			for(int32_t x = 0; x < g_uSideLength; x++)
+			{
+				const uint32_t uIndex = x + y * g_uSideLength + z * g_uSideLength * g_uSideLength;
+				vecCave[uIndex] = caveValue(x, y, z);
+				vecFewMaterials[uIndex] = static_cast<uint8_t>(nextRandom(uSeed) % 5);
+			}
+		}
+	}
+	const std::vector<uint8_t>* blocks[] = {&vecCave, &vecFewMaterials};
+
+	RLECompressor<uint8_t> rleCompressor;
+	MortonRLECompressor<uint8_t> mortonCompressor;
+	PaletteCompressor<uint8_t> paletteCompressor;
+	LZCompressor<uint8_t> lzCompressor;
+	const BlockCompressor<uint8_t>* compressors[] = {&rleCompressor, &mortonCompressor, &paletteCompressor, &lzCompressor};
+
+	//Every compressor must give the same answers from its compressed data as from the voxels.
+	for(uint32_t uBlock = 0; uBlock < 2; uBlock++)
+	{
+		const std::vector<uint8_t>& vecVoxels = *(blocks[uBlock]);
+		std::vector<uint32_t> vecExpectedHistogram(256, 0);
+		for(uint32_t ct = 0; ct < g_uNoOfVoxels; ct++)
+		{
+			vecExpectedHistogram[vecVoxels[ct]]++;
+		}
+
+		for(uint32_t uCompressor = 0; uCompressor < 4; uCompressor++)
+		{
+			std::vector<uint8_t> vecCompressedData;
+			compressors[uCompressor]->compress(&vecVoxels[0], g_uSideLength, vecCompressedData);
+
+			uint32_t uNoOfMismatches = 0;
+			for(uint32_t ct = 0; ct < g_uNoOfVoxels; ct++)
+			{
+				if(compressors[uCompressor]->getVoxelAt(vecCompressedData, g_uSideLength, ct) != vecVoxels[ct])
+				{
+					uNoOfMismatches++;
+				}
+			}
+			QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+			std::vector<uint32_t> vecHistogram(256, 0);
+			compressors[uCompressor]->visitRuns(vecCompressedData, g_uSideLength, polyvox_bind(&addRunToHistogram, polyvox_placeholder_1, polyvox_placeholder_2, &vecHistogram));
+			QCOMPARE(vecHistogram == vecExpectedHistogram, true);
+		}
+	}
+
+	//The volume's queries must not move any blocks into the uncompressed cache.
+	LargeVolume<uint8_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(63,63,63)));
+	volData.setMaxNumberOfUncompressedBlocks(2);
+	volData.setBorderValue(9);
+	for(int32_t z = 0; z < 64; z++)
+	{
+		for(int32_t y = 0; y < 64; y++)
+		{
+			for(int32_t x = 0; x < 64; x++)
+			{
+				volData.setVoxelAt(x, y, z, caveValue(x % 32, y % 32, z % 32));
+			}
+		}
+	}
+
+	const uint32_t uNoOfEmptyVoxels = static_cast<uint32_t>(std::count(vecCave.begin(), vecCave.end(), 0));
+	const uint32_t uMissesBefore = volData.getUncompressedBlockStatistics().misses;
+	const uint32_t uUncompressedSizeBefore = volData.getUncompressedSizeInBytes();
+
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = -1; z < 65; z++)
+	{
+		for(int32_t y = -1; y < 65; y++)
+		{
+			for(int32_t x = -1; x < 65; x++)
+			{
+				const bool bIsInside = (x >= 0) && (y >= 0) && (z >= 0) && (x < 64) && (y < 64) && (z < 64);
+				const uint8_t uExpectedValue = bIsInside ? caveValue(x % 32, y % 32, z % 32) : 9;
+				if(volData.getVoxelAtWithoutUncompressing(x, y, z) != uExpectedValue)
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+	QCOMPARE(volData.getUncompressedBlockStatistics().misses, uMissesBefore);
+	QCOMPARE(volData.getUncompressedSizeInBytes(), uUncompressedSizeBefore);
+
+	for(int32_t z = -1; z < 3; z++)
+	{
+		for(int32_t y = -1; y < 3; y++)
+		{
+			for(int32_t x = -1; x < 3; x++)
+			{
+				const Vector3DInt32 v3dBlockPos(x, y, z);
+				const bool bIsInside = (x >= 0) && (y >= 0) && (z >= 0) && (x < 2) && (y < 2) && (z < 2);
+
+				uint8_t uMin = 0;
+				uint8_t uMax = 0;
+				volData.calculateBlockRange(v3dBlockPos, uMin, uMax);
+				QCOMPARE(uMin, static_cast<uint8_t>(bIsInside ? 0 : 9));
+				QCOMPARE(uMax, static_cast<uint8_t>(bIsInside ? 3 : 9));
+
+				QCOMPARE(volData.countVoxelsInBlock(v3dBlockPos, 0), bIsInside ? uNoOfEmptyVoxels : static_cast<uint32_t>(0));
+			}
+		}
+	}
+	QCOMPARE(volData.getUncompressedBlockStatistics().misses, uMissesBefore);
+	QCOMPARE(volData.getUncompressedSizeInBytes(), uUncompressedSizeBefore);
+}
+
+QTEST_MAIN(TestBlockCompressor)
@@ -0,0 +1,275 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "TestFixedRawVolume.h"
+
+#include "PolyVoxCore/Density.h"
+#include "PolyVoxCore/FixedRawVolume.h"
+#include "PolyVoxCore/LowPassFilter.h"
+#include "PolyVoxCore/RawVolume.h"
+#include "PolyVoxCore/SimpleVolume.h"
+
+#include <QtTest>
+
+#include <vector>
+
+using namespace PolyVox;
+
+//Gives a value which changes in every direction, so misplaced voxels get noticed.
+static uint16_t fixedTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return static_cast<uint16_t>(x * 7 + y * 131 + z * 1031);
+}
+
+template <typename VolumeType>
+void fillWithTestValues(VolumeType& volData)
+{
+	const Region& reg = volData.getEnclosingRegion();
+	for(int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				volData.setVoxelAt(x, y, z, fixedTestValue(x, y, z));
+			}
+		}
+	}
+}
+
+//Sets a sampler to every position in and around the volume and checks each of the peeks, whose offsets are
+//compile time constants, against getVoxelAt(). Positions next to the edges have to fall back on getVoxelAt().
+template <typename VolumeType>
+uint32_t countPeekMismatches(VolumeType& volData)
+{
+	typedef typename VolumeType::Sampler SamplerType;
+	struct Peek
+	{
+		uint16_t (SamplerType::*funcPeek)(void) const;
+		int32_t iXOffset, iYOffset, iZOffset;
+	};
+	static const Peek peeks[] =
+	{
+		{&SamplerType::peekVoxel1nx1ny1nz, -1, -1, -1}, {&SamplerType::peekVoxel1nx1ny0pz, -1, -1, 0}, {&SamplerType::peekVoxel1nx1ny1pz, -1, -1, 1},
+		{&SamplerType::peekVoxel1nx0py1nz, -1,  0, -1}, {&SamplerType::peekVoxel1nx0py0pz, -1,  0, 0}, {&SamplerType::peekVoxel1nx0py1pz, -1,  0, 1},
+		{&SamplerType::peekVoxel1nx1py1nz, -1,  1, -1}, {&SamplerType::peekVoxel1nx1py0pz, -1,  1, 0}, {&SamplerType::peekVoxel1nx1py1pz, -1,  1, 1},
+		{&SamplerType::peekVoxel0px1ny1nz,  0, -1, -1}, {&SamplerType::peekVoxel0px1ny0pz,  0, -1, 0}, {&SamplerType::peekVoxel0px1ny1pz,  0, -1, 1},
+		{&SamplerType::peekVoxel0px0py1nz,  0,  0, -1}, {&SamplerType::peekVoxel0px0py0pz,  0,  0, 0}, {&SamplerType::peekVoxel0px0py1pz,  0,  0, 1},
+		{&SamplerType::peekVoxel0px1py1nz,  0,  1, -1}, {&SamplerType::peekVoxel0px1py0pz,  0,  1, 0}, {&SamplerType::peekVoxel0px1py1pz,  0,  1, 1},
+		{&SamplerType::peekVoxel1px1ny1nz,  1, -1, -1}, {&SamplerType::peekVoxel1px1ny0pz,  1, -1, 0}, {&SamplerType::peekVoxel1px1ny1pz,  1, -1, 1},
+		{&SamplerType::peekVoxel1px0py1nz,  1,  0, -1}, {&SamplerType::peekVoxel1px0py0pz,  1,  0, 0}, {&SamplerType::peekVoxel1px0py1pz,  1,  0, 1},
+		{&SamplerType::peekVoxel1px1py1nz,  1,  1, -1}, {&SamplerType::peekVoxel1px1py0pz,  1,  1, 0}, {&SamplerType::peekVoxel1px1py1pz,  1,  1, 1}
+	};
+
+	const Region& reg = volData.getEnclosingRegion();
+	SamplerType sampler(&volData);
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = reg.getLowerCorner().getZ() - 2; z <= reg.getUpperCorner().getZ() + 2; z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY() - 2; y <= reg.getUpperCorner().getY() + 2; y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX() - 2; x <= reg.getUpperCorner().getX() + 2; x++)
+			{
+				sampler.setPosition(x, y, z);
+				for(uint32_t ct = 0; ct < sizeof(peeks) / sizeof(peeks[0]); ct++)
+				{
+					if((sampler.*peeks[ct].funcPeek)() != volData.getVoxelAt(x + peeks[ct].iXOffset, y + peeks[ct].iYOffset, z + peeks[ct].iZOffset))
+					{
+						uNoOfMismatches++;
+					}
+				}
+			}
+		}
+	}
+	return uNoOfMismatches;
+}
+
+//Only compiles if the value is known at compile time.
+template <int32_t iValue>
+int32_t compileTimeValue(void)
+{
+	return iValue;
+}
+
+void TestFixedRawVolume::testConstants()
+{
+	typedef FixedRawVolume<uint16_t, 5, 6, 7> VolumeType;
+	QCOMPARE(compileTimeValue<VolumeType::YStride>(), static_cast<int32_t>(5));
+	QCOMPARE(compileTimeValue<VolumeType::ZStride>(), static_cast<int32_t>(30));
+	QCOMPARE(compileTimeValue<VolumeType::NoOfVoxels>(), static_cast<int32_t>(210));
+
+	//The size comes from the template parameters, and the position from the constructor.
+	VolumeType volData(Vector3DInt32(-2,-10,3));
+	QCOMPARE(volData.getEnclosingRegion(), Region(Vector3DInt32(-2,-10,3), Vector3DInt32(2,-5,9)));
+	QCOMPARE(volData.getWidth(), static_cast<int32_t>(5));
+	QCOMPARE(volData.getHeight(), static_cast<int32_t>(6));
+	QCOMPARE(volData.getDepth(), static_cast<int32_t>(7));
+	QCOMPARE(volData.getLongestSideLength(), static_cast<int32_t>(7));
+	QCOMPARE(volData.getShortestSideLength(), static_cast<int32_t>(5));
+	QCOMPARE(volData.calculateSizeInBytes(), static_cast<uint32_t>(VolumeType::NoOfVoxels * sizeof(uint16_t)));
+
+	//The voxels are laid out with x varying fastest, using the strides.
+	fillWithTestValues(volData);
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = 0; z < 7; z++)
+	{
+		for(int32_t y = 0; y < 6; y++)
+		{
+			for(int32_t x = 0; x < 5; x++)
+			{
+				if(volData.getData()[x + y * VolumeType::YStride + z * VolumeType::ZStride] != fixedTestValue(x - 2, y - 10, z + 3))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+}
+
+void TestFixedRawVolume::testBounds()
+{
+	FixedRawVolume<uint16_t, 5, 6, 7> volData(Vector3DInt32(-2,-10,3));
+	volData.setBorderValue(999);
+	fillWithTestValues(volData);
+
+	//One voxel past each face is outside, and so is everything the other side of the lower
+	//corner (where the position relative to the corner is negative).
+	QCOMPARE(volData.getVoxelAt(-2,-10,3), fixedTestValue(-2,-10,3));
+	QCOMPARE(volData.getVoxelAt(2,-5,9), fixedTestValue(2,-5,9));
+	QCOMPARE(volData.getVoxelAt(-3,-10,3), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(-2,-11,3), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(-2,-10,2), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(3,-5,9), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(2,-4,9), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(2,-5,10), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(-1000,-1000,-1000), static_cast<uint16_t>(999));
+	QCOMPARE(volData.getVoxelAt(1000,1000,1000), static_cast<uint16_t>(999));
+	QCOMPARE(volData.setVoxelAt(3,-5,9,1), false);
+	QCOMPARE(volData.setVoxelAt(-3,-10,3,1), false);
+	QCOMPARE(volData.getVoxelAt(2,-5,9), fixedTestValue(2,-5,9));
+
+	//Reading a region which sticks out of the volume gives the border value for the part outside.
+	std::vector<uint16_t> vecRead(5 * 5 * 2);
+	volData.readRegion(Region(Vector3DInt32(0,-12,8), Vector3DInt32(4,-8,9)), &vecRead[0]);
+	QCOMPARE(vecRead[0], static_cast<uint16_t>(999));
+	QCOMPARE(vecRead[2 * 5], fixedTestValue(0,-10,8));
+	QCOMPARE(vecRead[2 + 2 * 5], fixedTestValue(2,-10,8));
+	QCOMPARE(vecRead[3 + 2 * 5], static_cast<uint16_t>(999));
+
+	//Moving the volume keeps the voxels, so the same memory can be reused for a different part of the world.
+	volData.setLowerCorner(Vector3DInt32(100,100,100));
+	QCOMPARE(volData.getEnclosingRegion(), Region(Vector3DInt32(100,100,100), Vector3DInt32(104,105,106)));
+	QCOMPARE(volData.getVoxelAt(100,100,100), fixedTestValue(-2,-10,3));
+	QCOMPARE(volData.getVoxelAt(-2,-10,3), static_cast<uint16_t>(999));
+	volData.fillRegion(Region(Vector3DInt32(90,90,90), Vector3DInt32(100,101,100)), 7);
+	QCOMPARE(volData.getVoxelAt(100,101,100), static_cast<uint16_t>(7));
+	QCOMPARE(volData.getVoxelAt(101,101,100), fixedTestValue(-1,-9,3));
+}
+
+void TestFixedRawVolume::testSampler()
+{
+	{
+		FixedRawVolume<uint16_t, 4, 5, 6> volData(Vector3DInt32(-5,3,-20));
+		volData.setBorderValue(999);
+		fillWithTestValues(volData);
+		QCOMPARE(countPeekMismatches(volData), static_cast<uint32_t>(0));
+
+		//Moving in and out of the volume has to keep the sampler's flags up to date.
+		FixedRawVolume<uint16_t, 4, 5, 6>::Sampler sampler(&volData);
+		sampler.setPosition(-7, 4, -18);
+		uint32_t uNoOfMismatches = 0;
+		for(int32_t x = -7; x <= 0; x++)
+		{
+			if(sampler.getVoxel() != volData.getVoxelAt(x, 4, -18)) uNoOfMismatches++;
+			if(sampler.peekVoxel1px1py1pz() != volData.getVoxelAt(x + 1, 5, -17)) uNoOfMismatches++;
+			if(sampler.peekVoxel1nx1ny1nz() != volData.getVoxelAt(x - 1, 3, -19)) uNoOfMismatches++;
+			sampler.movePositiveX();
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+		//Writing through the sampler only works inside the volume.
+		sampler.setPosition(-4, 5, -18);
+		QCOMPARE(sampler.setVoxel(1), true);
+		QCOMPARE(volData.getVoxelAt(-4, 5, -18), static_cast<uint16_t>(1));
+		sampler.moveNegativeY();
+		sampler.movePositiveZ();
+		QCOMPARE(sampler.peekVoxel0px1py1nz(), static_cast<uint16_t>(1));
+		sampler.setPosition(-1, 5, -18);
+		QCOMPARE(sampler.setVoxel(1), false);
+	}
+
+	{
+		//Too small to have an interior, so every peek goes through getVoxelAt().
+		FixedRawVolume<uint16_t, 1, 2, 3> volData;
+		volData.setBorderValue(999);
+		fillWithTestValues(volData);
+		QCOMPARE(countPeekMismatches(volData), static_cast<uint32_t>(0));
+	}
+}
+
+void TestFixedRawVolume::testLowPassFilter()
+{
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(31,31,31));
+	SimpleVolume<Density8> volData(reg, 16);
+	FixedRawVolume<Density8, 32, 32, 32> volFixedData;
+	for(int32_t z = 0; z < 32; z++)
+	{
+		for(int32_t y = 0; y < 32; y++)
+		{
+			for(int32_t x = 0; x < 32; x++)
+			{
+				volData.setVoxelAt(x, y, z, Density8((x * 5 + y * 3 + z * 7) % 64));
+			}
+		}
+	}
+	volData.readRegion(reg, volFixedData.getData());
+
+	RawVolume<Density8> resultVolume(reg);
+	LowPassFilter< SimpleVolume<Density8>, RawVolume<Density8>, Density16 > lowPassFilter(&volData, reg, &resultVolume, reg, 3);
+	lowPassFilter.execute();
+
+	RawVolume<Density8> fixedResultVolume(reg);
+	LowPassFilter< FixedRawVolume<Density8, 32, 32, 32>, RawVolume<Density8>, Density16 > fixedLowPassFilter(&volFixedData, reg, &fixedResultVolume, reg, 3);
+	QBENCHMARK {
+		fixedLowPassFilter.execute();
+	}
+
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = 0; z < 32; z++)
+	{
+		for(int32_t y = 0; y < 32; y++)
+		{
+			for(int32_t x = 0; x < 32; x++)
+			{
+				if(fixedResultVolume.getVoxelAt(x, y, z) != resultVolume.getVoxelAt(x, y, z))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+}
+
+QTEST_MAIN(TestFixedRawVolume)
@@ -26,6 +26,7 @@ freely, subject to the following restrictions:
 #include "PolyVoxCore/Density.h"
 #include "PolyVoxCore/LowPassFilter.h"
 #include "PolyVoxCore/RawVolume.h"
+#include "PolyVoxCore/SimpleVolume.h"
 
 #include <QtTest>
 
@@ -87,4 +88,56 @@ void TestLowPassFilter::testExecute()
 	QCOMPARE(resultVolume.getVoxelAt(7,7,7), Density8(4));
 }
 
+void TestLowPassFilter::testBlockLayouts()
+{
+	//The filter reads every neighbour of every voxel, so it should benefit from the Morton layout. Run with '-perf'
+	//or '-callgrind' to compare the number of cache misses rather than the time.
+	const int32_t g_uVolumeSideLength = 64;
+
+	Region reg(Vector3DInt32(0,0,0), Vector3DInt32(g_uVolumeSideLength-1, g_uVolumeSideLength-1, g_uVolumeSideLength-1));
+
+	SimpleVolume<Density8> volData(reg);
+	for (int32_t z = 0; z < g_uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < g_uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < g_uVolumeSideLength; x++)
+			{
+				volData.setVoxelAt(x, y, z, Density8((x * 5 + y * 3 + z * 7) % 64));
+			}
+		}
+	}
+
+	RawVolume<Density8> linearResultVolume(reg);
+	LowPassFilter< SimpleVolume<Density8>, RawVolume<Density8>, Density16 > linearLowPassfilter(&volData, reg, &linearResultVolume, reg, 3);
+	QBENCHMARK {
+		linearLowPassfilter.execute();
+	}
+
+	volData.setBlockLayout(BlockLayouts::Morton);
+
+	RawVolume<Density8> mortonResultVolume(reg);
+	LowPassFilter< SimpleVolume<Density8>, RawVolume<Density8>, Density16 > mortonLowPassfilter(&volData, reg, &mortonResultVolume, reg, 3);
+	QBENCHMARK {
+		mortonLowPassfilter.execute();
+	}
+
+	//The layout must not change the result.
+	uint32_t uNoOfMismatches = 0;
+	for (int32_t z = 0; z < g_uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < g_uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < g_uVolumeSideLength; x++)
+			{
+				if(mortonResultVolume.getVoxelAt(x, y, z) != linearResultVolume.getVoxelAt(x, y, z))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+}
+
 QTEST_MAIN(TestLowPassFilter)
@@ -32,6 +32,7 @@ class TestLowPassFilter: public QObject
 	
 	private slots:
 		void testExecute();
+		void testBlockLayouts();
 };
 
 #endif
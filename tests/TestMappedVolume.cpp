@@ -0,0 +1,241 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "TestMappedVolume.h"
+
+#include "PolyVoxCore/MappedVolume.h"
+
+#include <QtTest>
+
+#include <cstdio> //For fopen() and remove()
+#include <stdexcept>
+
+using namespace PolyVox;
+
+const char* const testFilename = "TestMappedVolume.vol";
+
+//The header is the first page of the file.
+const uint64_t uHeaderSizeInBytes = 4096;
+
+//Gives a value which changes in every direction, so misplaced voxels get noticed.
+static uint16_t mappedTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return static_cast<uint16_t>(x * 7 + y * 131 + z * 1031);
+}
+
+//Creates a small volume in the test file, and then overwrites some of the bytes of its header.
+static void createVolumeWithHeaderBytes(long lOffset, const void* pBytes, size_t uNoOfBytes)
+{
+	{
+		MappedVolume<uint16_t> volData(testFilename, Region(Vector3DInt32(0,0,0), Vector3DInt32(15,15,15)), 16);
+	}
+
+	FILE* pFile = fopen(testFilename, "r+b");
+	fseek(pFile, lOffset, SEEK_SET);
+	fwrite(pBytes, 1, uNoOfBytes, pFile);
+	fclose(pFile);
+}
+
+template <typename VoxelType>
+bool openingThrowsInvalidArgument(void)
+{
+	try
+	{
+		MappedVolume<VoxelType> volData(testFilename);
+	}
+	catch(std::invalid_argument&)
+	{
+		return true;
+	}
+	return false;
+}
+
+void TestMappedVolume::testCreateAndReopen()
+{
+	//The region crosses zero and doesn't line up with the blocks, so it covers four blocks in each direction.
+	const Region reg(Vector3DInt32(-10,-10,-10), Vector3DInt32(40,40,40));
+	const uint64_t uExpectedFileSize = uHeaderSizeInBytes + 4 * 4 * 4 * 16 * 16 * 16 * sizeof(uint16_t);
+
+	{
+		MappedVolume<uint16_t> volData(testFilename, reg, 16);
+		QCOMPARE(volData.getFileSizeInBytes(), uExpectedFileSize);
+
+		//A new file reads as zero.
+		QCOMPARE(volData.getVoxelAt(-10, -10, -10), static_cast<uint16_t>(0));
+		QCOMPARE(volData.getVoxelAt(40, 40, 40), static_cast<uint16_t>(0));
+
+		for(int32_t z = -10; z <= 40; z++)
+		{
+			for(int32_t y = -10; y <= 40; y++)
+			{
+				for(int32_t x = -10; x <= 40; x++)
+				{
+					volData.setVoxelAt(x, y, z, mappedTestValue(x, y, z));
+				}
+			}
+		}
+		volData.flush();
+	}
+
+	//Open the file again and check everything was kept, with the size of the volume and its blocks read from the header.
+	{
+		MappedVolume<uint16_t> volData(testFilename);
+		QCOMPARE(volData.getEnclosingRegion().getLowerCorner(), reg.getLowerCorner());
+		QCOMPARE(volData.getEnclosingRegion().getUpperCorner(), reg.getUpperCorner());
+		QCOMPARE(volData.getBlockSideLength(), static_cast<uint16_t>(16));
+		QCOMPARE(volData.getFileSizeInBytes(), uExpectedFileSize);
+
+		uint32_t uNoOfMismatches = 0;
+		for(int32_t z = -10; z <= 40; z++)
+		{
+			for(int32_t y = -10; y <= 40; y++)
+			{
+				for(int32_t x = -10; x <= 40; x++)
+				{
+					if(volData.getVoxelAt(x, y, z) != mappedTestValue(x, y, z))
+					{
+						uNoOfMismatches++;
+					}
+				}
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+	}
+
+	//Creating a volume replaces the old file.
+	{
+		MappedVolume<uint16_t> volData(testFilename, Region(Vector3DInt32(0,0,0), Vector3DInt32(7,7,7)), 8);
+		QCOMPARE(volData.getFileSizeInBytes(), uHeaderSizeInBytes + 8 * 8 * 8 * sizeof(uint16_t));
+		QCOMPARE(volData.getVoxelAt(1, 1, 1), static_cast<uint16_t>(0));
+	}
+
+	remove(testFilename);
+}
+
+void TestMappedVolume::testInvalidFiles()
+{
+	//A file which doesn't exist can't be opened at all.
+	remove(testFilename);
+	bool bThrown = false;
+	try
+	{
+		MappedVolume<uint16_t> volData(testFilename);
+	}
+	catch(std::runtime_error&)
+	{
+		bThrown = true;
+	}
+	QCOMPARE(bThrown, true);
+
+	//A file too small to hold the header.
+	FILE* pFile = fopen(testFilename, "wb");
+	const char shortData[100] = {0};
+	fwrite(shortData, 1, sizeof(shortData), pFile);
+	fclose(pFile);
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+
+	//A header with the wrong magic number, version or block side length. The
+	//fields start with 8 bytes of magic, followed by the version, the voxel
+	//size and the block side length, each stored as a uint32_t.
+	createVolumeWithHeaderBytes(0, "NotAVol!", 8);
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+	const uint32_t uBadVersion = 2;
+	createVolumeWithHeaderBytes(8, &uBadVersion, sizeof(uBadVersion));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+	const uint32_t uZeroBlockSideLength = 0;
+	createVolumeWithHeaderBytes(16, &uZeroBlockSideLength, sizeof(uZeroBlockSideLength));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+	const uint32_t uHugeBlockSideLength = 65536;
+	createVolumeWithHeaderBytes(16, &uHugeBlockSideLength, sizeof(uHugeBlockSideLength));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+	const uint32_t uOddBlockSideLength = 12;
+	createVolumeWithHeaderBytes(16, &uOddBlockSideLength, sizeof(uOddBlockSideLength));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+
+	//A different block side length gives a different file size, so the blocks wouldn't fit the file.
+	const uint32_t uLargerBlockSideLength = 32;
+	createVolumeWithHeaderBytes(16, &uLargerBlockSideLength, sizeof(uLargerBlockSideLength));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+
+	//An untouched header opens, but not as a voxel type of a different size.
+	const uint32_t uVersion = 1;
+	createVolumeWithHeaderBytes(8, &uVersion, sizeof(uVersion));
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), false);
+	QCOMPARE(openingThrowsInvalidArgument<uint8_t>(), true);
+	QCOMPARE(openingThrowsInvalidArgument<uint32_t>(), true);
+
+	//A file which has been added to no longer matches the size in its header.
+	pFile = fopen(testFilename, "ab");
+	fwrite(shortData, 1, sizeof(shortData), pFile);
+	fclose(pFile);
+	QCOMPARE(openingThrowsInvalidArgument<uint16_t>(), true);
+
+	remove(testFilename);
+}
+
+void TestMappedVolume::testSampler()
+{
+	{
+		MappedVolume<uint16_t> volData(testFilename, Region(Vector3DInt32(0,0,0), Vector3DInt32(31,31,31)), 8);
+		volData.setBorderValue(99);
+		for(int32_t x = 0; x < 32; x++)
+		{
+			volData.setVoxelAt(x, 6, 7, mappedTestValue(x, 6, 7));
+		}
+
+		//The sampler reads straight from the mapped blocks, so check it as it crosses from one block to the next and out of the volume.
+		MappedVolume<uint16_t>::Sampler sampler(&volData);
+		sampler.setPosition(-1, 6, 7);
+		uint32_t uNoOfMismatches = 0;
+		for(int32_t x = -1; x <= 32; x++)
+		{
+			if(sampler.getVoxel() != volData.getVoxelAt(x, 6, 7)) uNoOfMismatches++;
+			if(sampler.peekVoxel1px0py0pz() != volData.getVoxelAt(x + 1, 6, 7)) uNoOfMismatches++;
+			if(sampler.peekVoxel1nx0py0pz() != volData.getVoxelAt(x - 1, 6, 7)) uNoOfMismatches++;
+			sampler.movePositiveX();
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+		//Writing through the sampler goes straight into the file, but only inside the volume.
+		sampler.setPosition(5, 6, 7);
+		QCOMPARE(sampler.setVoxel(200), true);
+		QCOMPARE(volData.getVoxelAt(5, 6, 7), static_cast<uint16_t>(200));
+		sampler.movePositiveY();
+		sampler.moveNegativeY();
+		QCOMPARE(sampler.getVoxel(), static_cast<uint16_t>(200));
+		sampler.setPosition(-5, 6, 7);
+		QCOMPARE(sampler.setVoxel(200), false);
+		volData.flush();
+	}
+
+	//The write made through the sampler should still be there when the file is opened again.
+	{
+		MappedVolume<uint16_t> volData(testFilename);
+		QCOMPARE(volData.getVoxelAt(5, 6, 7), static_cast<uint16_t>(200));
+		QCOMPARE(volData.getVoxelAt(6, 6, 7), mappedTestValue(6, 6, 7));
+	}
+
+	remove(testFilename);
+}
+
+QTEST_MAIN(TestMappedVolume)
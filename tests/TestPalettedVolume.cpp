@@ -0,0 +1,230 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "TestPalettedVolume.h"
+
+#include "PolyVoxCore/PalettedVolume.h"
+#include "PolyVoxCore/SimpleVolume.h"
+#include "PolyVoxCore/Impl/PalettedBlock.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+using namespace PolyVox;
+
+//Gives a value from the given number of possibilities, scattered so that every block sees all of them.
+uint32_t scatteredValue(int32_t x, int32_t y, int32_t z, uint32_t uNoOfValues)
+{
+	//Multiply as unsigned so that the products wrap rather than overflowing.
+	uint32_t uHash = (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u) ^ (static_cast<uint32_t>(z) * 83492791u);
+	return (uHash >> 4) % uNoOfValues;
+}
+
+void TestPalettedVolume::testPaletteGrowth()
+{
+	//A block this size can hold enough distinct values to need every index width, including 32 bits.
+	const uint16_t uSideLength = 64;
+	const uint32_t uNoOfVoxels = uSideLength * uSideLength * uSideLength;
+
+	PalettedBlock<uint32_t> block(uSideLength);
+	QCOMPARE(block.getPaletteSize(), static_cast<uint32_t>(1));
+	QCOMPARE(block.getBitsPerIndex(), static_cast<uint8_t>(0));
+	QCOMPARE(block.getVoxelAtIndex(uNoOfVoxels - 1), static_cast<uint32_t>(0));
+
+	//Each value goes in its own voxel, so every widening has to carry all the earlier voxels across.
+	const uint32_t uNoOfValuesAtWidening[] = {2, 3, 5, 17, 257, 65537};
+	const uint8_t uBitsAtWidening[] = {1, 2, 4, 8, 16, 32};
+	uint32_t uLastSize = block.calculateSizeInBytes();
+	uint32_t uNoOfValues = 1;
+	for(uint32_t ct = 0; ct < sizeof(uNoOfValuesAtWidening) / sizeof(uNoOfValuesAtWidening[0]); ct++)
+	{
+		//The value before the widening still fits.
+		while(uNoOfValues < uNoOfValuesAtWidening[ct] - 1)
+		{
+			block.setVoxelAtIndex(uNoOfValues, uNoOfValues * 3);
+			uNoOfValues++;
+		}
+		QVERIFY(block.getBitsPerIndex() < uBitsAtWidening[ct]);
+
+		block.setVoxelAtIndex(uNoOfValues, uNoOfValues * 3);
+		uNoOfValues++;
+		QCOMPARE(block.getPaletteSize(), uNoOfValues);
+		QCOMPARE(block.getBitsPerIndex(), uBitsAtWidening[ct]);
+
+		uint32_t uNoOfMismatches = 0;
+		for(uint32_t uIndex = 0; uIndex < uNoOfVoxels; uIndex++)
+		{
+			const uint32_t uExpectedValue = (uIndex < uNoOfValues) ? uIndex * 3 : 0;
+			if(block.getVoxelAtIndex(uIndex) != uExpectedValue)
+			{
+				uNoOfMismatches++;
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+		//The indices take up twice the space at each width.
+		QVERIFY(block.calculateSizeInBytes() > uLastSize);
+		uLastSize = block.calculateSizeInBytes();
+	}
+	QVERIFY(uLastSize >= uNoOfVoxels * sizeof(uint32_t));
+
+	//Writing values which are already in the palette doesn't make it grow.
+	block.setVoxelAtIndex(uNoOfVoxels - 1, 3);
+	block.setVoxelAtIndex(0, 6);
+	QCOMPARE(block.getPaletteSize(), uNoOfValues);
+	QCOMPARE(block.getVoxelAtIndex(uNoOfVoxels - 1), static_cast<uint32_t>(3));
+
+	//Only filling the whole block shrinks it again.
+	block.fill(42);
+	QCOMPARE(block.getPaletteSize(), static_cast<uint32_t>(1));
+	QCOMPARE(block.getBitsPerIndex(), static_cast<uint8_t>(0));
+	QCOMPARE(block.getVoxelAtIndex(12345), static_cast<uint32_t>(42));
+
+	//The palette keeps its capacity for the next time the block fills up, but the indices are freed.
+	QVERIFY(block.calculateSizeInBytes() + (uNoOfVoxels - 1) * sizeof(uint32_t) <= uLastSize);
+}
+
+void TestPalettedVolume::testExactValues()
+{
+	//The palette compares the bytes of the values, so values which compare equal but differ
+	//(such as the two zeros) each keep their own entry and are given back exactly.
+	PalettedBlock<float> block(8);
+	block.fill(0.0f);
+	block.setVoxelAt(1, 2, 3, -0.0f);
+	QCOMPARE(block.getPaletteSize(), static_cast<uint32_t>(2));
+	QVERIFY(std::signbit(block.getVoxelAt(1, 2, 3)));
+	QVERIFY(!std::signbit(block.getVoxelAt(3, 2, 1)));
+}
+
+void TestPalettedVolume::testFillRegion()
+{
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(63,63,63));
+	PalettedVolume<uint16_t> volData(reg, 16);
+	const uint32_t uEmptySize = volData.calculateSizeInBytes();
+
+	for(int32_t z = 0; z < 64; z++)
+	{
+		for(int32_t y = 0; y < 64; y++)
+		{
+			for(int32_t x = 0; x < 64; x++)
+			{
+				volData.setVoxelAt(x, y, z, static_cast<uint16_t>(scatteredValue(x, y, z, 200)));
+			}
+		}
+	}
+	const uint32_t uFullSize = volData.calculateSizeInBytes();
+
+	//Overwriting the voxels one at a time leaves the blocks as wide as they were.
+	for(int32_t z = 0; z < 64; z++)
+	{
+		for(int32_t y = 0; y < 64; y++)
+		{
+			for(int32_t x = 0; x < 64; x++)
+			{
+				volData.setVoxelAt(x, y, z, 7);
+			}
+		}
+	}
+	QCOMPARE(volData.calculateSizeInBytes(), uFullSize);
+
+	//Filling a region frees the indices of the blocks which it covers completely (which with 200 values
+	//were a byte per voxel), but the blocks which it only partly covers stay as wide as they were.
+	const uint32_t uIndexBytesPerBlock = 16 * 16 * 16;
+	volData.fillRegion(Region(Vector3DInt32(0,0,0), Vector3DInt32(63,63,40)), 9);
+	QVERIFY(volData.calculateSizeInBytes() <= uFullSize - 32 * (uIndexBytesPerBlock - 4));
+	QVERIFY(volData.calculateSizeInBytes() > uFullSize - 33 * uIndexBytesPerBlock);
+	QCOMPARE(volData.getVoxelAt(10, 20, 40), static_cast<uint16_t>(9));
+	QCOMPARE(volData.getVoxelAt(10, 20, 41), static_cast<uint16_t>(7));
+
+	volData.fillRegion(reg, 9);
+	QVERIFY(volData.calculateSizeInBytes() <= uFullSize - 64 * (uIndexBytesPerBlock - 4));
+	QVERIFY(volData.calculateSizeInBytes() > uEmptySize);
+	QCOMPARE(volData.getVoxelAt(63, 63, 63), static_cast<uint16_t>(9));
+}
+
+void TestPalettedVolume::testSize()
+{
+	//Four distinct 32-bit values only need two bits per voxel.
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(127,127,127));
+	PalettedVolume<uint32_t> volData(reg);
+	SimpleVolume<uint32_t> volSimpleData(reg);
+
+	const uint32_t uEmptySize = volData.calculateSizeInBytes();
+
+	for(int32_t z = 0; z < 128; z++)
+	{
+		for(int32_t y = 0; y < 128; y++)
+		{
+			for(int32_t x = 0; x < 128; x++)
+			{
+				volData.setVoxelAt(x, y, z, scatteredValue(x, y, z, 4) + 1000000);
+				volSimpleData.setVoxelAt(x, y, z, scatteredValue(x, y, z, 4) + 1000000);
+			}
+		}
+	}
+
+	//An empty volume is just the palettes, and a full one should be many times smaller than the SimpleVolume.
+	QCOMPARE(uEmptySize < volSimpleData.calculateSizeInBytes() / 100, true);
+	QCOMPARE(volData.calculateSizeInBytes() < volSimpleData.calculateSizeInBytes() / 8, true);
+}
+
+void TestPalettedVolume::testSampler()
+{
+	//Two values, so the blocks start out with one bit per voxel.
+	PalettedVolume<uint8_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(31,31,31)), 8);
+	volData.setBorderValue(99);
+	for(int32_t z = 0; z < 32; z++)
+	{
+		for(int32_t y = 0; y < 32; y++)
+		{
+			for(int32_t x = 0; x < 32; x++)
+			{
+				volData.setVoxelAt(x, y, z, static_cast<uint8_t>(scatteredValue(x, y, z, 2)));
+			}
+		}
+	}
+
+	//Writing a third value through the Sampler widens its block underneath it. The Sampler has to
+	//carry on reading the block correctly, both at the voxel it wrote and at the ones around it.
+	PalettedVolume<uint8_t>::Sampler sampler(&volData);
+	sampler.setPosition(5, 6, 7);
+	QCOMPARE(sampler.setVoxel(200), true);
+	QCOMPARE(volData.getVoxelAt(5, 6, 7), static_cast<uint8_t>(200));
+	QCOMPARE(sampler.getVoxel(), static_cast<uint8_t>(200));
+	QCOMPARE(sampler.peekVoxel1px0py0pz(), volData.getVoxelAt(6, 6, 7));
+	QCOMPARE(sampler.peekVoxel1nx1ny1nz(), volData.getVoxelAt(4, 5, 6));
+	sampler.movePositiveY();
+	QCOMPARE(sampler.peekVoxel0px1ny0pz(), static_cast<uint8_t>(200));
+	sampler.moveNegativeY();
+	QCOMPARE(sampler.getVoxel(), static_cast<uint8_t>(200));
+
+	//The border is a single value rather than a block, so it can't be written to.
+	sampler.setPosition(-5, 6, 7);
+	QCOMPARE(sampler.getVoxel(), static_cast<uint8_t>(99));
+	QCOMPARE(sampler.setVoxel(200), false);
+	sampler.setPosition(0, 6, 7);
+	QCOMPARE(sampler.peekVoxel1nx0py0pz(), static_cast<uint8_t>(99));
+}
+
+QTEST_MAIN(TestPalettedVolume)
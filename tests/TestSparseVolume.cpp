@@ -0,0 +1,263 @@
+/*******************************************************************************
+Copyright (c) 2005-2009 David Williams
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would be
+    appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not be
+    misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution. 	
+*******************************************************************************/
+
+#include "TestSparseVolume.h"
+
+#include "PolyVoxCore/SparseVolume.h"
+
+#include <QtTest>
+
+using namespace PolyVox;
+
+//Gives a value which changes in every direction, so misplaced voxels get noticed.
+static uint16_t sparseTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return static_cast<uint16_t>(x * 7 + y * 131 + z * 1031);
+}
+
+void TestSparseVolume::testAllocation()
+{
+	//With leaves of 8 voxels each node covers 128 voxels, and the region crosses zero.
+	SparseVolume<uint16_t> volData(Region(Vector3DInt32(-128,-128,-128), Vector3DInt32(127,127,127)), 8);
+	const uint32_t uLeafSizeInBytes = 8 * 8 * 8 * sizeof(uint16_t);
+	const uint32_t uEmptySize = volData.calculateSizeInBytes();
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+
+	//Writing the value a leaf already has doesn't allocate anything.
+	volData.setVoxelAt(0, 0, 0, 0);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QCOMPARE(volData.calculateSizeInBytes(), uEmptySize);
+
+	//The first write to a node allocates the node as well as the leaf.
+	volData.setVoxelAt(-1, -1, -1, 5);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(1));
+	const uint32_t uOneLeafSize = volData.calculateSizeInBytes();
+	QVERIFY(uOneLeafSize > uEmptySize + uLeafSizeInBytes);
+
+	//Other writes to the same leaf cost nothing, and a new leaf in the same node only costs the leaf.
+	volData.setVoxelAt(-8, -8, -8, 6);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(1));
+	QCOMPARE(volData.calculateSizeInBytes(), uOneLeafSize);
+	volData.setVoxelAt(-9, -1, -1, 7);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(2));
+	QCOMPARE(volData.calculateSizeInBytes(), uOneLeafSize + uLeafSizeInBytes);
+
+	//A leaf in the neighbouring node needs a node of its own.
+	volData.setVoxelAt(0, -1, -1, 8);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(3));
+	QCOMPARE(volData.calculateSizeInBytes(), 2 * uOneLeafSize + uLeafSizeInBytes - uEmptySize);
+
+	//Writing a different value into every leaf of one node allocates all 16 * 16 * 16 of them.
+	for(int32_t z = 0; z < 128; z += 8)
+	{
+		for(int32_t y = 0; y < 128; y += 8)
+		{
+			for(int32_t x = 0; x < 128; x += 8)
+			{
+				volData.setVoxelAt(x + 1, y + 2, z + 3, sparseTestValue(x, y, z) | 1);
+			}
+		}
+	}
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(3 + 16 * 16 * 16));
+
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = 0; z < 128; z++)
+	{
+		for(int32_t y = 0; y < 128; y++)
+		{
+			for(int32_t x = 0; x < 128; x++)
+			{
+				uint16_t uExpectedValue = 0;
+				if((x & 7) == 1 && (y & 7) == 2 && (z & 7) == 3)
+				{
+					uExpectedValue = sparseTestValue(x - 1, y - 2, z - 3) | 1;
+				}
+				if(volData.getVoxelAt(x, y, z) != uExpectedValue)
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+	QCOMPARE(volData.getVoxelAt(-1, -1, -1), static_cast<uint16_t>(5));
+	QCOMPARE(volData.getVoxelAt(-8, -8, -8), static_cast<uint16_t>(6));
+	QCOMPARE(volData.getVoxelAt(-9, -1, -1), static_cast<uint16_t>(7));
+	QCOMPARE(volData.getVoxelAt(0, -1, -1), static_cast<uint16_t>(8));
+}
+
+void TestSparseVolume::testPrune()
+{
+	SparseVolume<uint8_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(255,255,255)));
+	const uint32_t uEmptySize = volData.calculateSizeInBytes();
+
+	//Make the lower half solid, and put a few details in it.
+	for(int32_t z = 0; z < 256; z++)
+	{
+		for(int32_t y = 0; y < 128; y++)
+		{
+			for(int32_t x = 0; x < 256; x++)
+			{
+				volData.setVoxelAt(x, y, z, 1);
+			}
+		}
+	}
+	volData.setVoxelAt(10, 20, 30, 2);
+	volData.setVoxelAt(200, 100, 50, 3);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(32 * 16 * 32));
+
+	//Only the leaves with the details should be left.
+	volData.prune();
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(2));
+	QCOMPARE(volData.getVoxelAt(10, 20, 30), static_cast<uint8_t>(2));
+	QCOMPARE(volData.getVoxelAt(200, 100, 50), static_cast<uint8_t>(3));
+	QCOMPARE(volData.getVoxelAt(100, 100, 100), static_cast<uint8_t>(1));
+	QCOMPARE(volData.getVoxelAt(100, 200, 100), static_cast<uint8_t>(0));
+
+	//Pruning again changes nothing.
+	const uint32_t uPrunedSize = volData.calculateSizeInBytes();
+	volData.prune();
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(2));
+	QCOMPARE(volData.calculateSizeInBytes(), uPrunedSize);
+
+	//Once the details are gone everything collapses back to the nodes.
+	volData.setVoxelAt(10, 20, 30, 1);
+	volData.setVoxelAt(200, 100, 50, 1);
+	volData.prune();
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QCOMPARE(volData.calculateSizeInBytes(), uEmptySize);
+	QCOMPARE(volData.getVoxelAt(100, 100, 100), static_cast<uint8_t>(1));
+	QCOMPARE(volData.getVoxelAt(100, 200, 100), static_cast<uint8_t>(0));
+
+	//A node whose leaves collapse to different values loses its leaves but has to be kept.
+	for(int32_t z = 0; z < 16; z++)
+	{
+		for(int32_t y = 0; y < 16; y++)
+		{
+			for(int32_t x = 0; x < 16; x++)
+			{
+				volData.setVoxelAt(x, y, z, 4);
+			}
+		}
+	}
+	volData.prune();
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QVERIFY(volData.calculateSizeInBytes() > uEmptySize);
+	QCOMPARE(volData.getVoxelAt(15, 15, 15), static_cast<uint8_t>(4));
+	QCOMPARE(volData.getVoxelAt(16, 15, 15), static_cast<uint8_t>(1));
+	QCOMPARE(volData.getVoxelAt(15, 16, 15), static_cast<uint8_t>(1));
+}
+
+void TestSparseVolume::testFillRegion()
+{
+	SparseVolume<uint8_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(255,255,255)), 8);
+	const uint32_t uEmptySize = volData.calculateSizeInBytes();
+
+	//Filling with the value the volume already has does nothing.
+	volData.fillRegion(Region(Vector3DInt32(3,3,3), Vector3DInt32(200,200,200)), 0);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QCOMPARE(volData.calculateSizeInBytes(), uEmptySize);
+
+	//Leaves which are completely covered are collapsed rather than allocated, so only
+	//the partly covered leaves around the edge of the region need their voxels.
+	volData.fillRegion(Region(Vector3DInt32(4,8,8), Vector3DInt32(27,23,23)), 5);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(2 * 2 * 2));
+	QCOMPARE(volData.getVoxelAt(3, 8, 8), static_cast<uint8_t>(0));
+	QCOMPARE(volData.getVoxelAt(4, 8, 8), static_cast<uint8_t>(5));
+	QCOMPARE(volData.getVoxelAt(16, 16, 16), static_cast<uint8_t>(5));
+	QCOMPARE(volData.getVoxelAt(27, 23, 23), static_cast<uint8_t>(5));
+	QCOMPARE(volData.getVoxelAt(28, 23, 23), static_cast<uint8_t>(0));
+	QCOMPARE(volData.getVoxelAt(27, 24, 23), static_cast<uint8_t>(0));
+
+	//Covering an allocated leaf frees it again.
+	volData.fillRegion(Region(Vector3DInt32(0,8,8), Vector3DInt32(31,23,23)), 6);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QCOMPARE(volData.getVoxelAt(0, 8, 8), static_cast<uint8_t>(6));
+	QCOMPARE(volData.getVoxelAt(31, 23, 23), static_cast<uint8_t>(6));
+
+	//The part of the region outside the volume is ignored, and the nodes only collapse when pruned.
+	volData.fillRegion(Region(Vector3DInt32(-100,-100,-100), Vector3DInt32(300,300,300)), 0);
+	QCOMPARE(volData.getNoOfLeaves(), static_cast<uint32_t>(0));
+	QCOMPARE(volData.getVoxelAt(16, 16, 16), static_cast<uint8_t>(0));
+	QVERIFY(volData.calculateSizeInBytes() > uEmptySize);
+	volData.prune();
+	QCOMPARE(volData.calculateSizeInBytes(), uEmptySize);
+}
+
+void TestSparseVolume::testSampler()
+{
+	//Only fill part of the volume, so that the sampler goes through collapsed leaves and nodes as well as allocated ones.
+	SparseVolume<uint16_t> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(31,31,31)), 8);
+	volData.setBorderValue(99);
+	for(int32_t z = 0; z < 32; z++)
+	{
+		for(int32_t y = 0; y < 32; y++)
+		{
+			for(int32_t x = 0; x < 20; x++)
+			{
+				volData.setVoxelAt(x, y, z, sparseTestValue(x, y, z));
+			}
+		}
+	}
+	volData.fillRegion(Region(Vector3DInt32(24,0,0), Vector3DInt32(31,31,31)), 3);
+
+	//Move along a row which goes from allocated leaves, through a partly written leaf and a
+	//collapsed one, and then out of the volume.
+	uint32_t uNoOfMismatches = 0;
+	SparseVolume<uint16_t>::Sampler sampler(&volData);
+	sampler.setPosition(0, 9, 9);
+	for(int32_t x = 0; x <= 33; x++)
+	{
+		if(sampler.getVoxel() != volData.getVoxelAt(x, 9, 9)) uNoOfMismatches++;
+		if(sampler.peekVoxel1px0py0pz() != volData.getVoxelAt(x + 1, 9, 9)) uNoOfMismatches++;
+		if(sampler.peekVoxel1nx1ny1nz() != volData.getVoxelAt(x - 1, 8, 8)) uNoOfMismatches++;
+		if(sampler.peekVoxel0px1py1pz() != volData.getVoxelAt(x, 10, 10)) uNoOfMismatches++;
+		sampler.movePositiveX();
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+	//Writing through the sampler works in allocated and collapsed leaves, but not outside the volume.
+	sampler.setPosition(5, 6, 7);
+	QCOMPARE(sampler.setVoxel(200), true);
+	QCOMPARE(volData.getVoxelAt(5, 6, 7), static_cast<uint16_t>(200));
+	const uint32_t uNoOfLeaves = volData.getNoOfLeaves();
+	sampler.setPosition(29, 6, 7);
+	QCOMPARE(sampler.setVoxel(200), true);
+	QCOMPARE(volData.getVoxelAt(29, 6, 7), static_cast<uint16_t>(200));
+	QCOMPARE(volData.getVoxelAt(28, 6, 7), static_cast<uint16_t>(3));
+	QCOMPARE(volData.getNoOfLeaves(), uNoOfLeaves + 1);
+	sampler.movePositiveY();
+	sampler.moveNegativeY();
+	QCOMPARE(sampler.getVoxel(), static_cast<uint16_t>(200));
+	sampler.setPosition(-5, 6, 7);
+	QCOMPARE(sampler.setVoxel(200), false);
+
+	//A copy of the sampler must not share its collapsed leaf.
+	sampler.setPosition(-5, 6, 7);
+	SparseVolume<uint16_t>::Sampler copy(sampler);
+	sampler.setPosition(30, 30, 30);
+	QCOMPARE(copy.getVoxel(), static_cast<uint16_t>(99));
+	QCOMPARE(copy.peekVoxel1px0py0pz(), static_cast<uint16_t>(99));
+}
+
+QTEST_MAIN(TestSparseVolume)
@@ -24,10 +24,14 @@ freely, subject to the following restrictions:
 #include "TestSurfaceExtractor.h"
 
 #include "PolyVoxCore/Density.h"
+#include "PolyVoxCore/LargeVolume.h"
 #include "PolyVoxCore/MaterialDensityPair.h"
+#include "PolyVoxCore/RawVolume.h"
 #include "PolyVoxCore/SimpleVolume.h"
 #include "PolyVoxCore/MarchingCubesSurfaceExtractor.h"
 
+#include <map>
+
 #include <QtTest>
 
 using namespace PolyVox;
@@ -61,6 +65,17 @@ public:
 	}
 };
 
+// Behaves exactly like the DefaultMarchingCubesController, but because it is a different type the extractor can't
+// use the volume's density ranges with it. This lets us compare the results with and without skipping empty blocks.
+class UnsummarisedMarchingCubesController : public DefaultMarchingCubesController<uint8_t>
+{
+public:
+	UnsummarisedMarchingCubesController(uint8_t tThreshold = 127)
+		:DefaultMarchingCubesController<uint8_t>(tThreshold)
+	{
+	}
+};
+
 // These 'writeDensityValueToVoxel' functions provide a unified interface for writting densities to primative and class voxel types.
 // They are conceptually the inverse of the 'convertToDensity' function used by the MarchingCubesSurfaceExtractor. They probably shouldn't be part
 // of PolyVox, but they might be usful to other tests so we cold move them into a 'Tests.h' or something in the future.
@@ -219,4 +234,701 @@ void TestSurfaceExtractor::testExecute()
 	QCOMPARE(mesh.getVertices()[uMaterialToCheck].getMaterial(), fNoMaterial);
 }
 
+void TestSurfaceExtractor::testBlockLayouts()
+{
+	//The extractor looks at the neighbours of each voxel to compute the normals, so it should benefit from the Morton
+	//layout. Run with '-perf' or '-callgrind' to compare the number of cache misses rather than the time.
+	const int32_t uVolumeSideLength = 128;
+
+	LargeVolume<float> volData(Region(Vector3DInt32(0,0,0), Vector3DInt32(uVolumeSideLength-1, uVolumeSideLength-1, uVolumeSideLength-1)));
+	for (int32_t z = 0; z < uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < uVolumeSideLength; x++)
+			{
+				//A wavy surface, so that every block has some triangles in it.
+				float voxelValue = (y - uVolumeSideLength / 2) + 20.0f * sinf(x * 0.1f) * cosf(z * 0.1f);
+				volData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	DefaultMarchingCubesController<float> controller(0.0f);
+
+	SurfaceMesh<PositionMaterialNormal> linearMesh;
+	MarchingCubesSurfaceExtractor< LargeVolume<float> > linearExtractor(&volData, volData.getEnclosingRegion(), &linearMesh, controller);
+	QBENCHMARK {
+		linearExtractor.execute();
+	}
+
+	volData.setBlockLayout(BlockLayouts::Morton);
+
+	SurfaceMesh<PositionMaterialNormal> mortonMesh;
+	MarchingCubesSurfaceExtractor< LargeVolume<float> > mortonExtractor(&volData, volData.getEnclosingRegion(), &mortonMesh, controller);
+	QBENCHMARK {
+		mortonExtractor.execute();
+	}
+
+	//The layout must not change the mesh.
+	QVERIFY(linearMesh.getNoOfVertices() > 0);
+	QCOMPARE(mortonMesh.getNoOfVertices(), linearMesh.getNoOfVertices());
+	QCOMPARE(mortonMesh.getIndices() == linearMesh.getIndices(), true);
+	uint32_t uNoOfMismatches = 0;
+	for(uint32_t ct = 0; ct < linearMesh.getNoOfVertices(); ct++)
+	{
+		if((mortonMesh.getVertices()[ct].getPosition() != linearMesh.getVertices()[ct].getPosition()) ||
+			(mortonMesh.getVertices()[ct].getNormal() != linearMesh.getVertices()[ct].getNormal()))
+		{
+			uNoOfMismatches++;
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+}
+
+template <typename VolumeType>
+void testDensityRangesForVolume(VolumeType& volData)
+{
+	const int32_t uVolumeSideLength = volData.getWidth();
+
+	//Mostly empty space and solid ground, which is where the density ranges let the extractor skip the most.
+	for (int32_t z = 0; z < uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < uVolumeSideLength; x++)
+			{
+				uint8_t voxelValue = (y < 20 + (x * 7 + z * 3) % 5) ? 255 : 0;
+				volData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	//The first extraction calculates the ranges, then an edit must invalidate one of them.
+	for(uint32_t uPass = 0; uPass < 2; uPass++)
+	{
+		//Also extract a region which extends outside the volume, so the border value is used.
+		const Region regions[] = {volData.getEnclosingRegion(), Region(Vector3DInt32(-10, 5, 3), Vector3DInt32(40, 50, 70))};
+		for(uint32_t uRegion = 0; uRegion < 2; uRegion++)
+		{
+			SurfaceMesh<PositionMaterialNormal> expectedMesh;
+			MarchingCubesSurfaceExtractor<VolumeType, UnsummarisedMarchingCubesController> expectedExtractor(&volData, regions[uRegion], &expectedMesh, UnsummarisedMarchingCubesController());
+			expectedExtractor.execute();
+
+			SurfaceMesh<PositionMaterialNormal> mesh;
+			MarchingCubesSurfaceExtractor<VolumeType> extractor(&volData, regions[uRegion], &mesh, DefaultMarchingCubesController<uint8_t>());
+			extractor.execute();
+
+			QVERIFY(mesh.getNoOfVertices() > 0);
+			QCOMPARE(mesh.getNoOfVertices(), expectedMesh.getNoOfVertices());
+			QCOMPARE(mesh.getIndices() == expectedMesh.getIndices(), true);
+		}
+
+		//A floating voxel in the middle of an otherwise empty block.
+		volData.setVoxelAt(40, 50, 40, 255);
+	}
+}
+
+void TestSurfaceExtractor::testDensityRanges()
+{
+	const int32_t uVolumeSideLength = 64;
+	const Region region(Vector3DInt32(0,0,0), Vector3DInt32(uVolumeSideLength-1, uVolumeSideLength-1, uVolumeSideLength-1));
+
+	SimpleVolume<uint8_t> simpleVolume(region);
+	testDensityRangesForVolume(simpleVolume);
+
+	LargeVolume<uint8_t> largeVolume(region);
+	testDensityRangesForVolume(largeVolume);
+}
+
+//Counts the differences between two meshes, which should be identical.
+uint32_t countMeshMismatches(const SurfaceMesh<PositionMaterialNormal>& mesh, const SurfaceMesh<PositionMaterialNormal>& expectedMesh)
+{
+	if((mesh.getNoOfVertices() != expectedMesh.getNoOfVertices()) || (mesh.getIndices() != expectedMesh.getIndices()))
+	{
+		return (std::max)(mesh.getNoOfVertices(), expectedMesh.getNoOfVertices());
+	}
+
+	uint32_t uNoOfMismatches = 0;
+	for(uint32_t ct = 0; ct < expectedMesh.getNoOfVertices(); ct++)
+	{
+		if((mesh.getVertices()[ct].getPosition() != expectedMesh.getVertices()[ct].getPosition()) ||
+			(mesh.getVertices()[ct].getNormal() != expectedMesh.getVertices()[ct].getNormal()) ||
+			(mesh.getVertices()[ct].getMaterial() != expectedMesh.getVertices()[ct].getMaterial()))
+		{
+			uNoOfMismatches++;
+		}
+	}
+	return uNoOfMismatches;
+}
+
+//Extracts the region on one thread and then on several, and counts the differences between the meshes.
+template <typename VolumeType>
+uint32_t countParallelMeshMismatches(VolumeType& volData, const Region& region, uint32_t uNoOfThreads)
+{
+	DefaultMarchingCubesController<float> controller(0.0f);
+
+	SurfaceMesh<PositionMaterialNormal> expectedMesh;
+	MarchingCubesSurfaceExtractor<VolumeType> expectedExtractor(&volData, region, &expectedMesh, controller);
+	expectedExtractor.execute();
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor<VolumeType> extractor(&volData, region, &mesh, controller);
+	extractor.executeInParallel(uNoOfThreads);
+
+	return countMeshMismatches(mesh, expectedMesh);
+}
+
+void TestSurfaceExtractor::testExecuteInParallel()
+{
+	const Region region(Vector3DInt32(-20,-10,-30), Vector3DInt32(79,89,99));
+
+	SimpleVolume<float> volData(region);
+	for (int32_t z = region.getLowerCorner().getZ(); z <= region.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = region.getLowerCorner().getY(); y <= region.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = region.getLowerCorner().getX(); x <= region.getUpperCorner().getX(); x++)
+			{
+				//A wavy surface, with some floating blobs so that the slab boundaries cut through every kind of cell.
+				float voxelValue = (y - 40) + 20.0f * sinf(x * 0.1f) * cosf(z * 0.13f);
+				if(((x / 7 + y / 5 + z / 3) % 11) == 0)
+				{
+					voxelValue = -voxelValue;
+				}
+				volData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	QVERIFY(countParallelMeshMismatches(volData, region, 1) == 0);
+	QVERIFY(countParallelMeshMismatches(volData, region, 3) == 0);
+	QVERIFY(countParallelMeshMismatches(volData, region, 16) == 0);
+
+	//A region which sticks out of the volume, and one too thin to be split.
+	QVERIFY(countParallelMeshMismatches(volData, Region(Vector3DInt32(-30,0,-40), Vector3DInt32(30,50,200)), 4) == 0);
+	QVERIFY(countParallelMeshMismatches(volData, Region(Vector3DInt32(0,0,0), Vector3DInt32(50,50,10)), 4) == 0);
+
+	//The LargeVolume can be read from several threads at once if concurrent access is enabled.
+	LargeVolume<float> largeVolData(region, 0, 0, false, 16);
+	std::vector<float> vecVoxels(region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels());
+	volData.readRegion(region, &vecVoxels[0]);
+	largeVolData.writeRegion(region, &vecVoxels[0]);
+	largeVolData.setConcurrentAccessEnabled(true);
+	QVERIFY(countParallelMeshMismatches(largeVolData, region, 4) == 0);
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > extractor(&volData, region, &mesh, DefaultMarchingCubesController<float>(0.0f));
+	QBENCHMARK {
+		extractor.executeInParallel();
+	}
+	QVERIFY(mesh.getNoOfVertices() > 0);
+	QCOMPARE(mesh.m_vecLodRecords.size(), static_cast<size_t>(1));
+}
+
+//The SimpleVolume and RawVolume have their bitmasks computed a row at a time, while the LargeVolume has them computed
+//cell by cell. This fills all three with the same voxels (offset by tOffset, so that the unsigned types are compared
+//on both sides of their top bit) and counts the differences between the meshes for a few awkward regions.
+template <typename VoxelType>
+uint32_t countRowBitmaskMismatches(VoxelType tOffset, BorderMode eBorderMode)
+{
+	//The Samplers see the voxels beyond the edge of the volume which are in its blocks, rather than the border value, so
+	//the side length has to be a multiple of the block size.
+	const int32_t uVolumeSideLength = 64;
+	const Region regVolume(Vector3DInt32(0,0,0), Vector3DInt32(uVolumeSideLength-1, uVolumeSideLength-1, uVolumeSideLength-1));
+
+	SimpleVolume<VoxelType> simpleVolData(regVolume);
+	RawVolume<VoxelType> rawVolData(regVolume);
+	LargeVolume<VoxelType> largeVolData(regVolume);
+	for (int32_t z = 0; z < uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < uVolumeSideLength; x++)
+			{
+				int32_t iDensity = (y + 10) + static_cast<int32_t>(10.0f * sinf(x * 0.3f) * cosf(z * 0.2f));
+				if(((x / 5 + y / 3 + z / 7) % 13) == 0)
+				{
+					iDensity = 60 - iDensity;
+				}
+				const VoxelType voxelValue = static_cast<VoxelType>(tOffset + static_cast<VoxelType>(iDensity));
+				simpleVolData.setVoxelAt(x, y, z, voxelValue);
+				rawVolData.setVoxelAt(x, y, z, voxelValue);
+				largeVolData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	simpleVolData.setBorderValue(tOffset);
+	rawVolData.setBorderValue(tOffset);
+	largeVolData.setBorderValue(tOffset);
+	simpleVolData.setBorderMode(eBorderMode);
+	largeVolData.setBorderMode(eBorderMode);
+
+	DefaultMarchingCubesController<VoxelType> controller(static_cast<VoxelType>(tOffset + static_cast<VoxelType>(35)));
+
+	//The whole volume, one sticking out of it on every side, one a single cell wide, one a single slice deep and one
+	//which keeps far enough from the edges of the volume for the RawVolume (see below).
+	const Region regions[] = {regVolume, Region(Vector3DInt32(-5,-3,-7), Vector3DInt32(70,30,72)), Region(Vector3DInt32(10,0,10), Vector3DInt32(10,63,30)),
+		Region(Vector3DInt32(3,4,5), Vector3DInt32(20,40,5)), Region(Vector3DInt32(1,1,1), Vector3DInt32(60,61,59))};
+
+	uint32_t uNoOfMismatches = 0;
+	for(uint32_t uRegion = 0; uRegion < sizeof(regions) / sizeof(regions[0]); uRegion++)
+	{
+		SurfaceMesh<PositionMaterialNormal> expectedMesh;
+		MarchingCubesSurfaceExtractor< LargeVolume<VoxelType> > expectedExtractor(&largeVolData, regions[uRegion], &expectedMesh, controller);
+		expectedExtractor.execute();
+
+		SurfaceMesh<PositionMaterialNormal> simpleMesh;
+		MarchingCubesSurfaceExtractor< SimpleVolume<VoxelType> > simpleExtractor(&simpleVolData, regions[uRegion], &simpleMesh, controller);
+		simpleExtractor.execute();
+		uNoOfMismatches += countMeshMismatches(simpleMesh, expectedMesh);
+
+		//The RawVolume doesn't have border modes, and its Sampler can't compute normals for the voxels on the edge of the
+		//volume. The extractor reads one voxel beyond the upper corner of the region, and normals need one more each way.
+		if((eBorderMode == BorderModes::Constant) && regVolume.containsPoint(regions[uRegion].getLowerCorner(), 1) && regVolume.containsPoint(regions[uRegion].getUpperCorner(), 2))
+		{
+			SurfaceMesh<PositionMaterialNormal> rawMesh;
+			MarchingCubesSurfaceExtractor< RawVolume<VoxelType> > rawExtractor(&rawVolData, regions[uRegion], &rawMesh, controller);
+			rawExtractor.execute();
+			uNoOfMismatches += countMeshMismatches(rawMesh, expectedMesh);
+		}
+
+		//Make sure the surface actually goes through the regions.
+		if(expectedMesh.getNoOfVertices() == 0)
+		{
+			uNoOfMismatches++;
+		}
+	}
+	return uNoOfMismatches;
+}
+
+void TestSurfaceExtractor::testRowBitmasks()
+{
+	QCOMPARE(countRowBitmaskMismatches<int8_t>(-30, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<uint8_t>(100, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<int16_t>(-1000, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<uint16_t>(32740, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<int32_t>(-100000, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<uint32_t>(2147483620u, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<float>(-20.5f, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<double>(0.25, BorderModes::Constant), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<float>(0.0f, BorderModes::Clamp), static_cast<uint32_t>(0));
+	QCOMPARE(countRowBitmaskMismatches<uint8_t>(0, BorderModes::Wrap), static_cast<uint32_t>(0));
+
+	//The bitmasks are computed a row at a time for the SimpleVolume, and cell by cell for the LargeVolume.
+	const int32_t uVolumeSideLength = 128;
+	const Region region(Vector3DInt32(0,0,0), Vector3DInt32(uVolumeSideLength-1, uVolumeSideLength-1, uVolumeSideLength-1));
+	SimpleVolume<float> simpleVolData(region);
+	LargeVolume<float> largeVolData(region);
+	for (int32_t z = 0; z < uVolumeSideLength; z++)
+	{
+		for (int32_t y = 0; y < uVolumeSideLength; y++)
+		{
+			for (int32_t x = 0; x < uVolumeSideLength; x++)
+			{
+				float voxelValue = (y - uVolumeSideLength / 2) + 20.0f * sinf(x * 0.1f) * cosf(z * 0.1f);
+				simpleVolData.setVoxelAt(x, y, z, voxelValue);
+				largeVolData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	DefaultMarchingCubesController<float> controller(0.0f);
+
+	SurfaceMesh<PositionMaterialNormal> simpleMesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > simpleExtractor(&simpleVolData, region, &simpleMesh, controller);
+	QBENCHMARK {
+		simpleExtractor.execute();
+	}
+
+	SurfaceMesh<PositionMaterialNormal> largeMesh;
+	MarchingCubesSurfaceExtractor< LargeVolume<float> > largeExtractor(&largeVolData, region, &largeMesh, controller);
+	QBENCHMARK {
+		largeExtractor.execute();
+	}
+
+	QVERIFY(simpleMesh.getNoOfVertices() > 0);
+	QCOMPARE(countMeshMismatches(simpleMesh, largeMesh), static_cast<uint32_t>(0));
+}
+
+//Extracts the region normally and in two pass mode, and counts the differences between the meshes. The two pass
+//mode should have allocated exactly the right number of vertices, and at least enough indices.
+template <typename VolumeType>
+uint32_t countTwoPassMeshMismatches(VolumeType& volData, const Region& region, uint32_t uNoOfThreads)
+{
+	DefaultMarchingCubesController<float> controller(0.0f);
+
+	SurfaceMesh<PositionMaterialNormal> expectedMesh;
+	MarchingCubesSurfaceExtractor<VolumeType> expectedExtractor(&volData, region, &expectedMesh, controller);
+	expectedExtractor.execute();
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor<VolumeType> extractor(&volData, region, &mesh, controller);
+	extractor.setTwoPassEnabled(true);
+	if(uNoOfThreads == 1)
+	{
+		extractor.execute();
+	}
+	else
+	{
+		extractor.executeInParallel(uNoOfThreads);
+	}
+
+	uint32_t uNoOfMismatches = countMeshMismatches(mesh, expectedMesh);
+	if((mesh.m_vecVertices.capacity() != mesh.m_vecVertices.size()) || (mesh.m_vecTriangleIndices.capacity() < mesh.m_vecTriangleIndices.size()))
+	{
+		uNoOfMismatches++;
+	}
+	return uNoOfMismatches;
+}
+
+void TestSurfaceExtractor::testTwoPass()
+{
+	const Region region(Vector3DInt32(0,0,0), Vector3DInt32(95,95,95));
+
+	SimpleVolume<float> volData(region);
+	for (int32_t z = region.getLowerCorner().getZ(); z <= region.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = region.getLowerCorner().getY(); y <= region.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = region.getLowerCorner().getX(); x <= region.getUpperCorner().getX(); x++)
+			{
+				float voxelValue = (y - 40) + 20.0f * sinf(x * 0.1f) * cosf(z * 0.13f);
+				if(((x / 7 + y / 5 + z / 3) % 11) == 0)
+				{
+					voxelValue = -voxelValue;
+				}
+				volData.setVoxelAt(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	LargeVolume<float> largeVolData(region);
+	std::vector<float> vecVoxels(region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels());
+	volData.readRegion(region, &vecVoxels[0]);
+	largeVolData.writeRegion(region, &vecVoxels[0]);
+	largeVolData.setConcurrentAccessEnabled(true);
+
+	QCOMPARE(countTwoPassMeshMismatches(volData, region, 1), static_cast<uint32_t>(0));
+	QCOMPARE(countTwoPassMeshMismatches(largeVolData, region, 1), static_cast<uint32_t>(0));
+	QCOMPARE(countTwoPassMeshMismatches(volData, region, 4), static_cast<uint32_t>(0));
+	QCOMPARE(countTwoPassMeshMismatches(largeVolData, region, 4), static_cast<uint32_t>(0));
+
+	//A region which sticks out of the volume, one a single slice deep, and one with no surface in it.
+	QCOMPARE(countTwoPassMeshMismatches(volData, Region(Vector3DInt32(-30,0,-40), Vector3DInt32(30,50,120)), 1), static_cast<uint32_t>(0));
+	QCOMPARE(countTwoPassMeshMismatches(volData, Region(Vector3DInt32(5,0,7), Vector3DInt32(60,90,7)), 1), static_cast<uint32_t>(0));
+	QCOMPARE(countTwoPassMeshMismatches(volData, Region(Vector3DInt32(0,0,0), Vector3DInt32(10,5,10)), 1), static_cast<uint32_t>(0));
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > extractor(&volData, region, &mesh, DefaultMarchingCubesController<float>(0.0f));
+	extractor.setTwoPassEnabled(true);
+	QBENCHMARK {
+		extractor.execute();
+	}
+	QVERIFY(mesh.getNoOfVertices() > 0);
+}
+
+//Counts the vertices in the given range which differ between two meshes.
+uint32_t countVertexMismatches(const SurfaceMesh<PositionMaterialNormal>& mesh, uint32_t uBegin, const SurfaceMesh<PositionMaterialNormal>& otherMesh, uint32_t uOtherBegin, uint32_t uCount)
+{
+	uint32_t uNoOfMismatches = 0;
+	for(uint32_t ct = 0; ct < uCount; ct++)
+	{
+		if((mesh.getVertices()[uBegin + ct].getPosition() != otherMesh.getVertices()[uOtherBegin + ct].getPosition()) ||
+			(mesh.getVertices()[uBegin + ct].getNormal() != otherMesh.getVertices()[uOtherBegin + ct].getNormal()))
+		{
+			uNoOfMismatches++;
+		}
+	}
+	return uNoOfMismatches;
+}
+
+//Inverts the voxels in the dirty region and updates the mesh, then counts the differences from a freshly extracted
+//one. The parts of the mesh outside of the reported ranges should not have changed.
+template <typename VolumeType>
+uint32_t countUpdateMismatches(VolumeType& volData, MarchingCubesSurfaceExtractor<VolumeType>& extractor, SurfaceMesh<PositionMaterialNormal>& mesh, const Region& region, const Region& regDirty)
+{
+	const SurfaceMesh<PositionMaterialNormal> oldMesh(mesh);
+
+	for (int32_t z = regDirty.getLowerCorner().getZ(); z <= regDirty.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = regDirty.getLowerCorner().getY(); y <= regDirty.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = regDirty.getLowerCorner().getX(); x <= regDirty.getUpperCorner().getX(); x++)
+			{
+				volData.setVoxelAt(x, y, z, -volData.getVoxelAt(x, y, z));
+			}
+		}
+	}
+
+	const MeshChange change = extractor.update(regDirty);
+
+	SurfaceMesh<PositionMaterialNormal> expectedMesh;
+	MarchingCubesSurfaceExtractor<VolumeType> expectedExtractor(&volData, region, &expectedMesh, DefaultMarchingCubesController<float>(0.0f));
+	expectedExtractor.execute();
+
+	uint32_t uNoOfMismatches = countMeshMismatches(mesh, expectedMesh);
+	if((change.beginVertex > change.endVertex) || (change.endVertex > mesh.getNoOfVertices()) ||
+		(change.beginIndex > change.endIndex) || (change.endIndex > mesh.getNoOfIndices()) ||
+		(mesh.m_vecLodRecords.size() != 1) || (static_cast<uint32_t>(mesh.m_vecLodRecords[0].endIndex) != mesh.getNoOfIndices()))
+	{
+		return uNoOfMismatches + 1;
+	}
+
+	const uint32_t uNoOfVerticesAfter = mesh.getNoOfVertices() - change.endVertex;
+	const uint32_t uNoOfIndicesAfter = mesh.getNoOfIndices() - change.endIndex;
+	if((change.beginVertex > oldMesh.getNoOfVertices()) || (uNoOfVerticesAfter > oldMesh.getNoOfVertices() - change.beginVertex) ||
+		(change.beginIndex > oldMesh.getNoOfIndices()) || (uNoOfIndicesAfter > oldMesh.getNoOfIndices() - change.beginIndex))
+	{
+		return uNoOfMismatches + 1;
+	}
+
+	uNoOfMismatches += countVertexMismatches(mesh, 0, oldMesh, 0, change.beginVertex);
+	uNoOfMismatches += countVertexMismatches(mesh, change.endVertex, oldMesh, oldMesh.getNoOfVertices() - uNoOfVerticesAfter, uNoOfVerticesAfter);
+	if(!std::equal(mesh.getIndices().begin(), mesh.getIndices().begin() + change.beginIndex, oldMesh.getIndices().begin()) ||
+		!std::equal(mesh.getIndices().end() - uNoOfIndicesAfter, mesh.getIndices().end(), oldMesh.getIndices().end() - uNoOfIndicesAfter))
+	{
+		uNoOfMismatches++;
+	}
+	return uNoOfMismatches;
+}
+
+void TestSurfaceExtractor::testUpdate()
+{
+	const Region volumeRegion(Vector3DInt32(0,0,0), Vector3DInt32(95,95,95));
+
+	SimpleVolume<float> volData(volumeRegion);
+	for (int32_t z = volumeRegion.getLowerCorner().getZ(); z <= volumeRegion.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = volumeRegion.getLowerCorner().getY(); y <= volumeRegion.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = volumeRegion.getLowerCorner().getX(); x <= volumeRegion.getUpperCorner().getX(); x++)
+			{
+				volData.setVoxelAt(x, y, z, (y - 40) + 20.0f * sinf(x * 0.1f) * cosf(z * 0.13f));
+			}
+		}
+	}
+
+	LargeVolume<float> largeVolData(volumeRegion);
+	std::vector<float> vecVoxels(volumeRegion.getWidthInVoxels() * volumeRegion.getHeightInVoxels() * volumeRegion.getDepthInVoxels());
+	volData.readRegion(volumeRegion, &vecVoxels[0]);
+	largeVolData.writeRegion(volumeRegion, &vecVoxels[0]);
+	largeVolData.setConcurrentAccessEnabled(true);
+
+	//A region which doesn't start at the origin, so that edits can be made on either side of it.
+	const Region region(Vector3DInt32(8,0,10), Vector3DInt32(71,95,80));
+
+	//Updating before anything has been extracted extracts the whole region.
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > extractor(&volData, region, &mesh, DefaultMarchingCubesController<float>(0.0f));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(20,30,40), Vector3DInt32(30,50,45))), static_cast<uint32_t>(0));
+
+	//Edits in the middle, at both ends in z, just outside the region, and a long way outside it.
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(25,35,30), Vector3DInt32(35,45,33))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(10,20,5), Vector3DInt32(60,60,11))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(10,20,78), Vector3DInt32(60,60,90))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(20,30,8), Vector3DInt32(30,50,9))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(72,30,40), Vector3DInt32(73,50,45))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(volData, extractor, mesh, region, Region(Vector3DInt32(0,0,0), Vector3DInt32(95,95,95))), static_cast<uint32_t>(0));
+
+	const SurfaceMesh<PositionMaterialNormal> meshBeforeEdit(mesh);
+	const MeshChange noChange = extractor.update(Region(Vector3DInt32(80,30,40), Vector3DInt32(90,50,45)));
+	QCOMPARE(noChange.beginVertex, noChange.endVertex);
+	QCOMPARE(noChange.beginIndex, noChange.endIndex);
+	QCOMPARE(countMeshMismatches(mesh, meshBeforeEdit), static_cast<uint32_t>(0));
+
+	//A mesh from executeInParallel() can be updated in the same way.
+	SurfaceMesh<PositionMaterialNormal> largeMesh;
+	MarchingCubesSurfaceExtractor< LargeVolume<float> > largeExtractor(&largeVolData, region, &largeMesh, DefaultMarchingCubesController<float>(0.0f));
+	largeExtractor.executeInParallel(4);
+	QCOMPARE(countUpdateMismatches(largeVolData, largeExtractor, largeMesh, region, Region(Vector3DInt32(25,35,30), Vector3DInt32(35,45,33))), static_cast<uint32_t>(0));
+	QCOMPARE(countUpdateMismatches(largeVolData, largeExtractor, largeMesh, region, Region(Vector3DInt32(40,10,60), Vector3DInt32(41,80,61))), static_cast<uint32_t>(0));
+
+	//And so can a region a single slice deep.
+	const Region thinRegion(Vector3DInt32(5,0,7), Vector3DInt32(60,90,7));
+	SurfaceMesh<PositionMaterialNormal> thinMesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > thinExtractor(&volData, thinRegion, &thinMesh, DefaultMarchingCubesController<float>(0.0f));
+	thinExtractor.execute();
+	QCOMPARE(countUpdateMismatches(volData, thinExtractor, thinMesh, thinRegion, Region(Vector3DInt32(20,30,8), Vector3DInt32(30,50,9))), static_cast<uint32_t>(0));
+
+	QBENCHMARK {
+		extractor.update(Region(Vector3DInt32(25,35,30), Vector3DInt32(35,45,33)));
+	}
+}
+
+//Adds the triangles of a mesh to a list of their corners, scaling and moving them into the same space as the others.
+void addMeshTriangles(const SurfaceMesh<PositionMaterialNormal>& mesh, float fScale, const Vector3DFloat& v3dOffset, std::vector<Vector3DFloat>& vecCorners)
+{
+	for(uint32_t ct = 0; ct < mesh.getNoOfIndices(); ct++)
+	{
+		vecCorners.push_back(mesh.getVertices()[mesh.getIndices()[ct]].getPosition() * fScale + v3dOffset);
+	}
+}
+
+//Counts the sides of triangles which don't have another triangle going the other way along them, and so are next to
+//a hole. Corners are matched up by their positions. Sides on the outside of the regions are part of the border.
+uint32_t countOpenEdges(const std::vector<Vector3DFloat>& vecCorners, const std::vector<Region>& vecRegions)
+{
+	std::map<Vector3DFloat, uint32_t> mapVertices;
+	std::vector<uint32_t> vecIndices;
+	for(uint32_t ct = 0; ct < vecCorners.size(); ct++)
+	{
+		std::map<Vector3DFloat, uint32_t>::iterator iterVertex = mapVertices.insert(std::make_pair(vecCorners[ct], static_cast<uint32_t>(mapVertices.size()))).first;
+		vecIndices.push_back(iterVertex->second);
+	}
+
+	std::map<std::pair<uint32_t, uint32_t>, uint32_t> mapEdges;
+	for(uint32_t ct = 0; ct < vecIndices.size(); ct++)
+	{
+		const uint32_t uNext = (ct % 3 == 2) ? ct - 2 : ct + 1;
+		mapEdges[std::make_pair(vecIndices[ct], vecIndices[uNext])]++;
+	}
+
+	uint32_t uNoOfOpenEdges = 0;
+	for(uint32_t ct = 0; ct < vecIndices.size(); ct++)
+	{
+		const uint32_t uNext = (ct % 3 == 2) ? ct - 2 : ct + 1;
+		if((vecIndices[ct] == vecIndices[uNext]) || (mapEdges.count(std::make_pair(vecIndices[uNext], vecIndices[ct])) != 0))
+		{
+			continue;
+		}
+
+		//The side is on the border if there are points right next to its middle which are outside all of the regions.
+		const Vector3DFloat v3dMiddle = (vecCorners[ct] + vecCorners[uNext]) * 0.5f;
+		bool bOnBorder = false;
+		for(uint32_t uOffset = 0; uOffset < 8; uOffset++)
+		{
+			const float fOffset = 0.001f;
+			const Vector3DFloat v3dPoint = v3dMiddle + Vector3DFloat((uOffset & 1) ? fOffset : -fOffset, (uOffset & 2) ? fOffset : -fOffset, (uOffset & 4) ? fOffset : -fOffset);
+			bool bInside = false;
+			for(uint32_t uRegion = 0; uRegion < vecRegions.size(); uRegion++)
+			{
+				bInside = bInside || vecRegions[uRegion].containsPoint(v3dPoint);
+			}
+			bOnBorder = bOnBorder || !bInside;
+		}
+		if(!bOnBorder)
+		{
+			uNoOfOpenEdges++;
+		}
+	}
+	return uNoOfOpenEdges;
+}
+
+//Extracts the region, and the regions on the other side of the given faces from the lower resolution volume. Then counts
+//the holes in the combined mesh, which there shouldn't be if the region had transition cells on those faces.
+uint32_t countOpenEdgesAcrossFaces(SimpleVolume<float>& volData, SimpleVolume<float>& lowVolData, const Region& region, const std::vector<RegionFace>& vecFaces, bool bTransitionCells)
+{
+	std::vector<Vector3DFloat> vecCorners;
+	std::vector<Region> vecRegions;
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > extractor(&volData, region, &mesh, DefaultMarchingCubesController<float>(0.0f));
+	for(uint32_t ct = 0; ct < vecFaces.size(); ct++)
+	{
+		extractor.setTransitionFace(vecFaces[ct], bTransitionCells);
+	}
+	extractor.execute();
+	addMeshTriangles(mesh, 1.0f, static_cast<Vector3DFloat>(region.getLowerCorner()), vecCorners);
+	vecRegions.push_back(region);
+
+	for(uint32_t ct = 0; ct < vecFaces.size(); ct++)
+	{
+		const uint32_t uAxis = vecFaces[ct] / 2;
+		Vector3DInt32 v3dShift(0,0,0);
+		v3dShift.setElement(uAxis, ((vecFaces[ct] % 2) == 1) ? region.getDimensionsInCells().getElement(uAxis) : -region.getDimensionsInCells().getElement(uAxis));
+		Region neighbourRegion(region);
+		neighbourRegion.shift(v3dShift);
+		vecRegions.push_back(neighbourRegion);
+
+		const Region lowRegion(neighbourRegion.getLowerCorner() / 2, neighbourRegion.getUpperCorner() / 2);
+		SurfaceMesh<PositionMaterialNormal> lowMesh;
+		MarchingCubesSurfaceExtractor< SimpleVolume<float> > lowExtractor(&lowVolData, lowRegion, &lowMesh, DefaultMarchingCubesController<float>(0.0f));
+		lowExtractor.execute();
+		addMeshTriangles(lowMesh, 2.0f, static_cast<Vector3DFloat>(neighbourRegion.getLowerCorner()), vecCorners);
+	}
+
+	return countOpenEdges(vecCorners, vecRegions);
+}
+
+void TestSurfaceExtractor::testTransitionCells()
+{
+	//A bumpy sphere which is big enough to go through all the faces of the region in the middle.
+	const Region volumeRegion(Vector3DInt32(-40,-40,-40), Vector3DInt32(72,72,72));
+	SimpleVolume<float> volData(volumeRegion);
+	for (int32_t z = volumeRegion.getLowerCorner().getZ(); z <= volumeRegion.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = volumeRegion.getLowerCorner().getY(); y <= volumeRegion.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = volumeRegion.getLowerCorner().getX(); x <= volumeRegion.getUpperCorner().getX(); x++)
+			{
+				const float fDistToCenter = (Vector3DFloat(x, y, z) - Vector3DFloat(16.3f, 15.8f, 16.1f)).length();
+				volData.setVoxelAt(x, y, z, fDistToCenter - 20.5f + 1.5f * sinf(x * 0.3f) * cosf(y * 0.2f + z * 0.1f));
+			}
+		}
+	}
+
+	//The lower resolution volume has every second voxel of the other one.
+	const Region lowVolumeRegion(Vector3DInt32(-20,-20,-20), Vector3DInt32(36,36,36));
+	SimpleVolume<float> lowVolData(lowVolumeRegion);
+	for (int32_t z = lowVolumeRegion.getLowerCorner().getZ(); z <= lowVolumeRegion.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = lowVolumeRegion.getLowerCorner().getY(); y <= lowVolumeRegion.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = lowVolumeRegion.getLowerCorner().getX(); x <= lowVolumeRegion.getUpperCorner().getX(); x++)
+			{
+				lowVolData.setVoxelAt(x, y, z, volData.getVoxelAt(x * 2, y * 2, z * 2));
+			}
+		}
+	}
+
+	const Region region(Vector3DInt32(0,0,0), Vector3DInt32(32,32,32));
+	std::vector<RegionFace> vecFaces(1);
+	for(uint32_t uFace = 0; uFace < RegionFaces::NoOfFaces; uFace++)
+	{
+		vecFaces[0] = static_cast<RegionFace>(uFace);
+		QCOMPARE(countOpenEdgesAcrossFaces(volData, lowVolData, region, vecFaces, true), static_cast<uint32_t>(0));
+		QVERIFY(countOpenEdgesAcrossFaces(volData, lowVolData, region, vecFaces, false) > 0);
+	}
+
+	//Several faces at once, including where two of them meet.
+	vecFaces.clear();
+	vecFaces.push_back(RegionFaces::NegativeX);
+	vecFaces.push_back(RegionFaces::NegativeY);
+	vecFaces.push_back(RegionFaces::PositiveZ);
+	QCOMPARE(countOpenEdgesAcrossFaces(volData, lowVolData, region, vecFaces, true), static_cast<uint32_t>(0));
+
+	//The transition cells are kept when the mesh is updated or extracted on several threads.
+	SurfaceMesh<PositionMaterialNormal> expectedMesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > expectedExtractor(&volData, region, &expectedMesh, DefaultMarchingCubesController<float>(0.0f));
+	expectedExtractor.setTransitionFace(RegionFaces::NegativeX, true);
+	expectedExtractor.setTransitionFace(RegionFaces::PositiveZ, true);
+	expectedExtractor.execute();
+
+	SurfaceMesh<PositionMaterialNormal> mesh;
+	MarchingCubesSurfaceExtractor< SimpleVolume<float> > extractor(&volData, region, &mesh, DefaultMarchingCubesController<float>(0.0f));
+	extractor.setTransitionFace(RegionFaces::NegativeX, true);
+	extractor.setTransitionFace(RegionFaces::PositiveZ, true);
+	extractor.executeInParallel(4);
+	QCOMPARE(countMeshMismatches(mesh, expectedMesh), static_cast<uint32_t>(0));
+
+	extractor.update(Region(Vector3DInt32(10,10,10), Vector3DInt32(12,12,12)));
+	QCOMPARE(countMeshMismatches(mesh, expectedMesh), static_cast<uint32_t>(0));
+
+	for (int32_t z = 20; z <= 24; z++)
+	{
+		for (int32_t y = 0; y <= 8; y++)
+		{
+			for (int32_t x = -6; x <= 6; x++)
+			{
+				volData.setVoxelAt(x, y, z, -volData.getVoxelAt(x, y, z));
+			}
+		}
+	}
+	extractor.update(Region(Vector3DInt32(-6,0,20), Vector3DInt32(6,8,24)));
+	expectedExtractor.execute();
+	QCOMPARE(countMeshMismatches(mesh, expectedMesh), static_cast<uint32_t>(0));
+}
+
 QTEST_MAIN(TestSurfaceExtractor)
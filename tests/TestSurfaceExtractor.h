@@ -32,6 +32,13 @@ class TestSurfaceExtractor: public QObject
 	
 	private slots:
 		void testExecute();
+		void testBlockLayouts();
+		void testDensityRanges();
+		void testExecuteInParallel();
+		void testRowBitmasks();
+		void testTwoPass();
+		void testUpdate();
+		void testTransitionCells();
 };
 
 #endif
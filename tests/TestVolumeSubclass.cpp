@@ -27,7 +27,9 @@ freely, subject to the following restrictions:
 #include "PolyVoxCore/BaseVolume.h"
 #include "PolyVoxCore/CubicSurfaceExtractor.h"
 #include "PolyVoxCore/Material.h"
+#include "PolyVoxCore/RawVolume.h"
 #include "PolyVoxCore/Vector.h"
+#include "PolyVoxCore/VolumeResampler.h"
 
 #include <QtTest>
 
@@ -136,4 +138,45 @@ void TestVolumeSubclass::testExtractSurface()
 	QCOMPARE(result.getNoOfVertices(), static_cast<uint32_t>(8));
 }
 
+void TestVolumeSubclass::testResample()
+{
+	//The subclass doesn't provide readRegion() or writeRegion(), so the resampler has to copy it a voxel at a time.
+	const Region region(0,0,0,16,16,16);
+	VolumeSubclass<uint8_t> volumeSubclass(region);
+	for(int32_t z = 0; z < volumeSubclass.getDepth(); z++)
+	{
+		for(int32_t y = 0; y < volumeSubclass.getHeight(); y++)
+		{
+			for(int32_t x = 0; x < volumeSubclass.getWidth(); x++)
+			{
+				volumeSubclass.setVoxelAt(x, y, z, static_cast<uint8_t>((x + y * 3 + z * 5) % 7));
+			}
+		}
+	}
+
+	RawVolume<uint8_t> volCopy(region);
+	VolumeResampler< VolumeSubclass<uint8_t>, RawVolume<uint8_t> > copyOut(&volumeSubclass, region, &volCopy, region);
+	copyOut.execute();
+
+	VolumeSubclass<uint8_t> volCopyBack(region);
+	VolumeResampler< RawVolume<uint8_t>, VolumeSubclass<uint8_t> > copyBack(&volCopy, region, &volCopyBack, region);
+	copyBack.execute();
+
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = 0; z < volumeSubclass.getDepth(); z++)
+	{
+		for(int32_t y = 0; y < volumeSubclass.getHeight(); y++)
+		{
+			for(int32_t x = 0; x < volumeSubclass.getWidth(); x++)
+			{
+				if((volCopy.getVoxelAt(x, y, z) != volumeSubclass.getVoxelAt(x, y, z)) || (volCopyBack.getVoxelAt(x, y, z) != volumeSubclass.getVoxelAt(x, y, z)))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+}
+
 QTEST_MAIN(TestVolumeSubclass)
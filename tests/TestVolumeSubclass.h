@@ -32,6 +32,7 @@ class TestVolumeSubclass: public QObject
 	
 	private slots:
 		void testExtractSurface();
+		void testResample();
 };
 
 #endif
@@ -24,11 +24,71 @@ freely, subject to the following restrictions:
 #include "testvolume.h"
 
 #include "PolyVoxCore/LargeVolume.h"
+#include "PolyVoxCore/MappedVolume.h"
+#include "PolyVoxCore/PalettedVolume.h"
+#include "PolyVoxCore/RawVolume.h"
+#include "PolyVoxCore/SimpleVolume.h"
+#include "PolyVoxCore/SparseVolume.h"
+#include "PolyVoxCore/VolumeResampler.h"
 
 #include <QtTest>
 
+#include <algorithm>
+#include <cstdio> //For remove()
+#include <map>
+#include <vector>
+
 using namespace PolyVox;
 
+//Stands in for the disk when testing paging. The key is the lower corner of the paged region.
+static std::map< Vector3DInt32, std::vector<uint8_t> > g_mapPagedData;
+//The handlers can be called from several paging threads at once.
+static polyvox_mutex g_mutexPagedData;
+
+void savePagedData(const ConstVolumeProxy<uint8_t>& volume, const Region& reg)
+{
+	polyvox_lock_guard<polyvox_mutex> lock(g_mutexPagedData);
+	std::vector<uint8_t>& vecData = g_mapPagedData[reg.getLowerCorner()];
+	vecData.clear();
+	for(int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				vecData.push_back(volume.getVoxelAt(x,y,z));
+			}
+		}
+	}
+}
+
+void loadPagedData(const ConstVolumeProxy<uint8_t>& volume, const Region& reg)
+{
+	polyvox_lock_guard<polyvox_mutex> lock(g_mutexPagedData);
+	std::map< Vector3DInt32, std::vector<uint8_t> >::iterator itData = g_mapPagedData.find(reg.getLowerCorner());
+	if(itData == g_mapPagedData.end())
+	{
+		return;
+	}
+
+	uint32_t uIndex = 0;
+	for(int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				volume.setVoxelAt(x,y,z,itData->second[uIndex++]);
+			}
+		}
+	}
+}
+
+uint8_t pagingTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return static_cast<uint8_t>(x + y * 3 + z * 7);
+}
+
 void TestVolume::testSize()
 {
 	const int32_t g_uVolumeSideLength = 128;
@@ -50,4 +110,1267 @@ void TestVolume::testSize()
 	QCOMPARE(volData.getDepth(), g_uVolumeSideLength);
 }
 
+void testPagingWithPolicy(EvictionPolicy ePolicy)
+{
+	g_mapPagedData.clear();
+
+	//Only a handful of blocks fit in memory, so most of the volume gets paged out (and back in again) as we go.
+	LargeVolume<uint8_t> volData(&loadPagedData, &savePagedData, 16);
+	volData.setEvictionPolicy(ePolicy);
+	volData.setMaxNumberOfBlocksInMemory(8);
+	volData.setMaxNumberOfUncompressedBlocks(4);
+
+	const int32_t iLower = -40;
+	const int32_t iUpper = 40;
+
+	for (int32_t z = iLower; z <= iUpper; z++)
+	{
+		for (int32_t y = iLower; y <= iUpper; y++)
+		{
+			for (int32_t x = iLower; x <= iUpper; x++)
+			{
+				volData.setVoxelAt(x,y,z,pagingTestValue(x,y,z));
+			}
+		}
+	}
+
+	//Flush part of the volume explicitly and prefetch some of it back, to exercise those paths as well.
+	volData.flush(Region(Vector3DInt32(iLower,iLower,iLower), Vector3DInt32(0,0,0)));
+	volData.prefetch(Region(Vector3DInt32(-16,-16,-16), Vector3DInt32(15,15,15)));
+
+	uint32_t uNoOfMismatches = 0;
+	for (int32_t z = iUpper; z >= iLower; z--)
+	{
+		for (int32_t y = iLower; y <= iUpper; y++)
+		{
+			for (int32_t x = iUpper; x >= iLower; x--)
+			{
+				if(volData.getVoxelAt(x,y,z) != pagingTestValue(x,y,z))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+
+	QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+	//Every block which was loaded beyond the limit must have been evicted again.
+	CacheStatistics statsLoaded = volData.getLoadedBlockStatistics();
+	QVERIFY(statsLoaded.evictions > 0);
+	QVERIFY(statsLoaded.hits > 0);
+	QVERIFY(volData.getUncompressedBlockStatistics().evictions > 0);
+
+	volData.flushAll();
+	QCOMPARE(volData.getVoxelAt(iLower,iUpper,0), pagingTestValue(iLower,iUpper,0));
+}
+
+void TestVolume::testPaging()
+{
+	testPagingWithPolicy(EvictionPolicies::LeastRecentlyUsed);
+	testPagingWithPolicy(EvictionPolicies::SecondChance);
+}
+
+void TestVolume::testAsyncPaging()
+{
+	g_mapPagedData.clear();
+
+	const int32_t iLower = -40;
+	const int32_t iUpper = 40;
+
+	{
+		LargeVolume<uint8_t> volData(&loadPagedData, &savePagedData, 16);
+		volData.setMaxNumberOfBlocksInMemory(8);
+		volData.setMaxNumberOfUncompressedBlocks(4);
+		volData.setNumberOfPagingThreads(2);
+		QCOMPARE(volData.getNumberOfPagingThreads(), static_cast<uint32_t>(2));
+		QVERIFY(volData.isConcurrentAccessEnabled());
+
+		for (int32_t z = iLower; z <= iUpper; z++)
+		{
+			for (int32_t y = iLower; y <= iUpper; y++)
+			{
+				for (int32_t x = iLower; x <= iUpper; x++)
+				{
+					volData.setVoxelAt(x,y,z,pagingTestValue(x,y,z));
+				}
+			}
+		}
+
+		//Reading back has to wait for blocks which are still being written back, and then load them again.
+		uint32_t uNoOfMismatches = 0;
+		LargeVolume<uint8_t>::Sampler sampler(&volData);
+		for (int32_t z = iLower; z <= iUpper; z++)
+		{
+			//Queue up the next slice of blocks while we work on this one.
+			const int32_t iPrefetchZ = (std::min)(z + 16, iUpper);
+			volData.prefetch(Region(Vector3DInt32(iLower,iLower,iPrefetchZ), Vector3DInt32(iUpper,iUpper,iPrefetchZ)));
+
+			//The policy can be changed while the paging threads are busy.
+			if(z == 0)
+			{
+				volData.setEvictionPolicy(EvictionPolicies::SecondChance);
+			}
+
+			for (int32_t y = iLower; y <= iUpper; y++)
+			{
+				sampler.setPosition(iLower,y,z);
+				for (int32_t x = iLower; x <= iUpper; x++)
+				{
+					if(sampler.getVoxel() != pagingTestValue(x,y,z))
+					{
+						uNoOfMismatches++;
+					}
+					sampler.movePositiveX();
+				}
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+		QVERIFY(volData.getLoadedBlockStatistics().evictions > 0);
+		QVERIFY(volData.getEvictionPolicy() == EvictionPolicies::SecondChance);
+
+		//Going back to synchronous paging waits for everything to finish.
+		sampler.setPosition(iLower-1,iLower-1,iLower-1);
+		volData.setNumberOfPagingThreads(0);
+		QCOMPARE(volData.getVoxelAt(iUpper,iLower,0), pagingTestValue(iUpper,iLower,0));
+		volData.setNumberOfPagingThreads(4);
+	}
+
+	//Destroying the volume must have written everything back.
+	QCOMPARE(g_mapPagedData.size(), static_cast<size_t>(6 * 6 * 6));
+	QCOMPARE(g_mapPagedData[Vector3DInt32(32,-32,-16)][0], pagingTestValue(32,-32,-16));
+}
+
+//Reads the whole volume through a Sampler (as a surface extractor would) and then again through getVoxelAt(),
+//starting at a different place in each thread so that the threads are mostly working on different blocks.
+void readVolumeConcurrently(LargeVolume<uint8_t>* pVolData, int32_t iLower, int32_t iUpper, int32_t iStartZ, uint32_t* pNoOfMismatches)
+{
+	const int32_t iSideLength = iUpper - iLower + 1;
+	LargeVolume<uint8_t>::Sampler sampler(pVolData);
+
+	for (int32_t ct = 0; ct < iSideLength; ct++)
+	{
+		int32_t z = iLower + (iStartZ - iLower + ct) % iSideLength;
+		for (int32_t y = iLower; y <= iUpper; y++)
+		{
+			sampler.setPosition(iLower,y,z);
+			for (int32_t x = iLower; x <= iUpper; x++)
+			{
+				if((sampler.getVoxel() != pagingTestValue(x,y,z)) || (sampler.peekVoxel0px0py1pz() != pVolData->getVoxelAt(x,y,z+1)))
+				{
+					(*pNoOfMismatches)++;
+				}
+				sampler.movePositiveX();
+			}
+		}
+	}
+}
+
+//Overwrites the odd slices of the given z range with setVoxelAt() and reads each voxel back with getVoxelAt().
+void writeVolumeConcurrently(LargeVolume<uint8_t>* pVolData, int32_t iLower, int32_t iUpper, int32_t iStartZ, int32_t iEndZ, uint32_t* pNoOfMismatches)
+{
+	for (int32_t z = iStartZ | 1; z <= iEndZ; z += 2)
+	{
+		for (int32_t y = iLower; y <= iUpper; y++)
+		{
+			for (int32_t x = iLower; x <= iUpper; x++)
+			{
+				const uint8_t uValue = static_cast<uint8_t>(pagingTestValue(x,y,z) + 1);
+				pVolData->setVoxelAt(x,y,z,uValue);
+				if(pVolData->getVoxelAt(x,y,z) != uValue)
+				{
+					(*pNoOfMismatches)++;
+				}
+			}
+		}
+	}
+}
+
+void TestVolume::testConcurrentReads()
+{
+	const int32_t iLower = -40;
+	const int32_t iUpper = 40;
+
+	//A small cache of uncompressed blocks means the threads are constantly
+	//causing blocks to be compressed and uncompressed underneath each other.
+	LargeVolume<uint8_t> volData(Region(Vector3DInt32(iLower,iLower,iLower), Vector3DInt32(iUpper,iUpper,iUpper)), 0, 0, false, 16);
+	volData.setMaxNumberOfUncompressedBlocks(8);
+
+	for (int32_t z = iLower; z <= iUpper; z++)
+	{
+		for (int32_t y = iLower; y <= iUpper; y++)
+		{
+			for (int32_t x = iLower; x <= iUpper; x++)
+			{
+				volData.setVoxelAt(x,y,z,pagingTestValue(x,y,z));
+			}
+		}
+	}
+
+	volData.setConcurrentAccessEnabled(true);
+	volData.resetStatistics();
+
+	const uint32_t uNoOfThreads = 4;
+	std::vector<uint32_t> vecNoOfMismatches(uNoOfThreads, 0);
+	std::vector<polyvox_thread*> vecThreads;
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		int32_t iStartZ = iLower + ct * (iUpper - iLower) / uNoOfThreads;
+		vecThreads.push_back(new polyvox_thread(polyvox_bind(&readVolumeConcurrently, &volData, iLower, iUpper, iStartZ, &vecNoOfMismatches[ct])));
+	}
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		vecThreads[ct]->join();
+		delete vecThreads[ct];
+	}
+
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		QCOMPARE(vecNoOfMismatches[ct], static_cast<uint32_t>(0));
+	}
+
+	//Both the fast path and the slow path must have been exercised.
+	QVERIFY(volData.getUncompressedBlockStatistics().evictions > 0);
+	QVERIFY(volData.getUncompressedBlockStatistics().hits > 0);
+
+	//Writes from several threads at once, with the threads sharing blocks.
+	vecThreads.clear();
+	const int32_t iSlabDepth = (iUpper - iLower + 1) / uNoOfThreads + 1;
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		vecNoOfMismatches[ct] = 0;
+		int32_t iStartZ = iLower + ct * iSlabDepth;
+		int32_t iEndZ = (std::min)(iStartZ + iSlabDepth - 1, iUpper);
+		vecThreads.push_back(new polyvox_thread(polyvox_bind(&writeVolumeConcurrently, &volData, iLower, iUpper, iStartZ, iEndZ, &vecNoOfMismatches[ct])));
+	}
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		vecThreads[ct]->join();
+		delete vecThreads[ct];
+		QCOMPARE(vecNoOfMismatches[ct], static_cast<uint32_t>(0));
+	}
+
+	volData.setConcurrentAccessEnabled(false);
+	QCOMPARE(volData.getVoxelAt(iUpper,iLower,0), pagingTestValue(iUpper,iLower,0));
+	QCOMPARE(volData.getVoxelAt(iLower,iUpper,iLower), pagingTestValue(iLower,iUpper,iLower));
+	QCOMPARE(volData.getVoxelAt(iLower,iUpper,iLower+1), static_cast<uint8_t>(pagingTestValue(iLower,iUpper,iLower+1) + 1));
+}
+
+//Fills the blocks below y = 0 with rock and leaves the rest as air.
+void loadLayeredData(const ConstVolumeProxy<uint8_t>& volume, const Region& reg)
+{
+	if(reg.getLowerCorner().getY() >= 0)
+	{
+		return;
+	}
+
+	for(int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				volume.setVoxelAt(x,y,z,1);
+			}
+		}
+	}
+}
+
+//Reads every voxel through a Sampler and counts those which don't match the expected value.
+template <typename VolumeType>
+uint32_t countSamplerMismatches(VolumeType* pVolData, uint8_t (*funcExpectedValue)(int32_t, int32_t, int32_t))
+{
+	uint32_t uNoOfMismatches = 0;
+	typename VolumeType::Sampler sampler(pVolData);
+	const Region& reg = pVolData->getEnclosingRegion();
+	for (int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			sampler.setPosition(reg.getLowerCorner().getX(),y,z);
+			for (int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				if((sampler.getVoxel() != funcExpectedValue(x,y,z)) || (sampler.peekVoxel1px1py1pz() != pVolData->getVoxelAt(x+1,y+1,z+1)))
+				{
+					uNoOfMismatches++;
+				}
+				sampler.movePositiveX();
+			}
+		}
+	}
+	return uNoOfMismatches;
+}
+
+uint8_t uniformTestValue(int32_t x, int32_t y, int32_t z)
+{
+	//A single modified voxel, and a block which has been filled with fives.
+	if((x == 3) && (y == 4) && (z == 5))
+	{
+		return 7;
+	}
+	return ((x >= 16) && (x < 32) && (y < 16) && (z < 16)) ? 5 : 0;
+}
+
+uint8_t layeredTestValue(int32_t /*x*/, int32_t y, int32_t /*z*/)
+{
+	return (y < 0) ? 1 : 0;
+}
+
+uint8_t blockTestValue(int32_t x, int32_t y, int32_t z)
+{
+	//A different value for each of the 16x16x16 blocks of a 64x64x64 volume.
+	return static_cast<uint8_t>(1 + (x >> 4) + ((y >> 4) << 2) + ((z >> 4) << 4));
+}
+
+void TestVolume::testUniformBlocks()
+{
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(63,63,63));
+	const uint32_t uBlockSizeInBytes = 16 * 16 * 16;
+
+	{
+		LargeVolume<uint8_t> volData(reg, 0, 0, false, 16);
+		QCOMPARE(volData.getBlockSideLength(), static_cast<uint16_t>(16));
+
+		//Reading a new volume (or writing the value it already has) shouldn't uncompress anything.
+		QCOMPARE(volData.getVoxelAt(10,20,30), static_cast<uint8_t>(0));
+		volData.setVoxelAt(40,50,60,0);
+		QCOMPARE(countSamplerMismatches(&volData, &layeredTestValue), static_cast<uint32_t>(0));
+		QCOMPARE(volData.getUncompressedBlockStatistics().misses, static_cast<uint32_t>(0));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(2,3,3)));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(-1,0,0)));
+
+		//Writing a different value materialises the block, and filling a block makes it uniform again once it is compressed.
+		volData.setVoxelAt(3,4,5,7);
+		QVERIFY(!volData.isBlockUniform(Vector3DInt32(0,0,0)));
+		for (int32_t z = 0; z < 16; z++)
+		{
+			for (int32_t y = 0; y < 16; y++)
+			{
+				for (int32_t x = 16; x < 32; x++)
+				{
+					volData.setVoxelAt(x,y,z,5);
+				}
+			}
+		}
+		volData.clearBlockCache();
+		QVERIFY(!volData.isBlockUniform(Vector3DInt32(0,0,0)));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(1,0,0)));
+
+		volData.resetStatistics();
+		QCOMPARE(countSamplerMismatches(&volData, &uniformTestValue), static_cast<uint32_t>(0));
+		QCOMPARE(volData.getUncompressedBlockStatistics().misses, static_cast<uint32_t>(1));
+
+		volData.setConcurrentAccessEnabled(true);
+		volData.resetStatistics();
+		QCOMPARE(countSamplerMismatches(&volData, &uniformTestValue), static_cast<uint32_t>(0));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(1,0,0)));
+		//The uniform blocks are read without being uncompressed, so they are only hits for the loaded blocks.
+		QVERIFY(volData.getUncompressedBlockStatistics().hits < volData.getLoadedBlockStatistics().hits / 10);
+		QCOMPARE(volData.getUncompressedBlockStatistics().misses, static_cast<uint32_t>(0));
+		volData.setConcurrentAccessEnabled(false);
+
+		//Uniform blocks give the same results with every compressor.
+		volData.clearBlockCache();
+		RLECompressor<uint8_t> compressor;
+		QVERIFY(volData.calculateCompressionRatio(&compressor) < 0.01f);
+	}
+
+	{
+		//Blocks which the pager fills with a single value shouldn't stay uncompressed.
+		LargeVolume<uint8_t> volData(Region(Vector3DInt32(-32,-32,-32), Vector3DInt32(31,31,31)), &loadLayeredData, 0, true, 16);
+		QCOMPARE(countSamplerMismatches(&volData, &layeredTestValue), static_cast<uint32_t>(0));
+		QCOMPARE(volData.getUncompressedBlockStatistics().misses, static_cast<uint32_t>(0));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(0,-1,0)));
+	}
+
+	{
+		SimpleVolume<uint8_t> volData(reg, 16);
+		QCOMPARE(volData.getBlockSideLength(), static_cast<uint16_t>(16));
+		QVERIFY(volData.calculateSizeInBytes() < uBlockSizeInBytes * 2);
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(0,0,0)));
+		QCOMPARE(countSamplerMismatches(&volData, &layeredTestValue), static_cast<uint32_t>(0));
+
+		volData.setVoxelAt(3,4,5,7);
+		QVERIFY(!volData.isBlockUniform(Vector3DInt32(0,0,0)));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(1,0,0)));
+
+		//Writing through a Sampler in a uniform block has to give the block its own voxels first.
+		SimpleVolume<uint8_t>::Sampler sampler(&volData);
+		for (int32_t z = 0; z < 16; z++)
+		{
+			for (int32_t y = 0; y < 16; y++)
+			{
+				sampler.setPosition(16,y,z);
+				for (int32_t x = 16; x < 32; x++)
+				{
+					QVERIFY(sampler.setVoxel(5));
+					sampler.movePositiveX();
+				}
+			}
+		}
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(1,0,0)));
+		QCOMPARE(countSamplerMismatches(&volData, &uniformTestValue), static_cast<uint32_t>(0));
+
+		//Only two of the 64 blocks have their own voxels.
+		QVERIFY(volData.calculateSizeInBytes() < uBlockSizeInBytes * 8);
+	}
+
+	{
+		//Every block is uniform with a different value, which is more values than the volume keeps data for.
+		//Samplers go through the volume in the other blocks, so they still read (and write) the right voxels.
+		SimpleVolume<uint8_t> volData(reg, 16);
+		for (int32_t z = 0; z < 64; z += 16)
+		{
+			for (int32_t y = 0; y < 64; y += 16)
+			{
+				for (int32_t x = 0; x < 64; x += 16)
+				{
+					volData.fillRegion(Region(Vector3DInt32(x,y,z), Vector3DInt32(x+15,y+15,z+15)), blockTestValue(x,y,z));
+				}
+			}
+		}
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(3,3,3)));
+		QCOMPARE(countSamplerMismatches(&volData, &blockTestValue), static_cast<uint32_t>(0));
+		QVERIFY(volData.calculateSizeInBytes() < uBlockSizeInBytes * 20);
+
+		SimpleVolume<uint8_t>::Sampler sampler(&volData);
+		sampler.setPosition(60,61,62);
+		QCOMPARE(sampler.getVoxel(), blockTestValue(60,61,62));
+		QVERIFY(sampler.setVoxel(200));
+		QCOMPARE(sampler.getVoxel(), static_cast<uint8_t>(200));
+		QCOMPARE(volData.getVoxelAt(60,61,62), static_cast<uint8_t>(200));
+		QCOMPARE(volData.getVoxelAt(61,61,62), blockTestValue(61,61,62));
+	}
+}
+
+//Walks a Sampler through the volume (and a voxel of the border) along each axis in both directions,
+//checking the current voxel and all 26 neighbours against getVoxelAt() as it goes.
+template <typename VolumeType>
+uint32_t countNeighbourhoodMismatches(VolumeType* pVolData)
+{
+	typedef uint8_t (VolumeType::Sampler::*PeekFunction)(void) const;
+	const PeekFunction peekFunctions[27] =
+	{
+		&VolumeType::Sampler::peekVoxel1nx1ny1nz, &VolumeType::Sampler::peekVoxel0px1ny1nz, &VolumeType::Sampler::peekVoxel1px1ny1nz,
+		&VolumeType::Sampler::peekVoxel1nx0py1nz, &VolumeType::Sampler::peekVoxel0px0py1nz, &VolumeType::Sampler::peekVoxel1px0py1nz,
+		&VolumeType::Sampler::peekVoxel1nx1py1nz, &VolumeType::Sampler::peekVoxel0px1py1nz, &VolumeType::Sampler::peekVoxel1px1py1nz,
+		&VolumeType::Sampler::peekVoxel1nx1ny0pz, &VolumeType::Sampler::peekVoxel0px1ny0pz, &VolumeType::Sampler::peekVoxel1px1ny0pz,
+		&VolumeType::Sampler::peekVoxel1nx0py0pz, &VolumeType::Sampler::peekVoxel0px0py0pz, &VolumeType::Sampler::peekVoxel1px0py0pz,
+		&VolumeType::Sampler::peekVoxel1nx1py0pz, &VolumeType::Sampler::peekVoxel0px1py0pz, &VolumeType::Sampler::peekVoxel1px1py0pz,
+		&VolumeType::Sampler::peekVoxel1nx1ny1pz, &VolumeType::Sampler::peekVoxel0px1ny1pz, &VolumeType::Sampler::peekVoxel1px1ny1pz,
+		&VolumeType::Sampler::peekVoxel1nx0py1pz, &VolumeType::Sampler::peekVoxel0px0py1pz, &VolumeType::Sampler::peekVoxel1px0py1pz,
+		&VolumeType::Sampler::peekVoxel1nx1py1pz, &VolumeType::Sampler::peekVoxel0px1py1pz, &VolumeType::Sampler::peekVoxel1px1py1pz
+	};
+
+	uint32_t uNoOfMismatches = 0;
+	typename VolumeType::Sampler sampler(pVolData);
+	const Region& reg = pVolData->getEnclosingRegion();
+	const int32_t iLower = reg.getLowerCorner().getX() - 1;
+	const int32_t iUpper = reg.getUpperCorner().getX() + 1;
+
+	//The volume is a cube, so the same range is used for every axis. 'uAxis' is the one we move along.
+	for(uint32_t uAxis = 0; uAxis < 3; uAxis++)
+	{
+		for(int32_t a = iLower; a <= iUpper; a++)
+		{
+			for(int32_t b = iLower; b <= iUpper; b++)
+			{
+				for(uint32_t uDirection = 0; uDirection < 2; uDirection++)
+				{
+					const int32_t iStart = (uDirection == 0) ? iLower : iUpper;
+					Vector3DInt32 v3dPos;
+					v3dPos.setElement(uAxis, iStart);
+					v3dPos.setElement((uAxis + 1) % 3, a);
+					v3dPos.setElement((uAxis + 2) % 3, b);
+					sampler.setPosition(v3dPos);
+
+					for(int32_t ct = iLower; ct <= iUpper; ct++)
+					{
+						//The peeks are the slowest part, so only check them along the first axis.
+						const uint32_t uNoOfPeeks = (uAxis == 0) ? 27 : 1;
+						for(uint32_t uPeek = 0; uPeek < uNoOfPeeks; uPeek++)
+						{
+							const uint32_t uPeekIndex = (uNoOfPeeks == 1) ? 13 : uPeek;
+							const int32_t x = v3dPos.getX() + static_cast<int32_t>(uPeekIndex % 3) - 1;
+							const int32_t y = v3dPos.getY() + static_cast<int32_t>((uPeekIndex / 3) % 3) - 1;
+							const int32_t z = v3dPos.getZ() + static_cast<int32_t>(uPeekIndex / 9) - 1;
+							if((sampler.*peekFunctions[uPeekIndex])() != pVolData->getVoxelAt(x,y,z))
+							{
+								uNoOfMismatches++;
+							}
+						}
+
+						if(uDirection == 0)
+						{
+							v3dPos.setElement(uAxis, v3dPos.getElement(uAxis) + 1);
+							if(uAxis == 0) sampler.movePositiveX();
+							if(uAxis == 1) sampler.movePositiveY();
+							if(uAxis == 2) sampler.movePositiveZ();
+						}
+						else
+						{
+							v3dPos.setElement(uAxis, v3dPos.getElement(uAxis) - 1);
+							if(uAxis == 0) sampler.moveNegativeX();
+							if(uAxis == 1) sampler.moveNegativeY();
+							if(uAxis == 2) sampler.moveNegativeZ();
+						}
+					}
+				}
+			}
+		}
+	}
+	return uNoOfMismatches;
+}
+
+template <typename VolumeType>
+void fillWithPagingTestValues(VolumeType* pVolData)
+{
+	const Region& reg = pVolData->getEnclosingRegion();
+	for (int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for (int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for (int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				pVolData->setVoxelAt(x,y,z,pagingTestValue(x,y,z));
+			}
+		}
+	}
+}
+
+void TestVolume::testBlockLayouts()
+{
+	//With negative coordinates, and walking a voxel into the border on each side.
+	const Region reg(Vector3DInt32(-16,-16,-16), Vector3DInt32(15,15,15));
+
+	{
+		LargeVolume<uint8_t> volData(reg, 0, 0, false, 8);
+		volData.setBorderValue(42);
+		fillWithPagingTestValues(&volData);
+		QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+
+		//Changing the layout rearranges both the compressed and the uncompressed blocks.
+		volData.setBlockLayout(BlockLayouts::Morton);
+		QCOMPARE(volData.getBlockLayout(), BlockLayouts::Morton);
+		QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+		QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+
+		volData.setConcurrentAccessEnabled(true);
+		QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+		volData.setConcurrentAccessEnabled(false);
+
+		//And it can be changed back again.
+		volData.setVoxelAt(1,2,3,200);
+		volData.setBlockLayout(BlockLayouts::Linear);
+		QCOMPARE(volData.getVoxelAt(1,2,3), static_cast<uint8_t>(200));
+		volData.setVoxelAt(1,2,3,pagingTestValue(1,2,3));
+		QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+	}
+
+	{
+		//Blocks which are paged out and back in again are stored in the volume's layout.
+		g_mapPagedData.clear();
+		LargeVolume<uint8_t> volData(reg, &loadPagedData, &savePagedData, true, 8);
+		volData.setMaxNumberOfBlocksInMemory(4);
+		volData.setBlockLayout(BlockLayouts::Morton);
+		fillWithPagingTestValues(&volData);
+		QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+	}
+
+	{
+		SimpleVolume<uint8_t> volData(reg, 8);
+		volData.setBorderValue(42);
+		volData.setBlockLayout(BlockLayouts::Morton);
+		QCOMPARE(volData.getBlockLayout(), BlockLayouts::Morton);
+		fillWithPagingTestValues(&volData);
+		QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+
+		volData.setBlockLayout(BlockLayouts::Linear);
+		QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+		QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+	}
+}
+
+void TestVolume::testBufferPool()
+{
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(63,63,63));
+	const uint32_t uBlockSizeInBytes = 16 * 16 * 16;
+
+	//Nothing is allocated until blocks are uncompressed.
+	LargeVolume<uint8_t> volData(reg, 0, 0, false, 16);
+	volData.setMaxNumberOfUncompressedBlocks(8);
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() < uBlockSizeInBytes);
+
+	//Blocks keep moving in and out of the cache, but the pool doesn't grow beyond the size of the cache.
+	fillWithPagingTestValues(&volData);
+	QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+	QVERIFY(volData.getUncompressedBlockStatistics().evictions > 0);
+	const uint32_t uPoolSizeInBytes = volData.calculateBufferPoolSizeInBytes();
+	QVERIFY(uPoolSizeInBytes >= uBlockSizeInBytes * 8);
+	QVERIFY(uPoolSizeInBytes < uBlockSizeInBytes * 9);
+
+	//Only the buffers which are in use count towards the size of the volume.
+	volData.clearBlockCache();
+	const uint32_t uCompressedSizeInBytes = volData.calculateSizeInBytes();
+	{
+		LargeVolume<uint8_t>::Sampler sampler(&volData);
+		for(int32_t ct = 0; ct < 8; ct++)
+		{
+			sampler.setPosition((ct % 4) * 16, (ct / 4) * 16, 0);
+			QCOMPARE(sampler.getVoxel(), pagingTestValue((ct % 4) * 16, (ct / 4) * 16, 0));
+		}
+	}
+	QCOMPARE(volData.calculateSizeInBytes(), uCompressedSizeInBytes + uBlockSizeInBytes * 8);
+	volData.clearBlockCache();
+	QCOMPARE(volData.calculateSizeInBytes(), uCompressedSizeInBytes);
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() < uPoolSizeInBytes + uBlockSizeInBytes);
+
+	//Growing the cache lets the pool grow as it is used, and it shrinks again when the cache does.
+	volData.setMaxNumberOfUncompressedBlocks(32);
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() < uPoolSizeInBytes + uBlockSizeInBytes);
+	QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() >= uPoolSizeInBytes + uBlockSizeInBytes * 24);
+	volData.setMaxNumberOfUncompressedBlocks(8);
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() < uPoolSizeInBytes + uBlockSizeInBytes);
+
+	//Samplers pin their blocks, so with more Samplers than the cache can hold some blocks have to come from the heap.
+	volData.setMaxNumberOfUncompressedBlocks(2);
+	const uint32_t uSmallPoolSizeInBytes = volData.calculateBufferPoolSizeInBytes();
+	{
+		std::vector<LargeVolume<uint8_t>::Sampler> vecSamplers(4, LargeVolume<uint8_t>::Sampler(&volData));
+		for(uint32_t ct = 0; ct < vecSamplers.size(); ct++)
+		{
+			vecSamplers[ct].setPosition(ct * 16, 0, 0);
+			QCOMPARE(vecSamplers[ct].getVoxel(), pagingTestValue(ct * 16, 0, 0));
+		}
+		QVERIFY(volData.calculateBufferPoolSizeInBytes() >= uSmallPoolSizeInBytes + uBlockSizeInBytes * 2);
+	}
+	volData.clearBlockCache();
+	QVERIFY(volData.calculateBufferPoolSizeInBytes() < uSmallPoolSizeInBytes + uBlockSizeInBytes);
+	QCOMPARE(countSamplerMismatches(&volData, &pagingTestValue), static_cast<uint32_t>(0));
+}
+
+//The bottom half of the volume is uniform and compresses to almost nothing, but the top half doesn't compress well.
+uint8_t budgetTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return (z < 48) ? 0 : pagingTestValue(x,y,z);
+}
+
+static uint32_t g_uNoOfHighWatermarkCalls = 0;
+static uint32_t g_uNoOfLowWatermarkCalls = 0;
+
+void countWatermarkCalls(uint32_t /*uSizeInBytes*/, bool bIsAboveHighWatermark)
+{
+	if(bIsAboveHighWatermark)
+	{
+		g_uNoOfHighWatermarkCalls++;
+	}
+	else
+	{
+		g_uNoOfLowWatermarkCalls++;
+	}
+}
+
+void TestVolume::testMemoryBudget()
+{
+	g_mapPagedData.clear();
+	g_uNoOfHighWatermarkCalls = 0;
+	g_uNoOfLowWatermarkCalls = 0;
+
+	const Region reg(Vector3DInt32(0,0,0), Vector3DInt32(95,95,95));
+	const uint32_t uBlockSizeInBytes = 16 * 16 * 16;
+	const uint32_t uMaxCompressedSizeInBytes = uBlockSizeInBytes * 8;
+
+	LargeVolume<uint8_t> volData(reg, &loadPagedData, &savePagedData, true, 16);
+	volData.setMaxUncompressedSizeInBytes(uBlockSizeInBytes * 4);
+	volData.setMaxCompressedSizeInBytes(uMaxCompressedSizeInBytes);
+	volData.setMemoryWatermarkHandler(&countWatermarkCalls, uMaxCompressedSizeInBytes / 4, uMaxCompressedSizeInBytes / 2);
+	QCOMPARE(volData.getMaxCompressedSizeInBytes(), uMaxCompressedSizeInBytes);
+
+	fillWithPagingTestValues(&volData);
+	for (int32_t z = 0; z < 48; z++)
+	{
+		for (int32_t y = 0; y <= 95; y++)
+		{
+			for (int32_t x = 0; x <= 95; x++)
+			{
+				volData.setVoxelAt(x,y,z,0);
+			}
+		}
+	}
+	QCOMPARE(countSamplerMismatches(&volData, &budgetTestValue), static_cast<uint32_t>(0));
+
+	//All 216 blocks would fit within the count limit, so only the budget can have caused them to be paged out. It is enforced
+	//as blocks are loaded, so the blocks in the cache (four, plus the one pinned by the Sampler) can take it over when they
+	//are compressed. Run length encoding this data takes four bytes per voxel.
+	QVERIFY(volData.getLoadedBlockStatistics().evictions > 0);
+	QVERIFY(volData.getUncompressedSizeInBytes() <= uBlockSizeInBytes * 4);
+	QVERIFY(volData.getCompressedSizeInBytes() <= uMaxCompressedSizeInBytes + uBlockSizeInBytes * 4 * 5);
+	QVERIFY(g_uNoOfHighWatermarkCalls > 0);
+
+	//Reducing the budget pages blocks out straight away.
+	volData.clearBlockCache();
+	QCOMPARE(volData.getUncompressedSizeInBytes(), static_cast<uint32_t>(0));
+	volData.setMaxCompressedSizeInBytes(uMaxCompressedSizeInBytes / 2);
+	QVERIFY(volData.getCompressedSizeInBytes() <= uMaxCompressedSizeInBytes / 2);
+
+	//Once everything has been paged out the usage has dropped below the low watermark, and
+	//the handler is told about each crossing of the watermarks exactly once.
+	volData.flushAll();
+	QCOMPARE(volData.getCompressedSizeInBytes(), static_cast<uint32_t>(0));
+	QCOMPARE(g_uNoOfLowWatermarkCalls, g_uNoOfHighWatermarkCalls);
+
+	volData.setMaxCompressedSizeInBytes(0);
+	QCOMPARE(countSamplerMismatches(&volData, &budgetTestValue), static_cast<uint32_t>(0));
+}
+
+uint8_t snapshotTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return pagingTestValue(x,y,z) + 1;
+}
+
+//Keeps reading the snapshot until told to stop, to check that it never sees any of the changes to the live volume.
+void readSnapshotRepeatedly(SimpleVolume<uint8_t>* pVolData, polyvox_atomic<bool>* pStop, uint32_t* pNoOfMismatches)
+{
+	do
+	{
+		(*pNoOfMismatches) += countSamplerMismatches(pVolData, &pagingTestValue);
+	} while(!pStop->load());
+}
+
+void TestVolume::testSnapshot()
+{
+	const Region reg(Vector3DInt32(-32,-32,-32), Vector3DInt32(31,31,31));
+	SimpleVolume<uint8_t> volData(reg, 16);
+	fillWithPagingTestValues(&volData);
+
+	polyvox_shared_ptr< SimpleVolume<uint8_t> > pSnapshot = volData.snapshot();
+	QCOMPARE(pSnapshot->getEnclosingRegion().getLowerCorner(), reg.getLowerCorner());
+	QCOMPARE(pSnapshot->getEnclosingRegion().getUpperCorner(), reg.getUpperCorner());
+
+	//Change every voxel of the live volume (half through a Sampler, which starts out pointing at the
+	//shared voxels) while other threads read the snapshot.
+	polyvox_atomic<bool> bStop(false);
+	const uint32_t uNoOfThreads = 2;
+	std::vector<uint32_t> vecNoOfMismatches(uNoOfThreads, 0);
+	std::vector<polyvox_thread*> vecThreads;
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		vecThreads.push_back(new polyvox_thread(polyvox_bind(&readSnapshotRepeatedly, pSnapshot.get(), &bStop, &vecNoOfMismatches[ct])));
+	}
+
+	SimpleVolume<uint8_t>::Sampler sampler(&volData);
+	for (int32_t z = -32; z <= 31; z++)
+	{
+		for (int32_t y = -32; y <= 31; y++)
+		{
+			sampler.setPosition(-32,y,z);
+			for (int32_t x = -32; x <= 31; x++)
+			{
+				if(z < 0)
+				{
+					volData.setVoxelAt(x,y,z,snapshotTestValue(x,y,z));
+				}
+				else
+				{
+					sampler.setVoxel(snapshotTestValue(x,y,z));
+				}
+				sampler.movePositiveX();
+			}
+		}
+	}
+
+	bStop.store(true);
+	for(uint32_t ct = 0; ct < uNoOfThreads; ct++)
+	{
+		vecThreads[ct]->join();
+		delete vecThreads[ct];
+		QCOMPARE(vecNoOfMismatches[ct], static_cast<uint32_t>(0));
+	}
+
+	QCOMPARE(countSamplerMismatches(pSnapshot.get(), &pagingTestValue), static_cast<uint32_t>(0));
+	QCOMPARE(countSamplerMismatches(&volData, &snapshotTestValue), static_cast<uint32_t>(0));
+
+	//Modifying the snapshot doesn't affect the volume either.
+	polyvox_shared_ptr< SimpleVolume<uint8_t> > pSecondSnapshot = volData.snapshot();
+	pSecondSnapshot->setVoxelAt(0,0,0,0);
+	QCOMPARE(volData.getVoxelAt(0,0,0), snapshotTestValue(0,0,0));
+
+	//The volume keeps its voxels when the snapshot is destroyed first.
+	pSecondSnapshot.reset();
+	volData.setVoxelAt(1,1,1,0);
+	QCOMPARE(volData.getVoxelAt(0,0,0), snapshotTestValue(0,0,0));
+	QCOMPARE(volData.getVoxelAt(1,1,1), static_cast<uint8_t>(0));
+}
+
+uint8_t regionTransferTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return static_cast<uint8_t>(200 + (x + y * 5 + z * 11) % 50);
+}
+
+//Modifies the volume with writeRegion() and fillRegion(), using regions which aren't aligned to the blocks and
+//which stick out of the volume, and then checks the results with readRegion() and getVoxelAt().
+template <typename VolumeType>
+uint32_t countRegionTransferMismatches(VolumeType* pVolData)
+{
+	const Region& regVolume = pVolData->getEnclosingRegion();
+	const Vector3DInt32& v3dLower = regVolume.getLowerCorner();
+
+	//The expected contents of the volume plus a few voxels of border around it.
+	const Region regAll(v3dLower - Vector3DInt32(3,5,2), regVolume.getUpperCorner() + Vector3DInt32(4,2,6));
+	std::vector<uint8_t> vecExpected(regAll.getWidthInVoxels() * regAll.getHeightInVoxels() * regAll.getDepthInVoxels());
+
+	//Writing the whole lot should just skip the voxels outside the volume.
+	for(int32_t z = regAll.getLowerCorner().getZ(); z <= regAll.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = regAll.getLowerCorner().getY(); y <= regAll.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = regAll.getLowerCorner().getX(); x <= regAll.getUpperCorner().getX(); x++)
+			{
+				vecExpected[getVoxelIndexInRegion(x, y, z, regAll)] = pagingTestValue(x, y, z);
+			}
+		}
+	}
+	pVolData->writeRegion(regAll, &vecExpected[0]);
+
+	//This covers some whole blocks and some partial ones, and the second fill misses the volume completely.
+	const Region regFill(v3dLower + Vector3DInt32(3,1,2), v3dLower + Vector3DInt32(26,20,30));
+	pVolData->fillRegion(regFill, 99);
+	pVolData->fillRegion(Region(v3dLower - Vector3DInt32(10,10,10), v3dLower - Vector3DInt32(1,1,1)), 98);
+
+	const Region regWrite(v3dLower + Vector3DInt32(-2,5,7), v3dLower + Vector3DInt32(9,6,20));
+	std::vector<uint8_t> vecWrite(regWrite.getWidthInVoxels() * regWrite.getHeightInVoxels() * regWrite.getDepthInVoxels());
+	for(int32_t z = regWrite.getLowerCorner().getZ(); z <= regWrite.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = regWrite.getLowerCorner().getY(); y <= regWrite.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = regWrite.getLowerCorner().getX(); x <= regWrite.getUpperCorner().getX(); x++)
+			{
+				vecWrite[getVoxelIndexInRegion(x, y, z, regWrite)] = regionTransferTestValue(x, y, z);
+			}
+		}
+	}
+	pVolData->writeRegion(regWrite, &vecWrite[0]);
+
+	for(int32_t z = regAll.getLowerCorner().getZ(); z <= regAll.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = regAll.getLowerCorner().getY(); y <= regAll.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = regAll.getLowerCorner().getX(); x <= regAll.getUpperCorner().getX(); x++)
+			{
+				const Vector3DInt32 v3dPos(x, y, z);
+				uint8_t& uExpected = vecExpected[getVoxelIndexInRegion(x, y, z, regAll)];
+				if(!regVolume.containsPoint(v3dPos))
+				{
+					uExpected = pVolData->getBorderValue();
+				}
+				else if(regWrite.containsPoint(v3dPos))
+				{
+					uExpected = regionTransferTestValue(x, y, z);
+				}
+				else if(regFill.containsPoint(v3dPos))
+				{
+					uExpected = 99;
+				}
+			}
+		}
+	}
+
+	uint32_t uNoOfMismatches = 0;
+	std::vector<uint8_t> vecRead(vecExpected.size());
+	pVolData->readRegion(regAll, &vecRead[0]);
+	for(int32_t z = regAll.getLowerCorner().getZ(); z <= regAll.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = regAll.getLowerCorner().getY(); y <= regAll.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = regAll.getLowerCorner().getX(); x <= regAll.getUpperCorner().getX(); x++)
+			{
+				const uint32_t uIndex = getVoxelIndexInRegion(x, y, z, regAll);
+				if((vecRead[uIndex] != vecExpected[uIndex]) || (pVolData->getVoxelAt(x, y, z) != vecExpected[uIndex]))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+
+	//A small read from the middle of a block, and one which misses the volume completely.
+	const Region regSmall(v3dLower + Vector3DInt32(1,2,3), v3dLower + Vector3DInt32(2,2,5));
+	pVolData->readRegion(regSmall, &vecRead[0]);
+	for(int32_t z = regSmall.getLowerCorner().getZ(); z <= regSmall.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t x = regSmall.getLowerCorner().getX(); x <= regSmall.getUpperCorner().getX(); x++)
+		{
+			if(vecRead[getVoxelIndexInRegion(x, regSmall.getLowerCorner().getY(), z, regSmall)] != vecExpected[getVoxelIndexInRegion(x, regSmall.getLowerCorner().getY(), z, regAll)])
+			{
+				uNoOfMismatches++;
+			}
+		}
+	}
+	pVolData->readRegion(Region(v3dLower - Vector3DInt32(3,3,3), v3dLower - Vector3DInt32(1,1,1)), &vecRead[0]);
+	uNoOfMismatches += static_cast<uint32_t>(std::count(vecRead.begin(), vecRead.begin() + 27, pVolData->getBorderValue()) != 27);
+
+	return uNoOfMismatches;
+}
+
+void TestVolume::testRegionTransfer()
+{
+	//The volume isn't aligned to the blocks either.
+	const Region reg(Vector3DInt32(-13,-16,-11), Vector3DInt32(18,19,15));
+
+	{
+		RawVolume<uint8_t> volData(reg);
+		volData.setBorderValue(42);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+	}
+
+	{
+		SimpleVolume<uint8_t> volData(reg, 8);
+		volData.setBorderValue(42);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(0,-1,0)));
+
+		volData.setBlockLayout(BlockLayouts::Morton);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+
+		//Writes to a snapshot's blocks go to a copy of them.
+		polyvox_shared_ptr< SimpleVolume<uint8_t> > pSnapshot = volData.snapshot();
+		pSnapshot->fillRegion(reg, 7);
+		QCOMPARE(volData.getVoxelAt(0,0,0), static_cast<uint8_t>(99));
+		QCOMPARE(pSnapshot->getVoxelAt(0,0,0), static_cast<uint8_t>(7));
+	}
+
+	{
+		LargeVolume<uint8_t> volData(reg, 0, 0, false, 8);
+		volData.setBorderValue(42);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+
+		volData.setBlockLayout(BlockLayouts::Morton);
+		volData.setConcurrentAccessEnabled(true);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+	}
+
+	{
+		//With most of the blocks having to be paged out and back in.
+		g_mapPagedData.clear();
+		LargeVolume<uint8_t> volData(reg, &loadPagedData, &savePagedData, true, 8);
+		volData.setMaxNumberOfBlocksInMemory(4);
+		volData.setMaxNumberOfUncompressedBlocks(2);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+	}
+
+	{
+		PalettedVolume<uint8_t> volData(reg, 8);
+		volData.setBorderValue(42);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+	}
+
+	{
+		SparseVolume<uint8_t> volData(reg, 4);
+		volData.setBorderValue(42);
+		QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+	}
+
+	{
+		const char* testFilename = "TestVolumeRegionTransfer.vol";
+		{
+			MappedVolume<uint8_t> volData(testFilename, reg, 8);
+			volData.setBorderValue(42);
+			QCOMPARE(countRegionTransferMismatches(&volData), static_cast<uint32_t>(0));
+		}
+		remove(testFilename);
+	}
+
+	{
+		//The resampler converts between voxel types as it copies.
+		SimpleVolume<uint8_t> volSrc(reg, 8);
+		fillWithPagingTestValues(&volSrc);
+		const Region regDst(Vector3DInt32(0,0,0), reg.getDimensionsInVoxels() - Vector3DInt32(1,1,1));
+		RawVolume<uint16_t> volDst(regDst);
+		VolumeResampler< SimpleVolume<uint8_t>, RawVolume<uint16_t> > resampler(&volSrc, reg, &volDst, regDst);
+		resampler.execute();
+
+		const Vector3DInt32 v3dOffset = reg.getLowerCorner();
+		uint32_t uNoOfMismatches = 0;
+		for(int32_t z = 0; z <= regDst.getUpperCorner().getZ(); z++)
+		{
+			for(int32_t y = 0; y <= regDst.getUpperCorner().getY(); y++)
+			{
+				for(int32_t x = 0; x <= regDst.getUpperCorner().getX(); x++)
+				{
+					if(volDst.getVoxelAt(x, y, z) != pagingTestValue(x + v3dOffset.getX(), y + v3dOffset.getY(), z + v3dOffset.getZ()))
+					{
+						uNoOfMismatches++;
+					}
+				}
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+	}
+}
+
+//The number of times each block has been generated, keyed on the lower corner of its region.
+static std::map<Vector3DInt32, uint32_t> g_mapGeneratedBlocks;
+static polyvox_mutex g_mutexGeneratedBlocks;
+
+//The bottom of the volume is uniform, so that some of the generated blocks get compressed straight away.
+uint8_t generateTestValue(int32_t x, int32_t y, int32_t z)
+{
+	return (z < 0) ? 0 : pagingTestValue(x,y,z);
+}
+
+void generateTestData(const ConstVolumeProxy<uint8_t>& volume, const Region& reg)
+{
+	for(int32_t z = reg.getLowerCorner().getZ(); z <= reg.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = reg.getLowerCorner().getY(); y <= reg.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = reg.getLowerCorner().getX(); x <= reg.getUpperCorner().getX(); x++)
+			{
+				volume.setVoxelAt(x,y,z,generateTestValue(x,y,z));
+			}
+		}
+	}
+
+	polyvox_lock_guard<polyvox_mutex> lock(g_mutexGeneratedBlocks);
+	g_mapGeneratedBlocks[reg.getLowerCorner()]++;
+}
+
+static uint32_t g_uNoOfProgressCalls = 0;
+static uint32_t g_uLastNoOfBlocksGenerated = 0;
+static bool g_bProgressWasInvalid = false;
+//Once this many blocks have been generated the progress handler cancels the generation.
+static uint32_t g_uNoOfBlocksToCancelAt = 0;
+
+bool recordGenerateProgress(uint32_t uNoOfBlocksGenerated, uint32_t uNoOfBlocks)
+{
+	//Always called on the thread which called generate(), so no locking is needed.
+	if((uNoOfBlocksGenerated < g_uLastNoOfBlocksGenerated) || (uNoOfBlocksGenerated > uNoOfBlocks))
+	{
+		g_bProgressWasInvalid = true;
+	}
+	g_uNoOfProgressCalls++;
+	g_uLastNoOfBlocksGenerated = uNoOfBlocksGenerated;
+	return (g_uNoOfBlocksToCancelAt == 0) || (uNoOfBlocksGenerated < g_uNoOfBlocksToCancelAt);
+}
+
+uint32_t countGeneratedBlocks(uint32_t uNoOfTimes)
+{
+	uint32_t uNoOfBlocks = 0;
+	for(std::map<Vector3DInt32, uint32_t>::iterator itBlock = g_mapGeneratedBlocks.begin(); itBlock != g_mapGeneratedBlocks.end(); itBlock++)
+	{
+		if(itBlock->second == uNoOfTimes)
+		{
+			uNoOfBlocks++;
+		}
+	}
+	return uNoOfBlocks;
+}
+
+void TestVolume::testGenerate()
+{
+	g_mapPagedData.clear();
+
+	//The generator fills whole blocks, so the region lines up with them.
+	const int32_t iLower = -48;
+	const int32_t iUpper = 47;
+	const Region reg(Vector3DInt32(iLower,iLower,iLower), Vector3DInt32(iUpper,iUpper,iUpper));
+	const uint32_t uNoOfBlocks = 6 * 6 * 6;
+
+	//Everything fits in memory.
+	{
+		g_mapGeneratedBlocks.clear();
+		g_uNoOfProgressCalls = 0;
+		g_uLastNoOfBlocksGenerated = 0;
+		g_bProgressWasInvalid = false;
+		g_uNoOfBlocksToCancelAt = 0;
+
+		LargeVolume<uint8_t> volData(reg, 0, 0, false, 16);
+		QVERIFY(volData.generate(reg, &generateTestData, 4, &recordGenerateProgress));
+		QVERIFY(!volData.isConcurrentAccessEnabled());
+		QCOMPARE(countGeneratedBlocks(1), uNoOfBlocks);
+		QVERIFY(g_uNoOfProgressCalls > 1);
+		QVERIFY(!g_bProgressWasInvalid);
+		QCOMPARE(g_uLastNoOfBlocksGenerated, uNoOfBlocks);
+		QCOMPARE(countSamplerMismatches(&volData, &generateTestValue), static_cast<uint32_t>(0));
+
+		//The blocks below zero are uniform, so they were compressed as soon as they had been generated.
+		QVERIFY(volData.getUncompressedSizeInBytes() <= (uNoOfBlocks / 2) * 16 * 16 * 16);
+
+		//Generating part of it again only touches the blocks which intersect that part.
+		g_mapGeneratedBlocks.clear();
+		QVERIFY(volData.generate(Region(Vector3DInt32(0,0,0), Vector3DInt32(16,1,1)), &generateTestData));
+		QCOMPARE(g_mapGeneratedBlocks.size(), static_cast<size_t>(2));
+		QCOMPARE(countSamplerMismatches(&volData, &generateTestValue), static_cast<uint32_t>(0));
+	}
+
+	//Only a handful of blocks fit in memory, so the earlier ones are paged out while the later ones are generated.
+	{
+		g_mapGeneratedBlocks.clear();
+		LargeVolume<uint8_t> volData(&loadPagedData, &savePagedData, 16);
+		volData.setMaxNumberOfBlocksInMemory(8);
+		volData.setMaxNumberOfUncompressedBlocks(4);
+		volData.setNumberOfPagingThreads(2);
+
+		QVERIFY(volData.generate(reg, &generateTestData));
+		QVERIFY(volData.isConcurrentAccessEnabled());
+		QCOMPARE(countGeneratedBlocks(1), uNoOfBlocks);
+		QVERIFY(volData.getLoadedBlockStatistics().evictions > 0);
+
+		uint32_t uNoOfMismatches = 0;
+		for (int32_t z = iLower; z <= iUpper; z++)
+		{
+			for (int32_t y = iLower; y <= iUpper; y++)
+			{
+				for (int32_t x = iLower; x <= iUpper; x++)
+				{
+					if(volData.getVoxelAt(x,y,z) != generateTestValue(x,y,z))
+					{
+						uNoOfMismatches++;
+					}
+				}
+			}
+		}
+		QCOMPARE(uNoOfMismatches, static_cast<uint32_t>(0));
+
+		//The data came back from the paging handlers, not the generator.
+		QCOMPARE(countGeneratedBlocks(1), uNoOfBlocks);
+	}
+
+	//Cancelling stops any more blocks being started, but those which already have been are finished.
+	{
+		g_mapGeneratedBlocks.clear();
+		g_uNoOfProgressCalls = 0;
+		g_uLastNoOfBlocksGenerated = 0;
+		g_bProgressWasInvalid = false;
+		g_uNoOfBlocksToCancelAt = 10;
+
+		LargeVolume<uint8_t> volData(reg, 0, 0, false, 16);
+		QVERIFY(volData.generate(reg, &generateTestData, 2, &recordGenerateProgress) == false);
+		QVERIFY(!volData.isConcurrentAccessEnabled());
+		QVERIFY(!g_bProgressWasInvalid);
+		QVERIFY(g_mapGeneratedBlocks.size() >= 10);
+		QVERIFY(g_mapGeneratedBlocks.size() < uNoOfBlocks);
+		QCOMPARE(countGeneratedBlocks(1), static_cast<uint32_t>(g_mapGeneratedBlocks.size()));
+		QCOMPARE(g_uLastNoOfBlocksGenerated, static_cast<uint32_t>(g_mapGeneratedBlocks.size()));
+	}
+}
+
+int32_t borderTestCoordinate(int32_t iPos, int32_t iLower, int32_t iUpper, BorderMode eMode)
+{
+	if(eMode == BorderModes::Clamp)
+	{
+		return std::min(std::max(iPos, iLower), iUpper);
+	}
+	const int32_t iLength = iUpper - iLower + 1;
+	return iLower + (((iPos - iLower) % iLength) + iLength) % iLength;
+}
+
+//Checks getVoxelAt() and readRegion() some way outside a volume filled with the paging test values.
+template <typename VolumeType>
+uint32_t countBorderMismatches(VolumeType* pVolData)
+{
+	const Region& regVolume = pVolData->getEnclosingRegion();
+	const BorderMode eMode = pVolData->getBorderMode();
+
+	//Far enough out to cross several blocks, and wrap round more than once on the low side.
+	const Region regAll(regVolume.getLowerCorner() - Vector3DInt32(70,9,3), regVolume.getUpperCorner() + Vector3DInt32(5,12,20));
+	std::vector<uint8_t> vecRead(regAll.getWidthInVoxels() * regAll.getHeightInVoxels() * regAll.getDepthInVoxels());
+	pVolData->readRegion(regAll, &vecRead[0]);
+
+	uint32_t uNoOfMismatches = 0;
+	for(int32_t z = regAll.getLowerCorner().getZ(); z <= regAll.getUpperCorner().getZ(); z++)
+	{
+		for(int32_t y = regAll.getLowerCorner().getY(); y <= regAll.getUpperCorner().getY(); y++)
+		{
+			for(int32_t x = regAll.getLowerCorner().getX(); x <= regAll.getUpperCorner().getX(); x++)
+			{
+				uint8_t uExpected = pVolData->getBorderValue();
+				if((eMode != BorderModes::Constant) || regVolume.containsPoint(Vector3DInt32(x, y, z)))
+				{
+					uExpected = pagingTestValue
+					(
+						borderTestCoordinate(x, regVolume.getLowerCorner().getX(), regVolume.getUpperCorner().getX(), eMode),
+						borderTestCoordinate(y, regVolume.getLowerCorner().getY(), regVolume.getUpperCorner().getY(), eMode),
+						borderTestCoordinate(z, regVolume.getLowerCorner().getZ(), regVolume.getUpperCorner().getZ(), eMode)
+					);
+				}
+
+				if((pVolData->getVoxelAt(x, y, z) != uExpected) || (vecRead[getVoxelIndexInRegion(x, y, z, regAll)] != uExpected))
+				{
+					uNoOfMismatches++;
+				}
+			}
+		}
+	}
+	return uNoOfMismatches;
+}
+
+void TestVolume::testBorderModes()
+{
+	const Region reg(Vector3DInt32(-16,-16,-16), Vector3DInt32(15,15,15));
+	const BorderMode modes[] = { BorderModes::Constant, BorderModes::Clamp, BorderModes::Wrap };
+
+	for(uint32_t uMode = 0; uMode < 3; uMode++)
+	{
+		{
+			SimpleVolume<uint8_t> volData(reg, 8);
+			QCOMPARE(volData.getBorderMode(), BorderModes::Constant);
+			volData.setBorderValue(42);
+			volData.setBorderMode(modes[uMode]);
+			fillWithPagingTestValues(&volData);
+			QCOMPARE(countBorderMismatches(&volData), static_cast<uint32_t>(0));
+			QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+
+			//Only a constant border is known to be uniform without looking at the voxels it maps to.
+			QCOMPARE(volData.isBlockUniform(Vector3DInt32(0,-5,0)), modes[uMode] == BorderModes::Constant);
+
+			volData.setBlockLayout(BlockLayouts::Morton);
+			QCOMPARE(countBorderMismatches(&volData), static_cast<uint32_t>(0));
+			QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+
+			//Snapshots keep the border.
+			polyvox_shared_ptr< SimpleVolume<uint8_t> > pSnapshot = volData.snapshot();
+			QCOMPARE(pSnapshot->getBorderMode(), modes[uMode]);
+			QCOMPARE(countBorderMismatches(pSnapshot.get()), static_cast<uint32_t>(0));
+		}
+
+		{
+			LargeVolume<uint8_t> volData(reg, 0, 0, false, 8);
+			volData.setBorderValue(42);
+			volData.setBorderMode(modes[uMode]);
+			QCOMPARE(volData.getBorderMode(), modes[uMode]);
+			fillWithPagingTestValues(&volData);
+			QCOMPARE(countBorderMismatches(&volData), static_cast<uint32_t>(0));
+			QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+			QCOMPARE(volData.isBlockUniform(Vector3DInt32(0,-5,0)), modes[uMode] == BorderModes::Constant);
+
+			volData.setConcurrentAccessEnabled(true);
+			QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+		}
+
+		{
+			//A constant border which doesn't fit in the shared uniform blocks is still read correctly.
+			LargeVolume<uint8_t> volData(reg, 0, 0, false, 8);
+			volData.setBorderMode(modes[uMode]);
+			fillWithPagingTestValues(&volData);
+			for(uint8_t uValue = 0; uValue < 20; uValue++)
+			{
+				volData.setBorderValue(100 + uValue);
+				QCOMPARE(countBorderMismatches(&volData), static_cast<uint32_t>(0));
+			}
+			QCOMPARE(countNeighbourhoodMismatches(&volData), static_cast<uint32_t>(0));
+		}
+	}
+
+	//A clamped volume whose edge is uniform has uniform blocks outside it too.
+	{
+		SimpleVolume<uint8_t> volData(reg, 8);
+		volData.setBorderMode(BorderModes::Clamp);
+		volData.fillRegion(reg, 5);
+		QVERIFY(volData.isBlockUniform(Vector3DInt32(0,-5,0)));
+		QCOMPARE(volData.getVoxelAt(100,-100,3), static_cast<uint8_t>(5));
+	}
+}
+
 QTEST_MAIN(TestVolume)
@@ -32,6 +32,17 @@ class TestVolume: public QObject
 	
 	private slots:
 		void testSize();
+		void testPaging();
+		void testAsyncPaging();
+		void testConcurrentReads();
+		void testUniformBlocks();
+		void testBlockLayouts();
+		void testBufferPool();
+		void testMemoryBudget();
+		void testSnapshot();
+		void testRegionTransfer();
+		void testGenerate();
+		void testBorderModes();
 };
 
 #endif